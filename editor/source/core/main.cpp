@@ -10,7 +10,10 @@ int main()
 {
     Application app;
 
-    app.Init();
+    if (!app.Init())
+    {
+        return -1;
+    }
 
     // Let the window open until we press escape or the window should close
     while (ServiceLocator::Get<Window>()->IsWindowOpen())
@@ -1,73 +1,70 @@
 #version 450 core
 
+// each keyword is defined in the variants drawing the feature (see ShaderKeyword in shader.h)
+#pragma keywords DIRECTIONAL_LIGHTS POINT_LIGHTS SPOT_LIGHTS HAS_TEXTURE PICKING_OUTPUT
+
 layout (location = 0) out vec4 FragColor;
+#ifdef PICKING_OUTPUT
 layout (location = 1) out int PickingFragColor;
+#endif
 
-struct DirLight 
+// packed light (see GpuLight in light_manager.h)
+struct Light
 {
-    vec3 direction;
-	
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
+    vec4 position;  // xyz : position, w : outer cut off
+    vec4 direction; // xyz : direction, w : cut off
+    vec4 ambient;   // xyz : ambient, w : constant attenuation
+    vec4 diffuse;   // xyz : diffuse, w : linear attenuation
+    vec4 specular;  // xyz : specular, w : quadratic attenuation
 };
 
-struct PointLight 
+in vec3 FragPos;
+in vec2 TexCoord;
+in vec3 Normal;
+
+layout (std140, row_major, binding = 0) uniform Camera
 {
-    vec3 position;
-    
-    float constant;
-    float linear;
-    float quadratic;
-	
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-
-    bool isUsed;
+    mat4 vp;
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
 };
 
-struct SpotLight 
+// LIGHT
+// lights sorted by type : directional lights, then point lights, then spot lights
+layout (std430, binding = 1) readonly buffer Lights
 {
-    vec3 position;
-    vec3 direction;
-    float cutOff;
-    float outerCutOff;
-  
-    float constant;
-    float linear;
-    float quadratic;
-  
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular; 
-    
-    bool isUsed;
+    uvec4 lightCounts; // x : directional, y : point, z : spot
+    Light lights[];
 };
 
-in vec3 FragPos;
-in vec2 TexCoord;
-in vec3 Normal;
-
-// LIGHT
-#define NBR_OF_DIR_LIGHT 1
-#define NBR_OF_POINT_LIGHT 16
-#define NBR_OF_SPOT_LIGHT 16
+// CLUSTERS
+// the view frustum is split in clusters, each one references the point and spot lights touching it
+layout (std430, binding = 2) readonly buffer LightClusters
+{
+    uvec4 clusterCount; // xyz : number of clusters on each axis
+    vec4 clusterParams; // xy : viewport size, z : depth slice scale, w : depth slice bias
+    uvec2 clusters[];   // x : offset in lightIndices, y : number of lights
+};
 
-uniform vec3 viewPos;
-uniform DirLight dirLights[NBR_OF_DIR_LIGHT];
-uniform PointLight pointLights[NBR_OF_POINT_LIGHT];
-uniform SpotLight spotLights[NBR_OF_SPOT_LIGHT];
+layout (std430, binding = 3) readonly buffer LightIndices
+{
+    uint lightIndices[];
+};
 
-uniform int EntityID;
+#ifdef PICKING_OUTPUT
+flat in int EntityID;
+#endif
 
 // TEXTURE
+#ifdef HAS_TEXTURE
 uniform sampler2D texture0;
+#endif
 
 // calculates the color when using a directional light.
-vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
+vec3 CalcDirLight(Light light, vec3 normal, vec3 viewDir, vec3 albedo)
 {
-    vec3 lightDir = normalize(-light.direction);
+    vec3 lightDir = normalize(-light.direction.xyz);
     // diffuse shading
     float diff = max(dot(normal, lightDir), 0.0);
 
@@ -76,29 +73,29 @@ vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
 
     // combine results
-    vec3 ambient = light.ambient * vec3(texture(texture0, TexCoord));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(texture0, TexCoord));
-    vec3 specular = light.specular * spec * vec3(texture(texture0, TexCoord));
+    vec3 ambient = light.ambient.xyz * albedo;
+    vec3 diffuse = light.diffuse.xyz * diff * albedo;
+    vec3 specular = light.specular.xyz * spec * albedo;
 
     return  (ambient + diffuse + specular);
 }
 
 // calculates the color when using a point light.
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+vec3 CalcPointLight(Light light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 albedo)
 {
-    vec3 lightDir = normalize(light.position - fragPos);
+    vec3 lightDir = normalize(light.position.xyz - fragPos);
     // diffuse shading
     float diff = max(dot(normal, lightDir), 0.0);
     // specular shading
     vec3 reflectDir = reflect(-lightDir, normal);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
     // attenuation
-    float distance = length(light.position - fragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
+    float distance = length(light.position.xyz - fragPos);
+    float attenuation = 1.0 / (light.ambient.w + light.diffuse.w * distance + light.specular.w * (distance * distance));    
     // combine results
-    vec3 ambient = light.ambient * vec3(texture(texture0, TexCoord));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(texture0, TexCoord));
-    vec3 specular = light.specular * spec * vec3(texture(texture0, TexCoord));
+    vec3 ambient = light.ambient.xyz * albedo;
+    vec3 diffuse = light.diffuse.xyz * diff * albedo;
+    vec3 specular = light.specular.xyz * spec * albedo;
     ambient *= attenuation;
     diffuse *= attenuation;
     specular *= attenuation;
@@ -107,61 +104,91 @@ vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
 
 
 // calculates the color when using a spot light.
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+vec3 CalcSpotLight(Light light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 albedo)
 {
-    vec3 lightDir = normalize(light.position - fragPos);
+    vec3 lightDir = normalize(light.position.xyz - fragPos);
     // diffuse shading
     float diff = max(dot(normal, lightDir), 0.0);
     // specular shading
     vec3 reflectDir = reflect(-lightDir, normal);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
     // attenuation
-    float distance = length(light.position - fragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
+    float distance = length(light.position.xyz - fragPos);
+    float attenuation = 1.0 / (light.ambient.w + light.diffuse.w * distance + light.specular.w * (distance * distance));    
     // spotlight intensity
-    float theta = dot(lightDir, normalize(-light.direction)); 
-    float epsilon = light.cutOff - light.outerCutOff;
-    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+    float theta = dot(lightDir, normalize(-light.direction.xyz)); 
+    float epsilon = light.direction.w - light.position.w;
+    float intensity = clamp((theta - light.position.w) / epsilon, 0.0, 1.0);
     // combine results
-    vec3 ambient = light.ambient * vec3(texture(texture0, TexCoord));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(texture0, TexCoord));
-    vec3 specular = light.specular * spec * vec3(texture(texture0, TexCoord));
+    vec3 ambient = light.ambient.xyz * albedo;
+    vec3 diffuse = light.diffuse.xyz * diff * albedo;
+    vec3 specular = light.specular.xyz * spec * albedo;
     ambient *= attenuation * intensity;
     diffuse *= attenuation * intensity;
     specular *= attenuation * intensity;
     return (ambient + diffuse + specular);
 }
 
+// index of the cluster containing the fragment
+uint GetClusterIndex()
+{
+    uvec2 tile = min(uvec2(gl_FragCoord.xy / clusterParams.xy * vec2(clusterCount.xy)), clusterCount.xy - 1u);
+
+    // gl_FragCoord.w is 1 / clip w, which is the view depth
+    float depth = 1.0 / gl_FragCoord.w;
+    uint slice = uint(clamp(log(depth) * clusterParams.z - clusterParams.w, 0.0, float(clusterCount.z - 1u)));
+
+    return tile.x + clusterCount.x * (tile.y + clusterCount.y * slice);
+}
+
 void main()
 {
-    vec3 result;
+    vec3 result = vec3(0.0);
     vec3 norm = normalize(Normal);
     vec3 viewDir = normalize(viewPos - FragPos);
-    
-    // dirlight
-    for (int i = 0; i < NBR_OF_DIR_LIGHT; i++)
+
+    // sampled once for every light
+#ifdef HAS_TEXTURE
+    vec3 albedo = vec3(texture(texture0, TexCoord));
+#else
+    vec3 albedo = vec3(1.0);
+#endif
+
+#ifdef DIRECTIONAL_LIGHTS
+    // dir light
+    for (uint i = 0u; i < lightCounts.x; i++)
     {
-         result += CalcDirLight(dirLights[i], norm, viewDir);
+        result += CalcDirLight(lights[i], norm, viewDir, albedo);
     }
-    
-    // point light
-    for (int i = 0; i < NBR_OF_POINT_LIGHT; i++)
+#endif
+
+#if defined(POINT_LIGHTS) || defined(SPOT_LIGHTS)
+    // point and spot lights of the cluster, sorted by type like the lights buffer
+    uvec2 cluster = clusters[GetClusterIndex()];
+    uint firstSpotLight = lightCounts.x + lightCounts.y;
+    for (uint i = cluster.x; i < cluster.x + cluster.y; i++)
     {
-        if (pointLights[i].isUsed)
+        uint lightIndex = lightIndices[i];
+
+#if defined(POINT_LIGHTS) && defined(SPOT_LIGHTS)
+        if (lightIndex < firstSpotLight)
         {
-            result += CalcPointLight(pointLights[i], norm, FragPos, viewDir);
+            result += CalcPointLight(lights[lightIndex], norm, FragPos, viewDir, albedo);
         }
-    }
-
-    // point light
-    for (int i = 0; i < NBR_OF_SPOT_LIGHT; i++)
-    {
-        if (spotLights[i].isUsed)
+        else
         {
-            result += CalcSpotLight(spotLights[i], norm, FragPos, viewDir);
+            result += CalcSpotLight(lights[lightIndex], norm, FragPos, viewDir, albedo);
         }
+#elif defined(POINT_LIGHTS)
+        result += CalcPointLight(lights[lightIndex], norm, FragPos, viewDir, albedo);
+#else
+        result += CalcSpotLight(lights[lightIndex], norm, FragPos, viewDir, albedo);
+#endif
     }
-    
+#endif
+
     FragColor = vec4(result, 1.0);
+#ifdef PICKING_OUTPUT
     PickingFragColor = EntityID;
+#endif
 }
\ No newline at end of file
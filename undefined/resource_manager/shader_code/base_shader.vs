@@ -4,18 +4,36 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
 
-uniform mat4 model;
-uniform mat4 vp;
+// Per-instance data, the rows of the model matrix are read as columns
+layout (location = 3) in mat4 aModel;
+layout (location = 7) in int aEntityID;
+
+layout (std140, row_major, binding = 0) uniform Camera
+{
+    mat4 vp;
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
 
 out vec3 Normal;
 out vec2 TexCoord;
 out vec3 FragPos;
+#ifdef PICKING_OUTPUT
+flat out int EntityID;
+#endif
+
+// The depth pre-pass computes the same position, its depths must be equal to these ones
+invariant gl_Position;
 
 void main()
 {
-   FragPos = vec3(model * vec4(aPos, 1.0f));
+   FragPos = vec3(vec4(aPos, 1.0f) * aModel);
    Normal = aNormal;
    TexCoord = aTexCoord;
+#ifdef PICKING_OUTPUT
+   EntityID = aEntityID;
+#endif
 
    gl_Position = vp * vec4(FragPos, 1.0);
 }
@@ -0,0 +1,161 @@
+#version 450 core
+
+// Test the bounds of every instance against the frustum and the depth pyramid of the previous frame,
+// the visible instances are copied next to each other from the base instance of their command
+layout (local_size_x = 64) in;
+
+layout (std140, row_major, binding = 0) uniform Camera
+{
+    mat4 vp;
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
+
+struct CullObject
+{
+    vec3 center;
+    uint command;
+    vec3 extents;
+    float padding;
+};
+
+struct DrawCommand
+{
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+// Model matrix (16 floats) and entity id (bits of an int), packed like InstanceData
+const uint INSTANCE_SIZE = 17u;
+
+layout (std430, binding = 4) readonly buffer SourceInstances
+{
+    float sourceInstances[];
+};
+
+layout (std430, binding = 5) readonly buffer CullObjects
+{
+    CullObject objects[];
+};
+
+layout (std430, binding = 6) writeonly buffer Instances
+{
+    float instances[];
+};
+
+layout (std430, binding = 7) buffer DrawCommands
+{
+    DrawCommand commands[];
+};
+
+layout (std430, binding = 8) buffer CullStats
+{
+    uint tested;
+    uint frustumCulled;
+    uint occlusionCulled;
+    uint visible;
+};
+
+uniform int objectCount;
+uniform bool occlusionCulling;
+uniform sampler2D depthPyramid;
+uniform int pyramidLevelCount;
+uniform mat4 previousViewProjection;
+
+bool IsInsideFrustum(vec3 center, vec3 extents)
+{
+    // Gribb-Hartmann : the planes are the last row of the VP plus or minus the other rows
+    mat4 rows = transpose(vp);
+
+    for (int i = 0; i < 6; i++)
+    {
+        vec4 plane = rows[3] + ((i & 1) == 0 ? rows[i >> 1] : -rows[i >> 1]);
+
+        // Not normalized, only the sign of the distance matters
+        if (dot(plane.xyz, center) + plane.w + dot(abs(plane.xyz), extents) < 0.0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool IsOccluded(vec3 center, vec3 extents)
+{
+    vec2 minUV = vec2(1.0);
+    vec2 maxUV = vec2(0.0);
+    float minDepth = 1.0;
+
+    for (int i = 0; i < 8; i++)
+    {
+        vec3 corner = center + extents * vec3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0, (i & 4) != 0 ? 1.0 : -1.0);
+        vec4 clip = previousViewProjection * vec4(corner, 1.0);
+
+        // Crossing the near plane of the previous camera, no reliable rectangle
+        if (clip.w <= 0.0)
+        {
+            return false;
+        }
+
+        vec3 ndc = clip.xyz / clip.w;
+        minUV = min(minUV, ndc.xy * 0.5 + 0.5);
+        maxUV = max(maxUV, ndc.xy * 0.5 + 0.5);
+        minDepth = min(minDepth, ndc.z * 0.5 + 0.5);
+    }
+
+    minUV = clamp(minUV, 0.0, 1.0);
+    maxUV = clamp(maxUV, 0.0, 1.0);
+
+    // Level where the rectangle covers at most 2x2 texels
+    vec2 size = (maxUV - minUV) * vec2(textureSize(depthPyramid, 0));
+    int level = clamp(int(ceil(log2(max(max(size.x, size.y), 1.0)))), 0, pyramidLevelCount - 1);
+
+    ivec2 levelSize = textureSize(depthPyramid, level);
+    ivec2 first = clamp(ivec2(minUV * vec2(levelSize)), ivec2(0), levelSize - 1);
+    ivec2 last = clamp(ivec2(maxUV * vec2(levelSize)), ivec2(0), levelSize - 1);
+
+    float maxDepth = max(max(texelFetch(depthPyramid, first, level).r, texelFetch(depthPyramid, ivec2(last.x, first.y), level).r),
+                         max(texelFetch(depthPyramid, ivec2(first.x, last.y), level).r, texelFetch(depthPyramid, last, level).r));
+
+    return minDepth > maxDepth;
+}
+
+void main()
+{
+    uint id = gl_GlobalInvocationID.x;
+
+    if (id >= uint(objectCount))
+    {
+        return;
+    }
+
+    atomicAdd(tested, 1u);
+
+    CullObject object = objects[id];
+
+    if (!IsInsideFrustum(object.center, object.extents))
+    {
+        atomicAdd(frustumCulled, 1u);
+        return;
+    }
+
+    if (occlusionCulling && IsOccluded(object.center, object.extents))
+    {
+        atomicAdd(occlusionCulled, 1u);
+        return;
+    }
+
+    atomicAdd(visible, 1u);
+
+    uint slot = commands[object.command].baseInstance + atomicAdd(commands[object.command].instanceCount, 1u);
+
+    for (uint i = 0u; i < INSTANCE_SIZE; i++)
+    {
+        instances[slot * INSTANCE_SIZE + i] = sourceInstances[id * INSTANCE_SIZE + i];
+    }
+}
@@ -0,0 +1,6 @@
+#version 450 core
+
+// Only the depth is written, the color writes are masked during the pre-pass
+void main()
+{
+}
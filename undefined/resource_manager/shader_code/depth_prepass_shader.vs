@@ -0,0 +1,23 @@
+#version 450 core
+layout (location = 0) in vec3 aPos;
+
+// Per-instance data, the rows of the model matrix are read as columns
+layout (location = 3) in mat4 aModel;
+
+layout (std140, row_major, binding = 0) uniform Camera
+{
+    mat4 vp;
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
+
+// Same expression as base_shader.vs, the depths must be equal for the GL_EQUAL test of the opaque pass
+invariant gl_Position;
+
+void main()
+{
+   vec3 fragPos = vec3(vec4(aPos, 1.0f) * aModel);
+
+   gl_Position = vp * vec4(fragPos, 1.0);
+}
@@ -0,0 +1,36 @@
+#version 450 core
+
+// Build a level of the depth pyramid : each texel keeps the farthest depth of the texels it covers in the source
+layout (local_size_x = 8, local_size_y = 8) in;
+
+uniform sampler2D source;
+uniform int sourceLevel;
+
+layout (r32f, binding = 0) writeonly uniform image2D destination;
+
+void main()
+{
+   ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+   ivec2 destinationSize = imageSize(destination);
+
+   if (texel.x >= destinationSize.x || texel.y >= destinationSize.y)
+   {
+      return;
+   }
+
+   // The source is at most twice as big (the first level is the power of two below the depth buffer)
+   ivec2 sourceSize = textureSize(source, sourceLevel);
+   ivec2 first = texel * sourceSize / destinationSize;
+   ivec2 last = max(((texel + 1) * sourceSize + destinationSize - 1) / destinationSize, first + 1);
+
+   float depth = 0.0;
+   for (int y = first.y; y < last.y; y++)
+   {
+      for (int x = first.x; x < last.x; x++)
+      {
+         depth = max(depth, texelFetch(source, min(ivec2(x, y), sourceSize - 1), sourceLevel).r);
+      }
+   }
+
+   imageStore(destination, texel, vec4(depth));
+}
@@ -1,12 +1,10 @@
 #version 450 core
 
-layout (location = 0) out vec4 FragColor;
+layout (location = 0) out int PickingFragColor;
 
-in vec3 FragPos;
-in vec2 TexCoord;
-in vec3 Normal;
+flat in int EntityID;
 
 void main()
 {
-    FragColor = vec4(1.0, 0.0, 0.0, 1.0);
+    PickingFragColor = EntityID;
 }
\ No newline at end of file
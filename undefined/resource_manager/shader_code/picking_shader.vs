@@ -1,20 +1,23 @@
 #version 450 core
 layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
-layout (location = 2) in vec2 aTexCoord;
 
-uniform mat4 model;
-uniform mat4 vp;
+// Per-instance data, the rows of the model matrix are read as columns
+layout (location = 3) in mat4 aModel;
+layout (location = 7) in int aEntityID;
 
-out vec3 Normal;
-out vec2 TexCoord;
-out vec3 FragPos;
+layout (std140, row_major, binding = 0) uniform Camera
+{
+    mat4 vp;
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
+
+flat out int EntityID;
 
 void main()
 {
-   FragPos = vec3(model * vec4(aPos, 1.0f));
-   Normal = aNormal;
-   TexCoord = aTexCoord;
+   EntityID = aEntityID;
 
-   gl_Position = vp * model * vec4(FragPos, 1.0);
+   gl_Position = vp * vec4(vec3(vec4(aPos, 1.0f) * aModel), 1.0);
 }
@@ -3,12 +3,17 @@ layout (location = 0) in vec3 aPos;
 
 out vec3 TexCoords;
 
-uniform mat4 projection;
-uniform mat4 view;
+layout (std140, row_major, binding = 0) uniform Camera
+{
+    mat4 vp;
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
 
 void main()
 {
     TexCoords = aPos;
-    vec4 pos = projection * view * vec4(aPos, 1.0);
+    vec4 pos = projection * mat4(mat3(view)) * vec4(aPos, 1.0); // remove translation from the view matrix
     gl_Position = pos.xyww;
 }  
\ No newline at end of file
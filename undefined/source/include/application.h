@@ -10,7 +10,10 @@
 
 #include "utils/flag.h"
 
+#include "wrapper/frame_graph.h"
+
 class Window;
+class EditorViewport;
 class Renderer;
 class Object;
 
@@ -19,7 +22,11 @@ class Application
 public:
 	UNDEFINED_ENGINE Application();
 
-	UNDEFINED_ENGINE void Init();
+	/// <summary>
+	/// Init the window, the renderer and the engine
+	/// </summary>
+	/// <returns>Return either true if the application can run or false</returns>
+	UNDEFINED_ENGINE bool Init();
 	UNDEFINED_ENGINE void Update();
 	UNDEFINED_ENGINE void Clear();
 
@@ -28,10 +35,29 @@ public:
 	Logger Log;
 
 private:
+	/// <summary>
+	/// Declare the passes drawing a viewport in the frame graph
+	/// </summary>
+	/// <param name="viewport">: Viewport drawn</param>
+	/// <param name="viewportImages">: Images displayed by the interface, the image of the viewport is added if it must be drawn again</param>
+	void AddViewportPasses(EditorViewport* viewport, std::vector<FrameGraphResource>& viewportImages);
+
 	Editor mEditor;
 	Game mGame;
 	Window* mWindowManager = nullptr;
 	Renderer* mRenderer = nullptr;
+	/// <summary>
+	/// Were textures or shaders loading during the last frame, the viewports show the last ones once they are done
+	/// </summary>
+	bool mWasLoading = false;
+	/// <summary>
+	/// Passes of the frame, declared again every frame
+	/// </summary>
+	FrameGraph mFrameGraph;
+	/// <summary>
+	/// Position-only program of the depth pre-pass of the viewports
+	/// </summary>
+	std::shared_ptr<Shader> mDepthPrepassShader;
 
 public:
 	UNDEFINED_ENGINE static inline bool IsInGame = false;
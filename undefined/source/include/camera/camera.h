@@ -4,6 +4,7 @@
 
 #include <toolbox/Matrix4x4.h>
 #include <toolbox/Vector3.h>
+#include <toolbox/calc.h>
 
 #include "utils/flag.h"
 
@@ -81,6 +82,19 @@ public:
     /// </summary>
     float Height;
 
+    /// <summary>
+    /// Vertical field of view in radians
+    /// </summary>
+    float Fov = calc::PI / 2.f;
+    /// <summary>
+    /// Distance of the near plane
+    /// </summary>
+    float Near = 0.1f;
+    /// <summary>
+    /// Distance of the far plane
+    /// </summary>
+    float Far = 100.f;
+
 private:
     /// <summary>
     /// Matrix4x4 for the VP (Perspective * View)
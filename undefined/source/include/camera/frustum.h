@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <toolbox/Matrix4x4.h>
+#include <toolbox/Vector4.h>
+
+#include "utils/bounds.h"
+#include "utils/flag.h"
+
+/// <summary>
+/// Six planes of a view frustum, the normals point inside
+/// </summary>
+class Frustum
+{
+public:
+	/// <summary>
+	/// Default constructor of Frustum (every plane accepts everything)
+	/// </summary>
+	UNDEFINED_ENGINE Frustum() = default;
+	/// <summary>
+	/// Constructor of Frustum, extract the planes from a view projection matrix (Gribb and Hartmann)
+	/// </summary>
+	/// <param name="viewProjection">: VP of the camera</param>
+	UNDEFINED_ENGINE Frustum(const Matrix4x4& viewProjection);
+
+	/// <summary>
+	/// Test a sphere against the frustum
+	/// </summary>
+	/// <param name="sphere">: Sphere in world space</param>
+	/// <returns>Return either true if the sphere is at least partly inside or false</returns>
+	UNDEFINED_ENGINE bool Intersects(const BoundingSphere& sphere) const;
+	/// <summary>
+	/// Test a box against the frustum
+	/// </summary>
+	/// <param name="box">: Box in world space</param>
+	/// <returns>Return either true if the box is at least partly inside or false</returns>
+	UNDEFINED_ENGINE bool Intersects(const BoundingBox& box) const;
+	/// <summary>
+	/// Check if a box is completely inside the frustum
+	/// </summary>
+	/// <param name="box">: Box in world space</param>
+	/// <returns>Return either true if the whole box is inside or false</returns>
+	UNDEFINED_ENGINE bool Contains(const BoundingBox& box) const;
+
+	/// <summary>
+	/// Test boxes stored as arrays of centers and extents, four boxes are tested at once with SSE
+	/// </summary>
+	/// <param name="centerX">: X coordinate of the center of each box</param>
+	/// <param name="centerY">: Y coordinate of the center of each box</param>
+	/// <param name="centerZ">: Z coordinate of the center of each box</param>
+	/// <param name="extentX">: Half size of each box on X</param>
+	/// <param name="extentY">: Half size of each box on Y</param>
+	/// <param name="extentZ">: Half size of each box on Z</param>
+	/// <param name="count">: Number of boxes</param>
+	/// <param name="visible">: Written with 1 for each box at least partly inside, 0 otherwise (count elements)</param>
+	/// <returns>Return the number of visible boxes</returns>
+	UNDEFINED_ENGINE size_t CullBoxes(const float* centerX, const float* centerY, const float* centerZ,
+		const float* extentX, const float* extentY, const float* extentZ, size_t count, uint8_t* visible) const;
+
+	/// <summary>
+	/// Number of planes : left, right, bottom, top, near, far
+	/// </summary>
+	static constexpr int PlaneCount = 6;
+
+	/// <summary>
+	/// Planes (xyz : normal, w : distance), a point p is inside when dot(normal, p) + w >= 0
+	/// </summary>
+	Vector4 Planes[PlaneCount];
+};
@@ -15,7 +15,7 @@ public:
 	~Framebuffer();
 
     /// <summary>
-    /// Rescale the framebuffer
+    /// Rescale the framebuffer, the attachments are only allocated again when its size in pixels changes
     /// </summary>
     /// <param name="width">: New width of the framebuffer</param>
     /// <param name="height">: New height of the framebuufer</param>
@@ -40,11 +40,20 @@ public:
 	unsigned int RBO_ID;
 
 	/// <summary>
-	/// stdd::vector to store the textures usefull for the framebuffer
+	/// ID of the color textures, they come from the RenderTargetPool and are given back to it when the framebuffer is resized or destroyed
 	/// </summary>
-	std::vector<std::unique_ptr<Texture>> FramebufferTextures;
+	std::vector<unsigned int> FramebufferTextures;
 
 private:
+    /// <summary>
+    /// Get the color textures of the size of the framebuffer from the pool and allocate the depth renderbuffer, then attach them
+    /// </summary>
+    void AllocateAttachments();
+
+    /// <summary>
+    /// Sized format of each color texture
+    /// </summary>
+    std::vector<unsigned int> mColorFormats;
     /// <summary>
     /// Pointer to our Renderer to simplify the calls from the ServiceLocator
     /// </summary>
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+
+#include "utils/flag.h"
+
+/// <summary>
+/// A Class for a window comparing the spatial queries of the BVH with a scan of every object
+/// </summary>
+class BvhBenchmark
+{
+	STATIC_CLASS(BvhBenchmark)
+
+public:
+	/// <summary>
+	/// Display the BVH window
+	/// </summary>
+	UNDEFINED_ENGINE static void ShowWindow();
+
+private:
+	/// <summary>
+	/// Build a BVH of random boxes and time each kind of query against the scan of the same boxes
+	/// </summary>
+	static void Run();
+
+	/// <summary>
+	/// Timings of one kind of query
+	/// </summary>
+	struct QueryResult
+	{
+		/// <summary>
+		/// Name of the query
+		/// </summary>
+		const char* Name = "";
+		/// <summary>
+		/// Time spent in the BVH (ms)
+		/// </summary>
+		double BvhTime = 0.0;
+		/// <summary>
+		/// Time spent scanning every box (ms)
+		/// </summary>
+		double ScanTime = 0.0;
+		/// <summary>
+		/// Boxes found by the BVH and by the scan, the BVH tests the fat boxes so it can find a few more
+		/// </summary>
+		size_t BvhHits = 0;
+		size_t ScanHits = 0;
+	};
+
+	/// <summary>
+	/// Number of boxes of the benchmark
+	/// </summary>
+	static inline int mObjectCount = 100000;
+	/// <summary>
+	/// Number of queries of each kind
+	/// </summary>
+	static inline int mQueryCount = 1000;
+
+	/// <summary>
+	/// Time spent inserting the boxes (ms)
+	/// </summary>
+	static inline double mBuildTime = 0.0;
+	/// <summary>
+	/// Height of the BVH built
+	/// </summary>
+	static inline int mHeight = -1;
+	/// <summary>
+	/// Results of the box, sphere, ray and frustum queries (defined in the .cpp, QueryResult is only complete once the class is)
+	/// </summary>
+	static QueryResult mResults[4];
+	/// <summary>
+	/// Has the benchmark been run
+	/// </summary>
+	static inline bool mHasRun = false;
+};
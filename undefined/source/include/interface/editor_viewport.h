@@ -1,15 +1,21 @@
 #pragma once
 
+#include <cstdint>
 #include <imgui/imgui.h>
 
 #include "framebuffer.h"
 
+#include <toolbox/Matrix4x4.h>
 #include <toolbox/Vector2.h>
 
 #include "resources/shader.h"
 
 #include "world/gizmo.h"
 
+#include "wrapper/gpu_timer.h"
+
+class Scene;
+
 /// <summary>
 /// A Class for the Viewport in the Editor
 /// </summary>
@@ -43,16 +49,38 @@ public:
 	/// <returns>Return the framebuffer ID</returns>
 	unsigned int GetFBO_ID() const;
 	/// <summary>
+	/// Get the framebuffer drawn by the viewport
+	/// </summary>
+	/// <returns>Return a pointer to the Framebuffer</returns>
+	Framebuffer* GetFramebuffer() const;
+	/// <summary>
 	/// Get the editor ID
 	/// </summary>
 	/// <returns>Return the editor ID</returns>
 	int GetEditorID() const;
 
 	/// <summary>
-	/// Rescale the viewport with the current window size
+	/// Rescale the viewport with the current window size, the framebuffer is only reallocated when the size has changed
 	/// </summary>
 	void RescaleViewport();
 
+	/// <summary>
+	/// Check if the window of the viewport is shown with a size
+	/// </summary>
+	/// <returns>Return either true if the image of the viewport is on the screen or false</returns>
+	bool IsVisible() const;
+	/// <summary>
+	/// Check if the viewport must be drawn again : it is visible and its camera, its size, the scene, the lights or the editor changed since its last image,
+	/// or its last image was occlusion culled with the depth of an image drawn in another state
+	/// </summary>
+	/// <returns>Return either true if the framebuffer must be drawn or false if it keeps its last image</returns>
+	bool NeedsRedraw() const;
+	/// <summary>
+	/// Remember the state the framebuffer has been drawn with
+	/// </summary>
+	/// <param name="occlusionCulled">: Was the image culled against the depth pyramid of the previous image</param>
+	void SetDrawn(bool occlusionCulled);
+
 	void SetMouseMinMaxBounds(int& mouseX, int& mouseY, Vector2& viewportOffset, Vector2& viewportSize);
 
 	/// <summary>
@@ -65,6 +93,16 @@ public:
 	/// </summary>
 	Gizmo SceneGizmo;
 
+	/// <summary>
+	/// Should the depth of the opaque meshes be drawn first, so the lighting only runs on the visible fragments
+	/// </summary>
+	bool DepthPrepass = false;
+	/// <summary>
+	/// GPU time of the depth pre-pass and of the opaque pass of the viewport
+	/// </summary>
+	GpuTimer DepthPrepassTimer;
+	GpuTimer OpaqueTimer;
+
 
 private:
 	/// <summary>
@@ -109,6 +147,46 @@ private:
 	/// </summary>
 	float mHeight = 0.f;
 
+	/// <summary>
+	/// Is the window shown (not collapsed nor behind another docked tab)
+	/// </summary>
+	bool mIsVisible = false;
+	/// <summary>
+	/// Has the framebuffer been drawn at least once
+	/// </summary>
+	bool mIsDrawn = false;
+	/// <summary>
+	/// Is the last image complete : not occlusion culled or culled with the depth of an image drawn in the same state
+	/// </summary>
+	bool mIsSettled = false;
+	/// <summary>
+	/// VP of the camera of the last image
+	/// </summary>
+	Matrix4x4 mDrawnViewProjection;
+	/// <summary>
+	/// Size of the last image
+	/// </summary>
+	float mDrawnWidth = 0.f, mDrawnHeight = 0.f;
+	/// <summary>
+	/// Scene of the last image and its version
+	/// </summary>
+	const Scene* mDrawnScene = nullptr;
+	uint64_t mDrawnSceneVersion = 0;
+	/// <summary>
+	/// Version of the lights of the last image
+	/// </summary>
+	uint64_t mDrawnLightVersion = 0;
+	/// <summary>
+	/// Value of mInvalidation when the last image was drawn
+	/// </summary>
+	uint64_t mDrawnInvalidation = 0;
+
+	/// <summary>
+	/// Check if the camera, the size, the scene, the lights and the editor are the same as when the last image was drawn
+	/// </summary>
+	/// <returns>Return either true if nothing changed or false</returns>
+	bool MatchesDrawnState() const;
+
 public:
 	/// <summary>
 	/// Set mIsGizmoUpdated value
@@ -121,6 +199,16 @@ public:
 	/// </summary>
 	static void InitButtonTextures();
 
+	/// <summary>
+	/// Draw every viewport again at the next frame (for the changes without a version : edits in the inspector, loads, play mode)
+	/// </summary>
+	static void Invalidate();
+
+	/// <summary>
+	/// Should every visible viewport be drawn every frame, even when nothing changed
+	/// </summary>
+	static inline bool AlwaysRedraw = false;
+
 private:
 	/// <summary>
 	/// Number of editor viewport from the beginning
@@ -131,6 +219,10 @@ private:
 	/// Boolean vlaue to know if the gizmos has been drawn and updated
 	/// </summary>
 	static inline bool mIsGizmoUpdated = false;
+	/// <summary>
+	/// Incremented by Invalidate
+	/// </summary>
+	static inline uint64_t mInvalidation = 0;
 
 	static inline ImTextureID mPlayID;
 	static inline ImTextureID mStopID;
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "utils/flag.h"
+
+/// <summary>
+/// A Class for a window to monitor the work sent to the GPU each frame
+/// </summary>
+class RenderStats
+{
+	STATIC_CLASS(RenderStats)
+
+public:
+	/// <summary>
+	/// Display the render stats window
+	/// </summary>
+	UNDEFINED_ENGINE static void ShowWindow();
+};
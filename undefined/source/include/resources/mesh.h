@@ -3,12 +3,20 @@
 #include <glad/glad.h>
 #include <toolbox/Vector3.h>
 #include <toolbox/Vector2.h>
+#include <toolbox/Matrix4x4.h>
 
 #include "resources/texture.h"
 #include "resources/shader.h"
 
+#include "utils/bounds.h"
+
+#include "wrapper/geometry_arena.h"
+
 #include "utils/flag.h"
 
+#include <cstdint>
+#include <memory>
+#include <vector>
 #include <refl.hpp>
 
 /// <summary>
@@ -30,16 +38,133 @@ struct Vertex
 	Vector2 TexCoords;
 };
 
+/// <summary>
+/// Compact vertex of VertexFormat::Packed (16 bytes instead of 32)
+/// </summary>
+struct PackedVertex
+{
+	/// <summary>
+	/// Position in the bounding box of the mesh, from -32767 to 32767 on each axis (the fourth value keeps the alignment)
+	/// </summary>
+	int16_t Position[4];
+	/// <summary>
+	/// Normal with 10 signed bits per axis (GL_INT_2_10_10_10_REV)
+	/// </summary>
+	uint32_t Normal;
+	/// <summary>
+	/// UV Coordinates as half floats
+	/// </summary>
+	uint16_t TexCoords[2];
+};
+
+
+class Renderer;
 
 class Mesh
 {
 public:
 	/// <summary>
-	/// Constructor of Mesh
+	/// Constructor of Mesh, compute the local bounding box and sphere of the vertices
 	/// </summary>
 	/// <param name="vertices">: std::vector of the vertices of our mesh</param>
 	/// <param name="indices">: std::vector of the indices of our mesh</param>
-	UNDEFINED_ENGINE Mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+	UNDEFINED_ENGINE Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices);
+	/// <summary>
+	/// Destructor of Mesh, give its range back to the arena
+	/// </summary>
+	UNDEFINED_ENGINE ~Mesh();
+
+	DELETE_COPY_MOVE_OPERATIONS(Mesh)
+
+	/// <summary>
+	/// Upload the vertices and indices once into the geometry arena of their format, with the levels of detail
+	/// (the indices are stored on 16 bits when the Mesh has at most 65536 vertices)
+	/// </summary>
+	UNDEFINED_ENGINE void Upload();
+	/// <summary>
+	/// Set the layout of the vertices on the GPU, must be called before Upload (the CPU copy always uses Vertex)
+	/// </summary>
+	/// <param name="format">: Layout used by the arena of the Mesh</param>
+	UNDEFINED_ENGINE void SetVertexFormat(VertexFormat format);
+	/// <summary>
+	/// Get the layout of the vertices on the GPU
+	/// </summary>
+	/// <returns>Return the format</returns>
+	UNDEFINED_ENGINE VertexFormat GetVertexFormat() const;
+	/// <summary>
+	/// Get the matrix bringing the packed positions back in the space of the Mesh, applied on the model matrix of each instance
+	/// </summary>
+	/// <returns>Return the dequantization matrix (identity for VertexFormat::Standard)</returns>
+	UNDEFINED_ENGINE const Matrix4x4& GetDequantization() const;
+	/// <summary>
+	/// Free the CPU copy of the vertices and indices of the Mesh and its levels of detail (the Mesh must have been uploaded)
+	/// </summary>
+	UNDEFINED_ENGINE void ReleaseCPUData();
+
+	/// <summary>
+	/// Check if the Mesh is on the GPU
+	/// </summary>
+	/// <returns>Return either true if it has been uploaded or false</returns>
+	UNDEFINED_ENGINE bool IsUploaded() const;
+	/// <summary>
+	/// Get the VAO of the arena holding the Mesh
+	/// </summary>
+	/// <returns>Return the VAO ID</returns>
+	UNDEFINED_ENGINE unsigned int GetVAO() const;
+	/// <summary>
+	/// Get the number of indices to draw (still valid after ReleaseCPUData)
+	/// </summary>
+	/// <returns>Return the number of indices</returns>
+	UNDEFINED_ENGINE int GetIndexCount() const;
+	/// <summary>
+	/// Get the range of the Mesh in its arena
+	/// </summary>
+	/// <returns>Return the allocation (its Arena is nullptr before the upload)</returns>
+	UNDEFINED_ENGINE const GeometryAllocation& GetAllocation() const;
+	/// <summary>
+	/// Get an ID given to the Mesh when it is uploaded (used to sort the draws), the ID of a destroyed Mesh is given again
+	/// </summary>
+	/// <returns>Return the ID</returns>
+	UNDEFINED_ENGINE unsigned int GetID() const;
+	/// <summary>
+	/// Get the bounding box of the vertices in the space of the Mesh (still valid after ReleaseCPUData)
+	/// </summary>
+	/// <returns>Return the local bounding box</returns>
+	UNDEFINED_ENGINE const BoundingBox& GetBoundingBox() const;
+	/// <summary>
+	/// Get the bounding sphere of the vertices in the space of the Mesh (still valid after ReleaseCPUData)
+	/// </summary>
+	/// <returns>Return the local bounding sphere</returns>
+	UNDEFINED_ENGINE const BoundingSphere& GetBoundingSphere() const;
+	/// <summary>
+	/// Get the average UV units per unit of the Mesh, from the area of the triangles in both spaces (still valid after ReleaseCPUData)
+	/// </summary>
+	/// <returns>Return the density, 0 if the mesh has no area</returns>
+	UNDEFINED_ENGINE float GetUvDensity() const;
+
+	/// <summary>
+	/// Set the simplified versions of the Mesh, from the most detailed to the coarsest
+	/// </summary>
+	/// <param name="lods">: Simplified meshes</param>
+	/// <param name="errors">: Biggest distance between each simplified mesh and this Mesh, in the space of the Mesh</param>
+	UNDEFINED_ENGINE void SetLods(std::vector<std::shared_ptr<Mesh>> lods, std::vector<float> errors);
+	/// <summary>
+	/// Get the number of levels of detail, the Mesh itself is the level 0
+	/// </summary>
+	/// <returns>Return the number of levels</returns>
+	UNDEFINED_ENGINE size_t GetLodCount() const;
+	/// <summary>
+	/// Get a level of detail
+	/// </summary>
+	/// <param name="level">: Level wanted (0 is the Mesh itself)</param>
+	/// <returns>Return the Mesh of the level</returns>
+	UNDEFINED_ENGINE const Mesh* GetLod(size_t level) const;
+	/// <summary>
+	/// Get the error of a level of detail in the space of the Mesh
+	/// </summary>
+	/// <param name="level">: Level wanted (0 is the Mesh itself, its error is 0)</param>
+	/// <returns>Return the biggest distance to the surface of the Mesh</returns>
+	UNDEFINED_ENGINE float GetLodError(size_t level) const;
 
 	/// <summary>
 	/// std::vector of Vertex for the vertices of the Mesh
@@ -49,6 +174,63 @@ public:
 	/// std::vector of unsigned int for the indices of the Mesh
 	/// </summary>
 	std::vector<unsigned int> Indices;
+
+private:
+	/// <summary>
+	/// Convert the vertices in the packed layout, quantized in the bounding box of the mesh
+	/// </summary>
+	/// <param name="result">: Packed vertices</param>
+	void PackVertices(std::vector<PackedVertex>& result);
+
+	/// <summary>
+	/// Range of the mesh in its arena
+	/// </summary>
+	GeometryAllocation mAllocation;
+	/// <summary>
+	/// Layout of the vertices on the GPU
+	/// </summary>
+	VertexFormat mFormat = VertexFormat::Standard;
+	/// <summary>
+	/// Matrix from the packed positions to the space of the mesh
+	/// </summary>
+	Matrix4x4 mDequantization = Matrix4x4::Identity();
+	/// <summary>
+	/// ID of the mesh, unique among the meshes alive
+	/// </summary>
+	unsigned int mID = 0;
+	/// <summary>
+	/// Local bounding box of the vertices
+	/// </summary>
+	BoundingBox mBoundingBox;
+	/// <summary>
+	/// Local bounding sphere of the vertices
+	/// </summary>
+	BoundingSphere mBoundingSphere;
+	/// <summary>
+	/// UV units per unit of the mesh
+	/// </summary>
+	float mUvDensity = 0.f;
+	/// <summary>
+	/// Simplified meshes, from the level 1
+	/// </summary>
+	std::vector<std::shared_ptr<Mesh>> mLods;
+	/// <summary>
+	/// Error of each simplified mesh
+	/// </summary>
+	std::vector<float> mLodErrors;
+
+	/// <summary>
+	/// Last ID given to a Mesh
+	/// </summary>
+	static inline unsigned int mLastID = 0;
+	/// <summary>
+	/// IDs of the destroyed meshes, given again before a new one
+	/// </summary>
+	static inline std::vector<unsigned int> mFreeIDs;
+	/// <summary>
+	/// Number of IDs the sort keys of the RenderQueue can tell apart
+	/// </summary>
+	static constexpr unsigned int MESH_ID_LIMIT = 0xFFFF;
 };
 
 REFL_AUTO(type(Mesh, bases<Resource>)
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "utils/flag.h"
+
+struct Vertex;
+
+/// <summary>
+/// Efficiency of an index buffer for a FIFO post-transform vertex cache
+/// </summary>
+struct VertexCacheStats
+{
+	/// <summary>
+	/// Average cache miss ratio : vertices transformed per triangle (0.5 at best on a regular grid, 3 at worst)
+	/// </summary>
+	float ACMR = 0.f;
+	/// <summary>
+	/// Average transform to vertex ratio : vertices transformed per vertex used (1 at best)
+	/// </summary>
+	float ATVR = 0.f;
+};
+
+/// <summary>
+/// Import time optimizations of the meshes : welding of the duplicated vertices, triangle order for the post-transform cache
+/// and for the overdraw, vertex order for the fetches
+/// </summary>
+class MeshOptimizer
+{
+	STATIC_CLASS(MeshOptimizer)
+
+public:
+	/// <summary>
+	/// Run every optimization in order : weld, vertex cache, overdraw (optional), vertex fetch
+	/// </summary>
+	/// <param name="vertices">: Vertices of the mesh, replaced by the welded and reordered ones</param>
+	/// <param name="indices">: Triangles of the mesh, replaced by the reordered ones</param>
+	/// <param name="overdraw">: Should the triangles also be ordered from the outside of the mesh to the inside</param>
+	UNDEFINED_ENGINE static void Optimize(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, bool overdraw);
+
+	/// <summary>
+	/// Merge the vertices whose position, normal and UV are identical
+	/// </summary>
+	/// <param name="vertices">: Vertices of the mesh, the duplicates are removed</param>
+	/// <param name="indices">: Triangles of the mesh, remapped on the remaining vertices</param>
+	UNDEFINED_ENGINE static void WeldVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+	/// <summary>
+	/// Reorder the triangles so the vertices they share are still in the post-transform cache (Forsyth, linear speed vertex cache optimization)
+	/// </summary>
+	/// <param name="indices">: Triangles of the mesh</param>
+	/// <param name="vertexCount">: Number of vertices indexed</param>
+	UNDEFINED_ENGINE static void OptimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount);
+	/// <summary>
+	/// Reorder clusters of triangles so the ones facing outward are drawn first, the clusters are cut where the cache
+	/// order allows it so the cache efficiency stays under threshold times the efficiency of the input (Sander et al.)
+	/// </summary>
+	/// <param name="indices">: Triangles of the mesh, ordered for the vertex cache</param>
+	/// <param name="vertices">: Vertices of the mesh</param>
+	/// <param name="threshold">: Biggest loss of ACMR allowed (e.g : 1.05 for 5%)</param>
+	UNDEFINED_ENGINE static void OptimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, float threshold);
+	/// <summary>
+	/// Reorder the vertices in the order of their first use and remove the unused ones
+	/// </summary>
+	/// <param name="vertices">: Vertices of the mesh</param>
+	/// <param name="indices">: Triangles of the mesh, remapped on the new order</param>
+	UNDEFINED_ENGINE static void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+	/// <summary>
+	/// Simulate a FIFO post-transform cache over the triangles
+	/// </summary>
+	/// <param name="indices">: Triangles of the mesh</param>
+	/// <param name="vertexCount">: Number of vertices indexed</param>
+	/// <returns>Return the ACMR and ATVR</returns>
+	UNDEFINED_ENGINE static VertexCacheStats AnalyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount);
+};
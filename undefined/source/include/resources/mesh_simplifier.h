@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "utils/flag.h"
+
+struct Vertex;
+
+/// <summary>
+/// Simplification of meshes by quadric edge collapse (Garland-Heckbert) : a vertex is moved on a neighbour
+/// when the distance to the planes of the triangles they share stays small, the vertices themselves are never modified
+/// </summary>
+class MeshSimplifier
+{
+	STATIC_CLASS(MeshSimplifier)
+
+public:
+	/// <summary>
+	/// Collapse edges from the cheapest until the number of indices or the error is reached,
+	/// the vertices on an open border are locked so the silhouette of the holes is kept
+	/// </summary>
+	/// <param name="vertices">: Vertices of the mesh</param>
+	/// <param name="indices">: Triangles of the mesh</param>
+	/// <param name="targetIndexCount">: Number of indices wanted</param>
+	/// <param name="maxError">: Biggest distance allowed between the new surface and the planes of the original triangles</param>
+	/// <param name="result">: Triangles of the simplified mesh, indexing the same vertices</param>
+	/// <returns>Return the biggest error of the collapses done</returns>
+	UNDEFINED_ENGINE static float Simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, size_t targetIndexCount, float maxError,
+		std::vector<unsigned int>& result);
+
+	/// <summary>
+	/// Keep only the vertices used by some indices
+	/// </summary>
+	/// <param name="vertices">: Vertices of the mesh</param>
+	/// <param name="indices">: Triangles using a part of the vertices</param>
+	/// <param name="resultVertices">: Vertices used, in the order of their first use</param>
+	/// <param name="resultIndices">: Triangles indexing resultVertices</param>
+	UNDEFINED_ENGINE static void CompactVertices(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+		std::vector<Vertex>& resultVertices, std::vector<unsigned int>& resultIndices);
+};
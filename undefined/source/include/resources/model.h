@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <assimp/scene.h>
 
 #include "resources/mesh.h"
@@ -27,10 +28,15 @@ public:
     UNDEFINED_ENGINE Model(const char* path);
 
     /// <summary>
-    /// Initialise the Model
+    /// Initialise the Model, upload every Mesh once on the GPU
     /// </summary>
     UNDEFINED_ENGINE void Init();
 
+    /// <summary>
+    /// Free the CPU copy of the vertices and indices of every Mesh already uploaded
+    /// </summary>
+    UNDEFINED_ENGINE void ReleaseCPUData();
+
     /// <summary>
     /// Check if the Model is valid
     /// </summary>
@@ -43,12 +49,35 @@ public:
     /// <param name="index">: Index of the mesh</param>
     /// <param name="tex">: Pointer to the texture</param>
     UNDEFINED_ENGINE void SetTexture(int index, std::shared_ptr<Texture> tex);
+
+    /// <summary>
+    /// Should the Models free the CPU copy of their meshes once uploaded (large models don't sit in RAM twice)
+    /// </summary>
+    UNDEFINED_ENGINE static inline bool ReleaseCPUDataOnLoad = false;
+    /// <summary>
+    /// Should the Models build the levels of detail of their meshes when loaded (read from a .lod file next to the model once generated)
+    /// </summary>
+    UNDEFINED_ENGINE static inline bool GenerateLodsOnLoad = true;
+    /// <summary>
+    /// Should the Models weld the duplicated vertices of their meshes and reorder them for the vertex cache and the vertex fetches when loaded
+    /// </summary>
+    UNDEFINED_ENGINE static inline bool OptimizeMeshesOnLoad = true;
+    /// <summary>
+    /// Should the optimization also order the triangles from the outside of each mesh to the inside to reduce the overdraw
+    /// </summary>
+    UNDEFINED_ENGINE static inline bool OptimizeOverdrawOnLoad = false;
+    /// <summary>
+    /// Should the Models upload their meshes with VertexFormat::Packed (half the memory and the fetches, positions precise to 1/65534 of the mesh size)
+    /// </summary>
+    UNDEFINED_ENGINE static inline bool PackVerticesOnLoad = false;
 private:
     /// <summary>
     /// Draw the model
     /// </summary>
     /// <param name="TRS">: The TRS Matrix of the object</param>
-    UNDEFINED_ENGINE void Draw(const Matrix4x4& TRS);
+    /// <param name="worldBoxes">: World bounding box of each mesh, tested against the frustum before drawing</param>
+    /// <param name="lods">: Level of detail drawn for each mesh</param>
+    UNDEFINED_ENGINE void Draw(const Matrix4x4& TRS, const std::vector<BoundingBox>& worldBoxes, const std::vector<uint8_t>& lods);
     /// <summary>
     /// Load a model
     /// </summary>
@@ -65,25 +94,22 @@ private:
     /// </summary>
     /// <param name="mesh">: aiMesh from assimp</param>
     /// <returns>Return our own Mesh</returns>
-    UNDEFINED_ENGINE Mesh ProcessMesh(aiMesh* mesh);
-
+    UNDEFINED_ENGINE std::shared_ptr<Mesh> ProcessMesh(aiMesh* mesh);
     /// <summary>
-    /// std::vector of a pair composes with a pointer to a Mesh and a pointer to a Material
+    /// Optimize every mesh and log the ACMR and ATVR of the model before and after
     /// </summary>
-    std::vector<std::pair<std::shared_ptr<Mesh>, std::shared_ptr<Material>>> mModel;
-
+    /// <param name="path">: Path to the file containg the Model data</param>
+    UNDEFINED_ENGINE void OptimizeMeshes(const std::string& path);
     /// <summary>
-    /// EBO of the model
+    /// Give its levels of detail to every mesh, read from the cache of the model or simplified and written in the cache
     /// </summary>
-    unsigned int mEBO = 0;
-    /// <summary>
-    /// VBO of the model
-    /// </summary>
-    unsigned int mVBO = 0;
+    /// <param name="path">: Path to the file containg the Model data, the cache is this path followed by .lod</param>
+    UNDEFINED_ENGINE void LoadLods(const std::string& path);
+
     /// <summary>
-    /// VAO of the model
+    /// std::vector of a pair composes with a pointer to a Mesh and a pointer to a Material
     /// </summary>
-    unsigned int mVAO = 0;
+    std::vector<std::pair<std::shared_ptr<Mesh>, std::shared_ptr<Material>>> mModel;
 
     /// <summary>
     /// Pointer to our Renderer to simplify the calls from the ServiceLocator
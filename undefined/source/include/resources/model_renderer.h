@@ -3,8 +3,14 @@
 #include "world/component.h"
 #include "resources/model.h"
 
+#include "utils/bounds.h"
+
+#include <unordered_map>
+
 #include <refl.hpp>
 
+class Camera;
+
 /// <summary>
 /// Class for ModelRenderer that draw the model
 /// </summary>
@@ -18,10 +24,84 @@ public:
 	/// </summary>
 	void Draw() override;
 
+	/// <summary>
+	/// Get the box containing every mesh of the model in world space
+	/// </summary>
+	/// <param name="box">: Box computed</param>
+	/// <returns>Return either true if the model has meshes or false</returns>
+	UNDEFINED_ENGINE bool GetWorldBounds(BoundingBox& box);
+	/// <summary>
+	/// Intersect a ray with the triangles of the model, the meshes whose CPU data has been released are intersected with their box
+	/// </summary>
+	/// <param name="origin">: Origin of the ray in world space</param>
+	/// <param name="direction">: Direction of the ray in world space (normalized)</param>
+	/// <param name="maxDistance">: Length of the ray</param>
+	/// <param name="distance">: Distance of the closest hit</param>
+	/// <returns>Return either true if the model is hit closer than maxDistance or false</returns>
+	UNDEFINED_ENGINE bool RayCast(const Vector3& origin, const Vector3& direction, float maxDistance, float& distance);
+
 	/// <summary>
 	/// Model of the Object
 	/// </summary>
 	std::shared_ptr<Model> ModelObject;
+
+	/// <summary>
+	/// Should the meshes be drawn with the level of detail matching their size on screen
+	/// </summary>
+	UNDEFINED_ENGINE static inline bool UseLods = true;
+	/// <summary>
+	/// Biggest error in pixels allowed on screen when a coarser level is selected
+	/// </summary>
+	UNDEFINED_ENGINE static inline float LodPixelError = 1.f;
+	/// <summary>
+	/// Fraction of LodPixelError around the threshold where the level is kept, stops the level from flickering at the switching distance
+	/// </summary>
+	UNDEFINED_ENGINE static inline float LodHysteresis = 0.25f;
+
+private:
+	/// <summary>
+	/// Transform the local bounds of every mesh of the model in world space if the Transform or the model has changed
+	/// </summary>
+	/// <param name="TRS">: The TRS Matrix of the object</param>
+	void UpdateWorldBounds(const Matrix4x4& TRS);
+	/// <summary>
+	/// Select the level of detail of every mesh from the projection of its error on the screen of the camera being drawn
+	/// </summary>
+	/// <param name="lods">: Levels of the camera being drawn, the levels of its last draw on input</param>
+	void SelectLods(std::vector<uint8_t>& lods);
+	/// <summary>
+	/// Ask the textures of the meshes for the level their size on the screen of the camera being drawn needs
+	/// </summary>
+	void RequestTextureLevels();
+	/// <summary>
+	/// Compute the pixels covered on the screen of the camera being drawn by a unit in the space of each mesh
+	/// </summary>
+	void UpdatePixelsPerUnit();
+
+	/// <summary>
+	/// World bounding box of each mesh of the model, used for the frustum culling
+	/// </summary>
+	std::vector<BoundingBox> mWorldBoxes;
+	/// <summary>
+	/// World bounding sphere of each mesh of the model
+	/// </summary>
+	std::vector<BoundingSphere> mWorldSpheres;
+	/// <summary>
+	/// Pixels per unit of each mesh for the camera being drawn, used by the levels of detail and the texture levels
+	/// </summary>
+	std::vector<float> mPixelsPerUnit;
+	/// <summary>
+	/// Level of detail drawn for each mesh by each camera, kept between frames for the hysteresis of the camera
+	/// </summary>
+	std::unordered_map<const Camera*, std::vector<uint8_t>> mLods;
+	/// <summary>
+	/// Model the world bounds were computed for
+	/// </summary>
+	const Model* mBoundsModel = nullptr;
+	/// <summary>
+	/// Version of the Transform the world bounds were computed for
+	/// </summary>
+	unsigned int mBoundsVersion = 0;
 };
  
 REFL_AUTO(type(ModelRenderer, bases<Component>),
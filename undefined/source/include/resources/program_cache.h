@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "utils/flag.h"
+
+/// <summary>
+/// On-disk cache of the linked programs : the binary given by the driver is saved in a .ubin file named after the hash of the sources,
+/// the next launches restore it instead of compiling. The file also holds a hash of the vendor, the renderer and the version of the driver,
+/// a binary of another driver or rejected by the driver is compiled again from the sources
+/// </summary>
+class ProgramCache
+{
+	STATIC_CLASS(ProgramCache)
+
+public:
+	/// <summary>
+	/// Create a program from the cache
+	/// </summary>
+	/// <param name="sources">: Source of every stage of the program, in the order of the pipeline</param>
+	/// <param name="program">: Program created, untouched if the cache can't be used</param>
+	/// <returns>Return either true if the program has been restored or false if it must be compiled</returns>
+	UNDEFINED_ENGINE static bool Load(const std::vector<std::string>& sources, unsigned int& program);
+	/// <summary>
+	/// Save the binary of a program linked from sources
+	/// </summary>
+	/// <param name="sources">: Source of every stage of the program, in the order of the pipeline</param>
+	/// <param name="program">: Linked program</param>
+	UNDEFINED_ENGINE static void Save(const std::vector<std::string>& sources, unsigned int program);
+
+	/// <summary>
+	/// Should the programs be restored from the cache and saved after being compiled
+	/// </summary>
+	UNDEFINED_ENGINE static inline bool Enabled = true;
+	/// <summary>
+	/// Folder of the binaries, created when the first program is saved
+	/// </summary>
+	UNDEFINED_ENGINE static inline std::string CacheDirectory = "cache/programs/";
+
+private:
+	/// <summary>
+	/// Check that the driver gives binaries and hash its description once
+	/// </summary>
+	/// <returns>Return either true if the binaries can be used or false</returns>
+	static bool IsSupported();
+
+	static inline bool mIsChecked = false;
+	static inline bool mIsSupported = false;
+	/// <summary>
+	/// Hash of the vendor, the renderer and the version of the driver
+	/// </summary>
+	static inline uint64_t mDriverHash = 0;
+};
@@ -1,10 +1,47 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 #include <toolbox/Matrix4x4.h>
 
 #include "resources/resource.h"
 #include "utils/flag.h"
+#include "utils/utils.h"
+
+class Renderer;
+class ShaderCompiler;
+
+/// <summary>
+/// Feature a shader variant is compiled with. A shader declares the keywords it reads with a "#pragma keywords" line in its sources,
+/// each keyword of a variant becomes a #define of its stages (named like the keyword in capitals, e.g : HAS_TEXTURE)
+/// </summary>
+enum class ShaderKeyword : uint32_t
+{
+    DirectionalLights = 1 << 0,
+    PointLights = 1 << 1,
+    SpotLights = 1 << 2,
+    HasTexture = 1 << 3,
+    PickingOutput = 1 << 4,
+};
+
+/// <summary>
+/// Stage compiled but not yet checked
+/// </summary>
+struct ShaderStage
+{
+    /// <summary>
+    /// Shader type (GL_VERTEX_SHADER, GL_FRAGMENT_SHADER or GL_COMPUTE_SHADER)
+    /// </summary>
+    int Type = 0;
+    /// <summary>
+    /// ID of the Shader source
+    /// </summary>
+    unsigned int ID = 0;
+};
 
 /// <summary>
 /// a Class to store the shader
@@ -22,8 +59,17 @@ public:
     /// <param name="vertexPath">: Path to the file containing the vertex Shader</param>
     /// <param name="fragmentPath">: Path to the file containing the fragment Shader</param>
     UNDEFINED_ENGINE Shader(const char* vertexPath, const char* fragmentPath);
+    /// <summary>
+    /// Constructor for a compute Shader
+    /// </summary>
+    /// <param name="computePath">: Path to the file containing the compute Shader</param>
+    UNDEFINED_ENGINE Shader(const char* computePath);
+    /// <summary>
+    /// Destructor for Shader, a build still pending is dropped
+    /// </summary>
+    UNDEFINED_ENGINE ~Shader() override;
 
-    // use/activate the shader
+    // use/activate the shader (the fallback program of the ShaderCompiler while the program is built)
     UNDEFINED_ENGINE void Use();
 
     // unUse/desactivate the shader
@@ -56,12 +102,26 @@ public:
     /// <param name="fragment">: ID of the fragment Shader source</param>
     UNDEFINED_ENGINE void Link(unsigned int vertex, unsigned int fragment);
 
-    // utility uniform functions
-    UNDEFINED_ENGINE void SetBool(const std::string& mName, bool value) const;
-    UNDEFINED_ENGINE void SetInt(const std::string& mName, int value) const;
-    UNDEFINED_ENGINE void SetFloat(const std::string& mName, float value) const;
-    UNDEFINED_ENGINE void SetVec3(const std::string& mName, const Vector3& v) const;
-    UNDEFINED_ENGINE void SetMat4(const std::string& mName, const Matrix4x4& m) const;
+    /// <summary>
+    /// Get the location of an active uniform, the locations are queried once when the program is linked
+    /// </summary>
+    /// <param name="mName">: Name of the uniform (e.g : "model", "pointLights[2].position")</param>
+    /// <returns>Return the location of the uniform or -1 if the uniform is not active in the program</returns>
+    UNDEFINED_ENGINE int GetUniformLocation(std::string_view mName) const;
+
+    // utility uniform functions (by name, the location is taken from the cache)
+    UNDEFINED_ENGINE void SetBool(std::string_view mName, bool value) const;
+    UNDEFINED_ENGINE void SetInt(std::string_view mName, int value) const;
+    UNDEFINED_ENGINE void SetFloat(std::string_view mName, float value) const;
+    UNDEFINED_ENGINE void SetVec3(std::string_view mName, const Vector3& v) const;
+    UNDEFINED_ENGINE void SetMat4(std::string_view mName, const Matrix4x4& m) const;
+
+    // utility uniform functions (by location, to use in the hot paths with a location got once from GetUniformLocation)
+    UNDEFINED_ENGINE void SetBool(int location, bool value) const;
+    UNDEFINED_ENGINE void SetInt(int location, int value) const;
+    UNDEFINED_ENGINE void SetFloat(int location, float value) const;
+    UNDEFINED_ENGINE void SetVec3(int location, const Vector3& v) const;
+    UNDEFINED_ENGINE void SetMat4(int location, const Matrix4x4& m) const;
 
     /// <summary>
     /// Load a shader by using a vertex and a fragment shader
@@ -69,10 +129,99 @@ public:
     /// <param name="vertexPath">: Path to the file containing the vertex Shader</param>
     /// <param name="fragmentPath">: Path to the file containing the fragment Shader</param>
     UNDEFINED_ENGINE void Load(const char* vertexPath, const char* fragmentPath);
+    /// <summary>
+    /// Load a program made of a single compute shader
+    /// </summary>
+    /// <param name="computePath">: Path to the file containing the compute Shader</param>
+    UNDEFINED_ENGINE void LoadCompute(const char* computePath);
+
+    /// <summary>
+    /// Check if the program is built and linked, it can't be used before
+    /// </summary>
+    /// <returns>Return either true if the program can be used or false</returns>
+    UNDEFINED_ENGINE bool IsReady() const;
+
+    /// <summary>
+    /// Get the cheapest program drawing the features asked : the variant compiled with exactly these keywords once it is built,
+    /// until then the built variant with the fewest keywords among the ones having all of them, or the shader itself (every keyword)
+    /// </summary>
+    /// <param name="keywords">: ShaderKeyword flags needed by the draw, the keywords the shader doesn't declare are ignored</param>
+    /// <returns>Return the shader to draw with</returns>
+    UNDEFINED_ENGINE Shader* GetVariant(uint32_t keywords);
+    /// <summary>
+    /// Get the keywords declared by the sources, the shader itself is compiled with all of them
+    /// </summary>
+    /// <returns>Return the ShaderKeyword flags</returns>
+    UNDEFINED_ENGINE uint32_t GetKeywords() const;
+    /// <summary>
+    /// Get the number of variants created
+    /// </summary>
+    /// <returns>Return the number of variants</returns>
+    UNDEFINED_ENGINE size_t GetVariantCount() const;
 
     /// <summary>
     /// ID of the Shader program
     /// </summary>
     unsigned int ID = 0;
+
+private:
+    friend ShaderCompiler;
+
+    /// <summary>
+    /// Restore the program from the ProgramCache or compile and link it with the defines of the keywords
+    /// </summary>
+    /// <param name="code">: Source of every stage without the defines (a single stage is a compute shader)</param>
+    /// <param name="keywords">: Keywords defined</param>
+    void Compile(const std::vector<std::string>& code, uint32_t keywords);
+    /// <summary>
+    /// Hand the program compiled and linked to the ShaderCompiler, or finish it right away when the shaders are not built in the background
+    /// </summary>
+    void Build();
+    /// <summary>
+    /// Check the stages and the program, save the program in the ProgramCache and delete the stages (wait for the driver)
+    /// </summary>
+    void FinishBuild();
+    /// <summary>
+    /// Delete the stages of a build that will never be finished
+    /// </summary>
+    void CancelBuild();
+
+    /// <summary>
+    /// Query every active uniform of the program and store its location
+    /// </summary>
+    void CacheUniformLocations();
+
+    /// <summary>
+    /// Location of every active uniform of the program, keyed by name
+    /// </summary>
+    std::unordered_map<std::string, int, Utils::StringHash, std::equal_to<>> mUniformLocations;
+
+    /// <summary>
+    /// Stages of the program being built
+    /// </summary>
+    std::vector<ShaderStage> mStages;
+    /// <summary>
+    /// Sources of the program being built, saved with it in the ProgramCache
+    /// </summary>
+    std::vector<std::string> mSources;
+    bool mIsReady = false;
+
+    /// <summary>
+    /// Keywords declared by the sources
+    /// </summary>
+    uint32_t mKeywords = 0;
+    /// <summary>
+    /// Sources without the defines, kept to compile the variants (empty without keywords)
+    /// </summary>
+    std::vector<std::string> mCode;
+    /// <summary>
+    /// Variants compiled with a subset of the keywords, keyed by their keywords
+    /// </summary>
+    std::unordered_map<uint32_t, std::unique_ptr<Shader>> mVariants;
+
+    /// <summary>
+    /// Pointer to our Renderer to simplify the calls from the ServiceLocator
+    /// </summary>
+    Renderer* mRenderer = nullptr;
 };
 
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "utils/flag.h"
+
+class Shader;
+class Renderer;
+
+/// <summary>
+/// Non-blocking build of the shaders : the programs are compiled and linked as soon as they are loaded, without reading their status,
+/// so the driver builds them together on its own threads (GL_KHR_parallel_shader_compile). Their completion is polled every frame
+/// and a shader keeps drawing with a simple fallback program until its own program is ready
+/// </summary>
+class ShaderCompiler
+{
+	STATIC_CLASS(ShaderCompiler)
+
+public:
+	/// <summary>
+	/// Give the compiler threads to the driver and build the fallback program (need the Renderer to be initialized)
+	/// </summary>
+	UNDEFINED_ENGINE static void Setup();
+	/// <summary>
+	/// Drop the builds still pending and delete the fallback program
+	/// </summary>
+	UNDEFINED_ENGINE static void Shutdown();
+	/// <summary>
+	/// Check if the shaders are built in the background
+	/// </summary>
+	/// <returns>Return either true if the builds are polled or false if the shaders are built right away</returns>
+	UNDEFINED_ENGINE static bool IsRunning();
+
+	/// <summary>
+	/// Add a shader whose program has been compiled and linked to the builds polled
+	/// </summary>
+	/// <param name="shader">: Shader built</param>
+	UNDEFINED_ENGINE static void Submit(Shader* shader);
+	/// <summary>
+	/// Remove a shader from the builds polled, its pending stages are deleted
+	/// </summary>
+	/// <param name="shader">: Shader destroyed</param>
+	UNDEFINED_ENGINE static void Cancel(Shader* shader);
+
+	/// <summary>
+	/// Finish the builds done by the driver. Without the extension the status query waits, only MaxBlockingPerFrame builds are finished per frame.
+	/// Must be called once per frame on the GL thread
+	/// </summary>
+	UNDEFINED_ENGINE static void Update();
+
+	/// <summary>
+	/// Get the program used by the shaders until they are ready, it reads the inputs of the base shader and draws a flat shaded grey
+	/// </summary>
+	/// <returns>Return the ID of the fallback program</returns>
+	UNDEFINED_ENGINE static unsigned int GetFallbackID();
+	/// <summary>
+	/// Get the number of shaders still built by the driver
+	/// </summary>
+	/// <returns>Return the number of shaders</returns>
+	UNDEFINED_ENGINE static size_t GetPendingCount();
+
+	/// <summary>
+	/// Should the shaders be built in the background, they are built right away when they are loaded otherwise
+	/// </summary>
+	UNDEFINED_ENGINE static inline bool Enabled = true;
+	/// <summary>
+	/// Builds finished per frame when the driver can't tell if a build is done without waiting for it
+	/// </summary>
+	UNDEFINED_ENGINE static inline size_t MaxBlockingPerFrame = 1;
+
+private:
+	static inline std::vector<Shader*> mPending;
+	static inline unsigned int mFallbackID = 0;
+	static inline bool mIsRunning = false;
+	static inline Renderer* mRenderer = nullptr;
+};
@@ -3,6 +3,9 @@
 #include <string>
 #include <filesystem>
 #include <array>
+#include <climits>
+#include <memory>
+#include <vector>
 #include <refl.hpp>
 
 #include "resources/resource.h"
@@ -10,6 +13,8 @@
 #include "service_locator.h"
 #include "utils/flag.h"
 
+struct TextureRequest;
+
 /// <summary>
 /// A Class to store all the Texture data
 /// </summary>
@@ -24,7 +29,8 @@ public:
 	/// <param name="height">: Height of the texture created</param>
 	UNDEFINED_ENGINE Texture(const float width, const float height, const int internalFormat = 0x1908, const int format = 0x1908);
 	/// <summary>
-	/// A Constructor of Texture, creating a texture with an image (e.g : png or jpg)
+	/// A Constructor of Texture, creating a texture with an image (e.g : png or jpg), cooked once when UseCookedTextures is set.
+	/// When AsyncLoading is set the image is loaded by the TextureLoader and the placeholder is used until it is resident
 	/// </summary>
 	/// <param name="filepath">: Path of the image you want to create a texture</param>
 	/// <param name="isFlipped">: Do we need to flip the texture (by default : false)</param>
@@ -37,7 +43,7 @@ public:
 	/// <summary>
 	/// Get the Texture ID
 	/// </summary>
-	/// <returns>Return the Texture ID</returns>
+	/// <returns>Return the Texture ID, or the ID of the placeholder while the image is loading</returns>
 	UNDEFINED_ENGINE unsigned int GetID() const;
 
 	/// <summary>
@@ -60,13 +66,67 @@ public:
 	/// </summary>
 	/// <returns>Return either true if it is valid or false</returns>
 	UNDEFINED_ENGINE bool IsValid() const;
+	/// <summary>
+	/// Check if the image has been uploaded
+	/// </summary>
+	/// <returns>Return either true if the texture can be sampled or false if it is still loading</returns>
+	UNDEFINED_ENGINE bool IsResident() const;
+
+	/// <summary>
+	/// Ask for a level to be resident, the TextureStreamer keeps the finest level asked during the frame
+	/// </summary>
+	/// <param name="level">: Finest level sampled (0 is the full resolution)</param>
+	UNDEFINED_ENGINE void RequestLevel(int level);
+	/// <summary>
+	/// Check if the levels of the texture are streamed (cooked textures loaded by the TextureLoader)
+	/// </summary>
+	/// <returns>Return either true if the TextureStreamer manages the texture or false</returns>
+	UNDEFINED_ENGINE bool IsStreamable() const;
+	/// <summary>
+	/// Get the finest level in the storage of the texture
+	/// </summary>
+	/// <returns>Return the level, 0 when the texture is at full resolution</returns>
+	UNDEFINED_ENGINE int GetFirstResidentLevel() const;
+	/// <summary>
+	/// Get the number of levels of the whole chain
+	/// </summary>
+	/// <returns>Return the number of levels, 0 if the texture is not streamable</returns>
+	UNDEFINED_ENGINE int GetLevelCount() const;
+	/// <summary>
+	/// Get the size of the chain from a level to the 1x1 level
+	/// </summary>
+	/// <param name="level">: First level counted</param>
+	/// <returns>Return the size in bytes</returns>
+	UNDEFINED_ENGINE size_t GetSizeFromLevel(int level) const;
+	/// <summary>
+	/// Get the size of the levels in the storage of the texture
+	/// </summary>
+	/// <returns>Return the size in bytes, 0 if the texture is not streamable</returns>
+	UNDEFINED_ENGINE size_t GetResidentSize() const;
 
 	/// <summary>
 	/// Pointer for the Texture data
 	/// </summary>
 	const void* Data = nullptr;
 
+	/// <summary>
+	/// Should the images be loaded through the TextureCooker (block compressed with precomputed mips, cached on disk) instead of decoded at every launch
+	/// </summary>
+	UNDEFINED_ENGINE static inline bool UseCookedTextures = true;
+	/// <summary>
+	/// Should the images be decoded on the TextureLoader workers instead of blocking the constructor
+	/// </summary>
+	UNDEFINED_ENGINE static inline bool AsyncLoading = true;
+
 private:
+	friend class TextureLoader;
+	friend class TextureStreamer;
+
+	/// <summary>
+	/// Set the wrap and filter parameters of the texture bound
+	/// </summary>
+	void SetParameters();
+
 	/// <summary>
 	/// ID of the Texture
 	/// </summary>
@@ -79,6 +139,47 @@ private:
 	/// Height of the Texture
 	/// </summary>
 	int mHeight = 0;
+	/// <summary>
+	/// Has the image been uploaded
+	/// </summary>
+	bool mIsResident = true;
+	/// <summary>
+	/// Request of the TextureLoader while the image is loading
+	/// </summary>
+	std::shared_ptr<TextureRequest> mRequest;
+
+	/// <summary>
+	/// Path of the image, read again when finer levels are streamed
+	/// </summary>
+	std::string mPath;
+	/// <summary>
+	/// Is the image flipped vertically
+	/// </summary>
+	bool mIsFlipped = false;
+	/// <summary>
+	/// Compressed format of the storage
+	/// </summary>
+	unsigned int mInternalFormat = 0;
+	/// <summary>
+	/// Level of the whole chain held by the level 0 of the storage
+	/// </summary>
+	int mFirstLevel = 0;
+	/// <summary>
+	/// Size in bytes of every level of the whole chain, empty if the texture is not streamable
+	/// </summary>
+	std::vector<size_t> mLevelSizes;
+	/// <summary>
+	/// Finest level asked since the last update of the TextureStreamer (INT_MAX if the texture has not been drawn)
+	/// </summary>
+	int mRequestedLevel = INT_MAX;
+	/// <summary>
+	/// Finest level asked recently, the finer levels are only evicted when it hasn't been asked for a while
+	/// </summary>
+	int mRecentLevel = INT_MAX;
+	/// <summary>
+	/// Frame of the TextureStreamer when mRecentLevel was asked
+	/// </summary>
+	unsigned int mRecentFrame = 0;
 
 	/// <summary>
 	/// Pointer to our Renderer to simplify the calls from the ServiceLocator
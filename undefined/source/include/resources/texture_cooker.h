@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "utils/flag.h"
+
+/// <summary>
+/// Compressed blocks of one mip level
+/// </summary>
+struct CookedLevel
+{
+	/// <summary>
+	/// Size of the level in texels
+	/// </summary>
+	int Width = 0;
+	int Height = 0;
+	/// <summary>
+	/// Blocks of 4x4 texels, row after row
+	/// </summary>
+	std::vector<uint8_t> Data;
+};
+
+/// <summary>
+/// Block compressed texture with its whole mip chain, ready for glCompressedTexSubImage2D
+/// </summary>
+struct CookedTexture
+{
+	/// <summary>
+	/// Compressed format (GL_COMPRESSED_RGB_S3TC_DXT1_EXT, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, GL_COMPRESSED_RED_RGTC1 or GL_COMPRESSED_RG_RGTC2)
+	/// </summary>
+	unsigned int InternalFormat = 0;
+	/// <summary>
+	/// Size of the level 0 of the whole chain
+	/// </summary>
+	int Width = 0;
+	int Height = 0;
+	/// <summary>
+	/// Level of the chain held by Levels[0], the finer levels have not been read
+	/// </summary>
+	int FirstLevel = 0;
+	/// <summary>
+	/// Size in bytes of every level of the whole chain, from the level 0
+	/// </summary>
+	std::vector<size_t> LevelSizes;
+	/// <summary>
+	/// Levels from FirstLevel to 1x1
+	/// </summary>
+	std::vector<CookedLevel> Levels;
+};
+
+/// <summary>
+/// Offline preparation of the textures : the image is decoded once, its mips are filtered on the CPU and every level is block compressed
+/// (BC1 for RGB, BC3 for RGBA, BC4 for one channel, BC5 for two channels). The result is cached in a .utex file named after the hash of the image,
+/// the next launches read the blocks directly
+/// </summary>
+class TextureCooker
+{
+	STATIC_CLASS(TextureCooker)
+
+public:
+	/// <summary>
+	/// Get the cooked version of an image, from the cache or cooked and written in the cache
+	/// </summary>
+	/// <param name="path">: Path of the image (e.g : png or jpg)</param>
+	/// <param name="isFlipped">: Is the image flipped vertically</param>
+	/// <param name="result">: Cooked texture</param>
+	/// <param name="firstLevel">: Finest level read (by default : 0, the whole chain)</param>
+	/// <param name="maxSize">: Biggest side of the first level read, the finer levels are skipped (by default : 0, no limit)</param>
+	/// <returns>Return either true if the texture is ready or false if the image can't be read</returns>
+	UNDEFINED_ENGINE static bool Load(const std::string& path, bool isFlipped, CookedTexture& result, int firstLevel = 0, int maxSize = 0);
+
+	/// <summary>
+	/// Build the mip chain of an image and compress every level
+	/// </summary>
+	/// <param name="pixels">: Texels of the image, 8 bits per channel</param>
+	/// <param name="width">: Width of the image</param>
+	/// <param name="height">: Height of the image</param>
+	/// <param name="channelCount">: Number of channels (1 to 4)</param>
+	/// <param name="result">: Cooked texture</param>
+	UNDEFINED_ENGINE static void Cook(const uint8_t* pixels, int width, int height, int channelCount, CookedTexture& result);
+
+	/// <summary>
+	/// Folder of the cooked textures, created when the first texture is cooked
+	/// </summary>
+	UNDEFINED_ENGINE static inline std::string CacheDirectory = "cache/textures/";
+};
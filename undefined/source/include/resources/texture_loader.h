@@ -0,0 +1,193 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glad/glad.h>
+#include <ts_queue/tsqueue.hpp>
+
+#include "resources/texture_cooker.h"
+#include "utils/flag.h"
+
+class Texture;
+class Renderer;
+
+/// <summary>
+/// Image waiting to be decoded by a worker or uploaded by the GL thread
+/// </summary>
+struct TextureRequest
+{
+	/// <summary>
+	/// Texture receiving the image, set to nullptr by the destructor of the texture (only read on the GL thread)
+	/// </summary>
+	Texture* Target = nullptr;
+	/// <summary>
+	/// Set by the destructor of the texture, the workers skip the decode
+	/// </summary>
+	std::atomic<bool> IsCancelled = false;
+	/// <summary>
+	/// Path of the image
+	/// </summary>
+	std::string Path;
+	/// <summary>
+	/// Is the image flipped vertically
+	/// </summary>
+	bool IsFlipped = false;
+	/// <summary>
+	/// Finest level read from the cooked image
+	/// </summary>
+	int FirstLevel = 0;
+	/// <summary>
+	/// Biggest side of the first level read (0 for no limit)
+	/// </summary>
+	int MaxSize = 0;
+
+	/// <summary>
+	/// Has the image been read by the worker
+	/// </summary>
+	bool IsDecoded = false;
+	/// <summary>
+	/// Compressed levels when the texture is cooked, only the first level holds the raw texels otherwise
+	/// </summary>
+	CookedTexture Image;
+	/// <summary>
+	/// Number of channels of the raw texels (0 when the image is cooked)
+	/// </summary>
+	int ChannelCount = 0;
+	/// <summary>
+	/// Size of every level, the size of the upload
+	/// </summary>
+	size_t ByteSize = 0;
+};
+
+/// <summary>
+/// Pixel buffer of the ring and the fence of the last upload read from it
+/// </summary>
+struct TextureUploadBuffer
+{
+	/// <summary>
+	/// Buffer ID
+	/// </summary>
+	unsigned int ID = 0;
+	/// <summary>
+	/// Size of the storage in bytes
+	/// </summary>
+	size_t Capacity = 0;
+	/// <summary>
+	/// Signaled once the GPU has copied the buffer in the texture
+	/// </summary>
+	GLsync Fence = nullptr;
+};
+
+/// <summary>
+/// Asynchronous loading of the textures : the images are decoded (or read from the cooked cache) on worker threads,
+/// the GL thread copies them in a ring of pixel buffer objects within a budget of bytes per frame.
+/// A texture shows the placeholder until its storage is filled
+/// </summary>
+class TextureLoader
+{
+	STATIC_CLASS(TextureLoader)
+
+public:
+	/// <summary>
+	/// Load the placeholder, create the pixel buffers and start the workers (need the Renderer to be initialized)
+	/// </summary>
+	UNDEFINED_ENGINE static void Setup();
+	/// <summary>
+	/// Stop the workers and release the pixel buffers, the textures still waiting keep the placeholder
+	/// </summary>
+	UNDEFINED_ENGINE static void Shutdown();
+	/// <summary>
+	/// Check if the workers are running
+	/// </summary>
+	/// <returns>Return either true if the textures can be loaded asynchronously or false</returns>
+	UNDEFINED_ENGINE static bool IsRunning();
+
+	/// <summary>
+	/// Queue the decode of an image for a texture
+	/// </summary>
+	/// <param name="target">: Texture receiving the image, its ID must be generated</param>
+	/// <param name="path">: Path of the image</param>
+	/// <param name="isFlipped">: Is the image flipped vertically</param>
+	/// <param name="firstLevel">: Finest level uploaded, a texture already resident gets a new storage holding the levels from this one</param>
+	/// <param name="maxSize">: Biggest side of the first level uploaded (0 for no limit)</param>
+	/// <returns>Return the request, kept by the texture to cancel it</returns>
+	UNDEFINED_ENGINE static std::shared_ptr<TextureRequest> Request(Texture* target, const std::string& path, bool isFlipped, int firstLevel = 0, int maxSize = 0);
+	/// <summary>
+	/// Upload the decoded images until the budget of the frame is spent, must be called once per frame on the GL thread
+	/// </summary>
+	UNDEFINED_ENGINE static void Update();
+
+	/// <summary>
+	/// Get the texture shown while an image is loading
+	/// </summary>
+	/// <returns>Return the ID of the placeholder (0 if it could not be loaded)</returns>
+	UNDEFINED_ENGINE static unsigned int GetPlaceholderID();
+	/// <summary>
+	/// Get the number of images not uploaded yet
+	/// </summary>
+	/// <returns>Return the number of requests in flight</returns>
+	UNDEFINED_ENGINE static size_t GetPendingCount();
+
+	/// <summary>
+	/// Bytes copied in the pixel buffers per frame, a bigger image is still uploaded alone in its frame
+	/// </summary>
+	UNDEFINED_ENGINE static inline size_t UploadBudget = 8 * 1024 * 1024;
+	/// <summary>
+	/// Image shown while the textures are loading
+	/// </summary>
+	UNDEFINED_ENGINE static inline std::string PlaceholderPath = "assets/missing_texture.jpg";
+
+private:
+	/// <summary>
+	/// Loop of a worker : decode the requests until the loader is shut down
+	/// </summary>
+	static void Work();
+	/// <summary>
+	/// Read the image of a request, cooked or raw
+	/// </summary>
+	/// <param name="request">: Request to fill</param>
+	static void Decode(TextureRequest& request);
+	/// <summary>
+	/// Copy a decoded image in the next pixel buffer and fill the storage of its texture from it,
+	/// the storage is immutable so a texture already resident gets a new one
+	/// </summary>
+	/// <param name="request">: Decoded request</param>
+	/// <returns>Return either true or false if the next pixel buffer is still read by the GPU</returns>
+	static bool Upload(TextureRequest& request);
+
+	/// <summary>
+	/// Number of pixel buffers, the GPU can copy from the others while one is written
+	/// </summary>
+	static constexpr size_t UPLOAD_BUFFER_COUNT = 4;
+
+	static inline std::array<TextureUploadBuffer, UPLOAD_BUFFER_COUNT> mUploadBuffers;
+	static inline size_t mNextUploadBuffer = 0;
+
+	static inline std::vector<std::thread> mWorkers;
+	static inline std::atomic<bool> mIsRunning = false;
+	static inline std::mutex mJobMutex;
+	static inline std::condition_variable mJobCondition;
+	/// <summary>
+	/// Requests waiting for a worker
+	/// </summary>
+	static inline std::deque<std::shared_ptr<TextureRequest>> mJobs;
+	/// <summary>
+	/// Requests decoded, in the order they have been finished
+	/// </summary>
+	static inline TsQueue<std::shared_ptr<TextureRequest>> mDecoded;
+	/// <summary>
+	/// Requests not uploaded yet
+	/// </summary>
+	static inline std::atomic<size_t> mPendingCount = 0;
+
+	static inline std::unique_ptr<Texture> mPlaceholder;
+	static inline Renderer* mRenderer = nullptr;
+};
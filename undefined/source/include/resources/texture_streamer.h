@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "utils/flag.h"
+
+class Texture;
+class Renderer;
+
+/// <summary>
+/// Mip residency of the cooked textures : the draws ask every frame for the finest level they sample, the streamer
+/// loads the finer levels through the TextureLoader and evicts the unused ones on the GPU so the textures stay under a budget of VRAM.
+/// When the levels asked don't fit, the biggest levels are dropped first
+/// </summary>
+class TextureStreamer
+{
+	STATIC_CLASS(TextureStreamer)
+
+public:
+	/// <summary>
+	/// Add a texture to the textures streamed (called by the TextureLoader once its cooked levels are resident)
+	/// </summary>
+	/// <param name="texture">: Texture streamed</param>
+	UNDEFINED_ENGINE static void Register(Texture* texture);
+	/// <summary>
+	/// Remove a texture from the textures streamed
+	/// </summary>
+	/// <param name="texture">: Texture removed</param>
+	UNDEFINED_ENGINE static void Unregister(Texture* texture);
+
+	/// <summary>
+	/// Choose the resident level of every texture from the levels asked during the frame and the budget, start the loads and evict the levels dropped.
+	/// Must be called once per frame on the GL thread, after every viewport has been drawn
+	/// </summary>
+	UNDEFINED_ENGINE static void Update();
+	/// <summary>
+	/// Keep the levels of the textures during the next Update : a visible viewport shows its last image without drawing, so it asks for no level
+	/// </summary>
+	UNDEFINED_ENGINE static void KeepLevels();
+
+	/// <summary>
+	/// Get the level a texture is sampled at
+	/// </summary>
+	/// <param name="textureWidth">: Width of the texture in texels</param>
+	/// <param name="uvDensity">: UV units per unit of the mesh</param>
+	/// <param name="pixelsPerUnit">: Pixels covered by a unit of the mesh on the screen</param>
+	/// <returns>Return the finest level needed</returns>
+	UNDEFINED_ENGINE static int ComputeLevel(unsigned int textureWidth, float uvDensity, float pixelsPerUnit);
+
+	/// <summary>
+	/// Get the size of the levels in VRAM
+	/// </summary>
+	/// <returns>Return the size in bytes</returns>
+	UNDEFINED_ENGINE static size_t GetResidentSize();
+	/// <summary>
+	/// Get the size of the levels asked by the draws, before the budget is applied
+	/// </summary>
+	/// <returns>Return the size in bytes</returns>
+	UNDEFINED_ENGINE static size_t GetRequestedSize();
+	/// <summary>
+	/// Get the number of textures streamed
+	/// </summary>
+	/// <returns>Return the number of textures</returns>
+	UNDEFINED_ENGINE static size_t GetTextureCount();
+
+	/// <summary>
+	/// Should the levels follow the draws, every texture is loaded at full resolution otherwise
+	/// </summary>
+	UNDEFINED_ENGINE static inline bool Enabled = true;
+	/// <summary>
+	/// Size of the streamed levels allowed in VRAM
+	/// </summary>
+	UNDEFINED_ENGINE static inline size_t VramBudget = 256 * 1024 * 1024;
+	/// <summary>
+	/// Biggest side of the first level loaded, the levels up to this size are never evicted
+	/// </summary>
+	UNDEFINED_ENGINE static inline int InitialSize = 128;
+	/// <summary>
+	/// Levels added to the level computed from the screen (positive values save memory, negative values sharpen)
+	/// </summary>
+	UNDEFINED_ENGINE static inline float LevelBias = 0.f;
+	/// <summary>
+	/// Frames a finer level is kept after the draws stopped asking for it
+	/// </summary>
+	UNDEFINED_ENGINE static inline unsigned int EvictionDelay = 120;
+	/// <summary>
+	/// Loads waiting in the TextureLoader at most
+	/// </summary>
+	UNDEFINED_ENGINE static inline size_t MaxLoadsInFlight = 8;
+
+private:
+	/// <summary>
+	/// Coarsest level the texture keeps, its biggest side is InitialSize or less
+	/// </summary>
+	/// <param name="texture">: Texture streamed</param>
+	/// <returns>Return the level</returns>
+	static int GetInitialLevel(const Texture& texture);
+	/// <summary>
+	/// Drop the finest levels of a texture : the levels kept are copied in a smaller storage on the GPU
+	/// </summary>
+	/// <param name="texture">: Texture streamed</param>
+	/// <param name="firstLevel">: New finest level</param>
+	static void Evict(Texture& texture, int firstLevel);
+
+	static inline std::vector<Texture*> mTextures;
+	static inline unsigned int mFrame = 0;
+	static inline bool mKeepLevels = false;
+	static inline size_t mResidentSize = 0;
+	static inline size_t mRequestedSize = 0;
+	static inline Renderer* mRenderer = nullptr;
+};
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <toolbox/Vector3.h>
+#include <toolbox/Matrix4x4.h>
+
+#include "utils/flag.h"
+
+struct Vertex;
+struct BoundingSphere;
+
+/// <summary>
+/// Axis aligned bounding box
+/// </summary>
+struct BoundingBox
+{
+	/// <summary>
+	/// Smallest corner of the box
+	/// </summary>
+	Vector3 Min;
+	/// <summary>
+	/// Biggest corner of the box
+	/// </summary>
+	Vector3 Max;
+
+	/// <summary>
+	/// Get the center of the box
+	/// </summary>
+	/// <returns>Return the center</returns>
+	UNDEFINED_ENGINE Vector3 GetCenter() const;
+	/// <summary>
+	/// Get the half size of the box on each axis
+	/// </summary>
+	/// <returns>Return the extents</returns>
+	UNDEFINED_ENGINE Vector3 GetExtents() const;
+	/// <summary>
+	/// Get the area of the faces of the box (cost used to build the BVH)
+	/// </summary>
+	/// <returns>Return the surface area</returns>
+	UNDEFINED_ENGINE float GetSurfaceArea() const;
+
+	/// <summary>
+	/// Check if a box is inside this box
+	/// </summary>
+	/// <param name="other">: Box to test</param>
+	/// <returns>Return either true if the whole box is inside or false</returns>
+	UNDEFINED_ENGINE bool Contains(const BoundingBox& other) const;
+	/// <summary>
+	/// Check if a box overlaps this box
+	/// </summary>
+	/// <param name="other">: Box to test</param>
+	/// <returns>Return either true if the boxes overlap or false</returns>
+	UNDEFINED_ENGINE bool Intersects(const BoundingBox& other) const;
+	/// <summary>
+	/// Check if a sphere overlaps this box
+	/// </summary>
+	/// <param name="sphere">: Sphere to test</param>
+	/// <returns>Return either true if the sphere overlaps the box or false</returns>
+	UNDEFINED_ENGINE bool Intersects(const BoundingSphere& sphere) const;
+	/// <summary>
+	/// Intersect a ray with the box (slab test)
+	/// </summary>
+	/// <param name="origin">: Origin of the ray</param>
+	/// <param name="inverseDirection">: 1 / direction of the ray on each axis</param>
+	/// <param name="maxDistance">: Length of the ray</param>
+	/// <param name="distance">: Distance along the ray where it enters the box (0 if the origin is inside)</param>
+	/// <returns>Return either true if the ray hits the box before maxDistance or false</returns>
+	UNDEFINED_ENGINE bool IntersectsRay(const Vector3& origin, const Vector3& inverseDirection, float maxDistance, float& distance) const;
+
+	/// <summary>
+	/// Compute the smallest box containing two boxes
+	/// </summary>
+	/// <param name="a">: First box</param>
+	/// <param name="b">: Second box</param>
+	/// <returns>Return the merged box</returns>
+	UNDEFINED_ENGINE static BoundingBox Merge(const BoundingBox& a, const BoundingBox& b);
+
+	/// <summary>
+	/// Compute the box containing this box once transformed (Arvo's method, no corner is transformed)
+	/// </summary>
+	/// <param name="matrix">: Transform applied to the box</param>
+	/// <returns>Return the transformed box</returns>
+	UNDEFINED_ENGINE BoundingBox Transformed(const Matrix4x4& matrix) const;
+};
+
+/// <summary>
+/// Bounding sphere
+/// </summary>
+struct BoundingSphere
+{
+	/// <summary>
+	/// Center of the sphere
+	/// </summary>
+	Vector3 Center;
+	/// <summary>
+	/// Radius of the sphere
+	/// </summary>
+	float Radius = 0.f;
+
+	/// <summary>
+	/// Compute the sphere containing this sphere once transformed, the radius is scaled by the biggest scale of the matrix
+	/// </summary>
+	/// <param name="matrix">: Transform applied to the sphere</param>
+	/// <returns>Return the transformed sphere</returns>
+	UNDEFINED_ENGINE BoundingSphere Transformed(const Matrix4x4& matrix) const;
+};
+
+/// <summary>
+/// Compute the bounding volumes of a list of vertices
+/// </summary>
+namespace Bounds
+{
+	/// <summary>
+	/// Compute the bounding box and sphere of vertices, the sphere is centered on the box
+	/// </summary>
+	/// <param name="vertices">: Pointer to the first vertex</param>
+	/// <param name="count">: Number of vertices</param>
+	/// <param name="box">: Box computed</param>
+	/// <param name="sphere">: Sphere computed</param>
+	UNDEFINED_ENGINE void Compute(const Vertex* vertices, size_t count, BoundingBox& box, BoundingSphere& sphere);
+}
@@ -3,6 +3,8 @@
 
 #include <vector>
 #include <numeric>
+#include <string_view>
+#include <functional>
 
 
 /// <summary>
@@ -53,4 +55,14 @@ namespace Utils
 
 		return reinterpret_cast<PtrT>(reinterpret_cast<uint8_t*>(1) + static_cast<const size_t>(number) - 1);
 	}
+
+	/// <summary>
+	/// Transparent string hash, allow an unordered_map keyed by std::string to be searched with a const char* or a std::string_view without allocating
+	/// </summary>
+	struct StringHash
+	{
+		using is_transparent = void;
+
+		size_t operator()(std::string_view str) const { return std::hash<std::string_view>{}(str); }
+	};
 };
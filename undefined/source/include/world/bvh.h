@@ -0,0 +1,206 @@
+#pragma once
+
+#include <vector>
+#include <toolbox/Vector3.h>
+
+#include "camera/frustum.h"
+
+#include "utils/bounds.h"
+#include "utils/flag.h"
+
+/// <summary>
+/// Dynamic AABB tree : every proxy is a leaf holding a box slightly bigger than its object (the fat box),
+/// a proxy is only reinserted when its object leaves the fat box and the tree is kept balanced with rotations
+/// </summary>
+class DynamicBvh
+{
+public:
+	/// <summary>
+	/// Default constructor of DynamicBvh
+	/// </summary>
+	UNDEFINED_ENGINE DynamicBvh();
+
+	/// <summary>
+	/// Add a proxy in the tree
+	/// </summary>
+	/// <param name="box">: Box of the object in world space</param>
+	/// <param name="userData">: Pointer given back by the queries</param>
+	/// <returns>Return the proxy ID</returns>
+	UNDEFINED_ENGINE int CreateProxy(const BoundingBox& box, void* userData);
+	/// <summary>
+	/// Remove a proxy from the tree
+	/// </summary>
+	/// <param name="proxy">: Proxy ID given by CreateProxy</param>
+	UNDEFINED_ENGINE void DestroyProxy(int proxy);
+	/// <summary>
+	/// Update the box of a proxy, the tree only changes when the box leaves the fat box of the proxy
+	/// </summary>
+	/// <param name="proxy">: Proxy ID given by CreateProxy</param>
+	/// <param name="box">: New box of the object in world space</param>
+	/// <returns>Return either true if the proxy has been reinserted or false</returns>
+	UNDEFINED_ENGINE bool MoveProxy(int proxy, const BoundingBox& box);
+	/// <summary>
+	/// Remove every proxy
+	/// </summary>
+	UNDEFINED_ENGINE void Clear();
+
+	/// <summary>
+	/// Get the pointer given when the proxy was created
+	/// </summary>
+	/// <param name="proxy">: Proxy ID</param>
+	/// <returns>Return the user data</returns>
+	UNDEFINED_ENGINE void* GetUserData(int proxy) const;
+	/// <summary>
+	/// Get the fat box stored for a proxy
+	/// </summary>
+	/// <param name="proxy">: Proxy ID</param>
+	/// <returns>Return the fat box</returns>
+	UNDEFINED_ENGINE const BoundingBox& GetFatBox(int proxy) const;
+	/// <summary>
+	/// Get the number of proxies in the tree
+	/// </summary>
+	/// <returns>Return the number of proxies</returns>
+	UNDEFINED_ENGINE size_t GetProxyCount() const;
+	/// <summary>
+	/// Get the height of the tree (0 for a single leaf, -1 when empty)
+	/// </summary>
+	/// <returns>Return the height</returns>
+	UNDEFINED_ENGINE int GetHeight() const;
+
+	/// <summary>
+	/// Call a function for every proxy whose fat box overlaps a box
+	/// </summary>
+	/// <typeparam name="Callback">: bool(void* userData), return false to stop the query</typeparam>
+	/// <param name="box">: Box in world space</param>
+	/// <param name="callback">: Function called for each proxy found</param>
+	template <typename Callback>
+	void QueryBox(const BoundingBox& box, Callback&& callback) const;
+	/// <summary>
+	/// Call a function for every proxy whose fat box overlaps a sphere
+	/// </summary>
+	/// <typeparam name="Callback">: bool(void* userData), return false to stop the query</typeparam>
+	/// <param name="sphere">: Sphere in world space</param>
+	/// <param name="callback">: Function called for each proxy found</param>
+	template <typename Callback>
+	void QuerySphere(const BoundingSphere& sphere, Callback&& callback) const;
+	/// <summary>
+	/// Call a function for every proxy whose fat box is at least partly inside a frustum,
+	/// a subtree completely inside is reported without testing its leaves
+	/// </summary>
+	/// <typeparam name="Callback">: bool(void* userData), return false to stop the query</typeparam>
+	/// <param name="frustum">: Frustum in world space</param>
+	/// <param name="callback">: Function called for each proxy found</param>
+	template <typename Callback>
+	void QueryFrustum(const Frustum& frustum, Callback&& callback) const;
+	/// <summary>
+	/// Call a function for every proxy whose fat box is hit by a ray
+	/// </summary>
+	/// <typeparam name="Callback">: float(void* userData, float boxDistance), return the new length of the ray
+	/// (e.g : the distance of the hit to keep only the closer objects, maxDistance to continue or 0 to stop)</typeparam>
+	/// <param name="origin">: Origin of the ray</param>
+	/// <param name="direction">: Direction of the ray (normalized)</param>
+	/// <param name="maxDistance">: Length of the ray</param>
+	/// <param name="callback">: Function called for each proxy hit</param>
+	template <typename Callback>
+	void RayCast(const Vector3& origin, const Vector3& direction, float maxDistance, Callback&& callback) const;
+
+	/// <summary>
+	/// Margin added on each side of the box of a proxy
+	/// </summary>
+	static constexpr float FatMargin = 0.1f;
+	/// <summary>
+	/// ID of a node that does not exist
+	/// </summary>
+	static constexpr int NullNode = -1;
+
+private:
+	/// <summary>
+	/// Node of the tree, a leaf is a proxy
+	/// </summary>
+	struct Node
+	{
+		/// <summary>
+		/// Box containing the whole subtree (the fat box for a leaf)
+		/// </summary>
+		BoundingBox Box;
+		/// <summary>
+		/// Pointer given when the proxy was created (leaves only)
+		/// </summary>
+		void* UserData = nullptr;
+		/// <summary>
+		/// Parent of the node, next free node when the node is in the free list
+		/// </summary>
+		int Parent = NullNode;
+		/// <summary>
+		/// Children of the node (NullNode for a leaf)
+		/// </summary>
+		int Child1 = NullNode;
+		int Child2 = NullNode;
+		/// <summary>
+		/// Height of the subtree (0 for a leaf, -1 for a free node)
+		/// </summary>
+		int Height = -1;
+
+		/// <summary>
+		/// Check if the node is a leaf
+		/// </summary>
+		/// <returns>Return either true if it is a leaf or false</returns>
+		bool IsLeaf() const { return Child1 == NullNode; }
+	};
+
+	/// <summary>
+	/// Take a node from the free list, the pool grows when it is empty
+	/// </summary>
+	/// <returns>Return the node ID</returns>
+	int AllocateNode();
+	/// <summary>
+	/// Give a node back to the free list
+	/// </summary>
+	/// <param name="node">: Node ID</param>
+	void FreeNode(int node);
+	/// <summary>
+	/// Insert a leaf next to the sibling that increases the surface area of the tree the least
+	/// </summary>
+	/// <param name="leaf">: Node ID of the leaf</param>
+	void InsertLeaf(int leaf);
+	/// <summary>
+	/// Remove a leaf, its sibling takes the place of their parent
+	/// </summary>
+	/// <param name="leaf">: Node ID of the leaf</param>
+	void RemoveLeaf(int leaf);
+	/// <summary>
+	/// Rotate a node with a grandchild when its children heights differ by more than one
+	/// </summary>
+	/// <param name="node">: Node ID</param>
+	/// <returns>Return the node ID now at the place of the node</returns>
+	int Balance(int node);
+	/// <summary>
+	/// Recompute the boxes and heights from a node to the root, balancing the tree on the way
+	/// </summary>
+	/// <param name="node">: First node to refit</param>
+	void Refit(int node);
+
+	/// <summary>
+	/// Pool of nodes, the IDs are indices in this pool
+	/// </summary>
+	std::vector<Node> mNodes;
+	/// <summary>
+	/// Root of the tree
+	/// </summary>
+	int mRoot = NullNode;
+	/// <summary>
+	/// First node of the free list
+	/// </summary>
+	int mFreeList = NullNode;
+	/// <summary>
+	/// Number of proxies in the tree
+	/// </summary>
+	size_t mProxyCount = 0;
+
+	/// <summary>
+	/// Stack used by the queries, kept to avoid an allocation per query (the queries are not thread safe)
+	/// </summary>
+	mutable std::vector<int> mStack;
+};
+
+#include "world/bvh.inl"
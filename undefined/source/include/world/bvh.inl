@@ -0,0 +1,159 @@
+template <typename Callback>
+void DynamicBvh::QueryBox(const BoundingBox& box, Callback&& callback) const
+{
+	if (mRoot == NullNode)
+	{
+		return;
+	}
+
+	mStack.clear();
+	mStack.push_back(mRoot);
+
+	while (!mStack.empty())
+	{
+		const Node& node = mNodes[mStack.back()];
+		mStack.pop_back();
+
+		if (!node.Box.Intersects(box))
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			if (!callback(node.UserData))
+			{
+				return;
+			}
+		}
+		else
+		{
+			mStack.push_back(node.Child1);
+			mStack.push_back(node.Child2);
+		}
+	}
+}
+
+template <typename Callback>
+void DynamicBvh::QuerySphere(const BoundingSphere& sphere, Callback&& callback) const
+{
+	if (mRoot == NullNode)
+	{
+		return;
+	}
+
+	mStack.clear();
+	mStack.push_back(mRoot);
+
+	while (!mStack.empty())
+	{
+		const Node& node = mNodes[mStack.back()];
+		mStack.pop_back();
+
+		if (!node.Box.Intersects(sphere))
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			if (!callback(node.UserData))
+			{
+				return;
+			}
+		}
+		else
+		{
+			mStack.push_back(node.Child1);
+			mStack.push_back(node.Child2);
+		}
+	}
+}
+
+template <typename Callback>
+void DynamicBvh::QueryFrustum(const Frustum& frustum, Callback&& callback) const
+{
+	if (mRoot == NullNode)
+	{
+		return;
+	}
+
+	// The sign of the node ID tells if the node is known to be inside : ~ID for a node inside
+	mStack.clear();
+	mStack.push_back(mRoot);
+
+	while (!mStack.empty())
+	{
+		const int entry = mStack.back();
+		mStack.pop_back();
+
+		const bool inside = entry < 0;
+		const Node& node = mNodes[inside ? ~entry : entry];
+
+		bool childrenInside = inside;
+		if (!inside)
+		{
+			if (!frustum.Intersects(node.Box))
+			{
+				continue;
+			}
+
+			childrenInside = !node.IsLeaf() && frustum.Contains(node.Box);
+		}
+
+		if (node.IsLeaf())
+		{
+			if (!callback(node.UserData))
+			{
+				return;
+			}
+		}
+		else
+		{
+			mStack.push_back(childrenInside ? ~node.Child1 : node.Child1);
+			mStack.push_back(childrenInside ? ~node.Child2 : node.Child2);
+		}
+	}
+}
+
+template <typename Callback>
+void DynamicBvh::RayCast(const Vector3& origin, const Vector3& direction, float maxDistance, Callback&& callback) const
+{
+	if (mRoot == NullNode)
+	{
+		return;
+	}
+
+	// A null component gives an infinite inverse, the slab test handles it
+	const Vector3 inverseDirection(1.f / direction.x, 1.f / direction.y, 1.f / direction.z);
+
+	mStack.clear();
+	mStack.push_back(mRoot);
+
+	while (!mStack.empty())
+	{
+		const Node& node = mNodes[mStack.back()];
+		mStack.pop_back();
+
+		float distance = 0.f;
+		if (!node.Box.IntersectsRay(origin, inverseDirection, maxDistance, distance))
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			maxDistance = callback(node.UserData, distance);
+
+			if (maxDistance <= 0.f)
+			{
+				return;
+			}
+		}
+		else
+		{
+			mStack.push_back(node.Child1);
+			mStack.push_back(node.Child2);
+		}
+	}
+}
@@ -101,12 +101,12 @@ private:
 	/// <summary>
 	/// Pointer to the object that contains the component
 	/// </summary>
-	Object* mObject;
+	Object* mObject = nullptr;
 
 	/// <summary>
 	/// Pointer to the transform of the object that contains the component
 	/// </summary>
-	Transform* mTransform;
+	Transform* mTransform = nullptr;
 
 private:
 	/// <summary>
@@ -27,9 +27,16 @@ public:
 	~DirLight();
 
 	/// <summary>
-	/// Draw function from Component which is override
+	/// Get the type of the light
 	/// </summary>
-	void Draw() override;
+	/// <returns>Return LightType::Directional</returns>
+	LightType GetLightType() const override;
+
+	/// <summary>
+	/// Write the light data in its slot of the Lights buffer
+	/// </summary>
+	/// <param name="gpuLight">: Slot of the light in the buffer</param>
+	void FillGpuLight(GpuLight& gpuLight) override;
 	/// <summary>
 	/// Get the total number of DirLight
 	/// </summary>
@@ -3,8 +3,7 @@
 #include <toolbox/Vector3.h>
 
 #include "world/component.h"
-
-#include "resources/shader.h"
+#include "world/light_manager.h"
 
 #include "utils/flag.h"
 
@@ -42,6 +41,18 @@ public:
 	/// </summary>
 	UNDEFINED_ENGINE virtual void Update();
 
+	/// <summary>
+	/// Get the type of the light
+	/// </summary>
+	/// <returns>Return the type used to sort the light in the Lights buffer</returns>
+	UNDEFINED_ENGINE virtual LightType GetLightType() const = 0;
+
+	/// <summary>
+	/// Write the light data in its slot of the Lights buffer
+	/// </summary>
+	/// <param name="gpuLight">: Slot of the light in the buffer</param>
+	UNDEFINED_ENGINE virtual void FillGpuLight(GpuLight& gpuLight) = 0;
+
 	/// <summary>
 	/// Ambient Light
 	/// </summary>
@@ -55,12 +66,6 @@ public:
 	/// </summary>
 	Vector3 Specular;
 
-protected:
-	/// <summary>
-	/// Shader use for the lights
-	/// </summary>
-	std::shared_ptr<Shader> pShader;
-
 private:
 	void ValueChanged();
 };
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+#include <toolbox/Vector3.h>
+
+#include "utils/flag.h"
+
+class Camera;
+class Renderer;
+
+/// <summary>
+/// Clustered forward lighting : split the view frustum of a camera in 3D clusters and bin the point and spot lights in them,
+/// the fragment shader only evaluates the lights of its own cluster
+/// </summary>
+class LightClusters
+{
+	STATIC_CLASS(LightClusters)
+
+public:
+	/// <summary>
+	/// Create the cluster buffers and bind them to their binding points (need the Renderer to be initialized)
+	/// </summary>
+	UNDEFINED_ENGINE static void Setup();
+
+	/// <summary>
+	/// Bin the lights uploaded by the LightManager in the clusters of the camera and upload the result,
+	/// must be called for each viewport before drawing it
+	/// </summary>
+	/// <param name="camera">: Camera of the viewport</param>
+	UNDEFINED_ENGINE static void Build(const Camera& camera);
+
+	/// <summary>
+	/// Get the total number of light references stored in the clusters during the last Build
+	/// </summary>
+	/// <returns>Return the size of the light index list</returns>
+	UNDEFINED_ENGINE static size_t GetLightIndexCount();
+
+	/// <summary>
+	/// Number of clusters along the width of the screen
+	/// </summary>
+	static constexpr unsigned int ClusterCountX = 16;
+	/// <summary>
+	/// Number of clusters along the height of the screen
+	/// </summary>
+	static constexpr unsigned int ClusterCountY = 9;
+	/// <summary>
+	/// Number of depth slices (logarithmic distribution between the near and far planes)
+	/// </summary>
+	static constexpr unsigned int ClusterCountZ = 24;
+	/// <summary>
+	/// Total number of clusters
+	/// </summary>
+	static constexpr unsigned int ClusterCount = ClusterCountX * ClusterCountY * ClusterCountZ;
+
+	/// <summary>
+	/// Binding point of the LightClusters buffer (layout (std430, binding = 2) in the shaders)
+	/// </summary>
+	static constexpr unsigned int ClusterBufferBinding = 2;
+	/// <summary>
+	/// Binding point of the LightIndices buffer (layout (std430, binding = 3) in the shaders)
+	/// </summary>
+	static constexpr unsigned int LightIndexBufferBinding = 3;
+
+private:
+	/// <summary>
+	/// View space bounding box of a cluster
+	/// </summary>
+	struct ClusterBounds
+	{
+		Vector3 Min;
+		Vector3 Max;
+	};
+
+	/// <summary>
+	/// Header of the LightClusters buffer (match the shaders)
+	/// </summary>
+	struct ClusterHeader
+	{
+		/// <summary>
+		/// xyz : Number of clusters on each axis
+		/// </summary>
+		unsigned int Count[4];
+		/// <summary>
+		/// xy : Size of the viewport, z : Depth slice scale, w : Depth slice bias
+		/// </summary>
+		float Params[4];
+	};
+
+	/// <summary>
+	/// Compute the view space bounding box of every cluster
+	/// </summary>
+	/// <param name="camera">: Camera of the viewport</param>
+	static void ComputeClusterBounds(const Camera& camera);
+
+	/// <summary>
+	/// Get the depth slice containing a view depth
+	/// </summary>
+	/// <param name="depth">: Distance along the view direction</param>
+	/// <returns>Return the slice, clamped in the grid</returns>
+	static unsigned int GetSlice(float depth);
+
+	/// <summary>
+	/// View space bounding box of every cluster
+	/// </summary>
+	static inline std::vector<ClusterBounds> mClusterBounds;
+	/// <summary>
+	/// Every (cluster, light) pair found during the binning
+	/// </summary>
+	static inline std::vector<std::pair<unsigned int, unsigned int>> mClusterLights;
+	/// <summary>
+	/// CPU copy of the LightClusters buffer : the header followed by the (offset, count) of each cluster
+	/// </summary>
+	static inline std::vector<unsigned int> mClusterStaging;
+	/// <summary>
+	/// CPU copy of the LightIndices buffer : the lights of each cluster, one cluster after the other
+	/// </summary>
+	static inline std::vector<unsigned int> mLightIndices;
+
+	/// <summary>
+	/// Depth slice scale and bias : slice = log(depth) * scale - bias
+	/// </summary>
+	static inline float mSliceScale = 0.f;
+	static inline float mSliceBias = 0.f;
+
+	/// <summary>
+	/// Shader storage buffer of the clusters
+	/// </summary>
+	static inline unsigned int mClusterSSBO = 0;
+	/// <summary>
+	/// Shader storage buffer of the light indices
+	/// </summary>
+	static inline unsigned int mLightIndexSSBO = 0;
+	/// <summary>
+	/// Size allocated for the light indices in bytes
+	/// </summary>
+	static inline size_t mLightIndexCapacity = 0;
+
+	/// <summary>
+	/// Pointer to our Renderer to simplify the calls from the ServiceLocator
+	/// </summary>
+	static inline Renderer* mRenderer = nullptr;
+};
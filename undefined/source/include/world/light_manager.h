@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <toolbox/Vector4.h>
+
+#include "utils/flag.h"
+
+class Light;
+class Renderer;
+
+/// <summary>
+/// Type of a Light, the lights are packed in the buffer in this order
+/// </summary>
+enum class LightType : unsigned int
+{
+	Directional = 0,
+	Point,
+	Spot,
+
+	Count
+};
+
+/// <summary>
+/// A Light as stored in the Lights shader storage buffer (std430 layout, match the Light struct of base_shader.fs)
+/// </summary>
+struct GpuLight
+{
+	/// <summary>
+	/// xyz : Position, w : Outer cut off (spot)
+	/// </summary>
+	Vector4 Position;
+	/// <summary>
+	/// xyz : Direction, w : Cut off (spot)
+	/// </summary>
+	Vector4 Direction;
+	/// <summary>
+	/// xyz : Ambient, w : Constant attenuation
+	/// </summary>
+	Vector4 Ambient;
+	/// <summary>
+	/// xyz : Diffuse, w : Linear attenuation
+	/// </summary>
+	Vector4 Diffuse;
+	/// <summary>
+	/// xyz : Specular, w : Quadratic attenuation
+	/// </summary>
+	Vector4 Specular;
+};
+
+/// <summary>
+/// Collect every enabled Light and upload them once per frame in a single shader storage buffer
+/// </summary>
+class LightManager
+{
+	STATIC_CLASS(LightManager)
+
+public:
+	/// <summary>
+	/// Create the light buffer and bind it to its binding point (need the Renderer to be initialized)
+	/// </summary>
+	UNDEFINED_ENGINE static void Setup();
+
+	/// <summary>
+	/// Add a light to the lights uploaded every frame
+	/// </summary>
+	/// <param name="light">: Light to add</param>
+	UNDEFINED_ENGINE static void Register(Light* light);
+	/// <summary>
+	/// Remove a light from the lights uploaded every frame
+	/// </summary>
+	/// <param name="light">: Light to remove</param>
+	UNDEFINED_ENGINE static void Unregister(Light* light);
+
+	/// <summary>
+	/// Pack every enabled light, sorted by type, and upload them with the counts in one call (only when they changed since the last upload)
+	/// </summary>
+	UNDEFINED_ENGINE static void Update();
+
+	/// <summary>
+	/// Get the number of lights of a type uploaded during the last Update
+	/// </summary>
+	/// <param name="type">: Type of light</param>
+	/// <returns>Return the number of lights</returns>
+	UNDEFINED_ENGINE static unsigned int GetLightCount(LightType type);
+
+	/// <summary>
+	/// Get the bounding sphere of every point and spot light uploaded during the last Update, in the same order as in the buffer
+	/// </summary>
+	/// <returns>Return the spheres (xyz : world position, w : range where the light is brighter than LightCutOffIntensity)</returns>
+	UNDEFINED_ENGINE static const std::vector<Vector4>& GetLocalLightBounds();
+	/// <summary>
+	/// Get the version of the lights uploaded, it changes when the buffer is uploaded again
+	/// </summary>
+	/// <returns>Return the version</returns>
+	UNDEFINED_ENGINE static uint64_t GetVersion();
+
+	/// <summary>
+	/// Compute the distance where an attenuated light becomes negligible
+	/// </summary>
+	/// <param name="gpuLight">: Packed light (the attenuation is stored in the w components)</param>
+	/// <returns>Return the range of the light</returns>
+	UNDEFINED_ENGINE static float ComputeRange(const GpuLight& gpuLight);
+
+	/// <summary>
+	/// Binding point of the Lights buffer (layout (std430, binding = 1) in the shaders)
+	/// </summary>
+	static constexpr unsigned int LightBufferBinding = 1;
+
+	/// <summary>
+	/// Intensity under which a light is considered as not contributing anymore
+	/// </summary>
+	static constexpr float LightCutOffIntensity = 5.f / 256.f;
+
+private:
+	/// <summary>
+	/// Header of the Lights buffer, number of lights of each type (uvec4 in the shaders)
+	/// </summary>
+	struct LightCounts
+	{
+		unsigned int Count[4];
+	};
+
+	/// <summary>
+	/// Every light alive
+	/// </summary>
+	static inline std::vector<Light*> mLights;
+	/// <summary>
+	/// CPU copy of the buffer : the counts followed by the packed lights
+	/// </summary>
+	static inline std::vector<unsigned char> mStaging;
+	/// <summary>
+	/// Copy of the last buffer uploaded, the same lights are not uploaded again
+	/// </summary>
+	static inline std::vector<unsigned char> mUploaded;
+	/// <summary>
+	/// Incremented with every upload
+	/// </summary>
+	static inline uint64_t mVersion = 0;
+	/// <summary>
+	/// Bounding sphere of every point and spot light uploaded
+	/// </summary>
+	static inline std::vector<Vector4> mLocalLightBounds;
+	/// <summary>
+	/// Number of lights of each type uploaded
+	/// </summary>
+	static inline LightCounts mLightCounts = {};
+
+	/// <summary>
+	/// Shader storage buffer of the lights
+	/// </summary>
+	static inline unsigned int mSSBO = 0;
+	/// <summary>
+	/// Size allocated for the buffer in bytes
+	/// </summary>
+	static inline size_t mCapacity = 0;
+
+	/// <summary>
+	/// Pointer to our Renderer to simplify the calls from the ServiceLocator
+	/// </summary>
+	static inline Renderer* mRenderer = nullptr;
+};
@@ -174,6 +174,23 @@ private:
 	/// </summary>
 	bool mIsEnable = true;
 
+	/// <summary>
+	/// Proxy of the Object in the BVH of the scene (-1 when not inserted)
+	/// </summary>
+	int mBvhProxy = -1;
+	/// <summary>
+	/// Version of the Transform when the proxy was last updated
+	/// </summary>
+	unsigned int mBvhVersion = 0;
+	/// <summary>
+	/// Model drawn by the Object when the proxy was last updated
+	/// </summary>
+	const void* mBvhModel = nullptr;
+	/// <summary>
+	/// Last frustum query of the scene that found the proxy of the Object
+	/// </summary>
+	uint64_t mVisibleQuery = 0;
+
 	friend struct refl_impl::metadata::type_info__ <Object>;
 
 private:
@@ -22,14 +22,16 @@ public:
 	~PointLight();
 
 	/// <summary>
-	/// Draw function from Component which is override
+	/// Get the type of the light
 	/// </summary>
-	void Draw() override;
+	/// <returns>Return LightType::Point</returns>
+	LightType GetLightType() const override;
 
 	/// <summary>
-	/// Post Draw function from Component which is override
+	/// Write the light data in its slot of the Lights buffer
 	/// </summary>
-	void PostDraw() override;
+	/// <param name="gpuLight">: Slot of the light in the buffer</param>
+	void FillGpuLight(GpuLight& gpuLight) override;
 
 	/// <summary>
 	/// Get the total number of PointLight
@@ -40,14 +42,6 @@ public:
 	float ConstantAttenuation = 1.f;
 	float LinearAttenuation = 0.09f;
 	float QuadraticAttenuation = 0.032f;
-
-private:
-	int mID = 0;
-
-private:
-	static inline int mGlobalID = 0;
-	static inline std::vector<PointLight*> mPointLightsArray;
-
 };
 
 REFL_AUTO(type(PointLight, bases<Light>),
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstdint>
+
 #include "world/object.h"
+#include "world/bvh.h"
 #include "utils/flag.h"
 
 class Scene
@@ -17,6 +20,10 @@ public:
 	UNDEFINED_ENGINE void Update();
 	UNDEFINED_ENGINE void LateUpdate();
 	UNDEFINED_ENGINE void Draw();
+	/// <summary>
+	/// Submit the draw packets of the enabled objects to the RenderQueue without flushing it, stamped with the index of their object
+	/// </summary>
+	UNDEFINED_ENGINE void SubmitDraws();
 	UNDEFINED_ENGINE void PostDraw();
 
 	UNDEFINED_ENGINE Object* AddObject(const std::string& mName = "Default");
@@ -30,9 +37,57 @@ public:
 
 	UNDEFINED_ENGINE void RemoveObject(Object* object);
 
+	/// <summary>
+	/// Refit the proxies of the objects whose Transform or model has changed, insert the objects not in the BVH yet
+	/// </summary>
+	UNDEFINED_ENGINE void UpdateBvh();
+	/// <summary>
+	/// Get the BVH of the objects, the user data of each proxy is the Object
+	/// </summary>
+	/// <returns>Return the BVH</returns>
+	UNDEFINED_ENGINE const DynamicBvh& GetBvh() const;
+	/// <summary>
+	/// Get the version of the objects, it changes when an object is added, removed, moved or changes its model
+	/// </summary>
+	/// <returns>Return the version</returns>
+	UNDEFINED_ENGINE uint64_t GetVersion() const;
+	/// <summary>
+	/// Compute the world box of an Object : the box of its model or its position
+	/// </summary>
+	/// <param name="object">: Object</param>
+	/// <returns>Return the box</returns>
+	UNDEFINED_ENGINE static BoundingBox ComputeBounds(Object* object);
+
 	std::string Name = "Default";
 
 	std::filesystem::path Path;
 
 	std::vector<Object*> Objects;
+
+private:
+	/// <summary>
+	/// Insert an Object in the BVH
+	/// </summary>
+	/// <param name="object">: Object added to the scene</param>
+	void InsertInBvh(Object* object);
+	/// <summary>
+	/// Compute the box of the proxy of an Object
+	/// </summary>
+	/// <param name="object">: Object</param>
+	/// <param name="box">: Box of its model or its position</param>
+	/// <returns>Return the model whose box was used, nullptr when the box is the position</returns>
+	static const void* ComputeProxyBounds(Object* object, BoundingBox& box);
+
+	/// <summary>
+	/// BVH of the objects, answer the spatial queries without going through every object
+	/// </summary>
+	DynamicBvh mBvh;
+	/// <summary>
+	/// Incremented with every change of the BVH, the viewports draw again when it changes
+	/// </summary>
+	uint64_t mVersion = 0;
+	/// <summary>
+	/// Incremented with every frustum query of SubmitDraws, the objects found by the query are stamped with it
+	/// </summary>
+	uint64_t mVisibleQuery = 0;
 };
\ No newline at end of file
@@ -26,11 +26,6 @@ public:
 	/// </summary>
 	UNDEFINED_ENGINE static void Setup();
 	/// <summary>
-	/// Update the skybox
-	/// </summary>
-	/// <param name="cam">: Camera viewing the skybox</param>
-	UNDEFINED_ENGINE static void Update(Camera* cam);
-	/// <summary>
 	/// Draw the skybox
 	/// </summary>
 	UNDEFINED_ENGINE static void Draw();
@@ -38,11 +33,6 @@ public:
 	UNDEFINED_ENGINE static void ChangeFaces();
 
 private:
-	/// <summary>
-	/// Camera View without the translation
-	/// </summary>
-	static inline Matrix4x4 mView;
-
 	/// <summary>
 	/// VAO
 	/// </summary>
@@ -22,14 +22,16 @@ public:
 	~SpotLight();
 
 	/// <summary>
-	/// Draw function from Component which is override
+	/// Get the type of the light
 	/// </summary>
-	void Draw() override;
+	/// <returns>Return LightType::Spot</returns>
+	LightType GetLightType() const override;
 
 	/// <summary>
-	/// Post Draw function from Component which is override
+	/// Write the light data in its slot of the Lights buffer
 	/// </summary>
-	void PostDraw() override;
+	/// <param name="gpuLight">: Slot of the light in the buffer</param>
+	void FillGpuLight(GpuLight& gpuLight) override;
 
 	/// <summary>
 	/// Get the total number of SpotLight
@@ -43,16 +45,8 @@ public:
 	float LinearAttenuation = 0.09f;
 	float QuadraticAttenuation = 0.032f;
 
-	float CutOff;
-	float OuterCutOff;
-
-private:
-	int mID = 0;
-
-private:
-	static inline int mGlobalID = 0;
-	static inline std::vector<SpotLight*> mSpotLightsArray;
-
+	float CutOff = 0.976f;
+	float OuterCutOff = 0.953f;
 };
 
 REFL_AUTO(type(SpotLight, bases<Light>),
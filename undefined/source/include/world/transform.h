@@ -19,6 +19,13 @@ public:
 	UNDEFINED_ENGINE const Matrix4x4& WorldMatrix();
 	UNDEFINED_ENGINE void SetWorldMatrix(const Matrix4x4& matrix);
 
+	/// <summary>
+	/// Get the number of times the world matrix has changed, a cache built from the matrix is stale when the version differs
+	/// (call WorldMatrix first so a pending change is applied)
+	/// </summary>
+	/// <returns>Return the version of the world matrix</returns>
+	UNDEFINED_ENGINE unsigned int GetVersion() const;
+
 	__declspec(property(get = GetPosition, put = SetPosition)) Vector3 Position;
 	UNDEFINED_ENGINE Vector3 GetPosition();
 	UNDEFINED_ENGINE void SetPosition(Vector3 newPosition);
@@ -57,6 +64,7 @@ public:
 
 private:
 	bool mHasChanged;
+	unsigned int mVersion = 0;
 	Vector3 mPosition;
 	Quaternion mRotation;
 	Vector3 mScale = { 1, 1, 1 };
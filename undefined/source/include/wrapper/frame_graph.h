@@ -0,0 +1,220 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "utils/flag.h"
+
+/// <summary>
+/// Handle of a resource of the FrameGraph, each write gives a new version of the resource
+/// </summary>
+struct FrameGraphResource
+{
+	/// <summary>
+	/// Index of the resource in the graph
+	/// </summary>
+	uint32_t Index = UINT32_MAX;
+	/// <summary>
+	/// Version of the content, 0 is the content before the first pass writing it
+	/// </summary>
+	uint32_t Version = 0;
+
+	/// <summary>
+	/// Check if the handle has been given by the graph
+	/// </summary>
+	/// <returns>Return either true or false</returns>
+	bool IsValid() const { return Index != UINT32_MAX; }
+};
+
+/// <summary>
+/// Texture created by the graph for the passes using it
+/// </summary>
+struct FrameGraphTextureDesc
+{
+	int Width = 0;
+	int Height = 0;
+	/// <summary>
+	/// Sized format of the texels (e.g : GL_RGBA8, GL_DEPTH24_STENCIL8)
+	/// </summary>
+	unsigned int InternalFormat = 0;
+	int Levels = 1;
+};
+
+/// <summary>
+/// Passes of a frame declared with the resources they read and write, rebuilt every frame :
+/// the passes are ordered from their dependencies, the passes whose result nothing reads (and without side effect) are culled,
+/// and the transient textures are only taken from the RenderTargetPool between their first and their last pass,
+/// so the textures whose lifetimes don't overlap share the same memory
+/// </summary>
+class FrameGraph
+{
+public:
+	/// <summary>
+	/// Declares the resources of a pass while it is added
+	/// </summary>
+	class Builder
+	{
+	public:
+		/// <summary>
+		/// Read a version of a resource, the pass runs after the pass writing it
+		/// </summary>
+		/// <param name="resource">: Resource read</param>
+		/// <returns>Return the same handle</returns>
+		UNDEFINED_ENGINE FrameGraphResource Read(FrameGraphResource resource);
+		/// <summary>
+		/// Write a resource, the pass runs after the passes using the version it replaces
+		/// </summary>
+		/// <param name="resource">: Resource written</param>
+		/// <returns>Return the handle of the new version, to give to the passes reading the result</returns>
+		UNDEFINED_ENGINE FrameGraphResource Write(FrameGraphResource resource);
+		/// <summary>
+		/// Keep the pass even if nothing reads what it writes (e.g : readback, upload)
+		/// </summary>
+		UNDEFINED_ENGINE void SetSideEffect();
+
+	private:
+		Builder(FrameGraph& graph, uint32_t pass);
+
+		FrameGraph& mGraph;
+		uint32_t mPass;
+
+		friend class FrameGraph;
+	};
+
+	/// <summary>
+	/// Function drawing the pass, the graph gives the textures of its resources
+	/// </summary>
+	using ExecuteFunction = std::function<void(const FrameGraph&)>;
+
+	/// <summary>
+	/// Remove the passes and the resources, the textures still taken are given back to the pool
+	/// </summary>
+	UNDEFINED_ENGINE void Reset();
+
+	/// <summary>
+	/// Declare a texture only living during the frame, it is created by the first pass using it
+	/// </summary>
+	/// <param name="name">: Name displayed in the stats</param>
+	/// <param name="desc">: Size and format of the texture</param>
+	/// <returns>Return the handle of the resource</returns>
+	UNDEFINED_ENGINE FrameGraphResource CreateTexture(const char* name, const FrameGraphTextureDesc& desc);
+	/// <summary>
+	/// Declare a resource living outside of the graph (e.g : a viewport framebuffer, the window)
+	/// </summary>
+	/// <param name="name">: Name displayed in the stats</param>
+	/// <param name="textureID">: Texture of the resource, 0 if it is only used to order the passes (by default : 0)</param>
+	/// <returns>Return the handle of the resource</returns>
+	UNDEFINED_ENGINE FrameGraphResource Import(const char* name, unsigned int textureID = 0);
+	/// <summary>
+	/// Keep the passes writing a version of a resource and the passes they depend on
+	/// </summary>
+	/// <param name="resource">: Version needed at the end of the frame</param>
+	UNDEFINED_ENGINE void MarkOutput(FrameGraphResource resource);
+
+	/// <summary>
+	/// Add a pass, setup is called right away to declare its resources
+	/// </summary>
+	/// <param name="name">: Name displayed in the stats</param>
+	/// <param name="setup">: Function declaring the resources of the pass</param>
+	/// <param name="execute">: Function drawing the pass</param>
+	UNDEFINED_ENGINE void AddPass(const char* name, const std::function<void(Builder&)>& setup, ExecuteFunction execute);
+
+	/// <summary>
+	/// Cull the passes not needed by the outputs, order the others and compute the lifetime of the transient textures
+	/// </summary>
+	UNDEFINED_ENGINE void Compile();
+	/// <summary>
+	/// Run the passes kept by Compile in their order
+	/// </summary>
+	UNDEFINED_ENGINE void Execute();
+
+	/// <summary>
+	/// Get the texture of a resource, the transient textures only exist while their passes run
+	/// </summary>
+	/// <param name="resource">: Resource</param>
+	/// <returns>Return the ID of the texture</returns>
+	UNDEFINED_ENGINE unsigned int GetTexture(FrameGraphResource resource) const;
+
+	/// <summary>
+	/// Get the number of passes added since Reset
+	/// </summary>
+	/// <returns>Return the number of passes</returns>
+	UNDEFINED_ENGINE size_t GetPassCount() const;
+	/// <summary>
+	/// Get the name of a pass
+	/// </summary>
+	/// <param name="pass">: Index of the pass in the order they were added</param>
+	/// <returns>Return the name</returns>
+	UNDEFINED_ENGINE const char* GetPassName(size_t pass) const;
+	/// <summary>
+	/// Check if a pass has been kept by Compile
+	/// </summary>
+	/// <param name="pass">: Index of the pass in the order they were added</param>
+	/// <returns>Return either true if the pass runs or false if it is culled</returns>
+	UNDEFINED_ENGINE bool IsPassExecuted(size_t pass) const;
+
+private:
+	/// <summary>
+	/// Resource of the graph
+	/// </summary>
+	struct Resource
+	{
+		const char* Name = "";
+		FrameGraphTextureDesc Desc;
+		/// <summary>
+		/// Texture of an imported resource or of a transient one while it lives
+		/// </summary>
+		unsigned int TextureID = 0;
+		bool IsTransient = false;
+		/// <summary>
+		/// Pass writing each version, -1 for the version 0
+		/// </summary>
+		std::vector<int> Writers;
+		/// <summary>
+		/// Passes reading each version
+		/// </summary>
+		std::vector<std::vector<uint32_t>> Readers;
+		/// <summary>
+		/// Position of the first and the last pass using the resource in the execution order
+		/// </summary>
+		size_t FirstUse = SIZE_MAX;
+		size_t LastUse = 0;
+	};
+
+	/// <summary>
+	/// Pass of the graph
+	/// </summary>
+	struct Pass
+	{
+		const char* Name = "";
+		ExecuteFunction Execute;
+		std::vector<FrameGraphResource> Reads;
+		std::vector<FrameGraphResource> Writes;
+		bool HasSideEffect = false;
+		bool IsKept = false;
+	};
+
+	/// <summary>
+	/// Keep a pass and the passes writing what it uses
+	/// </summary>
+	/// <param name="pass">: Index of the pass</param>
+	void Keep(uint32_t pass);
+	/// <summary>
+	/// Order the kept passes, a pass comes after the passes writing what it reads and the passes using what it overwrites.
+	/// The passes without dependency between them keep the order they were added
+	/// </summary>
+	/// <returns>Return either true or false if the dependencies have a cycle</returns>
+	bool SortPasses();
+
+	std::vector<Resource> mResources;
+	std::vector<Pass> mPasses;
+	/// <summary>
+	/// Versions marked as outputs
+	/// </summary>
+	std::vector<FrameGraphResource> mOutputs;
+	/// <summary>
+	/// Indices of the kept passes in their execution order
+	/// </summary>
+	std::vector<uint32_t> mOrder;
+};
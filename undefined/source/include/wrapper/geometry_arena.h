@@ -0,0 +1,249 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "utils/flag.h"
+
+class GeometryArena;
+class Renderer;
+
+/// <summary>
+/// Layout of the vertices stored in an arena
+/// </summary>
+enum class VertexFormat : uint8_t
+{
+	/// <summary>
+	/// Vertex : position, normal and texture coordinates as floats
+	/// </summary>
+	Standard = 0,
+	/// <summary>
+	/// PackedVertex : position quantized in the bounds of the mesh, normal on 10 bits per axis, texture coordinates as half floats
+	/// </summary>
+	Packed = 1,
+};
+
+/// <summary>
+/// Range of vertices and indices given to a Mesh by an arena
+/// </summary>
+struct GeometryAllocation
+{
+	/// <summary>
+	/// Arena holding the data (nullptr when nothing is allocated)
+	/// </summary>
+	GeometryArena* Arena = nullptr;
+	/// <summary>
+	/// First vertex of the Mesh in the vertex buffer, added to each index when drawing
+	/// </summary>
+	unsigned int BaseVertex = 0;
+	/// <summary>
+	/// Number of vertices
+	/// </summary>
+	unsigned int VertexCount = 0;
+	/// <summary>
+	/// First index of the Mesh in the index buffer
+	/// </summary>
+	unsigned int FirstIndex = 0;
+	/// <summary>
+	/// Number of indices
+	/// </summary>
+	unsigned int IndexCount = 0;
+};
+
+/// <summary>
+/// Command read by glMultiDrawElementsIndirect (layout fixed by OpenGL)
+/// </summary>
+struct DrawElementsIndirectCommand
+{
+	/// <summary>
+	/// Number of indices
+	/// </summary>
+	unsigned int Count = 0;
+	/// <summary>
+	/// Number of instances
+	/// </summary>
+	unsigned int InstanceCount = 0;
+	/// <summary>
+	/// First index in the index buffer
+	/// </summary>
+	unsigned int FirstIndex = 0;
+	/// <summary>
+	/// Value added to each index
+	/// </summary>
+	int BaseVertex = 0;
+	/// <summary>
+	/// First instance read in the per-instance attributes
+	/// </summary>
+	unsigned int BaseInstance = 0;
+};
+
+/// <summary>
+/// Shared vertex and index buffers for every Mesh with the same vertex format and index type,
+/// the meshes of an arena are drawn with the same VAO so a whole pass can be a single multi draw
+/// </summary>
+class GeometryArena
+{
+public:
+	/// <summary>
+	/// Get the arena of a vertex format and an index type, it is created the first time
+	/// </summary>
+	/// <param name="format">: Layout of the vertices</param>
+	/// <param name="indexType">: Type of the indices (e.g : GL_UNSIGNED_INT)</param>
+	/// <returns>Return the arena</returns>
+	UNDEFINED_ENGINE static GeometryArena& Get(VertexFormat format, unsigned int indexType);
+
+	/// <summary>
+	/// Copy vertices and indices in the arena, the buffers grow when they are full
+	/// </summary>
+	/// <param name="vertices">: Pointer to the first vertex</param>
+	/// <param name="vertexCount">: Number of vertices</param>
+	/// <param name="indices">: Pointer to the first index</param>
+	/// <param name="indexCount">: Number of indices</param>
+	/// <returns>Return the range given to the data</returns>
+	UNDEFINED_ENGINE GeometryAllocation Allocate(const void* vertices, unsigned int vertexCount, const void* indices, unsigned int indexCount);
+	/// <summary>
+	/// Give a range back to the arena
+	/// </summary>
+	/// <param name="allocation">: Range given by Allocate</param>
+	UNDEFINED_ENGINE void Free(const GeometryAllocation& allocation);
+
+	/// <summary>
+	/// Get the VAO reading the arena
+	/// </summary>
+	/// <returns>Return the VAO ID</returns>
+	UNDEFINED_ENGINE unsigned int GetVAO() const;
+	/// <summary>
+	/// Get the type of the indices
+	/// </summary>
+	/// <returns>Return the type (e.g : GL_UNSIGNED_INT)</returns>
+	UNDEFINED_ENGINE unsigned int GetIndexType() const;
+	/// <summary>
+	/// Get the size of an index in bytes
+	/// </summary>
+	/// <returns>Return the size</returns>
+	UNDEFINED_ENGINE size_t GetIndexSize() const;
+	/// <summary>
+	/// Get the size in bytes used by the arenas on the GPU
+	/// </summary>
+	/// <returns>Return the size of every buffer of every arena</returns>
+	UNDEFINED_ENGINE static size_t GetTotalMemory();
+	/// <summary>
+	/// Set the attributes of the VAO of every arena again, e.g : when the buffer read by the per-instance attributes has been replaced
+	/// </summary>
+	UNDEFINED_ENGINE static void ResetAttributes();
+
+	DELETE_COPY_MOVE_OPERATIONS(GeometryArena)
+
+private:
+	/// <summary>
+	/// Constructor of GeometryArena, create the buffers and the VAO
+	/// </summary>
+	/// <param name="format">: Layout of the vertices</param>
+	/// <param name="indexType">: Type of the indices</param>
+	GeometryArena(VertexFormat format, unsigned int indexType);
+
+	/// <summary>
+	/// First fit allocator of element ranges, the free ranges are merged when they touch
+	/// </summary>
+	class RangeAllocator
+	{
+	public:
+		/// <summary>
+		/// Find a free range
+		/// </summary>
+		/// <param name="count">: Number of elements</param>
+		/// <param name="offset">: First element of the range</param>
+		/// <returns>Return either true if a range has been found or false when the buffer must grow</returns>
+		bool Allocate(unsigned int count, unsigned int& offset);
+		/// <summary>
+		/// Free a range
+		/// </summary>
+		/// <param name="offset">: First element of the range</param>
+		/// <param name="count">: Number of elements</param>
+		void Free(unsigned int offset, unsigned int count);
+		/// <summary>
+		/// Add free elements at the end (after the buffer has grown)
+		/// </summary>
+		/// <param name="oldCapacity">: Number of elements before growing</param>
+		/// <param name="newCapacity">: Number of elements after growing</param>
+		void Grow(unsigned int oldCapacity, unsigned int newCapacity);
+
+	private:
+		/// <summary>
+		/// Free ranges (offset, count) sorted by offset
+		/// </summary>
+		std::vector<std::pair<unsigned int, unsigned int>> mFreeRanges;
+	};
+
+	/// <summary>
+	/// Replace a buffer by a bigger one, the content is copied on the GPU
+	/// </summary>
+	/// <param name="buffer">: Buffer to grow, replaced by the new buffer</param>
+	/// <param name="capacity">: Number of elements, replaced by the new capacity</param>
+	/// <param name="elementSize">: Size of an element in bytes</param>
+	/// <param name="minCapacity">: Number of elements needed</param>
+	/// <param name="allocator">: Allocator of the buffer</param>
+	void Grow(unsigned int& buffer, unsigned int& capacity, size_t elementSize, unsigned int minCapacity, RangeAllocator& allocator);
+	/// <summary>
+	/// Bind the buffers of the arena to its VAO and set the vertex attributes of the format and the per-instance attributes
+	/// </summary>
+	void SetAttributes();
+
+	/// <summary>
+	/// Layout of the vertices
+	/// </summary>
+	VertexFormat mFormat;
+	/// <summary>
+	/// Type of the indices
+	/// </summary>
+	unsigned int mIndexType;
+	/// <summary>
+	/// Size of a vertex in bytes
+	/// </summary>
+	size_t mVertexSize;
+	/// <summary>
+	/// Size of an index in bytes
+	/// </summary>
+	size_t mIndexSize;
+
+	/// <summary>
+	/// VAO reading the arena
+	/// </summary>
+	unsigned int mVAO = 0;
+	/// <summary>
+	/// Vertex buffer
+	/// </summary>
+	unsigned int mVBO = 0;
+	/// <summary>
+	/// Index buffer
+	/// </summary>
+	unsigned int mEBO = 0;
+	/// <summary>
+	/// Number of vertices the vertex buffer can hold
+	/// </summary>
+	unsigned int mVertexCapacity = 0;
+	/// <summary>
+	/// Number of indices the index buffer can hold
+	/// </summary>
+	unsigned int mIndexCapacity = 0;
+
+	/// <summary>
+	/// Free ranges of the vertex buffer
+	/// </summary>
+	RangeAllocator mVertexRanges;
+	/// <summary>
+	/// Free ranges of the index buffer
+	/// </summary>
+	RangeAllocator mIndexRanges;
+
+	/// <summary>
+	/// Pointer to our Renderer to simplify the calls from the ServiceLocator
+	/// </summary>
+	Renderer* mRenderer = nullptr;
+
+	/// <summary>
+	/// Every arena created, they are never deleted : a Mesh released at exit may still give its range back
+	/// </summary>
+	static inline std::vector<GeometryArena*> mArenas;
+};
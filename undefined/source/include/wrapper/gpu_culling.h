@@ -0,0 +1,238 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+#include <toolbox/Matrix4x4.h>
+#include <toolbox/Vector3.h>
+
+#include "utils/flag.h"
+
+class Camera;
+class Renderer;
+class Shader;
+struct InstanceData;
+
+/// <summary>
+/// Object tested by the culling compute shader, match the std430 layout of the shader
+/// </summary>
+struct GpuCullObject
+{
+	/// <summary>
+	/// Center of the world bounding box
+	/// </summary>
+	Vector3 Center;
+	/// <summary>
+	/// Indirect command drawing the object, its instance count is incremented when the object is visible
+	/// </summary>
+	unsigned int Command = 0;
+	/// <summary>
+	/// Half size of the world bounding box
+	/// </summary>
+	Vector3 Extents;
+	/// <summary>
+	/// Unused, keep the 16 bytes alignment of the shader
+	/// </summary>
+	float Padding = 0.f;
+};
+
+/// <summary>
+/// Objects counted by the culling shader, read back a few frames late so the read never waits for the GPU
+/// </summary>
+struct GpuCullingStats
+{
+	/// <summary>
+	/// Objects tested
+	/// </summary>
+	unsigned int Tested = 0;
+	/// <summary>
+	/// Objects outside the frustum
+	/// </summary>
+	unsigned int FrustumCulled = 0;
+	/// <summary>
+	/// Objects inside the frustum but hidden behind the depth of the previous frame
+	/// </summary>
+	unsigned int OcclusionCulled = 0;
+	/// <summary>
+	/// Objects written in the indirect commands
+	/// </summary>
+	unsigned int Visible = 0;
+};
+
+/// <summary>
+/// Culling on the GPU : a compute shader tests the bounds of every instance against the frustum and a hierarchical depth pyramid
+/// built from the depth of the previous frame, the visible instances are compacted in the instance buffer and counted in the indirect commands
+/// </summary>
+class GpuCulling
+{
+	STATIC_CLASS(GpuCulling)
+
+public:
+	/// <summary>
+	/// Get the compute shaders and create the buffers (need the Renderer and the ResourceManager to be initialized)
+	/// </summary>
+	UNDEFINED_ENGINE static void Setup();
+	/// <summary>
+	/// Check if the compute shaders have been loaded and built
+	/// </summary>
+	/// <returns>Return either true if the culling can run on the GPU or false</returns>
+	UNDEFINED_ENGINE static bool IsReady();
+
+	/// <summary>
+	/// Read back the counters of an old frame and reset the counters of the new one, must be called once per frame
+	/// </summary>
+	UNDEFINED_ENGINE static void BeginFrame();
+	/// <summary>
+	/// Select the depth pyramid of a viewport, must be called before its draw packets are flushed
+	/// </summary>
+	/// <param name="framebufferID">: Framebuffer of the viewport</param>
+	/// <param name="width">: Width of the framebuffer</param>
+	/// <param name="height">: Height of the framebuffer</param>
+	UNDEFINED_ENGINE static void SetViewport(unsigned int framebufferID, int width, int height);
+
+	/// <summary>
+	/// Cull the instances of a flush : the visible ones are copied in the instance buffer from the base instance of their command
+	/// and the instance count of the command is incremented
+	/// </summary>
+	/// <param name="instances">: Data of every instance, in the order of the commands</param>
+	/// <param name="objects">: Bounds and command of every instance</param>
+	/// <param name="count">: Number of instances</param>
+	/// <param name="commandOffset">: Offset of the indirect commands in the frame data buffer of the Renderer, their instance count must be 0.
+	/// Their base instances index the instances of the whole buffer</param>
+	/// <param name="commandSize">: Size in bytes of the indirect commands</param>
+	UNDEFINED_ENGINE static void Cull(const InstanceData* instances, const GpuCullObject* objects, size_t count, size_t commandOffset, size_t commandSize);
+	/// <summary>
+	/// Check if the viewports need their depth pyramid to be built
+	/// </summary>
+	/// <returns>Return either true if the occlusion culling runs or false</returns>
+	UNDEFINED_ENGINE static bool NeedsDepthPyramid();
+	/// <summary>
+	/// Build the depth pyramid of the current viewport from its depth buffer, used to cull the next frame
+	/// </summary>
+	/// <param name="camera">: Camera used to draw the depth</param>
+	/// <param name="depthTexture">: GL_DEPTH24_STENCIL8 texture of the size of the viewport receiving the copy of the depth, only used during the call</param>
+	UNDEFINED_ENGINE static void BuildDepthPyramid(const Camera& camera, unsigned int depthTexture);
+
+	/// <summary>
+	/// Get the last counters read back
+	/// </summary>
+	/// <returns>Return the counters</returns>
+	UNDEFINED_ENGINE static const GpuCullingStats& GetStats();
+
+	/// <summary>
+	/// Should the multi draw path cull on the GPU instead of the CPU
+	/// </summary>
+	UNDEFINED_ENGINE static inline bool Enabled = true;
+	/// <summary>
+	/// Should the GPU culling also test the depth pyramid (the objects uncovered since the last frame appear one frame late)
+	/// </summary>
+	UNDEFINED_ENGINE static inline bool OcclusionCulling = true;
+
+	/// <summary>
+	/// Binding point of the source instances (layout (std430, binding = 4) in the culling shader)
+	/// </summary>
+	static constexpr unsigned int SourceBufferBinding = 4;
+	/// <summary>
+	/// Binding point of the cull objects
+	/// </summary>
+	static constexpr unsigned int ObjectBufferBinding = 5;
+	/// <summary>
+	/// Binding point of the instance buffer written by the culling shader
+	/// </summary>
+	static constexpr unsigned int InstanceBufferBinding = 6;
+	/// <summary>
+	/// Binding point of the indirect commands
+	/// </summary>
+	static constexpr unsigned int CommandBufferBinding = 7;
+	/// <summary>
+	/// Binding point of the counters
+	/// </summary>
+	static constexpr unsigned int StatsBufferBinding = 8;
+
+private:
+	/// <summary>
+	/// Depth of the last frame of a viewport, reduced with a max in every mip
+	/// </summary>
+	struct DepthPyramid
+	{
+		/// <summary>
+		/// Framebuffer receiving the copy of the depth (a renderbuffer can't be sampled), its texture is given by the frame graph
+		/// </summary>
+		unsigned int DepthFramebuffer = 0;
+		/// <summary>
+		/// R32F texture, its first level is the power of two below the size of the viewport
+		/// </summary>
+		unsigned int PyramidTexture = 0;
+		/// <summary>
+		/// Size of the depth buffer
+		/// </summary>
+		int Width = 0;
+		int Height = 0;
+		/// <summary>
+		/// Size of the first level of the pyramid
+		/// </summary>
+		int PyramidWidth = 0;
+		int PyramidHeight = 0;
+		/// <summary>
+		/// Number of levels of the pyramid
+		/// </summary>
+		int LevelCount = 0;
+		/// <summary>
+		/// View projection of the camera when the pyramid was built
+		/// </summary>
+		Matrix4x4 ViewProjection;
+		/// <summary>
+		/// Has the pyramid been built since the textures were created
+		/// </summary>
+		bool IsBuilt = false;
+	};
+
+	/// <summary>
+	/// Create or resize the textures of a pyramid
+	/// </summary>
+	/// <param name="pyramid">: Pyramid to update</param>
+	/// <param name="width">: Width of the depth buffer</param>
+	/// <param name="height">: Height of the depth buffer</param>
+	static void ResizePyramid(DepthPyramid& pyramid, int width, int height);
+
+	/// <summary>
+	/// Compute shader testing the objects
+	/// </summary>
+	static inline std::shared_ptr<Shader> mCullShader;
+	/// <summary>
+	/// Compute shader reducing a level of the depth pyramid
+	/// </summary>
+	static inline std::shared_ptr<Shader> mPyramidShader;
+
+	/// <summary>
+	/// Counters of the last frames, the buffer written a few frames ago is read when it is reused
+	/// </summary>
+	static inline std::vector<unsigned int> mStatsBuffers;
+	/// <summary>
+	/// Fence placed after the dispatches writing each counters buffer, nullptr once the buffer has been read
+	/// </summary>
+	static inline std::vector<GLsync> mStatsFences;
+	/// <summary>
+	/// Index of the counters written this frame
+	/// </summary>
+	static inline size_t mStatsIndex = 0;
+	/// <summary>
+	/// Last counters read back
+	/// </summary>
+	static inline GpuCullingStats mStats;
+
+	/// <summary>
+	/// Pyramid of each viewport, keyed by framebuffer
+	/// </summary>
+	static inline std::unordered_map<unsigned int, DepthPyramid> mPyramids;
+	/// <summary>
+	/// Framebuffer of the viewport being drawn
+	/// </summary>
+	static inline unsigned int mCurrentFramebuffer = 0;
+
+	/// <summary>
+	/// Pointer to our Renderer to simplify the calls from the ServiceLocator
+	/// </summary>
+	static inline Renderer* mRenderer = nullptr;
+};
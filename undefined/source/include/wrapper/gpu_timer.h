@@ -0,0 +1,67 @@
+#pragma once
+
+#include "utils/flag.h"
+
+class Renderer;
+
+/// <summary>
+/// Time spent by the GPU on the commands sent between Begin and End, measured with GL_TIME_ELAPSED queries.
+/// The results are read a few frames later once the GPU has written them, so the CPU never waits for the GPU.
+/// Only one timer can measure at a time, the timers can't be nested
+/// </summary>
+class GpuTimer
+{
+public:
+	GpuTimer() = default;
+	/// <summary>
+	/// Delete the queries
+	/// </summary>
+	UNDEFINED_ENGINE ~GpuTimer();
+
+	DELETE_COPY_MOVE_OPERATIONS(GpuTimer)
+
+	/// <summary>
+	/// Start measuring, the measure is skipped if every query is still waiting for its result
+	/// </summary>
+	UNDEFINED_ENGINE void Begin();
+	/// <summary>
+	/// Stop measuring
+	/// </summary>
+	UNDEFINED_ENGINE void End();
+
+	/// <summary>
+	/// Get the time of the last measures read back, smoothed over a few frames
+	/// </summary>
+	/// <returns>Return the time in milliseconds</returns>
+	UNDEFINED_ENGINE float GetMilliseconds() const;
+
+	/// <summary>
+	/// Number of measures in flight
+	/// </summary>
+	static constexpr int QueryCount = 4;
+
+private:
+	/// <summary>
+	/// Read the results written by the GPU, the oldest first
+	/// </summary>
+	void ReadResults();
+
+	/// <summary>
+	/// Ring of queries, mNextQuery is the one Begin uses
+	/// </summary>
+	unsigned int mQueries[QueryCount] = {};
+	bool mIsPending[QueryCount] = {};
+	int mNextQuery = 0;
+	/// <summary>
+	/// Is a query running between Begin and End
+	/// </summary>
+	bool mIsMeasuring = false;
+
+	float mMilliseconds = 0.f;
+	/// <summary>
+	/// Has a result been read yet, the first one isn't smoothed
+	/// </summary>
+	bool mHasResult = false;
+
+	Renderer* mRenderer = nullptr;
+};
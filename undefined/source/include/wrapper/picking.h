@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <glad/glad.h>
+
+#include "utils/flag.h"
+
+class Camera;
+class Renderer;
+class Shader;
+
+/// <summary>
+/// How the object under the cursor is found
+/// </summary>
+enum class PickingMode : uint8_t
+{
+	/// <summary>
+	/// The IDs of the objects are drawn around the cursor and read back a frame later
+	/// </summary>
+	Gpu = 0,
+	/// <summary>
+	/// A ray is cast in the BVH of the scene and intersected with the triangles of the models, the result is known right away
+	/// </summary>
+	Ray = 1,
+};
+
+/// <summary>
+/// Object picking on demand : nothing is drawn for the picking until a click. The IDs of the objects are then drawn in a small region
+/// around the cursor, copied in a pixel buffer and read a frame later once the fence placed after the copy is signaled, so the CPU never waits for the GPU.
+/// The result is written in Renderer::ObjectIndex (-1 when nothing is under the cursor)
+/// </summary>
+class Picking
+{
+	STATIC_CLASS(Picking)
+
+public:
+	/// <summary>
+	/// Create the framebuffer of the region and the pixel buffer (need the Renderer and the shaders to be loaded)
+	/// </summary>
+	UNDEFINED_ENGINE static void Setup();
+	/// <summary>
+	/// Delete the framebuffer, the pixel buffer and the fence in flight
+	/// </summary>
+	UNDEFINED_ENGINE static void Shutdown();
+
+	/// <summary>
+	/// Read the result of the last region drawn if the GPU is done with it and drop the request of the previous frame.
+	/// Must be called once per frame before the windows of the editor
+	/// </summary>
+	UNDEFINED_ENGINE static void Update();
+
+	/// <summary>
+	/// Ask for the object under a pixel of a viewport, the newest request replaces the one pending
+	/// </summary>
+	/// <param name="camera">: Camera of the viewport clicked</param>
+	/// <param name="x">: x pos of the pixel from the left of the viewport</param>
+	/// <param name="y">: y pos of the pixel from the bottom of the viewport</param>
+	UNDEFINED_ENGINE static void Request(const Camera& camera, int x, int y);
+	/// <summary>
+	/// Draw the IDs of the region of the request and queue their copy, only does something for the camera of the pending request.
+	/// The Camera uniform block and the framebuffer bound are changed
+	/// </summary>
+	/// <param name="camera">: Camera of the viewport just drawn</param>
+	UNDEFINED_ENGINE static void Render(const Camera& camera);
+
+	/// <summary>
+	/// Cast a ray from a pixel of a camera and find the closest object hit
+	/// </summary>
+	/// <param name="camera">: Camera the ray starts from</param>
+	/// <param name="x">: x pos of the pixel from the left of the viewport</param>
+	/// <param name="y">: y pos of the pixel from the bottom of the viewport</param>
+	/// <returns>Return the index of the object in the scene or -1 if nothing is hit</returns>
+	UNDEFINED_ENGINE static int RayPick(const Camera& camera, int x, int y);
+
+	/// <summary>
+	/// Check if a click has not been resolved yet
+	/// </summary>
+	/// <returns>Return either true if a request or a readback is pending or false</returns>
+	UNDEFINED_ENGINE static bool IsPending();
+	/// <summary>
+	/// Check if the pending request has been made in the viewport of a camera
+	/// </summary>
+	/// <param name="camera">: Camera of the viewport</param>
+	/// <returns>Return either true if Render draws something for this camera or false</returns>
+	UNDEFINED_ENGINE static bool HasRequest(const Camera& camera);
+
+	/// <summary>
+	/// How the clicks are resolved
+	/// </summary>
+	UNDEFINED_ENGINE static inline PickingMode Mode = PickingMode::Gpu;
+	/// <summary>
+	/// Width and height in pixels of the region drawn around the cursor (odd so the cursor is in the center)
+	/// </summary>
+	static constexpr int RegionSize = 5;
+
+private:
+	/// <summary>
+	/// Find the ID of the pixels read back, the center first then the closest pixel with an object
+	/// </summary>
+	/// <param name="pixels">: RegionSize * RegionSize IDs, from the bottom row</param>
+	/// <returns>Return the ID or -1 if the region is empty</returns>
+	static int FindClosestID(const int* pixels);
+
+	/// <summary>
+	/// Shader writing the index of the object in the integer attachment
+	/// </summary>
+	static inline std::shared_ptr<Shader> mPickingShader;
+
+	/// <summary>
+	/// Framebuffer of the region, an integer color texture and a depth renderbuffer
+	/// </summary>
+	static inline unsigned int mFramebuffer = 0;
+	static inline unsigned int mIDTexture = 0;
+	static inline unsigned int mDepthRenderbuffer = 0;
+	/// <summary>
+	/// Pixel buffer receiving the copy of the region
+	/// </summary>
+	static inline unsigned int mPixelBuffer = 0;
+	/// <summary>
+	/// Fence placed after the copy, nullptr when no copy is in flight
+	/// </summary>
+	static inline GLsync mFence = nullptr;
+
+	/// <summary>
+	/// Request waiting for its viewport to be drawn
+	/// </summary>
+	static inline const Camera* mRequestCamera = nullptr;
+	static inline int mRequestX = 0;
+	static inline int mRequestY = 0;
+
+	static inline bool mIsSetup = false;
+	static inline Renderer* mRenderer = nullptr;
+};
@@ -0,0 +1,338 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <toolbox/Matrix4x4.h>
+#include <toolbox/Vector3.h>
+
+#include "camera/frustum.h"
+
+#include "utils/bounds.h"
+#include "utils/flag.h"
+
+#include "wrapper/geometry_arena.h"
+#include "wrapper/gpu_culling.h"
+
+class Camera;
+class Mesh;
+class Renderer;
+class Shader;
+
+/// <summary>
+/// Layer of a draw packet, the layers are drawn one after the other
+/// </summary>
+enum class RenderLayer : uint8_t
+{
+	Opaque = 0,
+	Transparent = 1,
+	Overlay = 2,
+};
+
+/// <summary>
+/// Everything needed to draw one mesh
+/// </summary>
+struct DrawPacket
+{
+	/// <summary>
+	/// Shader used to draw the mesh
+	/// </summary>
+	Shader* Program = nullptr;
+	/// <summary>
+	/// Texture bound on the unit 0
+	/// </summary>
+	unsigned int TextureID = 0;
+	/// <summary>
+	/// Mesh to draw
+	/// </summary>
+	const Mesh* DrawMesh = nullptr;
+	/// <summary>
+	/// Model matrix
+	/// </summary>
+	Matrix4x4 Transform;
+	/// <summary>
+	/// Index of the object in the scene (written in the picking attachment)
+	/// </summary>
+	int EntityID = -1;
+};
+
+/// <summary>
+/// Per-instance data read by the shaders (attributes 3 to 7)
+/// </summary>
+struct InstanceData
+{
+	/// <summary>
+	/// Model matrix, its rows are read as the columns of a mat4 so the shaders multiply it on the right of the position
+	/// </summary>
+	Matrix4x4 Model;
+	/// <summary>
+	/// Index of the object in the scene (written in the picking attachment)
+	/// </summary>
+	int EntityID;
+};
+
+/// <summary>
+/// Components submit draw packets during Scene::Draw, the queue sorts them by key and draws them with the fewest state changes,
+/// consecutive packets sharing a program, a texture and a mesh are drawn as instances of a single draw call
+/// </summary>
+class RenderQueue
+{
+	STATIC_CLASS(RenderQueue)
+
+public:
+	/// <summary>
+	/// Clear the packets, set the camera used to cull and sort them and the keywords of the shader variants drawn
+	/// </summary>
+	/// <param name="camera">: Camera of the viewport about to be drawn</param>
+	/// <param name="pickingOutput">: Does the framebuffer have a picking attachment (by default : false)</param>
+	UNDEFINED_ENGINE static void Begin(const Camera& camera, bool pickingOutput = false);
+	/// <summary>
+	/// Begin with a VP other than the one of the camera (e.g : the picking region), the levels of detail are still selected for the camera
+	/// </summary>
+	/// <param name="camera">: Camera of the viewport about to be drawn</param>
+	/// <param name="viewProjection">: VP used to cull and sort the packets</param>
+	/// <param name="pickingOutput">: Does the framebuffer have a picking attachment</param>
+	UNDEFINED_ENGINE static void Begin(const Camera& camera, const Matrix4x4& viewProjection, bool pickingOutput);
+
+	/// <summary>
+	/// Draw every packet submitted until the next Begin with a single shader, their textures are ignored
+	/// </summary>
+	/// <param name="program">: Shader used instead of the one of the packets (nullptr to use theirs)</param>
+	UNDEFINED_ENGINE static void SetProgramOverride(Shader* program);
+
+	/// <summary>
+	/// Set the entity stamped on the next packets submitted
+	/// </summary>
+	/// <param name="entityID">: Index of the object in the scene</param>
+	UNDEFINED_ENGINE static void SetCurrentEntity(int entityID);
+
+	/// <summary>
+	/// Add a mesh to draw
+	/// </summary>
+	/// <param name="program">: Shader used to draw the mesh, the packet draws with its cheapest variant</param>
+	/// <param name="textureID">: Texture bound on the unit 0</param>
+	/// <param name="mesh">: Mesh to draw</param>
+	/// <param name="transform">: Model matrix</param>
+	/// <param name="worldBounds">: Bounding box of the mesh in world space</param>
+	/// <param name="layer">: Layer of the mesh (by default : Opaque)</param>
+	UNDEFINED_ENGINE static void Submit(Shader* program, unsigned int textureID, const Mesh* mesh, const Matrix4x4& transform, const BoundingBox& worldBounds, RenderLayer layer = RenderLayer::Opaque);
+
+	/// <summary>
+	/// Cull the packets submitted since Begin against the frustum of the camera, sort the visible ones and draw them
+	/// </summary>
+	UNDEFINED_ENGINE static void Flush();
+
+	/// <summary>
+	/// Set the per-instance attributes (3 to 7) of the VAO currently bound, they read the frame data buffer of the Renderer filled by Flush
+	/// </summary>
+	UNDEFINED_ENGINE static void SetInstanceAttributes();
+
+	/// <summary>
+	/// Get the size in pixels of one world unit at a distance from the camera given to Begin
+	/// </summary>
+	/// <param name="distance">: Distance to the eye of the camera</param>
+	/// <returns>Return the number of pixels</returns>
+	UNDEFINED_ENGINE static float GetPixelsPerUnit(float distance);
+	/// <summary>
+	/// Get the position of the camera given to Begin
+	/// </summary>
+	/// <returns>Return the eye of the camera</returns>
+	UNDEFINED_ENGINE static const Vector3& GetEye();
+	/// <summary>
+	/// Get the camera given to Begin
+	/// </summary>
+	/// <returns>Return the camera, nullptr before the first Begin</returns>
+	UNDEFINED_ENGINE static const Camera* GetCamera();
+	/// <summary>
+	/// Get the frustum of the view projection given to Begin
+	/// </summary>
+	/// <returns>Return the frustum</returns>
+	UNDEFINED_ENGINE static const Frustum& GetFrustum();
+
+	/// <summary>
+	/// Get the number of packets drawn by the last Flush
+	/// </summary>
+	/// <returns>Return the number of packets</returns>
+	UNDEFINED_ENGINE static size_t GetPacketCount();
+
+	/// <summary>
+	/// Should the packets outside the frustum of the camera be skipped
+	/// </summary>
+	UNDEFINED_ENGINE static inline bool FrustumCulling = true;
+	/// <summary>
+	/// Should the packets be drawn with one glMultiDrawElementsIndirect per program, texture and geometry arena
+	/// instead of one instanced draw per mesh
+	/// </summary>
+	UNDEFINED_ENGINE static inline bool MultiDrawIndirect = true;
+	/// <summary>
+	/// Should the packets draw with the shader variants compiled for their features, every packet draws with the full shader otherwise
+	/// </summary>
+	UNDEFINED_ENGINE static inline bool ShaderVariants = true;
+
+private:
+	/// <summary>
+	/// Build the sort key of a packet :
+	/// layer (2 bits) | depth band (3 bits) | program (13 bits) | texture (16 bits) | mesh (16 bits) | depth (14 bits).
+	/// The coarse depth band keeps the opaque packets front to back, the state inside a band is grouped by program then texture
+	/// </summary>
+	/// <param name="packet">: Packet to sort</param>
+	/// <param name="layer">: Layer of the packet</param>
+	/// <returns>Return the key</returns>
+	static uint64_t MakeKey(const DrawPacket& packet, RenderLayer layer);
+
+	/// <summary>
+	/// Write the instances of the flush in the frame data buffer of the Renderer and keep their base instance
+	/// </summary>
+	static void UploadInstances();
+	/// <summary>
+	/// Draw each group with an instanced draw
+	/// </summary>
+	static void DrawGroups();
+	/// <summary>
+	/// Write an indirect command per group and draw them with a multi draw per program, texture and arena
+	/// </summary>
+	static void DrawGroupsIndirect();
+
+	/// <summary>
+	/// Consecutive sorted packets drawing the same mesh with the same state
+	/// </summary>
+	struct DrawGroup
+	{
+		/// <summary>
+		/// First packet of the group (gives the state and the mesh)
+		/// </summary>
+		const DrawPacket* Packet = nullptr;
+		/// <summary>
+		/// Index of the first packet in the instance buffer
+		/// </summary>
+		unsigned int FirstInstance = 0;
+		/// <summary>
+		/// Number of packets
+		/// </summary>
+		unsigned int InstanceCount = 0;
+	};
+
+	/// <summary>
+	/// Consecutive groups drawn by one multi draw
+	/// </summary>
+	struct IndirectRun
+	{
+		/// <summary>
+		/// First packet of the run (gives the state and the arena)
+		/// </summary>
+		const DrawPacket* Packet = nullptr;
+		/// <summary>
+		/// Index of the first command in the indirect buffer
+		/// </summary>
+		size_t FirstCommand = 0;
+		/// <summary>
+		/// Number of commands
+		/// </summary>
+		size_t CommandCount = 0;
+		/// <summary>
+		/// Number of instances drawn by the commands
+		/// </summary>
+		unsigned int InstanceCount = 0;
+	};
+
+	/// <summary>
+	/// Packets submitted since Begin
+	/// </summary>
+	static inline std::vector<DrawPacket> mPackets;
+	/// <summary>
+	/// Key and index of each packet, sorted in Flush
+	/// </summary>
+	static inline std::vector<std::pair<uint64_t, uint32_t>> mSortedPackets;
+	/// <summary>
+	/// Layer of each packet
+	/// </summary>
+	static inline std::vector<RenderLayer> mLayers;
+
+	/// <summary>
+	/// World bounding box of each packet (center and extents), one array per coordinate so four boxes are culled at once
+	/// </summary>
+	static inline std::vector<float> mCenterX, mCenterY, mCenterZ;
+	static inline std::vector<float> mExtentX, mExtentY, mExtentZ;
+	/// <summary>
+	/// Result of the culling of each packet
+	/// </summary>
+	static inline std::vector<uint8_t> mVisible;
+	/// <summary>
+	/// Frustum of the camera
+	/// </summary>
+	static inline Frustum mFrustum;
+
+	/// <summary>
+	/// Instance data of the packets in the sorted order
+	/// </summary>
+	static inline std::vector<InstanceData> mInstances;
+	/// <summary>
+	/// Frame data buffer read by the per-instance attributes of the VAOs, they are set again when the Renderer replaces it
+	/// </summary>
+	static inline unsigned int mInstanceAttributeBuffer = 0;
+	/// <summary>
+	/// Index in the frame data buffer of the first instance of the current flush, added to the base instance of the draws
+	/// </summary>
+	static inline unsigned int mBaseInstance = 0;
+
+	/// <summary>
+	/// Draw groups of the current flush
+	/// </summary>
+	static inline std::vector<DrawGroup> mDrawGroups;
+	/// <summary>
+	/// Indirect commands of the current flush
+	/// </summary>
+	static inline std::vector<DrawElementsIndirectCommand> mCommands;
+	/// <summary>
+	/// Bounds of the instances of the current flush in the order of the commands, for the GPU culling
+	/// </summary>
+	static inline std::vector<GpuCullObject> mCullObjects;
+	/// <summary>
+	/// Is the current flush culled on the GPU
+	/// </summary>
+	static inline bool mGpuCulling = false;
+	/// <summary>
+	/// Multi draws of the current flush
+	/// </summary>
+	static inline std::vector<IndirectRun> mIndirectRuns;
+
+	/// <summary>
+	/// Entity stamped on the packets submitted
+	/// </summary>
+	static inline int mCurrentEntity = -1;
+	/// <summary>
+	/// Keywords shared by the packets since Begin (lights of the frame and picking)
+	/// </summary>
+	static inline uint32_t mKeywords = 0;
+	/// <summary>
+	/// Shader drawing every packet since Begin, nullptr to draw them with their own
+	/// </summary>
+	static inline Shader* mProgramOverride = nullptr;
+
+	/// <summary>
+	/// VP of the camera, its last row gives the view depth of a point
+	/// </summary>
+	static inline Matrix4x4 mViewProjection;
+	/// <summary>
+	/// Near and far planes of the camera
+	/// </summary>
+	static inline float mNear = 0.1f;
+	static inline float mFar = 100.f;
+	/// <summary>
+	/// Position of the camera
+	/// </summary>
+	static inline Vector3 mEye;
+	/// <summary>
+	/// Camera given to Begin
+	/// </summary>
+	static inline const Camera* mCamera = nullptr;
+	/// <summary>
+	/// Half the height of the viewport divided by the tangent of half the field of view
+	/// </summary>
+	static inline float mProjectionScale = 1.f;
+
+	/// <summary>
+	/// Number of packets drawn by the last Flush
+	/// </summary>
+	static inline size_t mLastPacketCount = 0;
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "utils/flag.h"
+
+class Renderer;
+
+/// <summary>
+/// Textures of the intermediate passes (e.g : viewport attachments, depth pyramids) : a texture released is kept with its size and format
+/// and given back to the next pass asking for the same ones instead of being deleted and allocated again.
+/// The textures have an immutable storage, the free ones not asked for during MaxUnusedFrames frames are deleted
+/// </summary>
+class RenderTargetPool
+{
+	STATIC_CLASS(RenderTargetPool)
+
+public:
+	/// <summary>
+	/// Get a texture from the pool, a new one is allocated if no free texture has the size and the format.
+	/// The parameters of the texture (filters, wrap, ...) are the ones of its last user
+	/// </summary>
+	/// <param name="width">: Width of the level 0</param>
+	/// <param name="height">: Height of the level 0</param>
+	/// <param name="internalFormat">: Sized format of the texels (e.g : GL_RGBA8, GL_R32F, GL_DEPTH24_STENCIL8)</param>
+	/// <param name="levels">: Number of mip levels (by default : 1)</param>
+	/// <returns>Return the ID of the texture</returns>
+	UNDEFINED_ENGINE static unsigned int Acquire(int width, int height, unsigned int internalFormat, int levels = 1);
+	/// <summary>
+	/// Give a texture back to the pool, it can be given to another pass right away
+	/// </summary>
+	/// <param name="textureID">: Texture given by Acquire, 0 is ignored</param>
+	UNDEFINED_ENGINE static void Release(unsigned int textureID);
+
+	/// <summary>
+	/// Delete the free textures unused for too long or over MaxFreeSize, the oldest first. Must be called once per frame on the GL thread
+	/// </summary>
+	UNDEFINED_ENGINE static void Update();
+	/// <summary>
+	/// Delete every texture of the pool, the textures still used are deleted too
+	/// </summary>
+	UNDEFINED_ENGINE static void Clear();
+
+	/// <summary>
+	/// Get the number of textures of the pool
+	/// </summary>
+	/// <returns>Return the number of textures, used and free</returns>
+	UNDEFINED_ENGINE static size_t GetTextureCount();
+	/// <summary>
+	/// Get the size of the textures of the pool in VRAM (estimated from their format)
+	/// </summary>
+	/// <returns>Return the size in bytes</returns>
+	UNDEFINED_ENGINE static size_t GetAllocatedSize();
+	/// <summary>
+	/// Get the size of the free textures of the pool in VRAM
+	/// </summary>
+	/// <returns>Return the size in bytes</returns>
+	UNDEFINED_ENGINE static size_t GetFreeSize();
+	/// <summary>
+	/// Get the number of textures allocated since the start
+	/// </summary>
+	/// <returns>Return the number of allocations</returns>
+	UNDEFINED_ENGINE static size_t GetAllocationCount();
+
+	/// <summary>
+	/// Frames a free texture is kept before being deleted
+	/// </summary>
+	UNDEFINED_ENGINE static inline uint64_t MaxUnusedFrames = 120;
+	/// <summary>
+	/// Size of the free textures kept, the oldest are deleted above it (e.g : while a viewport is resized every frame)
+	/// </summary>
+	UNDEFINED_ENGINE static inline size_t MaxFreeSize = 64 * 1024 * 1024;
+
+private:
+	/// <summary>
+	/// Texture of the pool
+	/// </summary>
+	struct RenderTarget
+	{
+		unsigned int ID = 0;
+		int Width = 0;
+		int Height = 0;
+		unsigned int InternalFormat = 0;
+		int Levels = 1;
+		/// <summary>
+		/// Size of every level in VRAM
+		/// </summary>
+		size_t Size = 0;
+		bool IsUsed = false;
+		/// <summary>
+		/// Frame the texture has been released
+		/// </summary>
+		uint64_t ReleaseFrame = 0;
+	};
+
+	/// <summary>
+	/// Delete a texture of the pool
+	/// </summary>
+	/// <param name="index">: Index of the texture in mTargets</param>
+	static void Delete(size_t index);
+
+	static inline std::vector<RenderTarget> mTargets;
+	static inline uint64_t mFrame = 0;
+	static inline size_t mAllocationCount = 0;
+	static inline Renderer* mRenderer = nullptr;
+};
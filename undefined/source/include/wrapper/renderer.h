@@ -1,8 +1,13 @@
 #pragma once
 
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
 #include <glad/glad.h>
 #include <toolbox/Matrix4x4.h>
 #include <toolbox/Vector3.h>
+#include <toolbox/Vector4.h>
 
 #include "wrapper/service_type.h"
 #include "utils/flag.h"
@@ -10,6 +15,131 @@
 class Texture;
 class Model;
 
+/// <summary>
+/// Data of the Camera uniform block shared by every shader, match the std140 layout of the block
+/// </summary>
+struct CameraBufferData
+{
+	/// <summary>
+	/// Projection * View
+	/// </summary>
+	Matrix4x4 VP;
+	/// <summary>
+	/// View matrix
+	/// </summary>
+	Matrix4x4 View;
+	/// <summary>
+	/// Projection matrix
+	/// </summary>
+	Matrix4x4 Projection;
+	/// <summary>
+	/// Position of the camera (w is unused, vec3 are aligned on 16 bytes in std140)
+	/// </summary>
+	Vector4 ViewPos;
+};
+
+/// <summary>
+/// Range of the frame data ring buffer, written by the CPU and read by the GPU during the frame
+/// </summary>
+struct FrameDataAllocation
+{
+	/// <summary>
+	/// Mapped memory of the range, nullptr if nothing has been allocated
+	/// </summary>
+	void* Data = nullptr;
+	/// <summary>
+	/// Offset in bytes of the range from the start of the buffer (see Renderer::GetFrameDataBuffer)
+	/// </summary>
+	size_t Offset = 0;
+};
+
+/// <summary>
+/// Number of state changes and draws sent to OpenGL during a frame
+/// </summary>
+struct RenderCounters
+{
+	/// <summary>
+	/// glUseProgram issued
+	/// </summary>
+	unsigned int ProgramBinds = 0;
+	/// <summary>
+	/// Program binds skipped because the program was already bound
+	/// </summary>
+	unsigned int ProgramBindsSkipped = 0;
+	/// <summary>
+	/// glBindVertexArray issued
+	/// </summary>
+	unsigned int VertexArrayBinds = 0;
+	/// <summary>
+	/// VAO binds skipped because the VAO was already bound
+	/// </summary>
+	unsigned int VertexArrayBindsSkipped = 0;
+	/// <summary>
+	/// glBindTexture (GL_TEXTURE_2D) issued
+	/// </summary>
+	unsigned int TextureBinds = 0;
+	/// <summary>
+	/// Texture binds skipped because the texture was already bound on the active unit
+	/// </summary>
+	unsigned int TextureBindsSkipped = 0;
+	/// <summary>
+	/// Draw calls issued
+	/// </summary>
+	unsigned int DrawCalls = 0;
+	/// <summary>
+	/// Instances drawn by the draw calls
+	/// </summary>
+	unsigned int Instances = 0;
+	/// <summary>
+	/// Draws issued through the indirect commands of a multi draw
+	/// </summary>
+	unsigned int IndirectCommands = 0;
+	/// <summary>
+	/// Draw packets inside the frustum of their camera
+	/// </summary>
+	unsigned int PacketsVisible = 0;
+	/// <summary>
+	/// Draw packets skipped by the frustum culling
+	/// </summary>
+	unsigned int PacketsCulled = 0;
+	/// <summary>
+	/// Triangles sent to the draws (before the GPU culling)
+	/// </summary>
+	unsigned int Triangles = 0;
+	/// <summary>
+	/// Editor viewports drawn
+	/// </summary>
+	unsigned int ViewportsDrawn = 0;
+	/// <summary>
+	/// Editor viewports hidden or unchanged, their framebuffer kept its last image
+	/// </summary>
+	unsigned int ViewportsSkipped = 0;
+	/// <summary>
+	/// Passes of the frame graph executed
+	/// </summary>
+	unsigned int PassesExecuted = 0;
+	/// <summary>
+	/// Passes of the frame graph culled, nothing displayed reads what they write
+	/// </summary>
+	unsigned int PassesCulled = 0;
+	/// <summary>
+	/// Transient textures of the frame graph
+	/// </summary>
+	unsigned int TransientTargets = 0;
+	/// <summary>
+	/// Transient textures sharing the memory of a transient texture of an earlier pass
+	/// </summary>
+	unsigned int TransientTargetsAliased = 0;
+	/// <summary>
+	/// Bytes written in the frame data ring buffer
+	/// </summary>
+	size_t FrameDataBytes = 0;
+	/// <summary>
+	/// Did the CPU wait for the GPU to be done with the section of the ring buffer of this frame
+	/// </summary>
+	unsigned int FrameDataWaits = 0;
+};
+
 /// <summary>
 /// Class for our Renderer (works with OpenGL)
 /// </summary>
@@ -19,7 +149,8 @@ public:
 	/// <summary>
 	/// Init the renderer
 	/// </summary>
-	void Init();
+	/// <returns>Return either true if the renderer is ready or false if an OpenGL entry point is missing</returns>
+	bool Init();
 
 	/// <summary>
 	/// Set the framebuffer color
@@ -32,6 +163,34 @@ public:
 	/// Clear the framebuffer
 	/// </summary>
 	void ClearBuffer();
+	/// <summary>
+	/// Clear an integer color attachment of the framebuffer bound
+	/// </summary>
+	/// <param name="drawBuffer">: Index of the draw buffer</param>
+	/// <param name="value">: Value written in every pixel</param>
+	void ClearBufferInt(int drawBuffer, int value);
+	/// <summary>
+	/// Clear the depth attachment of the framebuffer bound
+	/// </summary>
+	/// <param name="depth">: Depth written in every pixel (by default : 1)</param>
+	void ClearBufferDepth(float depth = 1.f);
+	/// <summary>
+	/// Clear the color attachments of the framebuffer bound with the clear color, the depth is kept
+	/// </summary>
+	void ClearBufferColor();
+	/// <summary>
+	/// Set the rectangle of the framebuffer drawn
+	/// </summary>
+	/// <param name="x">: x pos of the lower left corner</param>
+	/// <param name="y">: y pos of the lower left corner</param>
+	/// <param name="width">: Width of the rectangle</param>
+	/// <param name="height">: Height of the rectangle</param>
+	void SetViewport(int x, int y, int width, int height);
+	/// <summary>
+	/// Get the rectangle of the framebuffer drawn
+	/// </summary>
+	/// <param name="viewport">: Array receiving x, y, width and height</param>
+	void GetViewport(int viewport[4]);
 
 	/// <summary>
 	/// Generate a texture
@@ -77,7 +236,7 @@ public:
 	void ActiveTexture(unsigned int ID);
 
 	/// <summary>
-	/// Bind a Texture to the actual active Texture
+	/// Bind a Texture to the actual active Texture, a GL_TEXTURE_2D already bound on the active unit is skipped
 	/// </summary>
 	/// <param name="ID">: Texture ID</param>
 	/// <param name="type">: Texture type (by default : 0x0DE1 = 3553U = GL_TEXTURE_2D)</param>
@@ -104,6 +263,11 @@ public:
 	/// <param name="renderbufferID">: Renderbuffer ID</param>
 	void BindRenderbuffer(unsigned int renderbufferID);
 	/// <summary>
+	/// Bind a VAO, skipped if it is already bound
+	/// </summary>
+	/// <param name="VAO">: VAO</param>
+	void BindVertexArray(unsigned int VAO);
+	/// <summary>
 	/// Bind the VAO, VBO and EBO given
 	/// </summary>
 	/// <param name="VAO">: VAO</param>
@@ -111,6 +275,28 @@ public:
 	/// <param name="EBO">: EBO</param>
 	void BindBuffers(unsigned int VAO, unsigned int VBO, unsigned int EBO);
 	/// <summary>
+	/// Bind a buffer to a target
+	/// </summary>
+	/// <param name="target">: Buffer target (e.g : GL_ARRAY_BUFFER, GL_UNIFORM_BUFFER, GL_SHADER_STORAGE_BUFFER, ...)</param>
+	/// <param name="buffer">: Buffer ID</param>
+	void BindBuffer(unsigned int target, unsigned int buffer);
+	/// <summary>
+	/// Bind a buffer to an indexed binding point (the "binding" of a block in the shaders)
+	/// </summary>
+	/// <param name="target">: Buffer target (GL_UNIFORM_BUFFER or GL_SHADER_STORAGE_BUFFER)</param>
+	/// <param name="index">: Binding point</param>
+	/// <param name="buffer">: Buffer ID</param>
+	void BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer);
+	/// <summary>
+	/// Bind a range of a buffer to an indexed binding point, the offset must be aligned (see GetUniformOffsetAlignment and GetStorageOffsetAlignment)
+	/// </summary>
+	/// <param name="target">: Buffer target (GL_UNIFORM_BUFFER or GL_SHADER_STORAGE_BUFFER)</param>
+	/// <param name="index">: Binding point</param>
+	/// <param name="buffer">: Buffer ID</param>
+	/// <param name="offset">: Offset in bytes of the range</param>
+	/// <param name="size">: Size of the range</param>
+	void BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, size_t offset, size_t size);
+	/// <summary>
 	/// Bind the renderbuffer given to the framebuffer given
 	/// </summary>
 	/// <param name="framebufferTarget">: Framebuffer target</param>
@@ -119,12 +305,17 @@ public:
 	void BindRenderbufferToFramebuffer(int framebufferTarget, int attachements, unsigned int renderbufferID);
 
 	/// <summary>
-	/// Read pixels on a certain color attachment
-	/// </summary>
-	/// <param name="attachmentIndex">: Which attachment index to read pixels on</param>
-	/// <param name="x">: x pos to read on</param>
-	/// <param name="y">: y pos to read on</param>
-	void ReadPixels(unsigned int framebufferID, uint32_t attachmentIndex, int x, int y);
+	/// Read a rectangle of the color attachment 0 of the framebuffer bound on GL_READ_FRAMEBUFFER.
+	/// With a GL_PIXEL_PACK_BUFFER bound the copy is queued in the buffer and nothing waits for the GPU
+	/// </summary>
+	/// <param name="x">: x pos of the lower left corner</param>
+	/// <param name="y">: y pos of the lower left corner</param>
+	/// <param name="width">: Width of the rectangle</param>
+	/// <param name="height">: Height of the rectangle</param>
+	/// <param name="format">: Format of the pixels (e.g : GL_RGBA, GL_RED_INTEGER)</param>
+	/// <param name="type">: Type of the components (e.g : GL_UNSIGNED_BYTE, GL_INT)</param>
+	/// <param name="data">: Pointer to the memory receiving the pixels (or an offset in the GL_PIXEL_PACK_BUFFER bound)</param>
+	void ReadPixels(int x, int y, int width, int height, unsigned int format, unsigned int type, void* data);
 
 	/// <summary>
 	/// Attribute Pointers of data in the VAO
@@ -137,6 +328,21 @@ public:
 	/// <param name="isNormalized">: Should the data be normalized (by default : false)</param>
 	void AttributePointers(unsigned int index, int size, unsigned int type, int stride, const void* pointer, bool isNormalized = false);
 	/// <summary>
+	/// Attribute Pointers of integer data in the VAO (read as int/ivec in the shader, not converted to float)
+	/// </summary>
+	/// <param name="index">: Index in the VAO</param>
+	/// <param name="size">: number of components</param>
+	/// <param name="type">: Type of data (e.g : GL_INT, GL_UNSIGNED_SHORT)</param>
+	/// <param name="stride">: Offest between the next pointer in the VAO</param>
+	/// <param name="pointer">: Offset of the first element that will be attribute</param>
+	void AttributeIPointers(unsigned int index, int size, unsigned int type, int stride, const void* pointer);
+	/// <summary>
+	/// Set how often an attribute advances (0 : every vertex, 1 : every instance)
+	/// </summary>
+	/// <param name="index">: Index in the VAO</param>
+	/// <param name="divisor">: Number of instances drawn before the attribute advances</param>
+	void AttributeDivisor(unsigned int index, unsigned int divisor);
+	/// <summary>
 	/// Set the data into a buffer (e.g : VBO or EBO)
 	/// </summary>
 	/// <param name="target">: Buffer target (e.g : VBO or EBO)</param>
@@ -145,6 +351,105 @@ public:
 	/// <param name="usage">: Type of data (e.g : GL_UNSIGNED_INT, GL_SHORT)</param>
 	void SetBufferData(unsigned int target, int size, const void* data, unsigned int usage);
 	/// <summary>
+	/// Update a part of the data of the buffer currently bound
+	/// </summary>
+	/// <param name="target">: Buffer target (e.g : GL_ARRAY_BUFFER, GL_SHADER_STORAGE_BUFFER, ...)</param>
+	/// <param name="offset">: Offset in bytes from the start of the buffer</param>
+	/// <param name="size">: Size of the data</param>
+	/// <param name="data">: Pointer to the first element of the data</param>
+	void SetBufferSubData(unsigned int target, size_t offset, size_t size, const void* data);
+	/// <summary>
+	/// Allocate an immutable storage for the buffer currently bound and fill it (e.g : VBO or EBO)
+	/// </summary>
+	/// <param name="target">: Buffer target (e.g : GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER)</param>
+	/// <param name="size">: Size of the data</param>
+	/// <param name="data">: Pointer to the first element of the data</param>
+	/// <param name="flags">: Storage flags (by default : 0, the buffer can't be modified after the upload)</param>
+	void SetBufferStorage(unsigned int target, size_t size, const void* data, unsigned int flags = 0);
+	/// <summary>
+	/// Copy a part of the buffer bound on a target into the buffer bound on another target on the GPU
+	/// </summary>
+	/// <param name="readTarget">: Target of the source buffer (e.g : GL_COPY_READ_BUFFER)</param>
+	/// <param name="writeTarget">: Target of the destination buffer (e.g : GL_COPY_WRITE_BUFFER)</param>
+	/// <param name="readOffset">: Offset in the source buffer in bytes</param>
+	/// <param name="writeOffset">: Offset in the destination buffer in bytes</param>
+	/// <param name="size">: Size of the copy in bytes</param>
+	void CopyBufferSubData(unsigned int readTarget, unsigned int writeTarget, size_t readOffset, size_t writeOffset, size_t size);
+	/// <summary>
+	/// Read a part of the buffer currently bound back to the CPU (wait for the GPU if the buffer is still written)
+	/// </summary>
+	/// <param name="target">: Buffer target (e.g : GL_SHADER_STORAGE_BUFFER)</param>
+	/// <param name="offset">: Offset in bytes from the start of the buffer</param>
+	/// <param name="size">: Size of the data</param>
+	/// <param name="data">: Pointer to the memory receiving the data</param>
+	void GetBufferSubData(unsigned int target, size_t offset, size_t size, void* data);
+	/// <summary>
+	/// Map a range of the buffer currently bound in the client memory
+	/// </summary>
+	/// <param name="target">: Buffer target (e.g : GL_PIXEL_UNPACK_BUFFER)</param>
+	/// <param name="offset">: Offset in bytes from the start of the buffer</param>
+	/// <param name="size">: Size of the range</param>
+	/// <param name="access">: Access flags (e.g : GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT)</param>
+	/// <returns>Return the pointer to the range or nullptr if the map failed</returns>
+	void* MapBufferRange(unsigned int target, size_t offset, size_t size, unsigned int access);
+	/// <summary>
+	/// Release the mapping of the buffer currently bound
+	/// </summary>
+	/// <param name="target">: Buffer target (e.g : GL_PIXEL_UNPACK_BUFFER)</param>
+	/// <returns>Return either true or false if the content has been corrupted while it was mapped</returns>
+	bool UnmapBuffer(unsigned int target);
+	/// <summary>
+	/// Insert a fence in the command stream, signaled once every command before it is executed
+	/// </summary>
+	/// <returns>Return the fence</returns>
+	GLsync FenceSync();
+	/// <summary>
+	/// Check a fence without waiting, the commands are flushed so the fence is signaled eventually
+	/// </summary>
+	/// <param name="fence">: Fence to check</param>
+	/// <returns>Return either true if the GPU has passed the fence or false</returns>
+	bool IsFenceSignaled(GLsync fence);
+	/// <summary>
+	/// Delete a fence
+	/// </summary>
+	/// <param name="fence">: Fence to delete</param>
+	void DeleteSync(GLsync fence);
+	/// <summary>
+	/// Generate one or more query objects
+	/// </summary>
+	/// <param name="number">: Number of queries</param>
+	/// <param name="queries">: Pointer to the array receiving the queries</param>
+	void GenerateQueries(int number, unsigned int* queries);
+	/// <summary>
+	/// Delete one or more query objects
+	/// </summary>
+	/// <param name="number">: Number of queries</param>
+	/// <param name="queries">: Pointer to the array of queries you want to delete</param>
+	void DeleteQueries(int number, unsigned int* queries);
+	/// <summary>
+	/// Start measuring the commands sent until EndQuery, a single query of a target can run at a time
+	/// </summary>
+	/// <param name="target">: What is measured (e.g : GL_TIME_ELAPSED, GL_SAMPLES_PASSED)</param>
+	/// <param name="query">: Query receiving the result</param>
+	void BeginQuery(unsigned int target, unsigned int query);
+	/// <summary>
+	/// Stop the query running for a target
+	/// </summary>
+	/// <param name="target">: What is measured (e.g : GL_TIME_ELAPSED, GL_SAMPLES_PASSED)</param>
+	void EndQuery(unsigned int target);
+	/// <summary>
+	/// Check without waiting if the GPU has written the result of a query
+	/// </summary>
+	/// <param name="query">: Query to check</param>
+	/// <returns>Return either true if GetQueryResult doesn't wait or false</returns>
+	bool IsQueryResultAvailable(unsigned int query);
+	/// <summary>
+	/// Get the result of a query, waits for the GPU if it is not available
+	/// </summary>
+	/// <param name="query">: Query to read</param>
+	/// <returns>Return the result (nanoseconds for GL_TIME_ELAPSED)</returns>
+	uint64_t GetQueryResult(unsigned int query);
+	/// <summary>
 	/// Allocate the storage for the renderbuffer data
 	/// </summary>
 	/// <param name="format">: Format used for the data (e.g : GL_DEPTH24_STENCIL8, GL_DEPTH32F_STENCIL8, ...)</param>
@@ -158,6 +463,78 @@ public:
 	/// <param name="texParam">: Texture parameter (e.g : GL_DEPTH_STENCIL_TEXTURE_MODE, GL_TEXTURE_MIN_FILTER, GL_TEXTURE_MAG_FILTER, ...)</param>
 	/// <param name="texValue">: Value of texParam (e.g : GL_LINEAR, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, ...)</param>
 	void SetTextureParameteri(unsigned int target, unsigned int texParam, unsigned int texValue);
+	/// <summary>
+	/// Allocate a level of the GL_TEXTURE_2D currently bound and fill it
+	/// </summary>
+	/// <param name="level">: Mip level</param>
+	/// <param name="internalFormat">: Format on the GPU (e.g : GL_RGB, GL_R32F, GL_DEPTH24_STENCIL8, ...)</param>
+	/// <param name="width">: Width of the level</param>
+	/// <param name="height">: Height of the level</param>
+	/// <param name="format">: Format of the data (e.g : GL_RGB, GL_RED, GL_DEPTH_STENCIL, ...)</param>
+	/// <param name="type">: Type of the data (e.g : GL_UNSIGNED_BYTE, GL_FLOAT, ...)</param>
+	/// <param name="data">: Pointer to the first texel or nullptr to leave the level uninitialized</param>
+	void SetTextureImage(int level, int internalFormat, int width, int height, unsigned int format, unsigned int type, const void* data);
+	/// <summary>
+	/// Allocate the immutable storage of every level of the GL_TEXTURE_2D bound
+	/// </summary>
+	/// <param name="levels">: Number of mip levels</param>
+	/// <param name="internalFormat">: Sized format of the texels (e.g : GL_RGBA8, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, ...)</param>
+	/// <param name="width">: Width of the level 0</param>
+	/// <param name="height">: Height of the level 0</param>
+	void SetTextureStorage(int levels, unsigned int internalFormat, int width, int height);
+	/// <summary>
+	/// Fill a level of the GL_TEXTURE_2D bound with compressed blocks
+	/// </summary>
+	/// <param name="level">: Mip level</param>
+	/// <param name="width">: Width of the level</param>
+	/// <param name="height">: Height of the level</param>
+	/// <param name="format">: Compressed format of the storage</param>
+	/// <param name="size">: Size of the data in bytes</param>
+	/// <param name="data">: Pointer to the first block</param>
+	void SetCompressedTextureImage(int level, int width, int height, unsigned int format, int size, const void* data);
+	/// <summary>
+	/// Fill a level of the GL_TEXTURE_2D bound with uncompressed texels
+	/// </summary>
+	/// <param name="level">: Mip level</param>
+	/// <param name="width">: Width of the level</param>
+	/// <param name="height">: Height of the level</param>
+	/// <param name="format">: Format of the texels (e.g : GL_RED, GL_RGB, GL_RGBA)</param>
+	/// <param name="data">: Pointer to the first texel, 8 bits per channel (or an offset in the GL_PIXEL_UNPACK_BUFFER bound)</param>
+	void SetTextureSubImage(int level, int width, int height, unsigned int format, const void* data);
+	/// <summary>
+	/// Copy a level of a GL_TEXTURE_2D into a level of another one on the GPU, the formats must be compatible
+	/// </summary>
+	/// <param name="source">: Texture read</param>
+	/// <param name="sourceLevel">: Level read</param>
+	/// <param name="destination">: Texture written</param>
+	/// <param name="destinationLevel">: Level written</param>
+	/// <param name="width">: Width of the level</param>
+	/// <param name="height">: Height of the level</param>
+	void CopyTextureLevel(unsigned int source, int sourceLevel, unsigned int destination, int destinationLevel, int width, int height);
+	/// <summary>
+	/// Set a pixel storage mode
+	/// </summary>
+	/// <param name="parameter">: Parameter (e.g : GL_UNPACK_ALIGNMENT)</param>
+	/// <param name="value">: Value of the parameter</param>
+	void SetPixelStore(unsigned int parameter, int value);
+	/// <summary>
+	/// Bind a level of a texture to an image unit, to be read or written by a compute shader
+	/// </summary>
+	/// <param name="unit">: Image unit (layout (binding = unit) in the shader)</param>
+	/// <param name="texture">: Texture ID</param>
+	/// <param name="level">: Mip level</param>
+	/// <param name="access">: GL_READ_ONLY, GL_WRITE_ONLY or GL_READ_WRITE</param>
+	/// <param name="format">: Format of the image in the shader (e.g : GL_R32F)</param>
+	void BindImageTexture(unsigned int unit, unsigned int texture, int level, unsigned int access, unsigned int format);
+	/// <summary>
+	/// Copy a rectangle of a framebuffer into another framebuffer
+	/// </summary>
+	/// <param name="readFramebuffer">: Source framebuffer ID</param>
+	/// <param name="drawFramebuffer">: Destination framebuffer ID</param>
+	/// <param name="width">: Width of the rectangle</param>
+	/// <param name="height">: Height of the rectangle</param>
+	/// <param name="mask">: Buffers to copy (e.g : GL_COLOR_BUFFER_BIT, GL_DEPTH_BUFFER_BIT)</param>
+	void BlitFramebuffer(unsigned int readFramebuffer, unsigned int drawFramebuffer, int width, int height, unsigned int mask);
 
 	/// <summary>
 	/// Draw the elements by using the indices 
@@ -168,6 +545,26 @@ public:
 	/// <param name="indices">: Pointer to the start of the data in the EBO (0 for the begining)</param>
 	void Draw(unsigned int mode, int size, unsigned int type, const void* indices);
 	/// <summary>
+	/// Draw several instances of the elements, the per-instance attributes start at baseInstance
+	/// </summary>
+	/// <param name="mode">: Drawing mode (e.g : GL_TRIANGLES, GL_LINES, ...)</param>
+	/// <param name="size">: Number of indices</param>
+	/// <param name="type">: Type of data that need to be draw (e.g : GL_UNSIGNED_INT, GL_SHORT)</param>
+	/// <param name="indices">: Pointer to the start of the data in the EBO (0 for the begining)</param>
+	/// <param name="instanceCount">: Number of instances</param>
+	/// <param name="baseVertex">: Value added to each index</param>
+	/// <param name="baseInstance">: First instance read in the per-instance attributes</param>
+	void DrawInstanced(unsigned int mode, int size, unsigned int type, const void* indices, int instanceCount, int baseVertex, unsigned int baseInstance);
+	/// <summary>
+	/// Draw a list of DrawElementsIndirectCommand read from the buffer bound on GL_DRAW_INDIRECT_BUFFER
+	/// </summary>
+	/// <param name="mode">: Drawing mode (e.g : GL_TRIANGLES, GL_LINES, ...)</param>
+	/// <param name="type">: Type of the indices (e.g : GL_UNSIGNED_INT, GL_UNSIGNED_SHORT)</param>
+	/// <param name="offset">: Offset of the first command in the indirect buffer in bytes</param>
+	/// <param name="drawCount">: Number of commands</param>
+	/// <param name="instanceCount">: Number of instances drawn by the commands (only for the counters)</param>
+	void MultiDrawIndirect(unsigned int mode, unsigned int type, size_t offset, int drawCount, unsigned int instanceCount);
+	/// <summary>
 	/// Draw by using the array
 	/// </summary>
 	/// <param name="mode">: Drawing mode (e.g : GL_TRIANGLES, GL_LINES, ...)</param>
@@ -180,25 +577,132 @@ public:
 	/// <param name="numberOfAttachement">: Number of attachements used</param>
 	/// <param name="attachements">: Array of the attachements</param>
 	void DrawBuffers(int numberOfAttachement, unsigned int* attachements);
+	/// <summary>
+	/// Run the compute shader currently used
+	/// </summary>
+	/// <param name="groupCountX">: Number of work groups along X</param>
+	/// <param name="groupCountY">: Number of work groups along Y</param>
+	/// <param name="groupCountZ">: Number of work groups along Z</param>
+	void DispatchCompute(unsigned int groupCountX, unsigned int groupCountY = 1, unsigned int groupCountZ = 1);
+	/// <summary>
+	/// Make the writes of the previous shaders visible to the following commands
+	/// </summary>
+	/// <param name="barriers">: How the data will be read (e.g : GL_COMMAND_BARRIER_BIT, GL_SHADER_STORAGE_BARRIER_BIT, ...)</param>
+	void SetMemoryBarrier(unsigned int barriers);
 
 	/// <summary>
 	/// Set a shader
 	/// </summary>
-	/// <param name="shaderType">: Shader type (GL_FRAGMENT_SHADER or GL_VERTEX_SHADER)</param>
+	/// <param name="shaderType">: Shader type (GL_FRAGMENT_SHADER, GL_VERTEX_SHADER or GL_COMPUTE_SHADER)</param>
 	/// <param name="vShaderCode">: Code of the shader</param>
 	/// <returns>Return the Shader source ID</returns>
 	unsigned int SetShader(int shaderType, const char* vShaderCode);
 	/// <summary>
+	/// Create and compile a shader without waiting for the result
+	/// </summary>
+	/// <param name="shaderType">: Shader type (GL_FRAGMENT_SHADER, GL_VERTEX_SHADER or GL_COMPUTE_SHADER)</param>
+	/// <param name="code">: Code of the shader</param>
+	/// <returns>Return the Shader source ID</returns>
+	unsigned int CreateShader(int shaderType, const char* code);
+	/// <summary>
+	/// Check the compile status of a shader and log its errors (wait for the compilation)
+	/// </summary>
+	/// <param name="shader">: Shader source ID</param>
+	/// <param name="shaderType">: Shader type, for the log</param>
+	/// <returns>Return either true if the shader is compiled or false</returns>
+	bool CheckShader(unsigned int shader, int shaderType) const;
+	/// <summary>
 	/// Link the vertex and the fragment shader together
 	/// </summary>
 	/// <param name="ID">: Shader ID</param>
 	/// <param name="vertex">: Vertex Shader source ID</param>
 	/// <param name="fragment">: Fragment Shader source ID</param>
-	/// <returns></returns>
-	void LinkShader(unsigned int& ID, unsigned int vertex, unsigned int fragment);
+	/// <returns>Return either true if the program is linked or false</returns>
+	bool LinkShader(unsigned int& ID, unsigned int vertex, unsigned int fragment);
+	/// <summary>
+	/// Link a compute shader alone in a program
+	/// </summary>
+	/// <param name="ID">: Shader ID</param>
+	/// <param name="compute">: Compute Shader source ID</param>
+	/// <returns>Return either true if the program is linked or false</returns>
+	bool LinkShader(unsigned int& ID, unsigned int compute);
+	/// <summary>
+	/// Create a program and link the vertex and the fragment shader without waiting for the result
+	/// </summary>
+	/// <param name="vertex">: Vertex Shader source ID</param>
+	/// <param name="fragment">: Fragment Shader source ID</param>
+	/// <returns>Return the Shader ID</returns>
+	unsigned int CreateProgram(unsigned int vertex, unsigned int fragment);
+	/// <summary>
+	/// Create a program and link a compute shader without waiting for the result
+	/// </summary>
+	/// <param name="compute">: Compute Shader source ID</param>
+	/// <returns>Return the Shader ID</returns>
+	unsigned int CreateProgram(unsigned int compute);
+	/// <summary>
+	/// Check the link status of a program and log its errors (wait for the link)
+	/// </summary>
+	/// <param name="ID">: Shader ID</param>
+	/// <returns>Return either true if the program is linked or false</returns>
+	bool CheckProgram(unsigned int ID) const;
+	/// <summary>
+	/// Poll the compilation and the link of a program without waiting (GL_KHR_parallel_shader_compile)
+	/// </summary>
+	/// <param name="ID">: Shader ID</param>
+	/// <returns>Return either true if the status can be checked without a stall or false</returns>
+	bool IsProgramCompleted(unsigned int ID) const;
+	/// <summary>
+	/// Create a program from a binary retrieved with GetProgramBinary
+	/// </summary>
+	/// <param name="ID">: Shader ID, 0 if the driver rejected the binary</param>
+	/// <param name="format">: Format of the binary</param>
+	/// <param name="data">: Binary</param>
+	/// <param name="size">: Size of the binary in bytes</param>
+	/// <returns>Return either true if the program is linked or false (e.g : the driver has been updated)</returns>
+	bool SetProgramBinary(unsigned int& ID, unsigned int format, const void* data, int size);
+	/// <summary>
+	/// Retrieve the binary of a linked program
+	/// </summary>
+	/// <param name="ID">: Shader ID</param>
+	/// <param name="format">: Format of the binary</param>
+	/// <param name="data">: Binary</param>
+	/// <returns>Return either true if the binary has been retrieved or false</returns>
+	bool GetProgramBinary(unsigned int ID, unsigned int& format, std::vector<uint8_t>& data) const;
+	/// <summary>
+	/// Get the number of program binary formats of the driver
+	/// </summary>
+	/// <returns>Return the number of formats, 0 if the programs can't be saved</returns>
+	int GetProgramBinaryFormatCount() const;
+	/// <summary>
+	/// Get the vendor, the renderer and the version of the driver
+	/// </summary>
+	/// <returns>Return the description of the driver</returns>
+	std::string GetDriverDescription() const;
 
 	/// <summary>
-	/// Use a Shader
+	/// Get the number of active uniforms in a linked program
+	/// </summary>
+	/// <param name="ID">: Shader ID</param>
+	/// <returns>Return the number of active uniforms</returns>
+	int GetActiveUniformCount(unsigned int ID) const;
+	/// <summary>
+	/// Get the name of an active uniform
+	/// </summary>
+	/// <param name="ID">: Shader ID</param>
+	/// <param name="index">: Index of the active uniform (between 0 and GetActiveUniformCount)</param>
+	/// <param name="arraySize">: Filled with the number of elements if the uniform is an array, 1 otherwise</param>
+	/// <returns>Return the name of the uniform</returns>
+	std::string GetActiveUniformName(unsigned int ID, int index, int& arraySize) const;
+	/// <summary>
+	/// Get the location of a uniform, should only be called once per uniform when the shader is linked
+	/// </summary>
+	/// <param name="ID">: Shader ID</param>
+	/// <param name="mName">: Name of the Uniform</param>
+	/// <returns>Return the location or -1 if the uniform is not active</returns>
+	int GetUniformLocation(unsigned int ID, const std::string& mName) const;
+
+	/// <summary>
+	/// Use a Shader, skipped if it is already used
 	/// </summary>
 	/// <param name="ID">: Shader ID</param>
 	void UseShader(int ID);
@@ -243,12 +747,105 @@ public:
 	/// <param name="m">: Value of the uniform</param>
 	void SetUniform(unsigned int ID, const std::string& mName, const Matrix4x4& m) const;
 
+	/// <summary>
+	/// Set a Uniform in the shader currently used
+	/// </summary>
+	/// <param name="location">: Location of the Uniform (-1 is ignored)</param>
+	/// <param name="value">: Value of the uniform</param>
+	void SetUniform(int location, bool value) const;
+	/// <summary>
+	/// Set a Uniform in the shader currently used
+	/// </summary>
+	/// <param name="location">: Location of the Uniform (-1 is ignored)</param>
+	/// <param name="value">: Value of the uniform</param>
+	void SetUniform(int location, int value) const;
+	/// <summary>
+	/// Set a Uniform in the shader currently used
+	/// </summary>
+	/// <param name="location">: Location of the Uniform (-1 is ignored)</param>
+	/// <param name="value">: Value of the uniform</param>
+	void SetUniform(int location, float value) const;
+	/// <summary>
+	/// Set a Uniform in the shader currently used
+	/// </summary>
+	/// <param name="location">: Location of the Uniform (-1 is ignored)</param>
+	/// <param name="v">: Value of the uniform</param>
+	void SetUniform(int location, const Vector3& v) const;
+	/// <summary>
+	/// Set a Uniform in the shader currently used
+	/// </summary>
+	/// <param name="location">: Location of the Uniform (-1 is ignored)</param>
+	/// <param name="m">: Value of the uniform</param>
+	void SetUniform(int location, const Matrix4x4& m) const;
+
+	/// <summary>
+	/// Upload the camera data in the Camera uniform block, every shader declaring the block reads it without any per-shader uniform
+	/// </summary>
+	/// <param name="vp">: Projection * View</param>
+	/// <param name="view">: View matrix</param>
+	/// <param name="projection">: Projection matrix</param>
+	/// <param name="viewPos">: Position of the camera</param>
+	void SetCameraBuffer(const Matrix4x4& vp, const Matrix4x4& view, const Matrix4x4& projection, const Vector3& viewPos);
+
+	/// <summary>
+	/// Start the section of the frame data ring buffer used by this frame, waits if the GPU still reads it (FrameDataSections frames behind).
+	/// Must be called once per frame before any allocation
+	/// </summary>
+	void BeginFrameData();
+	/// <summary>
+	/// Place the fence protecting the section of this frame, must be called once every command of the frame is sent
+	/// </summary>
+	void EndFrameData();
+	/// <summary>
+	/// Make sure the next allocations of the frame fit in the buffer without replacing it, so the ranges they give stay in the same buffer
+	/// </summary>
+	/// <param name="size">: Total size of the next allocations, with the padding of their alignment</param>
+	void ReserveFrameData(size_t size);
+	/// <summary>
+	/// Allocate a range written this frame in the frame data ring buffer, the CPU writes it directly (the buffer is persistently mapped and coherent).
+	/// The buffer is replaced by a bigger one when the section of the frame is full, the ranges given before stay valid until the end of the frame
+	/// </summary>
+	/// <param name="size">: Size in bytes</param>
+	/// <param name="alignment">: Alignment of the offset from the start of the buffer (any value, e.g : sizeof(InstanceData) to draw from a base instance)</param>
+	/// <returns>Return the range</returns>
+	FrameDataAllocation AllocateFrameData(size_t size, size_t alignment);
+	/// <summary>
+	/// Get the frame data ring buffer, it changes when the buffer grows
+	/// </summary>
+	/// <returns>Return the buffer ID</returns>
+	unsigned int GetFrameDataBuffer() const;
+	/// <summary>
+	/// Get the size of the section of each frame in the ring buffer
+	/// </summary>
+	/// <returns>Return the size in bytes</returns>
+	size_t GetFrameDataSectionSize() const;
+	/// <summary>
+	/// Get the alignment of the offsets of the uniform buffer ranges
+	/// </summary>
+	/// <returns>Return the alignment in bytes</returns>
+	size_t GetUniformOffsetAlignment() const;
+	/// <summary>
+	/// Get the alignment of the offsets of the shader storage buffer ranges
+	/// </summary>
+	/// <returns>Return the alignment in bytes</returns>
+	size_t GetStorageOffsetAlignment() const;
+
+	/// <summary>
+	/// Number of frames the GPU can be behind the CPU, each has its own section in the frame data ring buffer
+	/// </summary>
+	static constexpr unsigned int FrameDataSections = 3;
+
 	/// <summary>
 	/// Delete a Shader
 	/// </summary>
 	/// <param name="shader">: Shader ID</param>
 	void DeleteShader(unsigned int shader);
 	/// <summary>
+	/// Delete a Shader program
+	/// </summary>
+	/// <param name="ID">: Shader ID</param>
+	void DeleteProgram(unsigned int ID);
+	/// <summary>
 	/// Delete one or more Framebuffer
 	/// </summary>
 	/// <param name="number">: Number of Framebuffer to delete</param>
@@ -266,12 +863,34 @@ public:
 	/// <param name="number">: Number of Texture</param>
 	/// <param name="ID">: Pointer to the array of Texture ID you want to delete</param>
 	void DeleteTextures(int number, unsigned int* ID);
+	/// <summary>
+	/// Delete one or more buffer (e.g : VBO or EBO)
+	/// </summary>
+	/// <param name="number">: Number of buffer</param>
+	/// <param name="buffers">: Pointer to the array of buffers you want to delete</param>
+	void DeleteBuffers(int number, unsigned int* buffers);
+	/// <summary>
+	/// Delete one or more VAO
+	/// </summary>
+	/// <param name="number">: Number of VAO</param>
+	/// <param name="vertexArrays">: Pointer to the array of VAO you want to delete</param>
+	void DeleteVertexArrays(int number, unsigned int* vertexArrays);
 
 	/// <summary>
 	/// Set the depth 
 	/// </summary>
 	/// <param name="depth">Depth you want to set(e.g : GL_LEQUAL or GL_LESS)</param>
 	void SetDepth(unsigned int depth);
+	/// <summary>
+	/// Enable or disable the writes in the depth buffer, the depth test still runs
+	/// </summary>
+	/// <param name="isWritten">: Is the depth of the fragments written</param>
+	void SetDepthMask(bool isWritten);
+	/// <summary>
+	/// Enable or disable the writes in the color attachments
+	/// </summary>
+	/// <param name="isWritten">: Are the colors of the fragments written</param>
+	void SetColorMask(bool isWritten);
 
 	/// <summary>
 	/// Set a Quad data in the VBO, EBO, VAO
@@ -288,6 +907,15 @@ public:
 	/// <param name="VAO">: VAO</param>
 	void SetCube(unsigned int& VBO, unsigned int& VAO);
 
+	/// <summary>
+	/// Forget the program, VAO and textures the Renderer thinks are bound, must be called after anything binding them without the Renderer (e.g : ImGui)
+	/// </summary>
+	void InvalidateStateCache();
+	/// <summary>
+	/// Keep the counters of the frame that ended in LastFrameCounters and reset them, called at the start of each frame
+	/// </summary>
+	void ResetCounters();
+
 	/// <summary>
 	/// Enable the OpenGL Test
 	/// </summary>
@@ -300,6 +928,72 @@ public:
 	/// Index of the object selected
 	/// </summary>
 	int ObjectIndex = -1;
+
+	/// <summary>
+	/// State changes and draws of the current frame
+	/// </summary>
+	RenderCounters Counters;
+	/// <summary>
+	/// State changes and draws of the previous frame (complete, unlike Counters while the frame is drawn)
+	/// </summary>
+	RenderCounters LastFrameCounters;
+
+	/// <summary>
+	/// Binding point of the Camera uniform block (layout (std140, binding = 0) in the shaders)
+	/// </summary>
+	static constexpr unsigned int CameraBufferBinding = 0;
+
+private:
+	/// <summary>
+	/// Create the frame data ring buffer and map it
+	/// </summary>
+	/// <param name="sectionSize">: Size of the section of each frame</param>
+	void CreateFrameData(size_t sectionSize);
+
+	/// <summary>
+	/// Ring buffer of the data written every frame (camera, instances, indirect commands), persistently mapped
+	/// </summary>
+	unsigned int mFrameDataBuffer = 0;
+	uint8_t* mFrameData = nullptr;
+	size_t mFrameDataSectionSize = 0;
+	/// <summary>
+	/// Section of the current frame and bytes used in it
+	/// </summary>
+	unsigned int mFrameDataSection = 0;
+	size_t mFrameDataHead = 0;
+	/// <summary>
+	/// Fence placed after the last frame using each section, nullptr when the section is free
+	/// </summary>
+	GLsync mFrameDataFences[FrameDataSections] = {};
+	/// <summary>
+	/// Buffers replaced by a bigger one, deleted once the fence placed after their last frame is signaled (nullptr until that frame ends)
+	/// </summary>
+	std::vector<std::pair<unsigned int, GLsync>> mRetiredFrameData;
+
+	size_t mUniformOffsetAlignment = 256;
+	size_t mStorageOffsetAlignment = 256;
+
+	/// <summary>
+	/// Number of texture units tracked by the state cache
+	/// </summary>
+	static constexpr unsigned int CachedTextureUnits = 16;
+
+	/// <summary>
+	/// Program currently used (-1 when unknown)
+	/// </summary>
+	int mBoundProgram = -1;
+	/// <summary>
+	/// VAO currently bound (-1 when unknown)
+	/// </summary>
+	int mBoundVertexArray = -1;
+	/// <summary>
+	/// Active texture unit (index from GL_TEXTURE0)
+	/// </summary>
+	unsigned int mActiveTextureUnit = 0;
+	/// <summary>
+	/// GL_TEXTURE_2D bound on each unit (-1 when unknown)
+	/// </summary>
+	int mBoundTextures[CachedTextureUnits] = { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
 };
 
 template<class ...Args>
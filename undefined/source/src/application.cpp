@@ -15,11 +15,22 @@
 #include "resources/model.h"
 #include "resources/model_renderer.h"
 #include "resources/resource_manager.h"
+#include "resources/shader_compiler.h"
+#include "resources/texture_loader.h"
+#include "resources/texture_streamer.h"
 
 #include "world/dir_light.h"
 #include "world/point_light.h"
 #include "world/spot_light.h"
 #include "world/skybox.h"
+#include "world/light_manager.h"
+#include "world/light_clusters.h"
+
+#include "wrapper/render_queue.h"
+#include "wrapper/gpu_culling.h"
+#include "wrapper/frame_graph.h"
+#include "wrapper/picking.h"
+#include "wrapper/render_target_pool.h"
 
 #include "memory_leak.h"
 
@@ -44,10 +55,18 @@ Application::Application()
     mRenderer = ServiceLocator::Get<Renderer>();
 }
 
-void Application::Init()
+bool Application::Init()
 {
     mWindowManager->Init();
-    mRenderer->Init();
+    if (!mRenderer->Init())
+    {
+        return false;
+    }
+
+    // Before the editor loads the assets, so their images are decoded in the background
+    TextureLoader::Setup();
+    // Before the editor loads the shaders, so their programs are built in the background
+    ShaderCompiler::Setup();
 
     RuntimeClasses::AddAllClasses();
 
@@ -57,16 +76,32 @@ void Application::Init()
     mEditor.Init();
 
     BaseShader = ResourceManager::Get<Shader>("base_shader");
+    mDepthPrepassShader = ResourceManager::Get<Shader>("depth_prepass_shader");
 
     mGame.Init();
 
     Skybox::Setup();
+
+    LightManager::Setup();
+    LightClusters::Setup();
+    GpuCulling::Setup();
+    Picking::Setup();
+
+    return true;
 }
 
 void Application::Update()
 {
     Time::SetTimeVariables();
 
+    mRenderer->ResetCounters();
+    // Before anything writes the data of the frame
+    mRenderer->BeginFrameData();
+    GpuCulling::BeginFrame();
+    TextureLoader::Update();
+    ShaderCompiler::Update();
+    // The region drawn for the last click is read once the GPU is done with it
+    Picking::Update();
     mRenderer->SetClearColor(0,0,0);
 
     Camera::ProcessInput();
@@ -75,45 +110,256 @@ void Application::Update()
 
     mEditor.Update();
 
-    // Draw loop for all editors
-    for (int i = 0; i < Interface::EditorViewports.size(); i++)
+    // Lights are packed and uploaded once, every viewport reads the same buffer
+    LightManager::Update();
+
+    // The scene moves on its own or textures and shaders became resident, nothing has a version for these changes
+    const bool isLoading = TextureLoader::GetPendingCount() > 0 || ShaderCompiler::GetPendingCount() > 0;
+    if ((SceneManager::IsScenePlaying && !SceneManager::IsScenePaused) || isLoading || mWasLoading)
     {
-        Interface::EditorViewports[i]->RescaleViewport();
-        Interface::EditorViewports[i]->ViewportCamera->Update();
-        Skybox::Update(Interface::EditorViewports[i]->ViewportCamera);
+        EditorViewport::Invalidate();
+    }
+    mWasLoading = isLoading;
 
-        mRenderer->BindFramebuffer(GL_FRAMEBUFFER, Interface::EditorViewports[i]->GetFBO_ID());
+    mRenderer->EnableTest(GL_DEPTH_TEST);
 
-        mRenderer->EnableTest(GL_DEPTH_TEST);
-        
-        mRenderer->SetClearColor(0,0,0);
-        mRenderer->ClearBuffer();
-        
-        mRenderer->UseShader(BaseShader->ID);
+    // Every viewport declares its passes, the graph only runs the ones whose result is displayed this frame
+    mFrameGraph.Reset();
+    std::vector<FrameGraphResource> viewportImages;
 
-        mRenderer->SetUniform(BaseShader->ID ,"vp", Interface::EditorViewports[i]->ViewportCamera->GetVP());
-        mRenderer->SetUniform(BaseShader->ID ,"viewPos", Interface::EditorViewports[i]->ViewportCamera->Eye);
+    for (int i = 0; i < Interface::EditorViewports.size(); i++)
+    {
+        EditorViewport* viewport = Interface::EditorViewports[i];
 
-        SceneManager::Draw();
+        viewport->RescaleViewport();
+        viewport->ViewportCamera->Update();
 
-        mRenderer->UnUseShader();
+        AddViewportPasses(viewport, viewportImages);
+    }
 
+    FrameGraphResource window = mFrameGraph.Import("Window");
+    mFrameGraph.AddPass("Interface", [&](FrameGraph::Builder& builder)
+    {
+        for (const FrameGraphResource& image : viewportImages)
+        {
+            builder.Read(image);
+        }
+        window = builder.Write(window);
+    },
+    [this](const FrameGraph&)
+    {
         mRenderer->BindFramebuffer(GL_FRAMEBUFFER, 0);
-    }
+        Interface::Render();
+        // ImGui binds its own program, VAO and textures
+        mRenderer->InvalidateStateCache();
+    });
+    mFrameGraph.MarkOutput(window);
+
+    mFrameGraph.Compile();
+    mFrameGraph.Execute();
 
     EditorViewport::SetIsGizmoUpdated(false);
 
-    Interface::Render();
+    // Every viewport has asked for its texture levels
+    TextureStreamer::Update();
+    // The viewports have been resized, the render targets left free for too long are deleted
+    RenderTargetPool::Update();
+
+    // Every command reading the data of the frame has been sent
+    mRenderer->EndFrameData();
 
     mWindowManager->SwapBuffers();
     mRenderer->ClearBuffer();
     Logger::CheckForExit();
 }
 
+void Application::AddViewportPasses(EditorViewport* viewport, std::vector<FrameGraphResource>& viewportImages)
+{
+    Camera* camera = viewport->ViewportCamera;
+    Framebuffer* framebuffer = viewport->GetFramebuffer();
+
+    FrameGraphResource color = mFrameGraph.Import("Viewport color", framebuffer->FramebufferTextures[0]);
+    FrameGraphResource depth = mFrameGraph.Import("Viewport depth");
+    FrameGraphResource depthPyramid = mFrameGraph.Import("Depth pyramid");
+    FrameGraphResource pickingRegion = mFrameGraph.Import("Picking region");
+
+    // Hidden or unchanged, nothing reads the image so its passes are culled and the framebuffer keeps its last image
+    const bool needsRedraw = viewport->NeedsRedraw();
+
+    // Draws the scene on its own, only the frame the viewport is clicked
+    mFrameGraph.AddPass("Picking", [&](FrameGraph::Builder& builder)
+    {
+        pickingRegion = builder.Write(pickingRegion);
+    },
+    [camera](const FrameGraph&)
+    {
+        Picking::Render(*camera);
+    });
+
+    if (Picking::HasRequest(*camera))
+    {
+        mFrameGraph.MarkOutput(pickingRegion);
+    }
+
+    // The opaque pass draws over the depth of the pre-pass, only the shader of the pre-pass must be built
+    const bool hasDepthPrepass = viewport->DepthPrepass && mDepthPrepassShader && mDepthPrepassShader->IsReady();
+    if (hasDepthPrepass)
+    {
+        mFrameGraph.AddPass("Depth prepass", [&](FrameGraph::Builder& builder)
+        {
+            depth = builder.Write(depth);
+        },
+        [this, viewport, camera, framebuffer](const FrameGraph&)
+        {
+            mRenderer->SetCameraBuffer(camera->GetVP(), camera->GetView(), camera->GetProjection(), camera->Eye);
+
+            mRenderer->BindFramebuffer(GL_FRAMEBUFFER, framebuffer->FBO_ID);
+            mRenderer->SetViewport(0, 0, (int)framebuffer->Width, (int)framebuffer->Height);
+            GpuCulling::SetViewport(framebuffer->FBO_ID, (int)framebuffer->Width, (int)framebuffer->Height);
+
+            viewport->DepthPrepassTimer.Begin();
+            mRenderer->ClearBufferDepth();
+            mRenderer->SetColorMask(false);
+
+            // Same camera, same culling : the opaque pass draws exactly the meshes written here
+            RenderQueue::Begin(*camera);
+            RenderQueue::SetProgramOverride(mDepthPrepassShader.get());
+            if (SceneManager::ActualScene)
+            {
+                SceneManager::ActualScene->SubmitDraws();
+            }
+            RenderQueue::Flush();
+
+            mRenderer->SetColorMask(true);
+            viewport->DepthPrepassTimer.End();
+        });
+    }
+
+    mFrameGraph.AddPass("Opaque", [&](FrameGraph::Builder& builder)
+    {
+        if (hasDepthPrepass)
+        {
+            builder.Read(depth);
+        }
+        else
+        {
+            depth = builder.Write(depth);
+        }
+        color = builder.Write(color);
+    },
+    [this, viewport, camera, framebuffer, hasDepthPrepass](const FrameGraph&)
+    {
+        mRenderer->SetCameraBuffer(camera->GetVP(), camera->GetView(), camera->GetProjection(), camera->Eye);
+        LightClusters::Build(*camera);
+
+        mRenderer->BindFramebuffer(GL_FRAMEBUFFER, framebuffer->FBO_ID);
+        // Every viewport has been rescaled before the graph runs, each pass sets the size of its own framebuffer
+        mRenderer->SetViewport(0, 0, (int)framebuffer->Width, (int)framebuffer->Height);
+        GpuCulling::SetViewport(framebuffer->FBO_ID, (int)framebuffer->Width, (int)framebuffer->Height);
+
+        viewport->OpaqueTimer.Begin();
+        if (hasDepthPrepass)
+        {
+            // Only the closest fragment of each pixel passes, the lighting runs once per pixel
+            mRenderer->ClearBufferColor();
+            mRenderer->SetDepth(GL_EQUAL);
+            mRenderer->SetDepthMask(false);
+        }
+        else
+        {
+            mRenderer->ClearBuffer();
+        }
+
+        RenderQueue::Begin(*camera);
+        if (SceneManager::ActualScene)
+        {
+            SceneManager::ActualScene->SubmitDraws();
+        }
+        RenderQueue::Flush();
+
+        if (hasDepthPrepass)
+        {
+            mRenderer->SetDepth(GL_LESS);
+            mRenderer->SetDepthMask(true);
+        }
+        viewport->OpaqueTimer.End();
+    });
+
+    mFrameGraph.AddPass("Skybox", [&](FrameGraph::Builder& builder)
+    {
+        builder.Read(depth);
+        color = builder.Write(color);
+    },
+    [this, framebuffer](const FrameGraph&)
+    {
+        mRenderer->BindFramebuffer(GL_FRAMEBUFFER, framebuffer->FBO_ID);
+        mRenderer->SetViewport(0, 0, (int)framebuffer->Width, (int)framebuffer->Height);
+        Skybox::Draw();
+    });
+
+    // Occluders of the next frame of this viewport, the copy of the depth only lives during the pass
+    FrameGraphResource depthCopy = mFrameGraph.CreateTexture("Depth copy", { (int)framebuffer->Width, (int)framebuffer->Height, GL_DEPTH24_STENCIL8 });
+    mFrameGraph.AddPass("Depth pyramid", [&](FrameGraph::Builder& builder)
+    {
+        builder.Read(depth);
+        depthCopy = builder.Write(depthCopy);
+        depthPyramid = builder.Write(depthPyramid);
+    },
+    [camera, depthCopy](const FrameGraph& graph)
+    {
+        GpuCulling::BuildDepthPyramid(*camera, graph.GetTexture(depthCopy));
+    });
+
+    // Built from the depth of this frame only, it would keep the opaque pass of a skipped viewport alive
+    if (needsRedraw && GpuCulling::NeedsDepthPyramid())
+    {
+        mFrameGraph.MarkOutput(depthPyramid);
+    }
+
+    mFrameGraph.AddPass("Post draw", [&](FrameGraph::Builder& builder)
+    {
+        builder.Read(depth);
+        color = builder.Write(color);
+    },
+    [this, viewport, framebuffer](const FrameGraph&)
+    {
+        mRenderer->BindFramebuffer(GL_FRAMEBUFFER, framebuffer->FBO_ID);
+        mRenderer->SetViewport(0, 0, (int)framebuffer->Width, (int)framebuffer->Height);
+        if (SceneManager::ActualScene)
+        {
+            SceneManager::ActualScene->PostDraw();
+        }
+
+        mRenderer->BindFramebuffer(GL_FRAMEBUFFER, 0);
+        viewport->SetDrawn(RenderQueue::MultiDrawIndirect && GpuCulling::NeedsDepthPyramid());
+    });
+
+    if (needsRedraw)
+    {
+        mRenderer->Counters.ViewportsDrawn++;
+        viewportImages.push_back(color);
+    }
+    else
+    {
+        mRenderer->Counters.ViewportsSkipped++;
+
+        // Its draws don't run, the texture levels of its last image must stay resident
+        if (viewport->IsVisible())
+        {
+            TextureStreamer::KeepLevels();
+        }
+    }
+}
+
 void Application::Clear()
 {
     mRenderer->UnUseShader();
+    Picking::Shutdown();
+    TextureLoader::Shutdown();
+    ShaderCompiler::Shutdown();
     mEditor.Terminate();
+    // After the viewports have given their textures back
+    RenderTargetPool::Clear();
     mGame.Terminate();
     ServiceLocator::CleanServiceLocator();
     Logger::Stop();
@@ -0,0 +1,141 @@
+#include "camera/frustum.h"
+
+#include <cmath>
+#include <xmmintrin.h>
+
+Frustum::Frustum(const Matrix4x4& viewProjection)
+{
+	// The clip coordinates are the rows of the VP times the point : -w <= x, y, z <= w
+	const Vector4& x = viewProjection[0];
+	const Vector4& y = viewProjection[1];
+	const Vector4& z = viewProjection[2];
+	const Vector4& w = viewProjection[3];
+
+	Planes[0] = Vector4(w.x + x.x, w.y + x.y, w.z + x.z, w.w + x.w);
+	Planes[1] = Vector4(w.x - x.x, w.y - x.y, w.z - x.z, w.w - x.w);
+	Planes[2] = Vector4(w.x + y.x, w.y + y.y, w.z + y.z, w.w + y.w);
+	Planes[3] = Vector4(w.x - y.x, w.y - y.y, w.z - y.z, w.w - y.w);
+	Planes[4] = Vector4(w.x + z.x, w.y + z.y, w.z + z.z, w.w + z.w);
+	Planes[5] = Vector4(w.x - z.x, w.y - z.y, w.z - z.z, w.w - z.w);
+
+	for (Vector4& plane : Planes)
+	{
+		const float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+
+		if (length > 0.f)
+		{
+			plane = Vector4(plane.x / length, plane.y / length, plane.z / length, plane.w / length);
+		}
+	}
+}
+
+bool Frustum::Intersects(const BoundingSphere& sphere) const
+{
+	for (const Vector4& plane : Planes)
+	{
+		if (plane.x * sphere.Center.x + plane.y * sphere.Center.y + plane.z * sphere.Center.z + plane.w < -sphere.Radius)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool Frustum::Intersects(const BoundingBox& box) const
+{
+	const Vector3 center = box.GetCenter();
+	const Vector3 extents = box.GetExtents();
+
+	for (const Vector4& plane : Planes)
+	{
+		const float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+		const float radius = std::abs(plane.x) * extents.x + std::abs(plane.y) * extents.y + std::abs(plane.z) * extents.z;
+
+		if (distance < -radius)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool Frustum::Contains(const BoundingBox& box) const
+{
+	const Vector3 center = box.GetCenter();
+	const Vector3 extents = box.GetExtents();
+
+	for (const Vector4& plane : Planes)
+	{
+		const float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+		const float radius = std::abs(plane.x) * extents.x + std::abs(plane.y) * extents.y + std::abs(plane.z) * extents.z;
+
+		if (distance < radius)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+size_t Frustum::CullBoxes(const float* centerX, const float* centerY, const float* centerZ,
+	const float* extentX, const float* extentY, const float* extentZ, size_t count, uint8_t* visible) const
+{
+	// Each plane splat on the four lanes, the absolute normal gives the projected radius of a box
+	__m128 normalX[PlaneCount], normalY[PlaneCount], normalZ[PlaneCount], distance[PlaneCount];
+	__m128 absNormalX[PlaneCount], absNormalY[PlaneCount], absNormalZ[PlaneCount];
+	for (int p = 0; p < PlaneCount; p++)
+	{
+		normalX[p] = _mm_set1_ps(Planes[p].x);
+		normalY[p] = _mm_set1_ps(Planes[p].y);
+		normalZ[p] = _mm_set1_ps(Planes[p].z);
+		distance[p] = _mm_set1_ps(Planes[p].w);
+		absNormalX[p] = _mm_set1_ps(std::abs(Planes[p].x));
+		absNormalY[p] = _mm_set1_ps(std::abs(Planes[p].y));
+		absNormalZ[p] = _mm_set1_ps(std::abs(Planes[p].z));
+	}
+
+	size_t visibleCount = 0;
+	size_t i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 cx = _mm_loadu_ps(centerX + i);
+		const __m128 cy = _mm_loadu_ps(centerY + i);
+		const __m128 cz = _mm_loadu_ps(centerZ + i);
+		const __m128 ex = _mm_loadu_ps(extentX + i);
+		const __m128 ey = _mm_loadu_ps(extentY + i);
+		const __m128 ez = _mm_loadu_ps(extentZ + i);
+
+		__m128 outside = _mm_setzero_ps();
+		for (int p = 0; p < PlaneCount; p++)
+		{
+			const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(normalX[p], cx), _mm_mul_ps(normalY[p], cy)), _mm_add_ps(_mm_mul_ps(normalZ[p], cz), distance[p]));
+			const __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absNormalX[p], ex), _mm_mul_ps(absNormalY[p], ey)), _mm_mul_ps(absNormalZ[p], ez));
+
+			// d + r < 0 : the whole box is behind the plane
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(d, r), _mm_setzero_ps()));
+		}
+
+		const int outsideMask = _mm_movemask_ps(outside);
+		for (int lane = 0; lane < 4; lane++)
+		{
+			visible[i + lane] = (outsideMask >> lane & 1) ? 0 : 1;
+			visibleCount += visible[i + lane];
+		}
+	}
+
+	// Remaining boxes
+	for (; i < count; i++)
+	{
+		const BoundingBox box = { Vector3(centerX[i] - extentX[i], centerY[i] - extentY[i], centerZ[i] - extentZ[i]),
+								  Vector3(centerX[i] + extentX[i], centerY[i] + extentY[i], centerZ[i] + extentZ[i]) };
+
+		visible[i] = Intersects(box) ? 1 : 0;
+		visibleCount += visible[i];
+	}
+
+	return visibleCount;
+}
@@ -6,7 +6,12 @@ Editor::Editor()
 
 void Editor::Init()
 {
+	// The icons of the editor are drawn with their size on the first frame, only the assets are loaded in the background
+	const bool asyncLoading = Texture::AsyncLoading;
+	Texture::AsyncLoading = false;
 	ResourceManager::Load("../undefined/resource_manager/", true);
+	Texture::AsyncLoading = asyncLoading;
+
 	ResourceManager::Load("assets/", true);
 
 	Interface::Init();
@@ -1,5 +1,9 @@
 #include "framebuffer.h"
 
+#include <algorithm>
+
+#include "wrapper/render_target_pool.h"
+
 Framebuffer::Framebuffer()
 	: FBO_ID(0), RBO_ID(0), Height(0), Width(0), mRenderer(mRenderer = ServiceLocator::Get<Renderer>())
 {
@@ -7,39 +11,62 @@ Framebuffer::Framebuffer()
 
 Framebuffer::~Framebuffer()
 {
+	for (unsigned int texture : FramebufferTextures)
+	{
+		RenderTargetPool::Release(texture);
+	}
+
 	mRenderer->DeleteFramebuffers(1, &FBO_ID);
-	mRenderer->DeleteRenderbuffers(1, &FBO_ID);
+	mRenderer->DeleteRenderbuffers(1, &RBO_ID);
 }
 
 void Framebuffer::RescaleFramebuffer(float width, float height)
 {
+	// The viewports give their size every frame, a change smaller than a pixel keeps the attachments
+	const bool isResized = (int)width != (int)Width || (int)height != (int)Height;
+
 	Width = width;
 	Height = height;
 
+	if (isResized)
+	{
+		AllocateAttachments();
+	}
+}
+
+void Framebuffer::AllocateAttachments()
+{
+	const int width = std::max((int)Width, 1);
+	const int height = std::max((int)Height, 1);
+
 	mRenderer->BindFramebuffer(GL_FRAMEBUFFER, FBO_ID);
 
-	for (int i = 0; i < FramebufferTextures.size(); i++)
+	FramebufferTextures.resize(mColorFormats.size(), 0);
+	for (size_t i = 0; i < FramebufferTextures.size(); i++)
 	{
-		mRenderer->BindTexture(FramebufferTextures[i]->GetID());
-		if (i == 0)
-		{
-			// TODO add to renderer
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, (GLsizei)Width , (GLsizei)Height, 0, GL_RGB, GL_UNSIGNED_BYTE, FramebufferTextures[i]->Data);
-		}
-		else
-		{
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_R32I, (GLsizei)Width, (GLsizei)Height, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, FramebufferTextures[i]->Data);
-		}
-
-		mRenderer->SetTextureParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		mRenderer->SetTextureParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-			
-		mRenderer->BindTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, FramebufferTextures[i]->GetID());
+		// The texture of the previous size stays in the pool, it is reused if the framebuffer goes back to that size
+		RenderTargetPool::Release(FramebufferTextures[i]);
+		FramebufferTextures[i] = RenderTargetPool::Acquire(width, height, mColorFormats[i]);
+
+		// The integer textures can't be filtered
+		const unsigned int filter = mColorFormats[i] == GL_R32I ? GL_NEAREST : GL_LINEAR;
+		mRenderer->BindTexture(FramebufferTextures[i]);
+		mRenderer->SetTextureParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+		mRenderer->SetTextureParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+
+		mRenderer->BindTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + (int)i, FramebufferTextures[i]);
 	}
+	mRenderer->BindTexture(0);
 
+	// A renderbuffer has no immutable storage, it is only specified again when the size changes
 	mRenderer->BindRenderbuffer(RBO_ID);
-	mRenderer->SetRenderBufferStorageData(GL_DEPTH24_STENCIL8, (float)Width, (float)Height);
+	mRenderer->SetRenderBufferStorageData(GL_DEPTH24_STENCIL8, (float)width, (float)height);
 	mRenderer->BindRenderbufferToFramebuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, RBO_ID);
-	
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		Logger::Error("Framebuffer is not complete! : {}", glGetError());
+	}
+
 	mRenderer->BindFramebuffer(GL_FRAMEBUFFER, 0);
 }
@@ -0,0 +1,249 @@
+#include "interface/bvh_benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <imgui/imgui.h>
+
+#include "service_locator.h"
+
+#include "camera/camera.h"
+#include "camera/frustum.h"
+
+#include "world/bvh.h"
+#include "world/scene_manager.h"
+
+// Size of the cube the boxes are scattered in
+constexpr float BENCHMARK_WORLD_SIZE = 1000.f;
+
+BvhBenchmark::QueryResult BvhBenchmark::mResults[4];
+
+/// <summary>
+/// Time a function in milliseconds
+/// </summary>
+template <typename Function>
+static double Measure(Function&& function)
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    function();
+
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void BvhBenchmark::ShowWindow()
+{
+    ImGui::Begin("BVH");
+
+    if (ImGui::IsWindowFocused(ImGuiFocusedFlags_ChildWindows))
+    {
+        ServiceLocator::Get<InputManager>()->GetKeyInput("editorCameraInput")->SetIsEnabled(false);
+    }
+
+    if (SceneManager::ActualScene)
+    {
+        const DynamicBvh& bvh = SceneManager::ActualScene->GetBvh();
+        ImGui::Text("Scene proxies : %zu", bvh.GetProxyCount());
+        ImGui::Text("Scene height : %d", bvh.GetHeight());
+    }
+
+    ImGui::Separator();
+    ImGui::InputInt("Objects", &mObjectCount, 1000, 10000);
+    ImGui::InputInt("Queries", &mQueryCount, 100, 1000);
+    mObjectCount = std::max(mObjectCount, 1);
+    mQueryCount = std::max(mQueryCount, 1);
+
+    if (ImGui::Button("Run benchmark"))
+    {
+        Run();
+    }
+
+    if (mHasRun)
+    {
+        ImGui::Text("Build : %.2f ms (height %d)", mBuildTime, mHeight);
+
+        if (ImGui::BeginTable("Queries", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+        {
+            ImGui::TableSetupColumn("Query");
+            ImGui::TableSetupColumn("BVH (ms)");
+            ImGui::TableSetupColumn("Scan (ms)");
+            ImGui::TableSetupColumn("Speedup");
+            ImGui::TableSetupColumn("Hits (BVH / scan)");
+            ImGui::TableHeadersRow();
+
+            for (const QueryResult& result : mResults)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(result.Name);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", result.BvhTime);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", result.ScanTime);
+                ImGui::TableNextColumn();
+                ImGui::Text("x%.1f", result.BvhTime > 0.0 ? result.ScanTime / result.BvhTime : 0.0);
+                ImGui::TableNextColumn();
+                ImGui::Text("%zu / %zu", result.BvhHits, result.ScanHits);
+            }
+
+            ImGui::EndTable();
+        }
+    }
+
+    ImGui::End();
+}
+
+void BvhBenchmark::Run()
+{
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> position(-BENCHMARK_WORLD_SIZE * 0.5f, BENCHMARK_WORLD_SIZE * 0.5f);
+    std::uniform_real_distribution<float> size(0.1f, 2.f);
+
+    std::vector<BoundingBox> boxes((size_t)mObjectCount);
+    for (BoundingBox& box : boxes)
+    {
+        const Vector3 center(position(random), position(random), position(random));
+        const Vector3 extents(size(random), size(random), size(random));
+        box = { center - extents, center + extents };
+    }
+
+    DynamicBvh bvh;
+    mBuildTime = Measure([&]()
+    {
+        for (BoundingBox& box : boxes)
+        {
+            bvh.CreateProxy(box, &box);
+        }
+    });
+    mHeight = bvh.GetHeight();
+
+    // Same queries for the BVH and the scan
+    std::vector<BoundingBox> queryBoxes((size_t)mQueryCount);
+    std::vector<BoundingSphere> querySpheres((size_t)mQueryCount);
+    std::vector<Vector3> rayOrigins((size_t)mQueryCount);
+    std::vector<Vector3> rayDirections((size_t)mQueryCount);
+    std::uniform_real_distribution<float> direction(-1.f, 1.f);
+    for (size_t i = 0; i < (size_t)mQueryCount; i++)
+    {
+        const Vector3 center(position(random), position(random), position(random));
+        queryBoxes[i] = { center - Vector3(10.f), center + Vector3(10.f) };
+        querySpheres[i] = { center, 10.f };
+        rayOrigins[i] = center;
+
+        Vector3 rayDirection(direction(random), direction(random), direction(random));
+        rayDirections[i] = rayDirection * (1.f / std::max(rayDirection.Norm(), 1e-6f));
+    }
+
+    // Frustum of the current camera, or the unit cube without a camera
+    const Frustum frustum(Camera::CurrentCamera ? Camera::CurrentCamera->GetVP() : Matrix4x4::Identity());
+
+    QueryResult& boxResult = mResults[0];
+    boxResult = { "Box" };
+    boxResult.BvhTime = Measure([&]()
+    {
+        for (const BoundingBox& query : queryBoxes)
+        {
+            bvh.QueryBox(query, [&](void*) { boxResult.BvhHits++; return true; });
+        }
+    });
+    boxResult.ScanTime = Measure([&]()
+    {
+        for (const BoundingBox& query : queryBoxes)
+        {
+            for (const BoundingBox& box : boxes)
+            {
+                boxResult.ScanHits += query.Intersects(box);
+            }
+        }
+    });
+
+    QueryResult& sphereResult = mResults[1];
+    sphereResult = { "Sphere" };
+    sphereResult.BvhTime = Measure([&]()
+    {
+        for (const BoundingSphere& query : querySpheres)
+        {
+            bvh.QuerySphere(query, [&](void*) { sphereResult.BvhHits++; return true; });
+        }
+    });
+    sphereResult.ScanTime = Measure([&]()
+    {
+        for (const BoundingSphere& query : querySpheres)
+        {
+            for (const BoundingBox& box : boxes)
+            {
+                sphereResult.ScanHits += box.Intersects(query);
+            }
+        }
+    });
+
+    // Closest box hit by each ray
+    QueryResult& rayResult = mResults[2];
+    rayResult = { "Ray (closest)" };
+    rayResult.BvhTime = Measure([&]()
+    {
+        for (size_t i = 0; i < rayOrigins.size(); i++)
+        {
+            const Vector3 inverseDirection(1.f / rayDirections[i].x, 1.f / rayDirections[i].y, 1.f / rayDirections[i].z);
+            bool hit = false;
+
+            bvh.RayCast(rayOrigins[i], rayDirections[i], BENCHMARK_WORLD_SIZE, [&](void* userData, float)
+            {
+                float distance = 0.f;
+                if (static_cast<BoundingBox*>(userData)->IntersectsRay(rayOrigins[i], inverseDirection, BENCHMARK_WORLD_SIZE, distance))
+                {
+                    hit = true;
+                    return distance;
+                }
+
+                return BENCHMARK_WORLD_SIZE;
+            });
+
+            rayResult.BvhHits += hit;
+        }
+    });
+    rayResult.ScanTime = Measure([&]()
+    {
+        for (size_t i = 0; i < rayOrigins.size(); i++)
+        {
+            const Vector3 inverseDirection(1.f / rayDirections[i].x, 1.f / rayDirections[i].y, 1.f / rayDirections[i].z);
+            float closest = BENCHMARK_WORLD_SIZE;
+            bool hit = false;
+
+            for (const BoundingBox& box : boxes)
+            {
+                float distance = 0.f;
+                if (box.IntersectsRay(rayOrigins[i], inverseDirection, closest, distance))
+                {
+                    closest = distance;
+                    hit = true;
+                }
+            }
+
+            rayResult.ScanHits += hit;
+        }
+    });
+
+    // A single frustum, repeated to get a measurable time
+    QueryResult& frustumResult = mResults[3];
+    frustumResult = { "Frustum" };
+    frustumResult.BvhTime = Measure([&]()
+    {
+        for (int i = 0; i < mQueryCount; i++)
+        {
+            bvh.QueryFrustum(frustum, [&](void*) { frustumResult.BvhHits++; return true; });
+        }
+    });
+    frustumResult.ScanTime = Measure([&]()
+    {
+        for (int i = 0; i < mQueryCount; i++)
+        {
+            for (const BoundingBox& box : boxes)
+            {
+                frustumResult.ScanHits += frustum.Intersects(box);
+            }
+        }
+    });
+
+    mHasRun = true;
+}
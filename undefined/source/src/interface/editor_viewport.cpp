@@ -4,10 +4,12 @@
 
 #include <toolbox/calc.h>
 
+#include <cstring>
 #include <vector>
 
 #include "world/scene_manager.h"
 #include "world/gizmo.h"
+#include "world/light_manager.h"
 
 #include "utils/utils.h"
 
@@ -19,6 +21,8 @@
 
 #include "interface/interface.h"
 
+#include "wrapper/picking.h"
+
 
 EditorViewport::EditorViewport(Framebuffer* framebuffer, Camera* camera)
 	: mFramebuffer(framebuffer), ViewportCamera(camera), mShader(ResourceManager::Get<Shader>("viewport_shader"))
@@ -52,8 +56,13 @@ void EditorViewport::InitButtonTextures()
 
 void EditorViewport::ShowWindow()
 {
-	ImGui::Begin((std::string("Editor ##") + std::to_string(mID)).c_str(), 0, SceneGizmo.GizmoWindowFlags);
-
+	// Collapsed or behind another docked tab, the viewport is not drawn
+	mIsVisible = ImGui::Begin((std::string("Editor ##") + std::to_string(mID)).c_str(), 0, SceneGizmo.GizmoWindowFlags);
+	if (!mIsVisible)
+	{
+		ImGui::End();
+		return;
+	}
 
 	if (ImGui::IsWindowFocused(ImGuiFocusedFlags_ChildWindows))
 	{
@@ -111,8 +120,8 @@ void EditorViewport::ShowWindow()
 	{
 		if (!ImGuizmo::IsOver())
 		{
-			ServiceLocator::Get<Renderer>()->ReadPixels(GetFBO_ID(), 1, mouseX, mouseY);
-			Logger::Info("Pixel data = {}", ServiceLocator::Get<Renderer>()->ObjectIndex);
+			// Resolved when the viewport is drawn, the selection changes a frame later
+			Picking::Request(*ViewportCamera, mouseX, mouseY);
 		}
 	}
 
@@ -120,7 +129,7 @@ void EditorViewport::ShowWindow()
 	ImVec2 screenPos = ImGui::GetCursorScreenPos();
 	
 	ImGui::GetWindowDrawList()->AddImage(
-		Utils::IntToPointer<ImTextureID>(mFramebuffer->FramebufferTextures[0]->GetID()),
+		Utils::IntToPointer<ImTextureID>(mFramebuffer->FramebufferTextures[0]),
 		ImVec2(screenPos.x, screenPos.y),
 		ImVec2(screenPos.x + mWidth, screenPos.y + mHeight),
 		ImVec2(0, 1),
@@ -144,6 +153,11 @@ unsigned int EditorViewport::GetFBO_ID() const
 	return mFramebuffer->FBO_ID;
 }
 
+Framebuffer* EditorViewport::GetFramebuffer() const
+{
+	return mFramebuffer;
+}
+
 int EditorViewport::GetEditorID() const
 {
 	return mID;
@@ -167,14 +181,67 @@ void EditorViewport::RescaleViewport()
 		if (aspect < 1.0f)
 			aspect = mHeight / mWidth;
 
-		result = Matrix4x4::ProjectionMatrix(calc::PI / 2.0f, aspect, 0.1f, 100.0f);
+		result = Matrix4x4::ProjectionMatrix(ViewportCamera->Fov, aspect, ViewportCamera->Near, ViewportCamera->Far);
 		ViewportCamera->SetPerspective(result);
 	}
 
+	// The passes of the frame graph set the viewport of the framebuffer when they draw
 	mFramebuffer->RescaleFramebuffer(mWidth, mHeight);
+}
+
+bool EditorViewport::IsVisible() const
+{
+	return mIsVisible && mWidth > 0 && mHeight > 0;
+}
+
+bool EditorViewport::NeedsRedraw() const
+{
+	if (!IsVisible())
+	{
+		return false;
+	}
+
+	if (AlwaysRedraw || !mIsDrawn || !mIsSettled)
+	{
+		return true;
+	}
 
-	// TODO add to Renderer
-	glViewport(0, 0, (GLsizei)mWidth, (GLsizei)mHeight);
+	return !MatchesDrawnState();
+}
+
+void EditorViewport::SetDrawn(bool occlusionCulled)
+{
+	const Scene* scene = SceneManager::ActualScene;
+
+	// Culled against the depth pyramid of the last image, the objects uncovered since then are missing
+	// until the viewport is drawn once more in the same state
+	mIsSettled = !occlusionCulled || (mIsDrawn && MatchesDrawnState());
+
+	mIsDrawn = true;
+	mDrawnViewProjection = ViewportCamera->GetVP();
+	mDrawnWidth = mWidth;
+	mDrawnHeight = mHeight;
+	mDrawnScene = scene;
+	mDrawnSceneVersion = scene ? scene->GetVersion() : 0;
+	mDrawnLightVersion = LightManager::GetVersion();
+	mDrawnInvalidation = mInvalidation;
+}
+
+bool EditorViewport::MatchesDrawnState() const
+{
+	if (mDrawnInvalidation != mInvalidation)
+	{
+		return false;
+	}
+
+	const Scene* scene = SceneManager::ActualScene;
+	if (mDrawnScene != scene || (scene && mDrawnSceneVersion != scene->GetVersion()) || mDrawnLightVersion != LightManager::GetVersion())
+	{
+		return false;
+	}
+
+	return mDrawnWidth == mWidth && mDrawnHeight == mHeight
+		&& std::memcmp(&mDrawnViewProjection, &ViewportCamera->GetVP(), sizeof(Matrix4x4)) == 0;
 }
 
 void EditorViewport::SetMouseMinMaxBounds(int& mouseX, int& mouseY, Vector2& viewportOffset, Vector2& viewportSize)
@@ -226,3 +293,8 @@ void EditorViewport::SetIsGizmoUpdated(bool value)
 {
 	mIsGizmoUpdated = value;
 }
+
+void EditorViewport::Invalidate()
+{
+	mInvalidation++;
+}
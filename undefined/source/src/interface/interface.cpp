@@ -6,6 +6,8 @@
 #include "service_locator.h"
 
 #include "interface/fps_graph.h"
+#include "interface/render_stats.h"
+#include "interface/bvh_benchmark.h"
 #include "interface/content_browser.h"
 #include "interface/scene_graph.h"
 #include "interface/inspector.h"
@@ -96,6 +98,8 @@ void Interface::Update()
     BeginDockSpace();
 
     FPSGraph::ShowWindow();
+    RenderStats::ShowWindow();
+    BvhBenchmark::ShowWindow();
     ContentBrowser::DisplayWindow();
     SceneGraph::DisplayWindow();
     Inspector::ShowWindow();
@@ -105,6 +109,12 @@ void Interface::Update()
         EditorViewports[i]->ShowWindow();
     }
 
+    // A widget edited (dragged, typed in or clicked) may have changed anything drawn
+    if (ImGui::IsAnyItemActive() || ImGui::IsMouseReleased(ImGuiMouseButton_Left))
+    {
+        EditorViewport::Invalidate();
+    }
+
     ImGui::End();
 }
 
@@ -122,7 +132,7 @@ void Interface::Delete()
 
 void Interface::CreateEditorViewport()
 {
-    Framebuffer* framebuffer = Framebuffer::Create<2>(200.0f, 200.0f);
+    Framebuffer* framebuffer = Framebuffer::Create<1>(200.0f, 200.0f);
     Camera* camera = new Camera(200.0f, 200.0f);
 
     EditorViewports.push_back(new EditorViewport(framebuffer, camera));
@@ -0,0 +1,194 @@
+#include "interface/render_stats.h"
+
+#include <imgui/imgui.h>
+
+#include "service_locator.h"
+
+#include "interface/editor_viewport.h"
+#include "interface/interface.h"
+
+#include "resources/model_renderer.h"
+#include "resources/shader_compiler.h"
+#include "resources/texture_loader.h"
+#include "resources/texture_streamer.h"
+
+#include "wrapper/geometry_arena.h"
+#include "wrapper/gpu_culling.h"
+#include "wrapper/picking.h"
+#include "wrapper/render_queue.h"
+#include "wrapper/render_target_pool.h"
+
+/// <summary>
+/// Display an issued / skipped line in the stats table
+/// </summary>
+static void ShowBindRow(const char* label, unsigned int issued, unsigned int skipped)
+{
+    const unsigned int total = issued + skipped;
+
+    ImGui::TableNextRow();
+    ImGui::TableNextColumn();
+    ImGui::TextUnformatted(label);
+    ImGui::TableNextColumn();
+    ImGui::Text("%u", issued);
+    ImGui::TableNextColumn();
+    ImGui::Text("%u", skipped);
+    ImGui::TableNextColumn();
+    ImGui::Text("%.0f %%", total ? 100.f * skipped / total : 0.f);
+}
+
+void RenderStats::ShowWindow()
+{
+    ImGui::Begin("Render Stats");
+
+    if (ImGui::IsWindowFocused(ImGuiFocusedFlags_ChildWindows))
+    {
+        ServiceLocator::Get<InputManager>()->GetKeyInput("editorCameraInput")->SetIsEnabled(false);
+    }
+
+    const RenderCounters& counters = ServiceLocator::Get<Renderer>()->LastFrameCounters;
+
+    ImGui::Text("Draw calls : %u", counters.DrawCalls);
+    ImGui::Text("Instances : %u", counters.Instances);
+    ImGui::Text("Triangles : %u", counters.Triangles);
+    ImGui::Text("Packets (last viewport) : %zu", RenderQueue::GetPacketCount());
+
+    ImGui::Separator();
+    ImGui::Checkbox("Redraw every viewport", &EditorViewport::AlwaysRedraw);
+    ImGui::Text("Viewports drawn : %u", counters.ViewportsDrawn);
+    ImGui::Text("Viewports skipped : %u", counters.ViewportsSkipped);
+    ImGui::Text("Render targets : %zu (%.2f MB, %.2f MB free)", RenderTargetPool::GetTextureCount(),
+        RenderTargetPool::GetAllocatedSize() / (1024.f * 1024.f), RenderTargetPool::GetFreeSize() / (1024.f * 1024.f));
+    ImGui::Text("Render target allocations : %zu", RenderTargetPool::GetAllocationCount());
+    ImGui::Text("Passes executed : %u (%u culled)", counters.PassesExecuted, counters.PassesCulled);
+    ImGui::Text("Transient targets : %u (%u aliased)", counters.TransientTargets, counters.TransientTargetsAliased);
+
+    ImGui::Separator();
+    // The times only change while the viewport is drawn, redraw every viewport to compare them
+    if (ImGui::BeginTable("Depth pre-pass", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Viewport");
+        ImGui::TableSetupColumn("Pre-pass");
+        ImGui::TableSetupColumn("Pre-pass GPU");
+        ImGui::TableSetupColumn("Opaque GPU");
+        ImGui::TableHeadersRow();
+
+        for (EditorViewport* viewport : Interface::EditorViewports)
+        {
+            ImGui::PushID(viewport->GetEditorID());
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("Editor %d", viewport->GetEditorID());
+            ImGui::TableNextColumn();
+            if (ImGui::Checkbox("##Pre-pass", &viewport->DepthPrepass))
+            {
+                EditorViewport::Invalidate();
+            }
+            ImGui::TableNextColumn();
+            if (viewport->DepthPrepass)
+            {
+                ImGui::Text("%.3f ms", viewport->DepthPrepassTimer.GetMilliseconds());
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f ms", viewport->OpaqueTimer.GetMilliseconds());
+
+            ImGui::PopID();
+        }
+
+        ImGui::EndTable();
+    }
+
+    ImGui::Separator();
+    int pickingMode = (int)Picking::Mode;
+    if (ImGui::Combo("Picking", &pickingMode, "GPU region\0Ray cast\0"))
+    {
+        Picking::Mode = (PickingMode)pickingMode;
+    }
+
+    ImGui::Separator();
+    ImGui::Checkbox("Frustum culling", &RenderQueue::FrustumCulling);
+    ImGui::Text("Visible : %u", counters.PacketsVisible);
+    ImGui::Text("Culled : %u", counters.PacketsCulled);
+
+    ImGui::Separator();
+    ImGui::Checkbox("Levels of detail", &ModelRenderer::UseLods);
+    ImGui::BeginDisabled(!ModelRenderer::UseLods);
+    ImGui::SliderFloat("LOD pixel error", &ModelRenderer::LodPixelError, 0.25f, 16.f, "%.2f px", ImGuiSliderFlags_Logarithmic);
+    ImGui::EndDisabled();
+
+    ImGui::Separator();
+    ImGui::Checkbox("Multi draw indirect", &RenderQueue::MultiDrawIndirect);
+    ImGui::Text("Indirect commands : %u", counters.IndirectCommands);
+    ImGui::Text("Geometry arenas : %.2f MB", GeometryArena::GetTotalMemory() / (1024.f * 1024.f));
+    ImGui::Text("Frame data : %.2f MB of %.2f MB (%u waits)", counters.FrameDataBytes / (1024.f * 1024.f),
+        ServiceLocator::Get<Renderer>()->GetFrameDataSectionSize() / (1024.f * 1024.f), counters.FrameDataWaits);
+    ImGui::Text("Textures loading : %zu", TextureLoader::GetPendingCount());
+    ImGui::Checkbox("Shader variants", &RenderQueue::ShaderVariants);
+    ImGui::Text("Shaders compiling : %zu", ShaderCompiler::GetPendingCount());
+
+    ImGui::Separator();
+    ImGui::Checkbox("Texture streaming", &TextureStreamer::Enabled);
+    ImGui::BeginDisabled(!TextureStreamer::Enabled);
+    int budget = (int)(TextureStreamer::VramBudget / (1024 * 1024));
+    if (ImGui::SliderInt("VRAM budget", &budget, 16, 4096, "%d MB", ImGuiSliderFlags_Logarithmic))
+    {
+        TextureStreamer::VramBudget = (size_t)budget * 1024 * 1024;
+    }
+    ImGui::SliderFloat("Mip bias", &TextureStreamer::LevelBias, -2.f, 4.f, "%.1f");
+    ImGui::EndDisabled();
+    ImGui::Text("Streamed textures : %zu", TextureStreamer::GetTextureCount());
+    ImGui::Text("Resident : %.2f MB", TextureStreamer::GetResidentSize() / (1024.f * 1024.f));
+    ImGui::Text("Requested : %.2f MB", TextureStreamer::GetRequestedSize() / (1024.f * 1024.f));
+
+    ImGui::Separator();
+    // The GPU culling writes the indirect commands, it needs the multi draw path
+    ImGui::BeginDisabled(!GpuCulling::IsReady() || !RenderQueue::MultiDrawIndirect);
+    ImGui::Checkbox("GPU culling", &GpuCulling::Enabled);
+    ImGui::Checkbox("Occlusion culling", &GpuCulling::OcclusionCulling);
+    ImGui::EndDisabled();
+
+    const GpuCullingStats& gpuStats = GpuCulling::GetStats();
+    if (ImGui::BeginTable("GPU culling", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("GPU pass");
+        ImGui::TableSetupColumn("Tested");
+        ImGui::TableSetupColumn("Culled");
+        ImGui::TableHeadersRow();
+
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted("Frustum");
+        ImGui::TableNextColumn();
+        ImGui::Text("%u", gpuStats.Tested);
+        ImGui::TableNextColumn();
+        ImGui::Text("%u", gpuStats.FrustumCulled);
+
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted("Occlusion");
+        ImGui::TableNextColumn();
+        ImGui::Text("%u", gpuStats.Tested - gpuStats.FrustumCulled);
+        ImGui::TableNextColumn();
+        ImGui::Text("%u", gpuStats.OcclusionCulled);
+
+        ImGui::EndTable();
+    }
+    ImGui::Text("GPU visible : %u", gpuStats.Visible);
+
+    if (ImGui::BeginTable("Binds", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Binds");
+        ImGui::TableSetupColumn("Issued");
+        ImGui::TableSetupColumn("Skipped");
+        ImGui::TableSetupColumn("Saved");
+        ImGui::TableHeadersRow();
+
+        ShowBindRow("Program", counters.ProgramBinds, counters.ProgramBindsSkipped);
+        ShowBindRow("VAO", counters.VertexArrayBinds, counters.VertexArrayBindsSkipped);
+        ShowBindRow("Texture", counters.TextureBinds, counters.TextureBindsSkipped);
+
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
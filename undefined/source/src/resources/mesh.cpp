@@ -1,6 +1,295 @@
 #include "resources/mesh.h"
 
-Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
-    : Vertices(vertices), Indices(indices)
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "engine_debug/logger.h"
+
+static_assert(sizeof(PackedVertex) == 16, "PackedVertex must stay half the size of Vertex");
+
+// Biggest number of vertices a mesh can index with 16 bits indices
+constexpr size_t SHORT_INDEX_VERTEX_LIMIT = 1 << 16;
+
+// Biggest value of a normalized signed 16 bits and 10 bits integer
+constexpr float SNORM16_MAX = 32767.f;
+constexpr float SNORM10_MAX = 511.f;
+
+/// <summary>
+/// Convert a float to a half float, rounded to the nearest
+/// </summary>
+static uint16_t FloatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    const uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+    const int exponent = (int)((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    // infinity and NaN
+    if (((bits >> 23) & 0xFF) == 0xFF)
+    {
+        return sign | 0x7C00 | (mantissa ? 0x200 : 0);
+    }
+
+    // too big, clamped to infinity
+    if (exponent >= 31)
+    {
+        return sign | 0x7C00;
+    }
+
+    // denormalized half, or too small
+    if (exponent <= 0)
+    {
+        if (exponent < -10)
+        {
+            return sign;
+        }
+
+        mantissa |= 0x800000;
+        const int shift = 14 - exponent;
+        return sign | (uint16_t)((mantissa >> shift) + ((mantissa >> (shift - 1)) & 1));
+    }
+
+    // the rounding can carry into the exponent, which gives the next power of two as expected
+    return sign | (uint16_t)(((uint32_t)exponent << 10 | mantissa >> 13) + ((mantissa >> 12) & 1));
+}
+
+/// <summary>
+/// Convert a value from -1 to 1 to a normalized signed integer
+/// </summary>
+static int32_t ToSnorm(float value, float max)
+{
+    return (int32_t)std::lround(std::clamp(value, -1.f, 1.f) * max);
+}
+
+Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices)
+    : Vertices(std::move(vertices)), Indices(std::move(indices))
+{
+    Bounds::Compute(Vertices.data(), Vertices.size(), mBoundingBox, mBoundingSphere);
+
+    // Ratio of the UV area and the area of the triangles, the texture streaming turns it into texels per unit
+    double area = 0.0, uvArea = 0.0;
+    for (size_t i = 0; i + 2 < Indices.size(); i += 3)
+    {
+        const Vertex& a = Vertices[Indices[i]];
+        const Vertex& b = Vertices[Indices[i + 1]];
+        const Vertex& c = Vertices[Indices[i + 2]];
+
+        area += Vector3::Cross(b.Position - a.Position, c.Position - a.Position).Norm();
+        uvArea += std::abs((b.TexCoords.x - a.TexCoords.x) * (c.TexCoords.y - a.TexCoords.y) - (b.TexCoords.y - a.TexCoords.y) * (c.TexCoords.x - a.TexCoords.x));
+    }
+
+    mUvDensity = area > 0.0 ? (float)std::sqrt(uvArea / area) : 0.f;
+}
+
+Mesh::~Mesh()
+{
+    if (mAllocation.Arena)
+    {
+        mAllocation.Arena->Free(mAllocation);
+    }
+
+    // the ID is given to the next uploaded mesh, the sort keys only keep its 16 low bits
+    if (mID != 0)
+    {
+        mFreeIDs.push_back(mID);
+    }
+}
+
+void Mesh::Upload()
+{
+    if (IsUploaded() || Vertices.empty() || Indices.empty())
+    {
+        return;
+    }
+
+    const void* vertexData = Vertices.data();
+    std::vector<PackedVertex> packedVertices;
+    if (mFormat == VertexFormat::Packed)
+    {
+        PackVertices(packedVertices);
+        vertexData = packedVertices.data();
+    }
+
+    // the data is sent only once over the bus, every mesh of the arena shares its buffers and VAO
+    // the indices are relative to the base vertex of the mesh, 16 bits are enough up to 65536 vertices
+    if (Vertices.size() <= SHORT_INDEX_VERTEX_LIMIT)
+    {
+        const std::vector<uint16_t> shortIndices(Indices.begin(), Indices.end());
+
+        GeometryArena& arena = GeometryArena::Get(mFormat, GL_UNSIGNED_SHORT);
+        mAllocation = arena.Allocate(vertexData, (unsigned int)Vertices.size(), shortIndices.data(), (unsigned int)shortIndices.size());
+    }
+    else
+    {
+        GeometryArena& arena = GeometryArena::Get(mFormat, GL_UNSIGNED_INT);
+        mAllocation = arena.Allocate(vertexData, (unsigned int)Vertices.size(), Indices.data(), (unsigned int)Indices.size());
+    }
+
+    if (!mFreeIDs.empty())
+    {
+        mID = mFreeIDs.back();
+        mFreeIDs.pop_back();
+    }
+    else
+    {
+        mID = ++mLastID;
+        if (mID == MESH_ID_LIMIT + 1)
+        {
+            Logger::Warning("Mesh::Upload() more than {} meshes are uploaded, the draws of some meshes are not sorted by mesh", MESH_ID_LIMIT);
+        }
+    }
+
+    for (const std::shared_ptr<Mesh>& lod : mLods)
+    {
+        lod->mFormat = mFormat;
+        lod->Upload();
+    }
+}
+
+void Mesh::SetVertexFormat(VertexFormat format)
+{
+    if (IsUploaded())
+    {
+        Logger::Warning("Mesh::SetVertexFormat() the mesh has already been uploaded, the format is kept");
+        return;
+    }
+
+    mFormat = format;
+}
+
+VertexFormat Mesh::GetVertexFormat() const
+{
+    return mFormat;
+}
+
+const Matrix4x4& Mesh::GetDequantization() const
+{
+    return mDequantization;
+}
+
+void Mesh::ReleaseCPUData()
+{
+    if (!IsUploaded())
+    {
+        Logger::Warning("Mesh::ReleaseCPUData() the mesh has not been uploaded, the data is kept");
+        return;
+    }
+
+    std::vector<Vertex>().swap(Vertices);
+    std::vector<unsigned int>().swap(Indices);
+
+    for (const std::shared_ptr<Mesh>& lod : mLods)
+    {
+        if (lod->IsUploaded())
+        {
+            lod->ReleaseCPUData();
+        }
+    }
+}
+
+bool Mesh::IsUploaded() const
+{
+    return mAllocation.Arena != nullptr;
+}
+
+unsigned int Mesh::GetVAO() const
+{
+    return mAllocation.Arena ? mAllocation.Arena->GetVAO() : 0;
+}
+
+int Mesh::GetIndexCount() const
+{
+    return (int)mAllocation.IndexCount;
+}
+
+const GeometryAllocation& Mesh::GetAllocation() const
+{
+    return mAllocation;
+}
+
+unsigned int Mesh::GetID() const
+{
+    return mID;
+}
+
+const BoundingBox& Mesh::GetBoundingBox() const
+{
+    return mBoundingBox;
+}
+
+const BoundingSphere& Mesh::GetBoundingSphere() const
+{
+    return mBoundingSphere;
+}
+
+float Mesh::GetUvDensity() const
+{
+    return mUvDensity;
+}
+
+void Mesh::SetLods(std::vector<std::shared_ptr<Mesh>> lods, std::vector<float> errors)
+{
+    mLods = std::move(lods);
+    mLodErrors = std::move(errors);
+    mLodErrors.resize(mLods.size(), 0.f);
+
+    if (IsUploaded())
+    {
+        for (const std::shared_ptr<Mesh>& lod : mLods)
+        {
+            lod->Upload();
+        }
+    }
+}
+
+size_t Mesh::GetLodCount() const
+{
+    return mLods.size() + 1;
+}
+
+const Mesh* Mesh::GetLod(size_t level) const
 {
+    return level == 0 || mLods.empty() ? this : mLods[std::min(level, mLods.size()) - 1].get();
+}
+
+float Mesh::GetLodError(size_t level) const
+{
+    return level == 0 || mLodErrors.empty() ? 0.f : mLodErrors[std::min(level, mLodErrors.size()) - 1];
+}
+
+void Mesh::PackVertices(std::vector<PackedVertex>& result)
+{
+    // a flat mesh keeps a non zero scale on its flat axis
+    const Vector3 center = mBoundingBox.GetCenter();
+    Vector3 extents = mBoundingBox.GetExtents();
+    for (size_t axis = 0; axis < 3; axis++)
+    {
+        extents[axis] = std::max(extents[axis], 1e-6f);
+    }
+
+    mDequantization = Matrix4x4::TranslationMatrix3D(center) * Matrix4x4::ScalingMatrix3D(extents);
+
+    result.resize(Vertices.size());
+    for (size_t i = 0; i < Vertices.size(); i++)
+    {
+        const Vertex& vertex = Vertices[i];
+        PackedVertex& packed = result[i];
+
+        for (size_t axis = 0; axis < 3; axis++)
+        {
+            packed.Position[axis] = (int16_t)ToSnorm((vertex.Position[axis] - center[axis]) / extents[axis], SNORM16_MAX);
+        }
+        packed.Position[3] = 0;
+
+        packed.Normal = (uint32_t)(ToSnorm(vertex.Normal.x, SNORM10_MAX) & 0x3FF)
+            | (uint32_t)(ToSnorm(vertex.Normal.y, SNORM10_MAX) & 0x3FF) << 10
+            | (uint32_t)(ToSnorm(vertex.Normal.z, SNORM10_MAX) & 0x3FF) << 20;
+
+        packed.TexCoords[0] = FloatToHalf(vertex.TexCoords.x);
+        packed.TexCoords[1] = FloatToHalf(vertex.TexCoords.y);
+    }
 }
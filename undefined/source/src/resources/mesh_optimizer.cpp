@@ -0,0 +1,470 @@
+#include "resources/mesh_optimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+
+#include "resources/mesh.h"
+
+// Size of the LRU cache modelled by the vertex cache optimization
+constexpr size_t OPTIMIZER_CACHE_SIZE = 32;
+// Size of the FIFO cache simulated by the analysis and the overdraw clusters, close to the caches of the current GPUs
+constexpr unsigned int FIFO_CACHE_SIZE = 16;
+
+// Weights of the Forsyth score
+constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+constexpr float CACHE_DECAY_POWER = 1.5f;
+constexpr float VALENCE_BOOST_SCALE = 2.f;
+constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+// Loss of ACMR accepted by the overdraw optimization of Optimize
+constexpr float OVERDRAW_THRESHOLD = 1.05f;
+
+/// <summary>
+/// Score of a vertex in the Forsyth optimization : recently used vertices and vertices with few triangles left are preferred
+/// </summary>
+static float VertexScore(int cachePosition, unsigned int remainingTriangles)
+{
+	if (remainingTriangles == 0)
+	{
+		return -1.f;
+	}
+
+	float score = 0.f;
+	if (cachePosition >= 0)
+	{
+		// The last triangle's vertices get a fixed score so the strip doesn't turn back on itself
+		if (cachePosition < 3)
+		{
+			score = LAST_TRIANGLE_SCORE;
+		}
+		else
+		{
+			const float scale = 1.f / (OPTIMIZER_CACHE_SIZE - 3);
+			score = std::pow(1.f - (cachePosition - 3) * scale, CACHE_DECAY_POWER);
+		}
+	}
+
+	return score + VALENCE_BOOST_SCALE * std::pow((float)remainingTriangles, -VALENCE_BOOST_POWER);
+}
+
+/// <summary>
+/// FIFO cache simulated with timestamps : a vertex is in the cache while fewer than FIFO_CACHE_SIZE misses happened since it was added
+/// </summary>
+struct FifoCache
+{
+	std::vector<unsigned int> Timestamps;
+	unsigned int Time = FIFO_CACHE_SIZE + 1;
+
+	explicit FifoCache(size_t vertexCount)
+		: Timestamps(vertexCount, 0)
+	{
+	}
+
+	/// <summary>
+	/// Use a vertex, return 1 if it had to be transformed
+	/// </summary>
+	unsigned int Access(unsigned int vertex)
+	{
+		if (Time - Timestamps[vertex] > FIFO_CACHE_SIZE)
+		{
+			Timestamps[vertex] = Time++;
+			return 1;
+		}
+
+		return 0;
+	}
+
+	/// <summary>
+	/// Empty the cache
+	/// </summary>
+	void Flush()
+	{
+		Time += FIFO_CACHE_SIZE + 1;
+	}
+};
+
+void MeshOptimizer::Optimize(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, bool overdraw)
+{
+	WeldVertices(vertices, indices);
+	OptimizeVertexCache(indices, vertices.size());
+
+	if (overdraw)
+	{
+		OptimizeOverdraw(indices, vertices, OVERDRAW_THRESHOLD);
+	}
+
+	OptimizeVertexFetch(vertices, indices);
+}
+
+void MeshOptimizer::WeldVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+	static_assert(sizeof(Vertex) == 8 * sizeof(float), "Vertex is compared bytewise, it must not have padding");
+
+	const size_t vertexCount = vertices.size();
+
+	// Identical vertices end up next to each other, the first one in the mesh is kept
+	std::vector<unsigned int> order(vertexCount);
+	std::iota(order.begin(), order.end(), 0u);
+	std::stable_sort(order.begin(), order.end(), [&vertices](unsigned int a, unsigned int b)
+		{
+			return std::memcmp(&vertices[a], &vertices[b], sizeof(Vertex)) < 0;
+		});
+
+	std::vector<unsigned int> remap(vertexCount);
+	for (size_t first = 0; first < vertexCount;)
+	{
+		size_t last = first + 1;
+		while (last < vertexCount && std::memcmp(&vertices[order[first]], &vertices[order[last]], sizeof(Vertex)) == 0)
+		{
+			remap[order[last]] = order[first];
+			last++;
+		}
+
+		remap[order[first]] = order[first];
+		first = last;
+	}
+
+	// Compact the kept vertices in their original order
+	std::vector<unsigned int> newIndex(vertexCount);
+	size_t keptCount = 0;
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		if (remap[i] == i)
+		{
+			newIndex[i] = (unsigned int)keptCount;
+			vertices[keptCount++] = vertices[i];
+		}
+	}
+	vertices.resize(keptCount);
+
+	for (unsigned int& index : indices)
+	{
+		index = newIndex[remap[index]];
+	}
+}
+
+void MeshOptimizer::OptimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount)
+{
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0 || vertexCount == 0)
+	{
+		return;
+	}
+
+	// Triangles not drawn yet around each vertex, the first remainingTriangles[v] entries of its range are still to draw
+	std::vector<unsigned int> remainingTriangles(vertexCount, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		remainingTriangles[indices[i]]++;
+	}
+
+	std::vector<unsigned int> adjacencyOffsets(vertexCount + 1, 0);
+	std::partial_sum(remainingTriangles.begin(), remainingTriangles.end(), adjacencyOffsets.begin() + 1);
+
+	std::vector<unsigned int> adjacency(triangleCount * 3);
+	{
+		std::vector<unsigned int> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t i = 0; i < triangleCount * 3; i++)
+		{
+			adjacency[cursor[indices[i]]++] = (unsigned int)(i / 3);
+		}
+	}
+
+	std::vector<int> cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		vertexScores[v] = VertexScore(-1, remainingTriangles[v]);
+	}
+
+	std::vector<float> triangleScores(triangleCount);
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+	}
+
+	std::vector<uint8_t> emitted(triangleCount, 0);
+	std::vector<unsigned int> result;
+	result.reserve(triangleCount * 3);
+
+	std::vector<unsigned int> cache;
+	std::vector<unsigned int> newCache;
+	cache.reserve(OPTIMIZER_CACHE_SIZE + 3);
+	newCache.reserve(OPTIMIZER_CACHE_SIZE + 3);
+
+	size_t cursor = 0;
+	int bestTriangle = (int)(std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin());
+
+	while (result.size() < triangleCount * 3)
+	{
+		// Nothing left around the cache, restart from the next triangle of the input
+		if (bestTriangle < 0)
+		{
+			while (emitted[cursor])
+			{
+				cursor++;
+			}
+			bestTriangle = (int)cursor;
+		}
+
+		const unsigned int* triangle = &indices[bestTriangle * 3];
+		emitted[bestTriangle] = 1;
+		result.insert(result.end(), triangle, triangle + 3);
+
+		// The triangle is no longer waiting on its vertices
+		for (size_t i = 0; i < 3; i++)
+		{
+			const unsigned int vertex = triangle[i];
+			unsigned int* begin = &adjacency[adjacencyOffsets[vertex]];
+			unsigned int* end = begin + remainingTriangles[vertex];
+
+			unsigned int* found = std::find(begin, end, (unsigned int)bestTriangle);
+			if (found != end)
+			{
+				std::swap(*found, *(end - 1));
+				remainingTriangles[vertex]--;
+			}
+		}
+
+		// The vertices of the triangle move to the front of the LRU cache
+		newCache.clear();
+		for (size_t i = 0; i < 3; i++)
+		{
+			if (std::find(newCache.begin(), newCache.end(), triangle[i]) == newCache.end())
+			{
+				newCache.push_back(triangle[i]);
+			}
+		}
+		for (const unsigned int vertex : cache)
+		{
+			if (std::find(newCache.begin(), newCache.end(), vertex) == newCache.end())
+			{
+				newCache.push_back(vertex);
+			}
+		}
+
+		// Update the scores of every vertex that was or is in the cache, and of their triangles
+		bestTriangle = -1;
+		float bestScore = -1.f;
+		for (size_t i = 0; i < newCache.size(); i++)
+		{
+			const unsigned int vertex = newCache[i];
+			cachePositions[vertex] = i < OPTIMIZER_CACHE_SIZE ? (int)i : -1;
+
+			const float score = VertexScore(cachePositions[vertex], remainingTriangles[vertex]);
+			const float delta = score - vertexScores[vertex];
+			vertexScores[vertex] = score;
+
+			for (unsigned int j = 0; j < remainingTriangles[vertex]; j++)
+			{
+				const unsigned int adjacent = adjacency[adjacencyOffsets[vertex] + j];
+				triangleScores[adjacent] += delta;
+
+				if (triangleScores[adjacent] > bestScore)
+				{
+					bestScore = triangleScores[adjacent];
+					bestTriangle = (int)adjacent;
+				}
+			}
+		}
+
+		newCache.resize(std::min(newCache.size(), OPTIMIZER_CACHE_SIZE));
+		std::swap(cache, newCache);
+	}
+
+	indices.swap(result);
+}
+
+void MeshOptimizer::OptimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, float threshold)
+{
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	const float meshACMR = AnalyzeVertexCache(indices, vertices.size()).ACMR;
+
+	// A triangle missing its 3 vertices starts a new strip of the cache order, moving it doesn't cost anything
+	std::vector<size_t> clusters;
+	{
+		FifoCache cache(vertices.size());
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			const unsigned int misses = cache.Access(indices[t * 3]) + cache.Access(indices[t * 3 + 1]) + cache.Access(indices[t * 3 + 2]);
+			if (misses == 3 || t == 0)
+			{
+				clusters.push_back(t);
+			}
+		}
+	}
+
+	// Cut the strips further while the cut doesn't make the strip worse than the threshold
+	std::vector<size_t> softClusters;
+	{
+		FifoCache cache(vertices.size());
+		for (size_t c = 0; c < clusters.size(); c++)
+		{
+			const size_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+
+			size_t start = clusters[c];
+			unsigned int misses = 0;
+			cache.Flush();
+			softClusters.push_back(start);
+
+			for (size_t t = start; t < end; t++)
+			{
+				misses += cache.Access(indices[t * 3]) + cache.Access(indices[t * 3 + 1]) + cache.Access(indices[t * 3 + 2]);
+
+				if (t + 1 < end && (float)misses / (t + 1 - start) <= threshold * meshACMR)
+				{
+					start = t + 1;
+					misses = 0;
+					cache.Flush();
+					softClusters.push_back(start);
+				}
+			}
+		}
+	}
+
+	// Area weighted centroid and normal of each cluster, and of the whole mesh
+	struct Cluster
+	{
+		size_t Start;
+		size_t End;
+		float Sort;
+	};
+
+	std::vector<Cluster> sortedClusters(softClusters.size());
+	std::vector<float> centroids(softClusters.size() * 3);
+	std::vector<float> normals(softClusters.size() * 3);
+	float meshCentroid[3] = { 0.f, 0.f, 0.f };
+	float meshArea = 0.f;
+
+	for (size_t c = 0; c < softClusters.size(); c++)
+	{
+		const size_t start = softClusters[c];
+		const size_t end = c + 1 < softClusters.size() ? softClusters[c + 1] : triangleCount;
+
+		float area = 0.f;
+		for (size_t t = start; t < end; t++)
+		{
+			const Vector3& a = vertices[indices[t * 3]].Position;
+			const Vector3& b = vertices[indices[t * 3 + 1]].Position;
+			const Vector3& c0 = vertices[indices[t * 3 + 2]].Position;
+
+			const Vector3 ab = b - a;
+			const Vector3 ac = c0 - a;
+			const float normal[3] = { ab.y * ac.z - ab.z * ac.y, ab.z * ac.x - ab.x * ac.z, ab.x * ac.y - ab.y * ac.x };
+			const float triangleArea = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+			for (size_t k = 0; k < 3; k++)
+			{
+				const float center = (a[k] + b[k] + c0[k]) / 3.f;
+				centroids[c * 3 + k] += center * triangleArea;
+				normals[c * 3 + k] += normal[k];
+				meshCentroid[k] += center * triangleArea;
+			}
+
+			area += triangleArea;
+		}
+
+		for (size_t k = 0; k < 3; k++)
+		{
+			centroids[c * 3 + k] = area > 0.f ? centroids[c * 3 + k] / area : 0.f;
+		}
+
+		meshArea += area;
+		sortedClusters[c] = { start, end, 0.f };
+	}
+
+	for (float& coordinate : meshCentroid)
+	{
+		coordinate = meshArea > 0.f ? coordinate / meshArea : 0.f;
+	}
+
+	// Clusters far along their normal are on the outside of the mesh, they are drawn first to occlude the rest
+	for (size_t c = 0; c < sortedClusters.size(); c++)
+	{
+		const float* normal = &normals[c * 3];
+		const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+		float dot = 0.f;
+		for (size_t k = 0; k < 3; k++)
+		{
+			dot += (centroids[c * 3 + k] - meshCentroid[k]) * normal[k];
+		}
+
+		sortedClusters[c].Sort = length > 0.f ? dot / length : 0.f;
+	}
+
+	std::stable_sort(sortedClusters.begin(), sortedClusters.end(), [](const Cluster& a, const Cluster& b)
+		{
+			return a.Sort > b.Sort;
+		});
+
+	std::vector<unsigned int> result;
+	result.reserve(indices.size());
+	for (const Cluster& cluster : sortedClusters)
+	{
+		result.insert(result.end(), indices.begin() + cluster.Start * 3, indices.begin() + cluster.End * 3);
+	}
+
+	indices.swap(result);
+}
+
+void MeshOptimizer::OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+	constexpr unsigned int UNUSED = ~0u;
+
+	std::vector<unsigned int> remap(vertices.size(), UNUSED);
+	std::vector<Vertex> result;
+	result.reserve(vertices.size());
+
+	for (unsigned int& index : indices)
+	{
+		if (remap[index] == UNUSED)
+		{
+			remap[index] = (unsigned int)result.size();
+			result.push_back(vertices[index]);
+		}
+
+		index = remap[index];
+	}
+
+	vertices.swap(result);
+}
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount)
+{
+	VertexCacheStats stats;
+
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0 || vertexCount == 0)
+	{
+		return stats;
+	}
+
+	FifoCache cache(vertexCount);
+	std::vector<uint8_t> used(vertexCount, 0);
+	size_t misses = 0;
+	size_t usedCount = 0;
+
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		misses += cache.Access(indices[i]);
+
+		if (!used[indices[i]])
+		{
+			used[indices[i]] = 1;
+			usedCount++;
+		}
+	}
+
+	stats.ACMR = (float)misses / triangleCount;
+	stats.ATVR = (float)misses / usedCount;
+	return stats;
+}
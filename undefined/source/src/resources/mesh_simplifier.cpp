@@ -0,0 +1,385 @@
+#include "resources/mesh_simplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+
+#include "resources/mesh.h"
+
+// Cosine between the normals of a triangle before and after a collapse under which the collapse is rejected
+constexpr double MIN_NORMAL_COSINE = 0.2;
+
+/// <summary>
+/// Sum of the squared distances to a set of planes, each plane is weighted by the area of its triangle :
+/// the symmetric matrix A, the vector B and the scalar C give p.A.p + 2 B.p + C
+/// </summary>
+struct Quadric
+{
+	double A00 = 0.0, A01 = 0.0, A02 = 0.0, A11 = 0.0, A12 = 0.0, A22 = 0.0;
+	double B0 = 0.0, B1 = 0.0, B2 = 0.0;
+	double C = 0.0;
+	/// <summary>
+	/// Sum of the weights, divides the result to get a squared distance
+	/// </summary>
+	double Weight = 0.0;
+
+	void AddPlane(double a, double b, double c, double d, double weight)
+	{
+		A00 += weight * a * a; A01 += weight * a * b; A02 += weight * a * c;
+		A11 += weight * b * b; A12 += weight * b * c; A22 += weight * c * c;
+		B0 += weight * a * d; B1 += weight * b * d; B2 += weight * c * d;
+		C += weight * d * d;
+		Weight += weight;
+	}
+
+	void Add(const Quadric& other)
+	{
+		A00 += other.A00; A01 += other.A01; A02 += other.A02;
+		A11 += other.A11; A12 += other.A12; A22 += other.A22;
+		B0 += other.B0; B1 += other.B1; B2 += other.B2;
+		C += other.C;
+		Weight += other.Weight;
+	}
+
+	double Evaluate(double x, double y, double z) const
+	{
+		const double result = A00 * x * x + 2.0 * A01 * x * y + 2.0 * A02 * x * z + A11 * y * y + 2.0 * A12 * y * z + A22 * z * z
+			+ 2.0 * (B0 * x + B1 * y + B2 * z) + C;
+
+		// Rounding can give a tiny negative value on a flat area
+		return std::max(result, 0.0) / std::max(Weight, 1e-12);
+	}
+};
+
+/// <summary>
+/// Cross product of (b - a) and (c - a)
+/// </summary>
+static void TriangleNormal(const Vector3& a, const Vector3& b, const Vector3& c, double normal[3])
+{
+	const double ab[3] = { (double)b.x - a.x, (double)b.y - a.y, (double)b.z - a.z };
+	const double ac[3] = { (double)c.x - a.x, (double)c.y - a.y, (double)c.z - a.z };
+
+	normal[0] = ab[1] * ac[2] - ab[2] * ac[1];
+	normal[1] = ab[2] * ac[0] - ab[0] * ac[2];
+	normal[2] = ab[0] * ac[1] - ab[1] * ac[0];
+}
+
+float MeshSimplifier::Simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, size_t targetIndexCount, float maxError,
+	std::vector<unsigned int>& result)
+{
+	result = indices;
+
+	const size_t vertexCount = vertices.size();
+	if (result.size() <= targetIndexCount || vertexCount == 0)
+	{
+		return 0.f;
+	}
+
+	// Vertices split by their normals or UVs share a position, the position is the unit moved by the collapses :
+	// positionOf gives its first vertex and the vertices of a position are linked in a loop by nextWedge
+	std::vector<unsigned int> order(vertexCount);
+	std::iota(order.begin(), order.end(), 0u);
+	std::sort(order.begin(), order.end(), [&vertices](unsigned int a, unsigned int b)
+		{
+			const Vector3& pa = vertices[a].Position;
+			const Vector3& pb = vertices[b].Position;
+			return pa.x != pb.x ? pa.x < pb.x : pa.y != pb.y ? pa.y < pb.y : pa.z < pb.z;
+		});
+
+	std::vector<unsigned int> positionOf(vertexCount);
+	std::vector<unsigned int> nextWedge(vertexCount);
+	for (size_t first = 0; first < vertexCount;)
+	{
+		const Vector3& position = vertices[order[first]].Position;
+
+		size_t last = first + 1;
+		while (last < vertexCount && vertices[order[last]].Position.x == position.x && vertices[order[last]].Position.y == position.y
+			&& vertices[order[last]].Position.z == position.z)
+		{
+			last++;
+		}
+
+		for (size_t i = first; i < last; i++)
+		{
+			positionOf[order[i]] = order[first];
+			nextWedge[order[i]] = order[i + 1 < last ? i + 1 : first];
+		}
+
+		first = last;
+	}
+
+	// Planes of the triangles around each position
+	std::vector<Quadric> quadrics(vertexCount);
+	for (size_t i = 0; i + 2 < result.size(); i += 3)
+	{
+		const unsigned int p0 = positionOf[result[i]];
+		const unsigned int p1 = positionOf[result[i + 1]];
+		const unsigned int p2 = positionOf[result[i + 2]];
+
+		double normal[3];
+		TriangleNormal(vertices[p0].Position, vertices[p1].Position, vertices[p2].Position, normal);
+
+		const double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length <= 0.0)
+		{
+			continue;
+		}
+
+		const double a = normal[0] / length;
+		const double b = normal[1] / length;
+		const double c = normal[2] / length;
+		const double d = -(a * vertices[p0].Position.x + b * vertices[p0].Position.y + c * vertices[p0].Position.z);
+
+		for (const unsigned int p : { p0, p1, p2 })
+		{
+			quadrics[p].AddPlane(a, b, c, d, length * 0.5);
+		}
+	}
+
+	// An edge used by a single triangle is on an open border, its positions never move
+	std::vector<uint8_t> locked(vertexCount, 0);
+	{
+		std::vector<uint64_t> edges;
+		edges.reserve(result.size());
+		for (size_t i = 0; i < result.size(); i++)
+		{
+			const uint64_t a = positionOf[result[i]];
+			const uint64_t b = positionOf[result[i % 3 == 2 ? i - 2 : i + 1]];
+			edges.push_back(std::min(a, b) << 32 | std::max(a, b));
+		}
+
+		std::sort(edges.begin(), edges.end());
+		for (size_t first = 0; first < edges.size();)
+		{
+			size_t last = first + 1;
+			while (last < edges.size() && edges[last] == edges[first])
+			{
+				last++;
+			}
+
+			if (last - first == 1)
+			{
+				locked[edges[first] >> 32] = 1;
+				locked[edges[first] & 0xFFFFFFFF] = 1;
+			}
+
+			first = last;
+		}
+	}
+
+	struct Collapse
+	{
+		unsigned int From;
+		unsigned int To;
+		double Cost;
+	};
+
+	const double maxCost = (double)maxError * maxError;
+	double resultCost = 0.0;
+
+	std::vector<Collapse> collapses;
+	std::vector<unsigned int> collapseTarget(vertexCount);
+	std::vector<uint8_t> touched(vertexCount);
+	std::vector<unsigned int> triangleOffsets(vertexCount + 1);
+	std::vector<unsigned int> triangles;
+
+	// Each pass collapses the cheapest edges whose neighbourhoods don't overlap, then rebuilds the triangles
+	while (result.size() > targetIndexCount)
+	{
+		const size_t triangleCount = result.size() / 3;
+
+		// Triangles around each position
+		std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0u);
+		for (const unsigned int index : result)
+		{
+			triangleOffsets[positionOf[index] + 1]++;
+		}
+		std::partial_sum(triangleOffsets.begin(), triangleOffsets.end(), triangleOffsets.begin());
+
+		triangles.resize(result.size());
+		std::vector<unsigned int> cursor(triangleOffsets.begin(), triangleOffsets.end() - 1);
+		for (size_t i = 0; i < result.size(); i++)
+		{
+			triangles[cursor[positionOf[result[i]]]++] = (unsigned int)(i / 3);
+		}
+
+		// Every edge in both directions, an inner edge is seen once with a < b
+		collapses.clear();
+		for (size_t i = 0; i < result.size(); i++)
+		{
+			const unsigned int a = positionOf[result[i]];
+			const unsigned int b = positionOf[result[i % 3 == 2 ? i - 2 : i + 1]];
+
+			if (a >= b)
+			{
+				continue;
+			}
+
+			for (const std::pair<unsigned int, unsigned int>& edge : { std::make_pair(a, b), std::make_pair(b, a) })
+			{
+				if (locked[edge.first])
+				{
+					continue;
+				}
+
+				Quadric quadric = quadrics[edge.first];
+				quadric.Add(quadrics[edge.second]);
+
+				const Vector3& target = vertices[edge.second].Position;
+				collapses.push_back({ edge.first, edge.second, quadric.Evaluate(target.x, target.y, target.z) });
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.Cost < b.Cost; });
+
+		std::iota(collapseTarget.begin(), collapseTarget.end(), 0u);
+		std::fill(touched.begin(), touched.end(), (uint8_t)0);
+
+		const size_t goal = (result.size() - targetIndexCount + 2) / 3;
+		size_t removed = 0;
+
+		for (const Collapse& collapse : collapses)
+		{
+			if (collapse.Cost > maxCost || removed >= goal)
+			{
+				break;
+			}
+
+			if (touched[collapse.From] || touched[collapse.To])
+			{
+				continue;
+			}
+
+			// Reject the collapse if a remaining triangle around From would flip or become a sliver
+			const Vector3& target = vertices[collapse.To].Position;
+			bool isValid = true;
+			size_t shared = 0;
+
+			for (unsigned int t = triangleOffsets[collapse.From]; t < triangleOffsets[collapse.From + 1] && isValid; t++)
+			{
+				const unsigned int* corners = &result[triangles[t] * 3];
+				const unsigned int p[3] = { positionOf[corners[0]], positionOf[corners[1]], positionOf[corners[2]] };
+
+				if (p[0] == collapse.To || p[1] == collapse.To || p[2] == collapse.To)
+				{
+					shared++;
+					continue;
+				}
+
+				double before[3];
+				double after[3];
+				TriangleNormal(vertices[p[0]].Position, vertices[p[1]].Position, vertices[p[2]].Position, before);
+				TriangleNormal(p[0] == collapse.From ? target : vertices[p[0]].Position, p[1] == collapse.From ? target : vertices[p[1]].Position,
+					p[2] == collapse.From ? target : vertices[p[2]].Position, after);
+
+				const double dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+				const double lengths = std::sqrt((before[0] * before[0] + before[1] * before[1] + before[2] * before[2])
+					* (after[0] * after[0] + after[1] * after[1] + after[2] * after[2]));
+
+				isValid = dot > MIN_NORMAL_COSINE * lengths;
+			}
+
+			if (!isValid || shared == 0)
+			{
+				continue;
+			}
+
+			collapseTarget[collapse.From] = collapse.To;
+			quadrics[collapse.To].Add(quadrics[collapse.From]);
+			resultCost = std::max(resultCost, collapse.Cost);
+			removed += shared;
+
+			// The one ring of From changes, nothing else may move around it during this pass
+			for (unsigned int t = triangleOffsets[collapse.From]; t < triangleOffsets[collapse.From + 1]; t++)
+			{
+				for (unsigned int corner = 0; corner < 3; corner++)
+				{
+					touched[positionOf[result[triangles[t] * 3 + corner]]] = 1;
+				}
+			}
+		}
+
+		if (removed == 0)
+		{
+			break;
+		}
+
+		// Each corner of a collapsed position takes the vertex of the target position with the closest attributes
+		for (unsigned int& index : result)
+		{
+			const unsigned int target = collapseTarget[positionOf[index]];
+			if (target == positionOf[index])
+			{
+				continue;
+			}
+
+			const Vertex& source = vertices[index];
+			unsigned int best = target;
+			float bestDistance = std::numeric_limits<float>::max();
+
+			unsigned int wedge = target;
+			do
+			{
+				const Vertex& candidate = vertices[wedge];
+				const float distance = (candidate.Normal - source.Normal).SquaredNorm()
+					+ (candidate.TexCoords.x - source.TexCoords.x) * (candidate.TexCoords.x - source.TexCoords.x)
+					+ (candidate.TexCoords.y - source.TexCoords.y) * (candidate.TexCoords.y - source.TexCoords.y);
+
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					best = wedge;
+				}
+
+				wedge = nextWedge[wedge];
+			} while (wedge != target);
+
+			index = best;
+		}
+
+		// Drop the triangles that lost an edge
+		size_t write = 0;
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			const unsigned int a = result[t * 3];
+			const unsigned int b = result[t * 3 + 1];
+			const unsigned int c = result[t * 3 + 2];
+
+			if (positionOf[a] == positionOf[b] || positionOf[b] == positionOf[c] || positionOf[a] == positionOf[c])
+			{
+				continue;
+			}
+
+			result[write++] = a;
+			result[write++] = b;
+			result[write++] = c;
+		}
+		result.resize(write);
+	}
+
+	return (float)std::sqrt(resultCost);
+}
+
+void MeshSimplifier::CompactVertices(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+	std::vector<Vertex>& resultVertices, std::vector<unsigned int>& resultIndices)
+{
+	constexpr unsigned int unused = std::numeric_limits<unsigned int>::max();
+	std::vector<unsigned int> remap(vertices.size(), unused);
+
+	resultVertices.clear();
+	resultIndices.resize(indices.size());
+
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		unsigned int& newIndex = remap[indices[i]];
+		if (newIndex == unused)
+		{
+			newIndex = (unsigned int)resultVertices.size();
+			resultVertices.push_back(vertices[indices[i]]);
+		}
+
+		resultIndices[i] = newIndex;
+	}
+}
@@ -1,13 +1,105 @@
 #include "resources/model.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
 #include <iostream>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 
+#include "resources/mesh_optimizer.h"
+#include "resources/mesh_simplifier.h"
 #include "resources/resource_manager.h"
 
 #include "service_locator.h"
 
+#include "wrapper/render_queue.h"
+
+// Header of the .lod files, the version changes when the layout or the simplification changes
+constexpr uint32_t LOD_CACHE_MAGIC = 0x444F4C55; // "ULOD"
+constexpr uint32_t LOD_CACHE_VERSION = 2;
+
+// Import options stored in the .lod files, the optimizations change the vertices indexed by the levels
+constexpr uint32_t LOD_CACHE_OPTIMIZED = 1 << 0;
+constexpr uint32_t LOD_CACHE_OVERDRAW = 1 << 1;
+
+// Levels generated after the mesh itself, each one aims at half the triangles of the previous
+constexpr size_t LOD_MAX_LEVELS = 4;
+// Meshes with fewer triangles are cheap enough without levels
+constexpr size_t LOD_MIN_TRIANGLES = 256;
+// A level is dropped when it doesn't remove at least 10% of the triangles of the previous one
+constexpr float LOD_MIN_REDUCTION = 0.9f;
+// Biggest error of a level, relative to the radius of the mesh
+constexpr float LOD_MAX_RELATIVE_ERROR = 0.05f;
+
+/// <summary>
+/// Levels of detail of a mesh : the triangles of each level index the vertices of the mesh
+/// </summary>
+struct LodChain
+{
+    std::vector<std::vector<unsigned int>> Indices;
+    std::vector<float> Errors;
+};
+
+/// <summary>
+/// Simplify a mesh level after level, each level starts from the previous one so the errors add up
+/// </summary>
+static LodChain GenerateLodChain(const Mesh& mesh)
+{
+    LodChain chain;
+
+    if (mesh.Indices.size() / 3 < LOD_MIN_TRIANGLES)
+    {
+        return chain;
+    }
+
+    const float maxError = mesh.GetBoundingSphere().Radius * LOD_MAX_RELATIVE_ERROR;
+    const std::vector<unsigned int>* previous = &mesh.Indices;
+    float error = 0.f;
+
+    while (chain.Indices.size() < LOD_MAX_LEVELS && previous->size() / 3 >= LOD_MIN_TRIANGLES / 2 && error < maxError)
+    {
+        std::vector<unsigned int> indices;
+        const float levelError = MeshSimplifier::Simplify(mesh.Vertices, *previous, previous->size() / 6 * 3, maxError - error, indices);
+
+        if (indices.empty() || indices.size() > previous->size() * LOD_MIN_REDUCTION)
+        {
+            break;
+        }
+
+        error += levelError;
+        chain.Indices.push_back(std::move(indices));
+        chain.Errors.push_back(error);
+        previous = &chain.Indices.back();
+    }
+
+    return chain;
+}
+
+/// <summary>
+/// Get the size and the last write time of the model, a cache made for another version of the file is ignored
+/// </summary>
+static void GetSourceStamp(const std::string& path, uint64_t& size, int64_t& time)
+{
+    std::error_code error;
+    size = (uint64_t)std::filesystem::file_size(path, error);
+    time = (int64_t)std::filesystem::last_write_time(path, error).time_since_epoch().count();
+}
+
+template<class T>
+static bool ReadValue(std::ifstream& file, T& value)
+{
+    return (bool)file.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+template<class T>
+static void WriteValue(std::ofstream& file, const T& value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
 Model::Model()
 {
     Init();
@@ -24,54 +116,67 @@ void Model::Init()
 {
     mRenderer = ServiceLocator::Get<Renderer>();
 
-    mRenderer->GenerateVertexArray(1, &mVAO);
-    mRenderer->GenerateBuffer(1, &mVBO);
-    mRenderer->GenerateBuffer(1, &mEBO);
-
-    mRenderer->BindBuffers(mVAO, mVBO, mEBO);
-
-    // vertex positions
-    mRenderer->AttributePointers(0, 3, GL_FLOAT, sizeof(Vertex), (void*)0);
-
-    // vertex normals
-    mRenderer->AttributePointers(1, 3, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+    for (std::pair<std::shared_ptr<Mesh>, std::shared_ptr<Material>>& pair : mModel)
+    {
+        if (PackVerticesOnLoad && !pair.first->IsUploaded())
+        {
+            pair.first->SetVertexFormat(VertexFormat::Packed);
+        }
 
-    // vertex texture coords
-    mRenderer->AttributePointers(2, 2, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+        pair.first->Upload();
+    }
 
-    mRenderer->BindBuffers(0, 0, 0);
+    if (ReleaseCPUDataOnLoad)
+    {
+        ReleaseCPUData();
+    }
 }
 
-bool Model::IsValid()
+void Model::ReleaseCPUData()
 {
-    return (mVAO != 00 && mVBO != 0 && mEBO != 0);
+    for (std::pair<std::shared_ptr<Mesh>, std::shared_ptr<Material>>& pair : mModel)
+    {
+        if (pair.first->IsUploaded())
+        {
+            pair.first->ReleaseCPUData();
+        }
+    }
 }
 
-void Model::Draw(const Matrix4x4& TRS)
+bool Model::IsValid()
 {
-    mRenderer->BindBuffers(mVAO, mVBO, mEBO);
-
-    for (std::pair<std::shared_ptr<Mesh>, std::shared_ptr<Material>> pair : mModel)
+    if (mModel.empty())
     {
-        mRenderer->UseShader(pair.second->MatShader->ID);
-        mRenderer->SetUniform(pair.second->MatShader->ID, "model", TRS);
-        mRenderer->SetBufferData(GL_ARRAY_BUFFER, (int)pair.first->Vertices.size() * sizeof(Vertex), &pair.first->Vertices[0], GL_STATIC_DRAW);
-        mRenderer->SetBufferData(GL_ELEMENT_ARRAY_BUFFER, (int)pair.first->Indices.size() * sizeof(unsigned int), &pair.first->Indices[0], GL_STATIC_DRAW);
+        return false;
+    }
 
-        if (pair.second->MatTex)
+    for (const std::pair<std::shared_ptr<Mesh>, std::shared_ptr<Material>>& pair : mModel)
+    {
+        if (!pair.first->IsUploaded())
         {
-            mRenderer->BindTexture(pair.second->MatTex->GetID());
+            return false;
         }
-        else
+    }
+
+    return true;
+}
+
+void Model::Draw(const Matrix4x4& TRS, const std::vector<BoundingBox>& worldBoxes, const std::vector<uint8_t>& lods)
+{
+    for (size_t i = 0; i < mModel.size(); i++)
+    {
+        const std::pair<std::shared_ptr<Mesh>, std::shared_ptr<Material>>& pair = mModel[i];
+
+        if (!pair.first->IsUploaded())
         {
-            mRenderer->BindTexture(ResourceManager::Get<Texture>("assets/missing_texture.jpg")->GetID());
+            continue;
         }
-        mRenderer->Draw(GL_TRIANGLES, (GLsizei)pair.first->Indices.size(), GL_UNSIGNED_INT, 0);
-        mRenderer->UnUseShader();
+
+        const unsigned int textureID = pair.second->MatTex ? pair.second->MatTex->GetID() : ResourceManager::Get<Texture>("assets/missing_texture.jpg")->GetID();
+
+        // The bounds of the level 0 contain the simplified meshes, their vertices are a part of its vertices
+        RenderQueue::Submit(pair.second->MatShader.get(), textureID, pair.first->GetLod(lods[i]), TRS, worldBoxes[i]);
     }
-    
-    mRenderer->BindBuffers(0, 0, 0);
-    mRenderer->BindTexture(0);
 }
 
 void Model::SetTexture(int index, std::shared_ptr<Texture> tex)
@@ -91,6 +196,16 @@ void Model::LoadModel(const std::string& path)
     }
 
     ProcessNode(scene->mRootNode, scene);
+
+    if (OptimizeMeshesOnLoad)
+    {
+        OptimizeMeshes(path);
+    }
+
+    if (GenerateLodsOnLoad)
+    {
+        LoadLods(path);
+    }
 }
 
 void Model::ProcessNode(aiNode* node, const aiScene* scene)
@@ -99,7 +214,7 @@ void Model::ProcessNode(aiNode* node, const aiScene* scene)
     for (unsigned int i = 0; i < node->mNumMeshes; i++)
     {
         aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-        mModel.push_back(std::make_pair<std::shared_ptr<Mesh>, std::shared_ptr<Material>>(std::make_shared<Mesh>(ProcessMesh(mesh)), std::make_shared<Material>(nullptr)));
+        mModel.push_back(std::make_pair<std::shared_ptr<Mesh>, std::shared_ptr<Material>>(ProcessMesh(mesh), std::make_shared<Material>(nullptr)));
     }
     // then do the same for each of its children
     for (unsigned int i = 0; i < node->mNumChildren; i++)
@@ -108,11 +223,15 @@ void Model::ProcessNode(aiNode* node, const aiScene* scene)
     }
 }
 
-Mesh Model::ProcessMesh(aiMesh* mesh)
+std::shared_ptr<Mesh> Model::ProcessMesh(aiMesh* mesh)
 {
     std::vector<Vertex> Vertices;
     std::vector<unsigned int> Indices;
 
+    // assimp triangulates every face
+    Vertices.reserve(mesh->mNumVertices);
+    Indices.reserve((size_t)mesh->mNumFaces * 3);
+
     for (unsigned int i = 0; i < mesh->mNumVertices; i++)
     {
         Vertex vertex;
@@ -153,5 +272,169 @@ Mesh Model::ProcessMesh(aiMesh* mesh)
         }
     }
 
-    return Mesh(Vertices, Indices);
-}
\ No newline at end of file
+    return std::make_shared<Mesh>(std::move(Vertices), std::move(Indices));
+}
+
+void Model::OptimizeMeshes(const std::string& path)
+{
+    // Ratios of the whole model, weighted by the triangles (ACMR) and the vertices (ATVR) of each mesh
+    double trianglesBefore = 0.0, trianglesAfter = 0.0, acmrBefore = 0.0, acmrAfter = 0.0;
+    double verticesBefore = 0.0, verticesAfter = 0.0, atvrBefore = 0.0, atvrAfter = 0.0;
+
+    for (std::pair<std::shared_ptr<Mesh>, std::shared_ptr<Material>>& pair : mModel)
+    {
+        Mesh& mesh = *pair.first;
+
+        const VertexCacheStats before = MeshOptimizer::AnalyzeVertexCache(mesh.Indices, mesh.Vertices.size());
+        trianglesBefore += mesh.Indices.size() / 3;
+        verticesBefore += mesh.Vertices.size();
+        acmrBefore += before.ACMR * (mesh.Indices.size() / 3);
+        atvrBefore += before.ATVR * mesh.Vertices.size();
+
+        MeshOptimizer::Optimize(mesh.Vertices, mesh.Indices, OptimizeOverdrawOnLoad);
+
+        const VertexCacheStats after = MeshOptimizer::AnalyzeVertexCache(mesh.Indices, mesh.Vertices.size());
+        trianglesAfter += mesh.Indices.size() / 3;
+        verticesAfter += mesh.Vertices.size();
+        acmrAfter += after.ACMR * (mesh.Indices.size() / 3);
+        atvrAfter += after.ATVR * mesh.Vertices.size();
+    }
+
+    if (trianglesBefore == 0.0)
+    {
+        return;
+    }
+
+    Logger::Info("Model::OptimizeMeshes() {} : {} -> {} vertices, ACMR {} -> {}, ATVR {} -> {}", path, (size_t)verticesBefore, (size_t)verticesAfter,
+        std::format("{:.3f}", acmrBefore / trianglesBefore), std::format("{:.3f}", acmrAfter / std::max(trianglesAfter, 1.0)),
+        std::format("{:.3f}", atvrBefore / std::max(verticesBefore, 1.0)), std::format("{:.3f}", atvrAfter / std::max(verticesAfter, 1.0)));
+}
+
+void Model::LoadLods(const std::string& path)
+{
+    const std::string cachePath = path + ".lod";
+
+    uint64_t sourceSize = 0;
+    int64_t sourceTime = 0;
+    GetSourceStamp(path, sourceSize, sourceTime);
+
+    uint32_t importFlags = 0;
+    if (OptimizeMeshesOnLoad)
+    {
+        importFlags |= LOD_CACHE_OPTIMIZED;
+        importFlags |= OptimizeOverdrawOnLoad ? LOD_CACHE_OVERDRAW : 0;
+    }
+
+    std::vector<LodChain> chains(mModel.size());
+    bool isCached = false;
+
+    std::ifstream input(cachePath, std::ios::binary);
+    if (input)
+    {
+        uint32_t magic = 0, version = 0, flags = 0, meshCount = 0;
+        uint64_t size = 0;
+        int64_t time = 0;
+        isCached = ReadValue(input, magic) && ReadValue(input, version) && ReadValue(input, size) && ReadValue(input, time) && ReadValue(input, flags)
+            && ReadValue(input, meshCount) && magic == LOD_CACHE_MAGIC && version == LOD_CACHE_VERSION && size == sourceSize && time == sourceTime
+            && flags == importFlags && meshCount == mModel.size();
+
+        for (size_t i = 0; isCached && i < mModel.size(); i++)
+        {
+            const Mesh& mesh = *mModel[i].first;
+
+            uint32_t vertexCount = 0, indexCount = 0, lodCount = 0;
+            isCached = ReadValue(input, vertexCount) && ReadValue(input, indexCount) && ReadValue(input, lodCount)
+                && vertexCount == mesh.Vertices.size() && indexCount == mesh.Indices.size() && lodCount <= LOD_MAX_LEVELS;
+
+            for (uint32_t level = 0; isCached && level < lodCount; level++)
+            {
+                float error = 0.f;
+                uint32_t levelIndexCount = 0;
+                isCached = ReadValue(input, error) && ReadValue(input, levelIndexCount) && levelIndexCount <= indexCount;
+                if (!isCached)
+                {
+                    break;
+                }
+
+                std::vector<unsigned int>& indices = chains[i].Indices.emplace_back(levelIndexCount);
+                isCached = (bool)input.read(reinterpret_cast<char*>(indices.data()), levelIndexCount * sizeof(unsigned int));
+                chains[i].Errors.push_back(error);
+
+                for (size_t j = 0; isCached && j < indices.size(); j++)
+                {
+                    isCached = indices[j] < vertexCount;
+                }
+            }
+        }
+        input.close();
+    }
+
+    if (isCached)
+    {
+        Logger::Info("Model::LoadLods() levels of detail read from {}", cachePath);
+    }
+    else
+    {
+        for (size_t i = 0; i < mModel.size(); i++)
+        {
+            chains[i] = GenerateLodChain(*mModel[i].first);
+        }
+
+        std::ofstream output(cachePath, std::ios::binary | std::ios::trunc);
+        if (output)
+        {
+            WriteValue(output, LOD_CACHE_MAGIC);
+            WriteValue(output, LOD_CACHE_VERSION);
+            WriteValue(output, sourceSize);
+            WriteValue(output, sourceTime);
+            WriteValue(output, importFlags);
+            WriteValue(output, (uint32_t)mModel.size());
+
+            for (size_t i = 0; i < mModel.size(); i++)
+            {
+                WriteValue(output, (uint32_t)mModel[i].first->Vertices.size());
+                WriteValue(output, (uint32_t)mModel[i].first->Indices.size());
+                WriteValue(output, (uint32_t)chains[i].Indices.size());
+
+                for (size_t level = 0; level < chains[i].Indices.size(); level++)
+                {
+                    WriteValue(output, chains[i].Errors[level]);
+                    WriteValue(output, (uint32_t)chains[i].Indices[level].size());
+                    output.write(reinterpret_cast<const char*>(chains[i].Indices[level].data()), chains[i].Indices[level].size() * sizeof(unsigned int));
+                }
+            }
+        }
+
+        if (!output)
+        {
+            Logger::Warning("Model::LoadLods() can't write {}, the levels of detail will be generated again", cachePath);
+        }
+        else
+        {
+            Logger::Info("Model::LoadLods() levels of detail generated for {}", path);
+        }
+    }
+
+    // Each level keeps only the vertices it uses, in the order of the vertex cache
+    for (size_t i = 0; i < mModel.size(); i++)
+    {
+        const Mesh& mesh = *mModel[i].first;
+
+        std::vector<std::shared_ptr<Mesh>> lods;
+        for (std::vector<unsigned int>& indices : chains[i].Indices)
+        {
+            if (OptimizeMeshesOnLoad)
+            {
+                MeshOptimizer::OptimizeVertexCache(indices, mesh.Vertices.size());
+            }
+
+            std::vector<Vertex> lodVertices;
+            std::vector<unsigned int> lodIndices;
+            MeshSimplifier::CompactVertices(mesh.Vertices, indices, lodVertices, lodIndices);
+
+            lods.push_back(std::make_shared<Mesh>(std::move(lodVertices), std::move(lodIndices)));
+        }
+
+        mModel[i].first->SetLods(std::move(lods), std::move(chains[i].Errors));
+    }
+}
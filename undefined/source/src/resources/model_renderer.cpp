@@ -1,17 +1,230 @@
 #include "resources/model_renderer.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "resources/model.h"
+#include "resources/texture_streamer.h"
 
 #include "imgui/imgui.h"
 
+#include "wrapper/render_queue.h"
+
 ModelRenderer::ModelRenderer()
 {
 }
 
 void ModelRenderer::Draw()
 {
-	if (ModelObject)
+	if (!ModelObject)
+	{
+		return;
+	}
+
+	const Matrix4x4& TRS = GameTransform->WorldMatrix();
+	UpdateWorldBounds(TRS);
+	UpdatePixelsPerUnit();
+
+	std::vector<uint8_t>& lods = mLods[RenderQueue::GetCamera()];
+	SelectLods(lods);
+	RequestTextureLevels();
+
+	ModelObject->Draw(TRS, mWorldBoxes, lods);
+}
+
+bool ModelRenderer::GetWorldBounds(BoundingBox& box)
+{
+	if (!ModelObject)
+	{
+		return false;
+	}
+
+	UpdateWorldBounds(GameTransform->WorldMatrix());
+
+	if (mWorldBoxes.empty())
+	{
+		return false;
+	}
+
+	box = mWorldBoxes[0];
+	for (size_t i = 1; i < mWorldBoxes.size(); i++)
+	{
+		box = BoundingBox::Merge(box, mWorldBoxes[i]);
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Moller-Trumbore intersection of a ray with a triangle, both faces are hit
+/// </summary>
+static bool IntersectTriangle(const Vector3& origin, const Vector3& direction, const Vector3& a, const Vector3& b, const Vector3& c, float& distance)
+{
+	const Vector3 edge1 = b - a;
+	const Vector3 edge2 = c - a;
+	const Vector3 p = Vector3::Cross(direction, edge2);
+	const float determinant = Vector3::Dot(edge1, p);
+
+	// Ray parallel to the triangle
+	if (std::abs(determinant) < 1e-8f)
+	{
+		return false;
+	}
+
+	const float inverseDeterminant = 1.f / determinant;
+	const Vector3 s = origin - a;
+	const float u = Vector3::Dot(s, p) * inverseDeterminant;
+	if (u < 0.f || u > 1.f)
+	{
+		return false;
+	}
+
+	const Vector3 q = Vector3::Cross(s, edge1);
+	const float v = Vector3::Dot(direction, q) * inverseDeterminant;
+	if (v < 0.f || u + v > 1.f)
+	{
+		return false;
+	}
+
+	distance = Vector3::Dot(edge2, q) * inverseDeterminant;
+	return distance >= 0.f;
+}
+
+bool ModelRenderer::RayCast(const Vector3& origin, const Vector3& direction, float maxDistance, float& distance)
+{
+	if (!ModelObject)
 	{
-		ModelObject->Draw(GameTransform->WorldMatrix());
+		return false;
+	}
+
+	const Matrix4x4& TRS = GameTransform->WorldMatrix();
+	UpdateWorldBounds(TRS);
+
+	// The triangles are intersected in the space of the model, the direction isn't normalized again so the distances stay in world units
+	const Matrix4x4 inverseTRS = Matrix4x4::Inverse(TRS);
+	const Vector4 localOrigin = inverseTRS * Vector4(origin.x, origin.y, origin.z, 1.f);
+	const Vector4 localDirection = inverseTRS * Vector4(direction.x, direction.y, direction.z, 0.f);
+	const Vector3 rayOrigin(localOrigin.x, localOrigin.y, localOrigin.z);
+	const Vector3 rayDirection(localDirection.x, localDirection.y, localDirection.z);
+	const Vector3 inverseDirection(1.f / direction.x, 1.f / direction.y, 1.f / direction.z);
+
+	bool isHit = false;
+	for (size_t i = 0; i < ModelObject->mModel.size(); i++)
+	{
+		float boxDistance = 0.f;
+		if (!mWorldBoxes[i].IntersectsRay(origin, inverseDirection, maxDistance, boxDistance))
+		{
+			continue;
+		}
+
+		const Mesh& mesh = *ModelObject->mModel[i].first;
+		if (mesh.Indices.empty() || mesh.Vertices.empty())
+		{
+			maxDistance = boxDistance;
+			isHit = true;
+			continue;
+		}
+
+		for (size_t index = 0; index + 2 < mesh.Indices.size(); index += 3)
+		{
+			float hitDistance = 0.f;
+			if (IntersectTriangle(rayOrigin, rayDirection, mesh.Vertices[mesh.Indices[index]].Position, mesh.Vertices[mesh.Indices[index + 1]].Position,
+				mesh.Vertices[mesh.Indices[index + 2]].Position, hitDistance) && hitDistance < maxDistance)
+			{
+				maxDistance = hitDistance;
+				isHit = true;
+			}
+		}
+	}
+
+	distance = maxDistance;
+	return isHit;
+}
+
+void ModelRenderer::UpdateWorldBounds(const Matrix4x4& TRS)
+{
+	// The bounds only follow the Transform when it has moved since they were computed
+	if (mBoundsModel == ModelObject.get() && mBoundsVersion == GameTransform->GetVersion() && mWorldBoxes.size() == ModelObject->mModel.size())
+	{
+		return;
+	}
+
+	mWorldBoxes.resize(ModelObject->mModel.size());
+	mWorldSpheres.resize(ModelObject->mModel.size());
+
+	for (size_t i = 0; i < ModelObject->mModel.size(); i++)
+	{
+		const Mesh& mesh = *ModelObject->mModel[i].first;
+
+		mWorldBoxes[i] = mesh.GetBoundingBox().Transformed(TRS);
+		mWorldSpheres[i] = mesh.GetBoundingSphere().Transformed(TRS);
+	}
+
+	mBoundsModel = ModelObject.get();
+	mBoundsVersion = GameTransform->GetVersion();
+}
+
+void ModelRenderer::SelectLods(std::vector<uint8_t>& lods)
+{
+	lods.resize(ModelObject->mModel.size(), 0);
+
+	for (size_t i = 0; i < ModelObject->mModel.size(); i++)
+	{
+		const Mesh& mesh = *ModelObject->mModel[i].first;
+		const size_t lodCount = mesh.GetLodCount();
+
+		if (!UseLods || lodCount == 1)
+		{
+			lods[i] = 0;
+			continue;
+		}
+
+		const float pixelsPerUnit = mPixelsPerUnit[i];
+
+		// A level is entered under the threshold minus the hysteresis and left above the threshold plus the hysteresis
+		size_t lod = std::min((size_t)lods[i], lodCount - 1);
+		while (lod + 1 < lodCount && mesh.GetLodError(lod + 1) * pixelsPerUnit <= LodPixelError * (1.f - LodHysteresis))
+		{
+			lod++;
+		}
+		while (lod > 0 && mesh.GetLodError(lod) * pixelsPerUnit > LodPixelError * (1.f + LodHysteresis))
+		{
+			lod--;
+		}
+
+		lods[i] = (uint8_t)lod;
+	}
+}
+
+void ModelRenderer::RequestTextureLevels()
+{
+	for (size_t i = 0; i < ModelObject->mModel.size(); i++)
+	{
+		const std::shared_ptr<Texture>& texture = ModelObject->mModel[i].second->MatTex;
+		if (!texture || !texture->IsStreamable())
+		{
+			continue;
+		}
+
+		const Mesh& mesh = *ModelObject->mModel[i].first;
+		texture->RequestLevel(TextureStreamer::ComputeLevel(texture->GetWidth(), mesh.GetUvDensity(), mPixelsPerUnit[i]));
+	}
+}
+
+void ModelRenderer::UpdatePixelsPerUnit()
+{
+	mPixelsPerUnit.resize(ModelObject->mModel.size());
+
+	for (size_t i = 0; i < ModelObject->mModel.size(); i++)
+	{
+		const Mesh& mesh = *ModelObject->mModel[i].first;
+
+		// The errors and the UV density are in the space of the mesh, the ratio of the sphere radii gives the scale of the Transform
+		const float localRadius = mesh.GetBoundingSphere().Radius;
+		const float scale = localRadius > 0.f ? mWorldSpheres[i].Radius / localRadius : 1.f;
+
+		// The nearest point of the mesh needs the finest level
+		const float distance = std::max((mWorldSpheres[i].Center - RenderQueue::GetEye()).Norm() - mWorldSpheres[i].Radius, 0.f);
+		mPixelsPerUnit[i] = RenderQueue::GetPixelsPerUnit(distance) * scale;
 	}
 }
@@ -0,0 +1,157 @@
+#include "resources/program_cache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+
+#include "service_locator.h"
+
+#include "engine_debug/logger.h"
+
+// Header of the .ubin files, followed by the binary
+constexpr char PROGRAM_IDENTIFIER[8] = { 'U', 'P', 'R', 'G', '\r', '\n', '\x1A', '\n' };
+// Changes when the layout of the file changes
+constexpr uint32_t PROGRAM_VERSION = 1;
+
+struct ProgramHeader
+{
+	char Identifier[8];
+	uint32_t Version;
+	uint32_t Format;
+	uint64_t SourceHash;
+	uint64_t DriverHash;
+	uint64_t Size;
+};
+
+/// <summary>
+/// FNV-1a hash of a string, continued from a previous hash
+/// </summary>
+static uint64_t Hash(const std::string& string, uint64_t hash = 0xCBF29CE484222325ull)
+{
+	for (const char character : string)
+	{
+		hash = (hash ^ (uint8_t)character) * 0x100000001B3ull;
+	}
+
+	return hash;
+}
+
+/// <summary>
+/// Hash of every stage, the separators keep "ab" + "c" apart from "a" + "bc"
+/// </summary>
+static uint64_t HashSources(const std::vector<std::string>& sources)
+{
+	uint64_t hash = 0xCBF29CE484222325ull;
+	for (const std::string& source : sources)
+	{
+		hash = Hash(source, hash);
+		hash = (hash ^ 0xFF) * 0x100000001B3ull;
+	}
+
+	return (hash ^ PROGRAM_VERSION) * 0x100000001B3ull;
+}
+
+bool ProgramCache::Load(const std::vector<std::string>& sources, unsigned int& program)
+{
+	if (!Enabled || !IsSupported())
+	{
+		return false;
+	}
+
+	const uint64_t hash = HashSources(sources);
+	const std::filesystem::path cachePath = std::filesystem::path(CacheDirectory) / std::format("{:016x}.ubin", hash);
+
+	std::ifstream cache(cachePath, std::ios::binary);
+	if (!cache)
+	{
+		return false;
+	}
+
+	ProgramHeader header{};
+	bool isValid = (bool)cache.read(reinterpret_cast<char*>(&header), sizeof(header)) && std::memcmp(header.Identifier, PROGRAM_IDENTIFIER, sizeof(PROGRAM_IDENTIFIER)) == 0
+		&& header.Version == PROGRAM_VERSION && header.SourceHash == hash && header.Size > 0 && header.Size < (1ull << 30);
+
+	// Saved by another driver, compiled again and overwritten
+	if (!isValid || header.DriverHash != mDriverHash)
+	{
+		return false;
+	}
+
+	std::vector<uint8_t> binary(header.Size);
+	if (!cache.read(reinterpret_cast<char*>(binary.data()), binary.size()))
+	{
+		return false;
+	}
+
+	unsigned int restored = 0;
+	if (!ServiceLocator::Get<Renderer>()->SetProgramBinary(restored, header.Format, binary.data(), (int)binary.size()))
+	{
+		Logger::Warning("ProgramCache::Load() {} has been rejected by the driver, the program is compiled again", cachePath.generic_string());
+		return false;
+	}
+
+	program = restored;
+	return true;
+}
+
+void ProgramCache::Save(const std::vector<std::string>& sources, unsigned int program)
+{
+	if (!Enabled || !IsSupported())
+	{
+		return;
+	}
+
+	unsigned int format = 0;
+	std::vector<uint8_t> binary;
+	if (!ServiceLocator::Get<Renderer>()->GetProgramBinary(program, format, binary))
+	{
+		return;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(CacheDirectory, error);
+
+	const uint64_t hash = HashSources(sources);
+	const std::filesystem::path cachePath = std::filesystem::path(CacheDirectory) / std::format("{:016x}.ubin", hash);
+
+	ProgramHeader header{};
+	std::memcpy(header.Identifier, PROGRAM_IDENTIFIER, sizeof(PROGRAM_IDENTIFIER));
+	header.Version = PROGRAM_VERSION;
+	header.Format = format;
+	header.SourceHash = hash;
+	header.DriverHash = mDriverHash;
+	header.Size = binary.size();
+
+	std::ofstream output(cachePath, std::ios::binary | std::ios::trunc);
+	if (output)
+	{
+		output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		output.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+	}
+
+	// The program is still usable, it is only compiled again at the next launch
+	if (!output)
+	{
+		Logger::Warning("ProgramCache::Save() can't write {}", cachePath.generic_string());
+	}
+}
+
+bool ProgramCache::IsSupported()
+{
+	if (!mIsChecked)
+	{
+		const Renderer* renderer = ServiceLocator::Get<Renderer>();
+
+		mIsChecked = true;
+		mIsSupported = renderer->GetProgramBinaryFormatCount() > 0;
+		mDriverHash = Hash(renderer->GetDriverDescription());
+
+		if (!mIsSupported)
+		{
+			Logger::Info("ProgramCache : the driver has no program binary format, the shaders are compiled at every launch");
+		}
+	}
+
+	return mIsSupported;
+}
@@ -51,6 +51,12 @@ void ResourceManager::Load(const std::filesystem::path& path, bool recursivity)
 			Create<Audio>(newName, mName.c_str());
 		}
 
+		else if (mName.ends_with(".cs"))
+		{
+			mFilename.resize(mFilename.size() - 3);
+			Create<Shader>(mFilename, mName.c_str());
+		}
+
 		else if (mName.ends_with(".fs"))
 		{
 			mShader.push_back(entry.path().generic_string());
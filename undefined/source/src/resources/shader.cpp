@@ -1,70 +1,362 @@
 #include "resources/shader.h"
 
+#include <algorithm>
+#include <bit>
+#include <format>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <vector>
 #include <toolbox/Vector3.h>
 
 #include "service_locator.h"
 #include "engine_debug/logger.h"
 
+#include "resources/program_cache.h"
+#include "resources/shader_compiler.h"
+
+#include "wrapper/gl_extensions.h"
+
+// Name of the define of each ShaderKeyword, in the order of the flags
+static constexpr const char* KEYWORD_NAMES[] = { "DIRECTIONAL_LIGHTS", "POINT_LIGHTS", "SPOT_LIGHTS", "HAS_TEXTURE", "PICKING_OUTPUT" };
+
+/// <summary>
+/// Read the keywords of a "#pragma keywords" line, the compiler ignores the pragma
+/// </summary>
+static uint32_t ParseKeywords(const std::string& code)
+{
+    constexpr std::string_view PRAGMA = "#pragma keywords";
+
+    const size_t start = code.find(PRAGMA);
+    if (start == std::string::npos)
+    {
+        return 0;
+    }
+
+    const size_t end = code.find('\n', start);
+    std::istringstream line(code.substr(start + PRAGMA.size(), end == std::string::npos ? std::string::npos : end - start - PRAGMA.size()));
+
+    uint32_t keywords = 0;
+    std::string name;
+    while (line >> name)
+    {
+        const auto it = std::find(std::begin(KEYWORD_NAMES), std::end(KEYWORD_NAMES), name);
+        if (it == std::end(KEYWORD_NAMES))
+        {
+            Logger::Warning("Shader keyword {} is unknown, it is never defined", name);
+            continue;
+        }
+
+        keywords |= 1u << (it - std::begin(KEYWORD_NAMES));
+    }
+
+    return keywords;
+}
+
+/// <summary>
+/// Insert the defines of the keywords after the #version line, a #line keeps the line numbers of the errors
+/// </summary>
+static std::string AddDefines(const std::string& code, uint32_t keywords)
+{
+    if (!keywords)
+    {
+        return code;
+    }
+
+    size_t insert = 0;
+    const size_t version = code.find("#version");
+    if (version != std::string::npos)
+    {
+        const size_t end = code.find('\n', version);
+        insert = (end == std::string::npos) ? code.size() : end + 1;
+    }
+
+    std::string defines;
+    for (size_t i = 0; i < std::size(KEYWORD_NAMES); i++)
+    {
+        if (keywords & (1u << i))
+        {
+            defines += std::format("#define {}\n", KEYWORD_NAMES[i]);
+        }
+    }
+    defines += std::format("#line {}\n", std::count(code.begin(), code.begin() + insert, '\n') + 1);
+
+    std::string result = code;
+    result.insert(insert, defines);
+
+    return result;
+}
+
 Shader::Shader()
 {
+    mRenderer = ServiceLocator::Get<Renderer>();
 }
 
 Shader::Shader(const char* vertexPath, const char* fragmentPath)
 {
+    mRenderer = ServiceLocator::Get<Renderer>();
+
     Load(vertexPath, fragmentPath);
 }
 
+Shader::Shader(const char* computePath)
+{
+    mRenderer = ServiceLocator::Get<Renderer>();
+
+    LoadCompute(computePath);
+}
+
+Shader::~Shader()
+{
+    ShaderCompiler::Cancel(this);
+}
+
 void Shader::Use()
 {
-    ServiceLocator::Get<Renderer>()->UseShader(ID);
+    mRenderer->UseShader(mIsReady ? ID : ShaderCompiler::GetFallbackID());
 }
 
 void Shader::UnUse()
 {
-    ServiceLocator::Get<Renderer>()->UnUseShader();
+    mRenderer->UnUseShader();
 }
 
 unsigned int Shader::SetVertexShader(unsigned int vertex, const char* vShaderCode)
 {
-    vertex = ServiceLocator::Get<Renderer>()->SetShader(GL_VERTEX_SHADER, vShaderCode);
+    vertex = mRenderer->SetShader(GL_VERTEX_SHADER, vShaderCode);
 
     return vertex;
 }
 
 unsigned int Shader::SetFragmentShader(unsigned int fragment, const char* fShaderCode)
 {
-    fragment = ServiceLocator::Get<Renderer>()->SetShader(GL_FRAGMENT_SHADER, fShaderCode);
+    fragment = mRenderer->SetShader(GL_FRAGMENT_SHADER, fShaderCode);
 
     return fragment;
 }
 
 void Shader::Link(unsigned int vertex, unsigned int fragment)
 {
-    ServiceLocator::Get<Renderer>()->LinkShader(ID, vertex, fragment);
+    mIsReady = mRenderer->LinkShader(ID, vertex, fragment);
+
+    CacheUniformLocations();
+}
+
+void Shader::CacheUniformLocations()
+{
+    mUniformLocations.clear();
+
+    const int uniformCount = mRenderer->GetActiveUniformCount(ID);
+
+    for (int i = 0; i < uniformCount; i++)
+    {
+        int arraySize = 1;
+        std::string name = mRenderer->GetActiveUniformName(ID, i, arraySize);
+
+        const int location = mRenderer->GetUniformLocation(ID, name);
+
+        // Uniforms inside a block don't have a location
+        if (location < 0)
+        {
+            continue;
+        }
+
+        // Arrays of basic types are reported once as "name[0]", the other elements follow the first location
+        if (name.ends_with("[0]"))
+        {
+            const std::string baseName = name.substr(0, name.size() - 3);
+
+            mUniformLocations[baseName] = location;
+
+            for (int j = 1; j < arraySize; j++)
+            {
+                mUniformLocations[baseName + "[" + std::to_string(j) + "]"] = location + j;
+            }
+        }
+
+        mUniformLocations[std::move(name)] = location;
+    }
+}
+
+bool Shader::IsReady() const
+{
+    return mIsReady;
+}
+
+void Shader::Build()
+{
+    if (ShaderCompiler::IsRunning())
+    {
+        ShaderCompiler::Submit(this);
+    }
+    else
+    {
+        FinishBuild();
+    }
+}
+
+void Shader::FinishBuild()
+{
+    // A stage not compiled already explains why the link failed
+    bool isCompiled = true;
+    for (const ShaderStage& stage : mStages)
+    {
+        isCompiled &= mRenderer->CheckShader(stage.ID, stage.Type);
+    }
+
+    mIsReady = isCompiled && mRenderer->CheckProgram(ID);
+    if (mIsReady)
+    {
+        ProgramCache::Save(mSources, ID);
+    }
+    CacheUniformLocations();
+
+    // delete the shaders as they're linked into our program now and no longer necessary
+    CancelBuild();
+}
+
+void Shader::CancelBuild()
+{
+    for (const ShaderStage& stage : mStages)
+    {
+        mRenderer->DeleteShader(stage.ID);
+    }
+
+    mStages.clear();
+    mSources.clear();
+}
+
+Shader* Shader::GetVariant(uint32_t keywords)
+{
+    // The keywords the shader doesn't read give the same program
+    keywords &= mKeywords;
+    if (keywords == mKeywords)
+    {
+        return this;
+    }
+
+    std::unique_ptr<Shader>& variant = mVariants[keywords];
+    if (!variant)
+    {
+        variant = std::make_unique<Shader>();
+        variant->Name = Name;
+        variant->Compile(mCode, keywords);
+    }
+
+    if (variant->IsReady())
+    {
+        return variant.get();
+    }
+
+    // Drawn with more features than needed while the variant is built
+    Shader* cheapest = this;
+    int cheapestCount = std::popcount(mKeywords);
+    for (const std::pair<const uint32_t, std::unique_ptr<Shader>>& other : mVariants)
+    {
+        const int count = std::popcount(other.first);
+        if ((other.first & keywords) == keywords && count < cheapestCount && other.second->IsReady())
+        {
+            cheapest = other.second.get();
+            cheapestCount = count;
+        }
+    }
+
+    return cheapest;
+}
+
+uint32_t Shader::GetKeywords() const
+{
+    return mKeywords;
+}
+
+size_t Shader::GetVariantCount() const
+{
+    return mVariants.size();
+}
+
+void Shader::Compile(const std::vector<std::string>& code, uint32_t keywords)
+{
+    ShaderCompiler::Cancel(this);
+    mIsReady = false;
+
+    mSources.clear();
+    for (const std::string& stage : code)
+    {
+        mSources.push_back(AddDefines(stage, keywords));
+    }
+
+    // restore the program linked at a previous launch
+    if (ProgramCache::Load(mSources, ID))
+    {
+        mSources.clear();
+        mIsReady = true;
+        CacheUniformLocations();
+        return;
+    }
+
+    // the status is read once the driver has built the program
+    if (mSources.size() == 1)
+    {
+        mStages = { { GL_COMPUTE_SHADER, mRenderer->CreateShader(GL_COMPUTE_SHADER, mSources[0].c_str()) } };
+        ID = mRenderer->CreateProgram(mStages[0].ID);
+    }
+    else
+    {
+        mStages = { { GL_VERTEX_SHADER, mRenderer->CreateShader(GL_VERTEX_SHADER, mSources[0].c_str()) },
+            { GL_FRAGMENT_SHADER, mRenderer->CreateShader(GL_FRAGMENT_SHADER, mSources[1].c_str()) } };
+        ID = mRenderer->CreateProgram(mStages[0].ID, mStages[1].ID);
+    }
+
+    Build();
+}
+
+int Shader::GetUniformLocation(std::string_view mName) const
+{
+    auto it = mUniformLocations.find(mName);
+
+    return (it != mUniformLocations.end()) ? it->second : -1;
 }
 
-void Shader::SetBool(const std::string& mName, bool value) const
+void Shader::SetBool(std::string_view mName, bool value) const
 {
-    ServiceLocator::Get<Renderer>()->SetUniform(ID, mName.c_str(), value);
+    mRenderer->SetUniform(GetUniformLocation(mName), value);
 }
-void Shader::SetInt(const std::string& mName, int value) const
+void Shader::SetInt(std::string_view mName, int value) const
 {
-    ServiceLocator::Get<Renderer>()->SetUniform(ID, mName.c_str(), value);
+    mRenderer->SetUniform(GetUniformLocation(mName), value);
 }
-void Shader::SetFloat(const std::string& mName, float value) const
+void Shader::SetFloat(std::string_view mName, float value) const
 {
-    ServiceLocator::Get<Renderer>()->SetUniform(ID, mName.c_str(), value);
+    mRenderer->SetUniform(GetUniformLocation(mName), value);
 }
-void Shader::SetVec3(const std::string& mName, const Vector3& v) const
+void Shader::SetVec3(std::string_view mName, const Vector3& v) const
 {
-    ServiceLocator::Get<Renderer>()->SetUniform(ID, mName.c_str(), v);
+    mRenderer->SetUniform(GetUniformLocation(mName), v);
 }
-void Shader::SetMat4(const std::string& mName, const Matrix4x4& m) const
+void Shader::SetMat4(std::string_view mName, const Matrix4x4& m) const
 {
-    ServiceLocator::Get<Renderer>()->SetUniform(ID, mName.c_str(), m);
+    mRenderer->SetUniform(GetUniformLocation(mName), m);
+}
+
+void Shader::SetBool(int location, bool value) const
+{
+    mRenderer->SetUniform(location, value);
+}
+void Shader::SetInt(int location, int value) const
+{
+    mRenderer->SetUniform(location, value);
+}
+void Shader::SetFloat(int location, float value) const
+{
+    mRenderer->SetUniform(location, value);
+}
+void Shader::SetVec3(int location, const Vector3& v) const
+{
+    mRenderer->SetUniform(location, v);
+}
+void Shader::SetMat4(int location, const Matrix4x4& m) const
+{
+    mRenderer->SetUniform(location, m);
 }
 
 void Shader::Load(const char* vertexPath, const char* fragmentPath)
@@ -98,23 +390,36 @@ void Shader::Load(const char* vertexPath, const char* fragmentPath)
         Logger::Error("SHADER::FILE_NOT_SUCCESFULLY_READ");
     }
 
-    const char* vShaderCode = vertexCode.c_str();
-    const char* fShaderCode = fragmentCode.c_str();
-
-    // 2. compile shaders
-    unsigned int vertex = 0;
-    unsigned int fragment = 0;
-
-    // vertex Shader
-    vertex = SetVertexShader(vertex, vShaderCode);
+    // 2. every keyword is defined, the variants with less of them are compiled when a draw asks for them
+    mKeywords = ParseKeywords(vertexCode) | ParseKeywords(fragmentCode);
+    mVariants.clear();
+    mCode.clear();
+    if (mKeywords)
+    {
+        mCode = { vertexCode, fragmentCode };
+    }
 
-    // fragment Shader
-    fragment = SetFragmentShader(fragment, fShaderCode);
+    // 3. compile and link shaders, or restore the program linked at a previous launch
+    Compile({ vertexCode, fragmentCode }, mKeywords);
+}
 
-    // Link shaders
-    Link(vertex, fragment);
+void Shader::LoadCompute(const char* computePath)
+{
+    std::string computeCode;
+    std::ifstream cShaderFile;
+    cShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    try
+    {
+        cShaderFile.open(computePath);
+        std::stringstream cShaderStream;
+        cShaderStream << cShaderFile.rdbuf();
+        cShaderFile.close();
+        computeCode = cShaderStream.str();
+    }
+    catch (std::ifstream::failure e)
+    {
+        Logger::Error("SHADER::FILE_NOT_SUCCESFULLY_READ {}", computePath);
+    }
 
-    // delete the shaders as they're linked into our program now and no longer necessary
-    ServiceLocator::Get<Renderer>()->DeleteShader(vertex);
-    ServiceLocator::Get<Renderer>()->DeleteShader(fragment);
+    Compile({ computeCode }, 0);
 }
@@ -0,0 +1,161 @@
+#include "resources/shader_compiler.h"
+
+#include <algorithm>
+
+#include "service_locator.h"
+
+#include "engine_debug/logger.h"
+
+#include "resources/shader.h"
+
+#include "wrapper/gl_extensions.h"
+
+// Same inputs and outputs as the base shader, so the draw packets work unchanged while their program is built
+static constexpr const char* FALLBACK_VERTEX = R"(#version 450 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 3) in mat4 aModel;
+layout (location = 7) in int aEntityID;
+
+layout (std140, row_major, binding = 0) uniform Camera
+{
+    mat4 vp;
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
+
+out vec3 Normal;
+flat out int EntityID;
+
+// Drawn under GL_EQUAL after the depth pre-pass, same position expression as base_shader.vs and depth_prepass_shader.vs
+invariant gl_Position;
+
+void main()
+{
+    Normal = normalize(vec3(vec4(aNormal, 0.0) * aModel));
+    EntityID = aEntityID;
+
+    gl_Position = vp * vec4(vec3(vec4(aPos, 1.0) * aModel), 1.0);
+}
+)";
+
+static constexpr const char* FALLBACK_FRAGMENT = R"(#version 450 core
+
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out int PickingFragColor;
+
+in vec3 Normal;
+flat in int EntityID;
+
+void main()
+{
+    float shade = 0.35 + 0.35 * max(dot(normalize(Normal), normalize(vec3(0.4, 1.0, 0.3))), 0.0);
+
+    FragColor = vec4(vec3(shade), 1.0);
+    PickingFragColor = EntityID;
+}
+)";
+
+void ShaderCompiler::Setup()
+{
+	mRenderer = ServiceLocator::Get<Renderer>();
+
+	// Let the driver pick the number of threads
+	if (GLExtensions::ParallelShaderCompile && glMaxShaderCompilerThreadsKHR)
+	{
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+	}
+
+	// Built right away, it is drawn from the first frame
+	const unsigned int vertex = mRenderer->SetShader(GL_VERTEX_SHADER, FALLBACK_VERTEX);
+	const unsigned int fragment = mRenderer->SetShader(GL_FRAGMENT_SHADER, FALLBACK_FRAGMENT);
+	if (!mRenderer->LinkShader(mFallbackID, vertex, fragment))
+	{
+		Logger::Warning("ShaderCompiler::Setup() fallback program not linked, the shaders draw nothing while they are built");
+	}
+	mRenderer->DeleteShader(vertex);
+	mRenderer->DeleteShader(fragment);
+
+	mIsRunning = Enabled;
+}
+
+void ShaderCompiler::Shutdown()
+{
+	if (!mIsRunning)
+	{
+		return;
+	}
+
+	for (Shader* shader : mPending)
+	{
+		shader->CancelBuild();
+	}
+	mPending.clear();
+
+	mRenderer->DeleteProgram(mFallbackID);
+	mFallbackID = 0;
+	mIsRunning = false;
+}
+
+bool ShaderCompiler::IsRunning()
+{
+	return mIsRunning;
+}
+
+void ShaderCompiler::Submit(Shader* shader)
+{
+	mPending.push_back(shader);
+}
+
+void ShaderCompiler::Cancel(Shader* shader)
+{
+	std::vector<Shader*>::iterator it = std::find(mPending.begin(), mPending.end(), shader);
+	if (it != mPending.end())
+	{
+		shader->CancelBuild();
+		mPending.erase(it);
+	}
+}
+
+void ShaderCompiler::Update()
+{
+	if (!mIsRunning)
+	{
+		return;
+	}
+
+	// The builds are finished in the order they were submitted
+	size_t blockingCount = 0;
+	for (size_t i = 0; i < mPending.size();)
+	{
+		Shader& shader = *mPending[i];
+
+		if (GLExtensions::ParallelShaderCompile)
+		{
+			if (!mRenderer->IsProgramCompleted(shader.ID))
+			{
+				i++;
+				continue;
+			}
+		}
+		else if (blockingCount++ >= MaxBlockingPerFrame)
+		{
+			break;
+		}
+
+		shader.FinishBuild();
+		mPending.erase(mPending.begin() + i);
+	}
+}
+
+unsigned int ShaderCompiler::GetFallbackID()
+{
+	return mFallbackID;
+}
+
+size_t ShaderCompiler::GetPendingCount()
+{
+	return mPending.size();
+}
@@ -2,10 +2,15 @@
 
 #include <stb_image/stb_image.h>
 #include <glad/glad.h>
+#include <algorithm>
 #include <iostream>
 
 #include "engine_debug/logger.h"
 
+#include "resources/texture_cooker.h"
+#include "resources/texture_loader.h"
+#include "resources/texture_streamer.h"
+
 Texture::Texture()
 {
 	mRenderer = ServiceLocator::Get<Renderer>();
@@ -32,6 +37,36 @@ Texture::Texture(const char* mFilepath, bool isFlipped)
 	mRenderer->GenerateTexture(1, &mID);
 	mRenderer->BindTexture(mID);
 
+	SetParameters();
+
+	// The decode and the upload are spread over the next frames, the placeholder is drawn meanwhile
+	if (AsyncLoading && TextureLoader::IsRunning())
+	{
+		mIsResident = false;
+		mPath = mFilepath;
+		mIsFlipped = isFlipped;
+		// Only the coarse levels are read at first, the streamer loads the finer ones the draws need
+		mRequest = TextureLoader::Request(this, mPath, isFlipped, 0, TextureStreamer::Enabled ? TextureStreamer::InitialSize : 0);
+		return;
+	}
+
+	// The cooked blocks and their mips go straight to an immutable storage, no decode and no glGenerateMipmap
+	CookedTexture cooked;
+	if (UseCookedTextures && TextureCooker::Load(mFilepath, isFlipped, cooked))
+	{
+		mWidth = cooked.Width;
+		mHeight = cooked.Height;
+
+		mRenderer->SetTextureStorage((int)cooked.Levels.size(), cooked.InternalFormat, mWidth, mHeight);
+		for (size_t level = 0; level < cooked.Levels.size(); level++)
+		{
+			const CookedLevel& data = cooked.Levels[level];
+			mRenderer->SetCompressedTextureImage((int)level, data.Width, data.Height, cooked.InternalFormat, (int)data.Data.size(), data.Data.data());
+		}
+
+		return;
+	}
+
 	stbi_set_flip_vertically_on_load(isFlipped);
 
 	int channelCount;
@@ -54,12 +89,6 @@ Texture::Texture(const char* mFilepath, bool isFlipped)
 			format = GL_RGBA;
 		}
 
-		mRenderer->SetTextureParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		mRenderer->SetTextureParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-		mRenderer->SetTextureParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		mRenderer->SetTextureParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
 		glTexImage2D(GL_TEXTURE_2D, 0, format, mWidth, mHeight, 0, format, GL_UNSIGNED_BYTE, Data);
 		mRenderer->GenerateMipMap(GL_TEXTURE_2D);
 	}
@@ -73,12 +102,23 @@ Texture::Texture(const char* mFilepath, bool isFlipped)
 
 Texture::~Texture()
 {
+	if (mRequest)
+	{
+		mRequest->Target = nullptr;
+		mRequest->IsCancelled = true;
+	}
+
+	if (IsStreamable())
+	{
+		TextureStreamer::Unregister(this);
+	}
+
 	mRenderer->DeleteTextures(1, &mID);
 }
 
 unsigned int Texture::GetID() const
 {
-	return mID;
+	return mIsResident ? mID : TextureLoader::GetPlaceholderID();
 }
 
 void Texture::SetID(unsigned int newID)
@@ -101,6 +141,56 @@ bool Texture::IsValid() const
 	return (mWidth > 0 && mHeight > 0);
 }
 
+bool Texture::IsResident() const
+{
+	return mIsResident;
+}
+
+void Texture::RequestLevel(int level)
+{
+	mRequestedLevel = std::min(mRequestedLevel, std::max(level, 0));
+}
+
+bool Texture::IsStreamable() const
+{
+	return !mLevelSizes.empty();
+}
+
+int Texture::GetFirstResidentLevel() const
+{
+	return mFirstLevel;
+}
+
+int Texture::GetLevelCount() const
+{
+	return (int)mLevelSizes.size();
+}
+
+size_t Texture::GetSizeFromLevel(int level) const
+{
+	size_t size = 0;
+	for (size_t i = std::max(level, 0); i < mLevelSizes.size(); i++)
+	{
+		size += mLevelSizes[i];
+	}
+
+	return size;
+}
+
+size_t Texture::GetResidentSize() const
+{
+	return GetSizeFromLevel(mFirstLevel);
+}
+
+void Texture::SetParameters()
+{
+	mRenderer->SetTextureParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	mRenderer->SetTextureParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	mRenderer->SetTextureParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	mRenderer->SetTextureParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
 unsigned int Texture::LoadCubeMap(const std::vector<std::string>& faces)
 {
 	unsigned int textureID;
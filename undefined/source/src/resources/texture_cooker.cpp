@@ -0,0 +1,595 @@
+#include "resources/texture_cooker.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <stb_image/stb_image.h>
+
+#include "engine_debug/logger.h"
+
+#include "wrapper/gl_extensions.h"
+
+// Header of the .utex files : an identifier, the format and the levels, then the offset and size of each level like a KTX2 level index
+constexpr char COOKED_IDENTIFIER[8] = { 'U', 'T', 'E', 'X', '\r', '\n', '\x1A', '\n' };
+// Changes when the layout, the filter or the encoders change, the old files are then cooked again
+constexpr uint32_t COOKED_VERSION = 1;
+
+// Number of iterations of the power method giving the main axis of the colors of a block
+constexpr int PRINCIPAL_AXIS_ITERATIONS = 4;
+
+struct CookedHeader
+{
+	char Identifier[8];
+	uint32_t Version;
+	uint32_t InternalFormat;
+	uint32_t LevelCount;
+	uint32_t Padding;
+	uint64_t SourceHash;
+};
+
+struct CookedLevelIndex
+{
+	uint32_t Width;
+	uint32_t Height;
+	uint64_t Offset;
+	uint64_t Size;
+};
+
+/// <summary>
+/// FNV-1a hash of a file, combined with the options changing the result
+/// </summary>
+static uint64_t HashSource(const std::vector<char>& bytes, bool isFlipped)
+{
+	uint64_t hash = 0xCBF29CE484222325ull;
+	for (const char byte : bytes)
+	{
+		hash = (hash ^ (uint8_t)byte) * 0x100000001B3ull;
+	}
+
+	hash = (hash ^ (isFlipped ? 1u : 0u)) * 0x100000001B3ull;
+	return (hash ^ COOKED_VERSION) * 0x100000001B3ull;
+}
+
+/// <summary>
+/// Convert a color to RGB565
+/// </summary>
+static uint16_t ToRgb565(const float color[3])
+{
+	const int r = std::clamp((int)std::lround(color[0] * 31.f / 255.f), 0, 31);
+	const int g = std::clamp((int)std::lround(color[1] * 63.f / 255.f), 0, 63);
+	const int b = std::clamp((int)std::lround(color[2] * 31.f / 255.f), 0, 31);
+	return (uint16_t)(r << 11 | g << 5 | b);
+}
+
+/// <summary>
+/// Convert a RGB565 color back to 8 bits per channel, like the decoder does
+/// </summary>
+static void FromRgb565(uint16_t packed, float color[3])
+{
+	const int r = packed >> 11 & 0x1F;
+	const int g = packed >> 5 & 0x3F;
+	const int b = packed & 0x1F;
+	color[0] = (float)(r << 3 | r >> 2);
+	color[1] = (float)(g << 2 | g >> 4);
+	color[2] = (float)(b << 3 | b >> 2);
+}
+
+/// <summary>
+/// Give each texel the closest of the 4 colors of a BC1 block
+/// </summary>
+static uint32_t FindColorIndices(const float texels[16][3], uint16_t color0, uint16_t color1, float& error)
+{
+	float palette[4][3];
+	FromRgb565(color0, palette[0]);
+	FromRgb565(color1, palette[1]);
+	for (int c = 0; c < 3; c++)
+	{
+		palette[2][c] = (2.f * palette[0][c] + palette[1][c]) / 3.f;
+		palette[3][c] = (palette[0][c] + 2.f * palette[1][c]) / 3.f;
+	}
+
+	uint32_t indices = 0;
+	error = 0.f;
+	for (int i = 0; i < 16; i++)
+	{
+		int best = 0;
+		float bestDistance = FLT_MAX;
+		for (int p = 0; p < 4; p++)
+		{
+			const float dr = texels[i][0] - palette[p][0];
+			const float dg = texels[i][1] - palette[p][1];
+			const float db = texels[i][2] - palette[p][2];
+			const float distance = dr * dr + dg * dg + db * db;
+
+			if (distance < bestDistance)
+			{
+				bestDistance = distance;
+				best = p;
+			}
+		}
+
+		indices |= (uint32_t)best << (2 * i);
+		error += bestDistance;
+	}
+
+	return indices;
+}
+
+/// <summary>
+/// Encode the colors of a block in BC1, always in the 4 colors mode so the block is also valid in BC3
+/// </summary>
+static void EncodeColorBlock(const float texels[16][3], uint8_t* output)
+{
+	// Endpoints on the main axis of the colors (power method on the covariance)
+	float mean[3] = { 0.f, 0.f, 0.f };
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			mean[c] += texels[i][c] / 16.f;
+		}
+	}
+
+	float covariance[6] = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f };
+	for (int i = 0; i < 16; i++)
+	{
+		const float r = texels[i][0] - mean[0];
+		const float g = texels[i][1] - mean[1];
+		const float b = texels[i][2] - mean[2];
+		covariance[0] += r * r; covariance[1] += r * g; covariance[2] += r * b;
+		covariance[3] += g * g; covariance[4] += g * b; covariance[5] += b * b;
+	}
+
+	float axis[3] = { 1.f, 1.f, 1.f };
+	for (int iteration = 0; iteration < PRINCIPAL_AXIS_ITERATIONS; iteration++)
+	{
+		const float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+		const float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+		const float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+		const float length = std::max({ std::abs(x), std::abs(y), std::abs(z) });
+
+		if (length <= 0.f)
+		{
+			break;
+		}
+
+		axis[0] = x / length;
+		axis[1] = y / length;
+		axis[2] = z / length;
+	}
+
+	float minProjection = FLT_MAX, maxProjection = -FLT_MAX;
+	int minTexel = 0, maxTexel = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		const float projection = texels[i][0] * axis[0] + texels[i][1] * axis[1] + texels[i][2] * axis[2];
+		if (projection < minProjection)
+		{
+			minProjection = projection;
+			minTexel = i;
+		}
+		if (projection > maxProjection)
+		{
+			maxProjection = projection;
+			maxTexel = i;
+		}
+	}
+
+	// Inset the endpoints a little, the extremes are often noise
+	float endpoints[2][3];
+	for (int c = 0; c < 3; c++)
+	{
+		const float inset = (texels[maxTexel][c] - texels[minTexel][c]) / 16.f;
+		endpoints[0][c] = texels[maxTexel][c] - inset;
+		endpoints[1][c] = texels[minTexel][c] + inset;
+	}
+
+	uint16_t color0 = ToRgb565(endpoints[0]);
+	uint16_t color1 = ToRgb565(endpoints[1]);
+	float error = 0.f;
+	uint32_t indices = FindColorIndices(texels, color0, color1, error);
+
+	// One least squares pass on the endpoints with the indices found
+	{
+		constexpr float weights[4] = { 1.f, 0.f, 2.f / 3.f, 1.f / 3.f };
+
+		float aa = 0.f, bb = 0.f, ab = 0.f;
+		float ax[3] = { 0.f, 0.f, 0.f }, bx[3] = { 0.f, 0.f, 0.f };
+		for (int i = 0; i < 16; i++)
+		{
+			const float a = weights[indices >> (2 * i) & 3];
+			const float b = 1.f - a;
+			aa += a * a;
+			bb += b * b;
+			ab += a * b;
+			for (int c = 0; c < 3; c++)
+			{
+				ax[c] += a * texels[i][c];
+				bx[c] += b * texels[i][c];
+			}
+		}
+
+		const float determinant = aa * bb - ab * ab;
+		if (std::abs(determinant) > 1e-6f)
+		{
+			float refined[2][3];
+			for (int c = 0; c < 3; c++)
+			{
+				refined[0][c] = (ax[c] * bb - bx[c] * ab) / determinant;
+				refined[1][c] = (bx[c] * aa - ax[c] * ab) / determinant;
+			}
+
+			const uint16_t refined0 = ToRgb565(refined[0]);
+			const uint16_t refined1 = ToRgb565(refined[1]);
+			float refinedError = 0.f;
+			const uint32_t refinedIndices = FindColorIndices(texels, refined0, refined1, refinedError);
+
+			if (refinedError < error)
+			{
+				color0 = refined0;
+				color1 = refined1;
+				indices = refinedIndices;
+			}
+		}
+	}
+
+	// color0 > color1 selects the 4 colors mode, swapping the endpoints swaps the indices 0 <-> 1 and 2 <-> 3
+	if (color0 < color1)
+	{
+		std::swap(color0, color1);
+		indices ^= 0x55555555;
+	}
+	else if (color0 == color1)
+	{
+		indices = 0;
+	}
+
+	std::memcpy(output, &color0, 2);
+	std::memcpy(output + 2, &color1, 2);
+	std::memcpy(output + 4, &indices, 4);
+}
+
+/// <summary>
+/// Encode a single channel block in BC4 (also the alpha of BC3), in the 8 values mode
+/// </summary>
+static void EncodeChannelBlock(const uint8_t values[16], uint8_t* output)
+{
+	const uint8_t maxValue = *std::max_element(values, values + 16);
+	const uint8_t minValue = *std::min_element(values, values + 16);
+
+	output[0] = maxValue;
+	output[1] = minValue;
+
+	uint64_t indices = 0;
+	if (maxValue != minValue)
+	{
+		// index 0 is max, 1 is min, 2 to 7 go from max to min
+		float palette[8];
+		palette[0] = maxValue;
+		palette[1] = minValue;
+		for (int p = 1; p < 7; p++)
+		{
+			palette[p + 1] = ((7 - p) * maxValue + p * minValue) / 7.f;
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			int best = 0;
+			float bestDistance = FLT_MAX;
+			for (int p = 0; p < 8; p++)
+			{
+				const float distance = std::abs(values[i] - palette[p]);
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					best = p;
+				}
+			}
+
+			indices |= (uint64_t)best << (3 * i);
+		}
+	}
+
+	for (int byte = 0; byte < 6; byte++)
+	{
+		output[2 + byte] = (uint8_t)(indices >> (8 * byte));
+	}
+}
+
+/// <summary>
+/// Halve an image with a box filter, an odd texel on the border is averaged with itself
+/// </summary>
+static std::vector<uint8_t> Downsample(const std::vector<uint8_t>& pixels, int width, int height, int channelCount)
+{
+	const int newWidth = std::max(1, width / 2);
+	const int newHeight = std::max(1, height / 2);
+
+	std::vector<uint8_t> result((size_t)newWidth * newHeight * channelCount);
+	for (int y = 0; y < newHeight; y++)
+	{
+		const int y0 = std::min(2 * y, height - 1);
+		const int y1 = std::min(2 * y + 1, height - 1);
+
+		for (int x = 0; x < newWidth; x++)
+		{
+			const int x0 = std::min(2 * x, width - 1);
+			const int x1 = std::min(2 * x + 1, width - 1);
+
+			for (int c = 0; c < channelCount; c++)
+			{
+				const int sum = pixels[((size_t)y0 * width + x0) * channelCount + c] + pixels[((size_t)y0 * width + x1) * channelCount + c]
+					+ pixels[((size_t)y1 * width + x0) * channelCount + c] + pixels[((size_t)y1 * width + x1) * channelCount + c];
+				result[((size_t)y * newWidth + x) * channelCount + c] = (uint8_t)((sum + 2) / 4);
+			}
+		}
+	}
+
+	return result;
+}
+
+/// <summary>
+/// Compress a level block after block, the blocks crossing the border repeat the last texels
+/// </summary>
+static void CompressLevel(const std::vector<uint8_t>& pixels, int width, int height, int channelCount, unsigned int format, CookedLevel& level)
+{
+	const int blockCountX = (width + 3) / 4;
+	const int blockCountY = (height + 3) / 4;
+	const size_t blockSize = format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT || format == GL_COMPRESSED_RED_RGTC1 ? 8 : 16;
+
+	level.Width = width;
+	level.Height = height;
+	level.Data.resize((size_t)blockCountX * blockCountY * blockSize);
+
+	for (int blockY = 0; blockY < blockCountY; blockY++)
+	{
+		for (int blockX = 0; blockX < blockCountX; blockX++)
+		{
+			uint8_t texels[16][4] = {};
+			for (int i = 0; i < 16; i++)
+			{
+				const int x = std::min(blockX * 4 + i % 4, width - 1);
+				const int y = std::min(blockY * 4 + i / 4, height - 1);
+				std::memcpy(texels[i], &pixels[((size_t)y * width + x) * channelCount], channelCount);
+			}
+
+			uint8_t* output = &level.Data[((size_t)blockY * blockCountX + blockX) * blockSize];
+
+			if (format == GL_COMPRESSED_RED_RGTC1 || format == GL_COMPRESSED_RG_RGTC2)
+			{
+				for (int c = 0; c < (format == GL_COMPRESSED_RG_RGTC2 ? 2 : 1); c++)
+				{
+					uint8_t values[16];
+					for (int i = 0; i < 16; i++)
+					{
+						values[i] = texels[i][c];
+					}
+					EncodeChannelBlock(values, output + 8 * c);
+				}
+				continue;
+			}
+
+			// BC3 starts with the alpha block
+			if (format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+			{
+				uint8_t alpha[16];
+				for (int i = 0; i < 16; i++)
+				{
+					alpha[i] = texels[i][3];
+				}
+				EncodeChannelBlock(alpha, output);
+				output += 8;
+			}
+
+			float colors[16][3];
+			for (int i = 0; i < 16; i++)
+			{
+				for (int c = 0; c < 3; c++)
+				{
+					colors[i][c] = texels[i][c];
+				}
+			}
+			EncodeColorBlock(colors, output);
+		}
+	}
+}
+
+void TextureCooker::Cook(const uint8_t* pixels, int width, int height, int channelCount, CookedTexture& result)
+{
+	std::vector<uint8_t> level(pixels, pixels + (size_t)width * height * channelCount);
+
+	// An opaque RGBA image doesn't need the alpha block
+	bool hasAlpha = false;
+	if (channelCount == 4)
+	{
+		for (size_t i = 3; i < level.size() && !hasAlpha; i += 4)
+		{
+			hasAlpha = level[i] != 255;
+		}
+	}
+
+	switch (channelCount)
+	{
+	case 1:
+		result.InternalFormat = GL_COMPRESSED_RED_RGTC1;
+		break;
+
+	case 2:
+		result.InternalFormat = GL_COMPRESSED_RG_RGTC2;
+		break;
+
+	default:
+		result.InternalFormat = hasAlpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		break;
+	}
+
+	result.Width = width;
+	result.Height = height;
+	result.FirstLevel = 0;
+	result.Levels.clear();
+	while (true)
+	{
+		CompressLevel(level, width, height, channelCount, result.InternalFormat, result.Levels.emplace_back());
+
+		if (width == 1 && height == 1)
+		{
+			break;
+		}
+
+		level = Downsample(level, width, height, channelCount);
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+	}
+
+	result.LevelSizes.clear();
+	for (const CookedLevel& cooked : result.Levels)
+	{
+		result.LevelSizes.push_back(cooked.Data.size());
+	}
+}
+
+/// <summary>
+/// First level to read : the requested one, or a coarser one when the finer levels are bigger than maxSize
+/// </summary>
+static size_t SelectFirstLevel(const std::vector<CookedLevelIndex>& levels, int firstLevel, int maxSize)
+{
+	size_t first = std::min((size_t)std::max(firstLevel, 0), levels.size() - 1);
+
+	while (maxSize > 0 && first + 1 < levels.size() && (int)std::max(levels[first].Width, levels[first].Height) > maxSize)
+	{
+		first++;
+	}
+
+	return first;
+}
+
+bool TextureCooker::Load(const std::string& path, bool isFlipped, CookedTexture& result, int firstLevel, int maxSize)
+{
+	std::ifstream source(path, std::ios::binary);
+	if (!source)
+	{
+		return false;
+	}
+
+	const std::vector<char> bytes((std::istreambuf_iterator<char>(source)), std::istreambuf_iterator<char>());
+	source.close();
+
+	const uint64_t hash = HashSource(bytes, isFlipped);
+	const std::filesystem::path cachePath = std::filesystem::path(CacheDirectory) / std::format("{:016x}.utex", hash);
+
+	// Read the cooked file if it matches the image, only the levels from the first one are read
+	std::ifstream cache(cachePath, std::ios::binary);
+	if (cache)
+	{
+		CookedHeader header{};
+		bool isValid = (bool)cache.read(reinterpret_cast<char*>(&header), sizeof(header)) && std::memcmp(header.Identifier, COOKED_IDENTIFIER, sizeof(COOKED_IDENTIFIER)) == 0
+			&& header.Version == COOKED_VERSION && header.SourceHash == hash && header.LevelCount > 0 && header.LevelCount <= 32;
+
+		std::vector<CookedLevelIndex> levels(isValid ? header.LevelCount : 0);
+		isValid = isValid && (bool)cache.read(reinterpret_cast<char*>(levels.data()), levels.size() * sizeof(CookedLevelIndex));
+
+		if (isValid)
+		{
+			const size_t first = SelectFirstLevel(levels, firstLevel, maxSize);
+
+			result.InternalFormat = header.InternalFormat;
+			result.Width = (int)levels[0].Width;
+			result.Height = (int)levels[0].Height;
+			result.FirstLevel = (int)first;
+			result.LevelSizes.resize(levels.size());
+			result.Levels.resize(levels.size() - first);
+
+			for (size_t i = 0; i < levels.size(); i++)
+			{
+				result.LevelSizes[i] = (size_t)levels[i].Size;
+			}
+
+			for (size_t i = first; isValid && i < levels.size(); i++)
+			{
+				CookedLevel& level = result.Levels[i - first];
+				level.Width = (int)levels[i].Width;
+				level.Height = (int)levels[i].Height;
+				level.Data.resize(levels[i].Size);
+
+				cache.seekg(levels[i].Offset);
+				isValid = (bool)cache.read(reinterpret_cast<char*>(level.Data.data()), levels[i].Size);
+			}
+		}
+
+		if (isValid)
+		{
+			return true;
+		}
+
+		Logger::Warning("TextureCooker::Load() {} is corrupted, {} is cooked again", cachePath.generic_string(), path);
+	}
+	cache.close();
+
+	// Cook the image
+	// Per thread flag, the images are cooked on the TextureLoader workers
+	stbi_set_flip_vertically_on_load_thread(isFlipped);
+
+	int width = 0, height = 0, channelCount = 0;
+	stbi_uc* pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(bytes.data()), (int)bytes.size(), &width, &height, &channelCount, 0);
+	if (!pixels)
+	{
+		return false;
+	}
+
+	Cook(pixels, width, height, channelCount, result);
+	stbi_image_free(pixels);
+
+	size_t cookedSize = 0;
+	for (const CookedLevel& level : result.Levels)
+	{
+		cookedSize += level.Data.size();
+	}
+	Logger::Info("TextureCooker::Load() {} cooked : {} KB for the level 0 uncompressed, {} KB with every level compressed", path,
+		(size_t)width * height * channelCount / 1024, cookedSize / 1024);
+
+	// Write the cooked file, the texture is still usable if the write fails
+	std::error_code error;
+	std::filesystem::create_directories(CacheDirectory, error);
+
+	std::vector<CookedLevelIndex> levels;
+	uint64_t offset = sizeof(CookedHeader) + result.Levels.size() * sizeof(CookedLevelIndex);
+	for (const CookedLevel& level : result.Levels)
+	{
+		levels.push_back({ (uint32_t)level.Width, (uint32_t)level.Height, offset, level.Data.size() });
+		offset += level.Data.size();
+	}
+
+	std::ofstream output(cachePath, std::ios::binary | std::ios::trunc);
+	if (output)
+	{
+		CookedHeader header{};
+		std::memcpy(header.Identifier, COOKED_IDENTIFIER, sizeof(COOKED_IDENTIFIER));
+		header.Version = COOKED_VERSION;
+		header.InternalFormat = result.InternalFormat;
+		header.LevelCount = (uint32_t)result.Levels.size();
+		header.SourceHash = hash;
+		output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		output.write(reinterpret_cast<const char*>(levels.data()), levels.size() * sizeof(CookedLevelIndex));
+
+		for (const CookedLevel& level : result.Levels)
+		{
+			output.write(reinterpret_cast<const char*>(level.Data.data()), level.Data.size());
+		}
+	}
+
+	if (!output)
+	{
+		Logger::Warning("TextureCooker::Load() can't write {}, {} will be cooked again", cachePath.generic_string(), path);
+	}
+
+	// The whole chain is cooked, the levels finer than the first one are only kept in the file
+	const size_t first = SelectFirstLevel(levels, firstLevel, maxSize);
+	result.FirstLevel = (int)first;
+	result.Levels.erase(result.Levels.begin(), result.Levels.begin() + first);
+
+	return true;
+}
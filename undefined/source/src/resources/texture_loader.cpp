@@ -0,0 +1,370 @@
+#include "resources/texture_loader.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <stb_image/stb_image.h>
+
+#include "service_locator.h"
+
+#include "engine_debug/logger.h"
+
+#include "resources/texture.h"
+#include "resources/texture_streamer.h"
+
+#include "wrapper/gl_extensions.h"
+
+void TextureLoader::Setup()
+{
+	mRenderer = ServiceLocator::Get<Renderer>();
+
+	// Loaded before the workers start, so the placeholder itself is resident right away
+	if (std::filesystem::exists(PlaceholderPath))
+	{
+		mPlaceholder = std::make_unique<Texture>(PlaceholderPath.c_str());
+	}
+	else
+	{
+		Logger::Warning("TextureLoader::Setup() placeholder {} not found, the textures are black while they load", PlaceholderPath);
+	}
+
+	for (TextureUploadBuffer& buffer : mUploadBuffers)
+	{
+		mRenderer->GenerateBuffer(1, &buffer.ID);
+	}
+
+	mIsRunning = true;
+
+	// Half of the cores, the other half is left to the main thread, the physics and the driver
+	const unsigned int workerCount = std::max(1u, std::thread::hardware_concurrency() / 2);
+	for (unsigned int i = 0; i < workerCount; i++)
+	{
+		mWorkers.emplace_back(&TextureLoader::Work);
+	}
+}
+
+void TextureLoader::Shutdown()
+{
+	if (!mIsRunning)
+	{
+		return;
+	}
+
+	{
+		std::scoped_lock lock(mJobMutex);
+		mIsRunning = false;
+	}
+	mJobCondition.notify_all();
+
+	for (std::thread& worker : mWorkers)
+	{
+		worker.join();
+	}
+	mWorkers.clear();
+
+	mJobs.clear();
+	mDecoded.Clear();
+	mPendingCount = 0;
+
+	for (TextureUploadBuffer& buffer : mUploadBuffers)
+	{
+		if (buffer.Fence)
+		{
+			mRenderer->DeleteSync(buffer.Fence);
+		}
+		mRenderer->DeleteBuffers(1, &buffer.ID);
+		buffer = TextureUploadBuffer();
+	}
+
+	mPlaceholder.reset();
+}
+
+bool TextureLoader::IsRunning()
+{
+	return mIsRunning;
+}
+
+std::shared_ptr<TextureRequest> TextureLoader::Request(Texture* target, const std::string& path, bool isFlipped, int firstLevel, int maxSize)
+{
+	std::shared_ptr<TextureRequest> request = std::make_shared<TextureRequest>();
+	request->Target = target;
+	request->Path = path;
+	request->IsFlipped = isFlipped;
+	request->FirstLevel = firstLevel;
+	request->MaxSize = maxSize;
+
+	mPendingCount++;
+	{
+		std::scoped_lock lock(mJobMutex);
+		mJobs.push_back(request);
+	}
+	mJobCondition.notify_one();
+
+	return request;
+}
+
+void TextureLoader::Update()
+{
+	if (!mIsRunning)
+	{
+		return;
+	}
+
+	size_t uploadedBytes = 0;
+	while (!mDecoded.Empty())
+	{
+		const std::shared_ptr<TextureRequest> request = mDecoded.Front();
+
+		// Texture destroyed while it was loading or image unreadable, nothing to upload
+		if (!request->Target || !request->IsDecoded)
+		{
+			if (request->Target)
+			{
+				Logger::Warning("Failed to load {} texture", request->Path);
+
+				// A streamed texture keeps its levels and stops asking for the image
+				Texture& texture = *request->Target;
+				if (texture.IsStreamable())
+				{
+					TextureStreamer::Unregister(&texture);
+					texture.mLevelSizes.clear();
+				}
+				texture.mRequest.reset();
+			}
+
+			mDecoded.Pop();
+			mPendingCount--;
+			continue;
+		}
+
+		// The first image of the frame is always uploaded, even when it is bigger than the budget
+		if (uploadedBytes > 0 && uploadedBytes + request->ByteSize > UploadBudget)
+		{
+			break;
+		}
+
+		// The next pixel buffer is still read by the GPU, the remaining images wait for the next frame
+		if (!Upload(*request))
+		{
+			break;
+		}
+
+		uploadedBytes += request->ByteSize;
+		mDecoded.Pop();
+		mPendingCount--;
+	}
+}
+
+unsigned int TextureLoader::GetPlaceholderID()
+{
+	return mPlaceholder ? mPlaceholder->GetID() : 0;
+}
+
+size_t TextureLoader::GetPendingCount()
+{
+	return mPendingCount;
+}
+
+void TextureLoader::Work()
+{
+	while (true)
+	{
+		std::shared_ptr<TextureRequest> request;
+		{
+			std::unique_lock lock(mJobMutex);
+			mJobCondition.wait(lock, [] { return !mJobs.empty() || !mIsRunning; });
+
+			if (!mIsRunning)
+			{
+				return;
+			}
+
+			request = std::move(mJobs.front());
+			mJobs.pop_front();
+		}
+
+		if (!request->IsCancelled)
+		{
+			Decode(*request);
+		}
+
+		mDecoded.Push(std::move(request));
+	}
+}
+
+void TextureLoader::Decode(TextureRequest& request)
+{
+	if (Texture::UseCookedTextures && TextureCooker::Load(request.Path, request.IsFlipped, request.Image, request.FirstLevel, request.MaxSize))
+	{
+		for (const CookedLevel& level : request.Image.Levels)
+		{
+			request.ByteSize += level.Data.size();
+		}
+
+		request.IsDecoded = true;
+		return;
+	}
+
+	stbi_set_flip_vertically_on_load_thread(request.IsFlipped);
+
+	int width = 0, height = 0, channelCount = 0;
+	stbi_uc* pixels = stbi_load(request.Path.c_str(), &width, &height, &channelCount, 0);
+	if (!pixels)
+	{
+		return;
+	}
+
+	// Only the level 0 is decoded, the mips are generated by the GPU after the upload
+	CookedLevel level;
+	level.Width = width;
+	level.Height = height;
+	level.Data.assign(pixels, pixels + (size_t)width * height * channelCount);
+	stbi_image_free(pixels);
+
+	request.Image.Levels.clear();
+	request.Image.Levels.push_back(std::move(level));
+	request.ChannelCount = channelCount;
+	request.ByteSize = request.Image.Levels[0].Data.size();
+	request.IsDecoded = true;
+}
+
+bool TextureLoader::Upload(TextureRequest& request)
+{
+	TextureUploadBuffer& buffer = mUploadBuffers[mNextUploadBuffer];
+
+	if (buffer.Fence)
+	{
+		if (!mRenderer->IsFenceSignaled(buffer.Fence))
+		{
+			return false;
+		}
+
+		mRenderer->DeleteSync(buffer.Fence);
+		buffer.Fence = nullptr;
+	}
+
+	// Orphan the storage, it only grows so the biggest image seen fits in every buffer after a while
+	buffer.Capacity = std::max(buffer.Capacity, request.ByteSize);
+	mRenderer->BindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.ID);
+	mRenderer->SetBufferData(GL_PIXEL_UNPACK_BUFFER, (int)buffer.Capacity, nullptr, GL_STREAM_DRAW);
+
+	uint8_t* mapped = static_cast<uint8_t*>(mRenderer->MapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, request.ByteSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+	if (mapped)
+	{
+		size_t offset = 0;
+		for (const CookedLevel& level : request.Image.Levels)
+		{
+			std::memcpy(mapped + offset, level.Data.data(), level.Data.size());
+			offset += level.Data.size();
+		}
+
+		// Released before the copies, a mapped buffer can't be read by the GPU
+		if (!mRenderer->UnmapBuffer(GL_PIXEL_UNPACK_BUFFER))
+		{
+			mapped = nullptr;
+		}
+	}
+
+	// Without the pixel buffer the levels are read from the client memory
+	if (!mapped)
+	{
+		mRenderer->BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+
+	Texture& texture = *request.Target;
+	const CookedLevel& base = request.Image.Levels[0];
+
+	// The immutable storage can't be resized, a streamed texture swaps to a new one once it is filled
+	const bool isReplaced = texture.mIsResident;
+	unsigned int textureID = texture.mID;
+	if (isReplaced)
+	{
+		mRenderer->GenerateTexture(1, &textureID);
+	}
+
+	mRenderer->BindTexture(textureID);
+	if (isReplaced)
+	{
+		texture.SetParameters();
+	}
+
+	size_t offset = 0;
+	if (request.ChannelCount == 0)
+	{
+		mRenderer->SetTextureStorage((int)request.Image.Levels.size(), request.Image.InternalFormat, base.Width, base.Height);
+
+		for (size_t level = 0; level < request.Image.Levels.size(); level++)
+		{
+			const CookedLevel& data = request.Image.Levels[level];
+			const void* source = mapped ? reinterpret_cast<const void*>(offset) : data.Data.data();
+
+			mRenderer->SetCompressedTextureImage((int)level, data.Width, data.Height, request.Image.InternalFormat, (int)data.Data.size(), source);
+			offset += data.Data.size();
+		}
+	}
+	else
+	{
+		static constexpr unsigned int INTERNAL_FORMATS[] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+		static constexpr unsigned int FORMATS[] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+
+		const int channel = std::clamp(request.ChannelCount, 1, 4) - 1;
+		const int levelCount = std::bit_width((unsigned int)std::max(base.Width, base.Height));
+		const void* source = mapped ? nullptr : base.Data.data();
+
+		mRenderer->SetTextureStorage(levelCount, INTERNAL_FORMATS[channel], base.Width, base.Height);
+
+		// The rows of the RGB and single channel images are not aligned on 4 bytes
+		mRenderer->SetPixelStore(GL_UNPACK_ALIGNMENT, 1);
+		mRenderer->SetTextureSubImage(0, base.Width, base.Height, FORMATS[channel], source);
+		mRenderer->SetPixelStore(GL_UNPACK_ALIGNMENT, 4);
+
+		mRenderer->GenerateMipMap(GL_TEXTURE_2D);
+	}
+
+	if (mapped)
+	{
+		buffer.Fence = mRenderer->FenceSync();
+		mNextUploadBuffer = (mNextUploadBuffer + 1) % UPLOAD_BUFFER_COUNT;
+	}
+
+	mRenderer->BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	if (isReplaced)
+	{
+		mRenderer->DeleteTextures(1, &texture.mID);
+		texture.mID = textureID;
+	}
+
+	const bool wasStreamable = texture.IsStreamable();
+	if (request.ChannelCount == 0)
+	{
+		texture.mWidth = request.Image.Width;
+		texture.mHeight = request.Image.Height;
+		texture.mInternalFormat = request.Image.InternalFormat;
+		texture.mFirstLevel = request.Image.FirstLevel;
+		texture.mLevelSizes = request.Image.LevelSizes;
+	}
+	else
+	{
+		texture.mWidth = base.Width;
+		texture.mHeight = base.Height;
+		texture.mFirstLevel = 0;
+		texture.mLevelSizes.clear();
+	}
+
+	// Only the cooked levels can be read one by one from the cache
+	if (texture.IsStreamable() && !wasStreamable)
+	{
+		TextureStreamer::Register(&texture);
+	}
+	else if (!texture.IsStreamable() && wasStreamable)
+	{
+		TextureStreamer::Unregister(&texture);
+	}
+
+	texture.mIsResident = true;
+	texture.mRequest.reset();
+
+	return true;
+}
@@ -0,0 +1,190 @@
+#include "resources/texture_streamer.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <queue>
+#include <utility>
+
+#include "service_locator.h"
+
+#include "resources/texture.h"
+#include "resources/texture_loader.h"
+
+void TextureStreamer::Register(Texture* texture)
+{
+	mTextures.push_back(texture);
+}
+
+void TextureStreamer::Unregister(Texture* texture)
+{
+	std::vector<Texture*>::iterator it = std::find(mTextures.begin(), mTextures.end(), texture);
+	if (it != mTextures.end())
+	{
+		*it = mTextures.back();
+		mTextures.pop_back();
+	}
+}
+
+void TextureStreamer::Update()
+{
+	mRenderer = ServiceLocator::Get<Renderer>();
+	mFrame++;
+
+	// Level wanted by each texture before the budget, a finer level is taken right away but only given back after EvictionDelay frames
+	std::vector<int> wanted(mTextures.size());
+	size_t wantedSize = 0;
+
+	for (size_t i = 0; i < mTextures.size(); i++)
+	{
+		Texture& texture = *mTextures[i];
+		const int initialLevel = GetInitialLevel(texture);
+
+		// The levels shown by a viewport which didn't draw don't age, a finer level asked by another viewport is still taken
+		if (mKeepLevels)
+		{
+			texture.mRecentFrame = mFrame;
+		}
+
+		if (texture.mRequestedLevel != INT_MAX)
+		{
+			if (texture.mRequestedLevel <= texture.mRecentLevel || mFrame - texture.mRecentFrame > EvictionDelay)
+			{
+				texture.mRecentLevel = texture.mRequestedLevel;
+				texture.mRecentFrame = mFrame;
+			}
+		}
+		else if (mFrame - texture.mRecentFrame > EvictionDelay)
+		{
+			texture.mRecentLevel = INT_MAX;
+		}
+		texture.mRequestedLevel = INT_MAX;
+
+		wanted[i] = Enabled ? std::min(texture.mRecentLevel, initialLevel) : 0;
+		wantedSize += texture.GetSizeFromLevel(wanted[i]);
+	}
+
+	mRequestedSize = wantedSize;
+	mKeepLevels = false;
+
+	// Over the budget, the biggest level of all the textures is dropped until the levels fit (the initial levels always stay)
+	if (Enabled && wantedSize > VramBudget)
+	{
+		std::priority_queue<std::pair<size_t, size_t>> biggestLevels;
+		for (size_t i = 0; i < mTextures.size(); i++)
+		{
+			if (wanted[i] < GetInitialLevel(*mTextures[i]))
+			{
+				biggestLevels.emplace(mTextures[i]->mLevelSizes[wanted[i]], i);
+			}
+		}
+
+		while (wantedSize > VramBudget && !biggestLevels.empty())
+		{
+			const size_t i = biggestLevels.top().second;
+			biggestLevels.pop();
+
+			wantedSize -= mTextures[i]->mLevelSizes[wanted[i]];
+			wanted[i]++;
+
+			if (wanted[i] < GetInitialLevel(*mTextures[i]))
+			{
+				biggestLevels.emplace(mTextures[i]->mLevelSizes[wanted[i]], i);
+			}
+		}
+	}
+
+	size_t loadsInFlight = 0;
+	for (const Texture* texture : mTextures)
+	{
+		loadsInFlight += texture->mRequest != nullptr;
+	}
+
+	mResidentSize = 0;
+	for (size_t i = 0; i < mTextures.size(); i++)
+	{
+		Texture& texture = *mTextures[i];
+
+		// The levels change once the load in flight is uploaded
+		if (!texture.mRequest)
+		{
+			if (wanted[i] > texture.mFirstLevel)
+			{
+				Evict(texture, wanted[i]);
+			}
+			else if (wanted[i] < texture.mFirstLevel && loadsInFlight < MaxLoadsInFlight)
+			{
+				texture.mRequest = TextureLoader::Request(&texture, texture.mPath, texture.mIsFlipped, wanted[i]);
+				loadsInFlight++;
+			}
+		}
+
+		mResidentSize += texture.GetResidentSize();
+	}
+}
+
+void TextureStreamer::KeepLevels()
+{
+	mKeepLevels = true;
+}
+
+int TextureStreamer::ComputeLevel(unsigned int textureWidth, float uvDensity, float pixelsPerUnit)
+{
+	if (uvDensity <= 0.f || pixelsPerUnit <= 0.f)
+	{
+		return 0;
+	}
+
+	// One texel per pixel at the level sampled
+	const float texelsPerPixel = textureWidth * uvDensity / pixelsPerUnit;
+	return std::max((int)std::floor(std::log2(std::max(texelsPerPixel, 1.f)) + LevelBias), 0);
+}
+
+size_t TextureStreamer::GetResidentSize()
+{
+	return mResidentSize;
+}
+
+size_t TextureStreamer::GetRequestedSize()
+{
+	return mRequestedSize;
+}
+
+size_t TextureStreamer::GetTextureCount()
+{
+	return mTextures.size();
+}
+
+int TextureStreamer::GetInitialLevel(const Texture& texture)
+{
+	int level = 0;
+	while (level + 1 < texture.GetLevelCount() && std::max(texture.mWidth >> level, texture.mHeight >> level) > InitialSize)
+	{
+		level++;
+	}
+
+	return level;
+}
+
+void TextureStreamer::Evict(Texture& texture, int firstLevel)
+{
+	const int levelCount = texture.GetLevelCount();
+
+	unsigned int textureID = 0;
+	mRenderer->GenerateTexture(1, &textureID);
+	mRenderer->BindTexture(textureID);
+	texture.SetParameters();
+
+	mRenderer->SetTextureStorage(levelCount - firstLevel, texture.mInternalFormat, std::max(texture.mWidth >> firstLevel, 1), std::max(texture.mHeight >> firstLevel, 1));
+
+	// The coarse levels are already in VRAM, nothing is read from the disk
+	for (int level = firstLevel; level < levelCount; level++)
+	{
+		mRenderer->CopyTextureLevel(texture.mID, level - texture.mFirstLevel, textureID, level - firstLevel,
+			std::max(texture.mWidth >> level, 1), std::max(texture.mHeight >> level, 1));
+	}
+
+	mRenderer->DeleteTextures(1, &texture.mID);
+	texture.mID = textureID;
+	texture.mFirstLevel = firstLevel;
+}
@@ -0,0 +1,150 @@
+#include "utils/bounds.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "resources/mesh.h"
+
+Vector3 BoundingBox::GetCenter() const
+{
+	return (Min + Max) * 0.5f;
+}
+
+Vector3 BoundingBox::GetExtents() const
+{
+	return (Max - Min) * 0.5f;
+}
+
+float BoundingBox::GetSurfaceArea() const
+{
+	const Vector3 size = Max - Min;
+
+	return 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+bool BoundingBox::Contains(const BoundingBox& other) const
+{
+	return Min.x <= other.Min.x && Min.y <= other.Min.y && Min.z <= other.Min.z
+		&& other.Max.x <= Max.x && other.Max.y <= Max.y && other.Max.z <= Max.z;
+}
+
+bool BoundingBox::Intersects(const BoundingBox& other) const
+{
+	return Min.x <= other.Max.x && other.Min.x <= Max.x
+		&& Min.y <= other.Max.y && other.Min.y <= Max.y
+		&& Min.z <= other.Max.z && other.Min.z <= Max.z;
+}
+
+bool BoundingBox::Intersects(const BoundingSphere& sphere) const
+{
+	// Squared distance between the center of the sphere and the box
+	float distance = 0.f;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		const float closest = std::clamp(sphere.Center[axis], Min[axis], Max[axis]);
+		distance += (sphere.Center[axis] - closest) * (sphere.Center[axis] - closest);
+	}
+
+	return distance <= sphere.Radius * sphere.Radius;
+}
+
+bool BoundingBox::IntersectsRay(const Vector3& origin, const Vector3& inverseDirection, float maxDistance, float& distance) const
+{
+	float entry = 0.f;
+	float exit = maxDistance;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float t0 = (Min[axis] - origin[axis]) * inverseDirection[axis];
+		float t1 = (Max[axis] - origin[axis]) * inverseDirection[axis];
+
+		if (t0 > t1)
+		{
+			std::swap(t0, t1);
+		}
+
+		// A NaN (origin on the slab with a null direction) keeps the previous bounds
+		entry = t0 > entry ? t0 : entry;
+		exit = t1 < exit ? t1 : exit;
+
+		if (entry > exit)
+		{
+			return false;
+		}
+	}
+
+	distance = entry;
+	return true;
+}
+
+BoundingBox BoundingBox::Merge(const BoundingBox& a, const BoundingBox& b)
+{
+	return { Vector3(std::min(a.Min.x, b.Min.x), std::min(a.Min.y, b.Min.y), std::min(a.Min.z, b.Min.z)),
+			 Vector3(std::max(a.Max.x, b.Max.x), std::max(a.Max.y, b.Max.y), std::max(a.Max.z, b.Max.z)) };
+}
+
+BoundingBox BoundingBox::Transformed(const Matrix4x4& matrix) const
+{
+	const Vector3 center = GetCenter();
+	const Vector3 extents = GetExtents();
+
+	// The translation is in the last column, the new extents are the extents projected on the absolute rows of the rotation and scale
+	Vector3 newCenter;
+	Vector3 newExtents;
+	for (int row = 0; row < 3; row++)
+	{
+		newCenter[row] = matrix[row].x * center.x + matrix[row].y * center.y + matrix[row].z * center.z + matrix[row].w;
+		newExtents[row] = std::abs(matrix[row].x) * extents.x + std::abs(matrix[row].y) * extents.y + std::abs(matrix[row].z) * extents.z;
+	}
+
+	return { newCenter - newExtents, newCenter + newExtents };
+}
+
+BoundingSphere BoundingSphere::Transformed(const Matrix4x4& matrix) const
+{
+	Vector3 newCenter;
+	for (int row = 0; row < 3; row++)
+	{
+		newCenter[row] = matrix[row].x * Center.x + matrix[row].y * Center.y + matrix[row].z * Center.z + matrix[row].w;
+	}
+
+	// Length of each column of the 3x3 part is the scale on that axis
+	float maxScale = 0.f;
+	for (int column = 0; column < 3; column++)
+	{
+		const float scale = matrix[0][column] * matrix[0][column] + matrix[1][column] * matrix[1][column] + matrix[2][column] * matrix[2][column];
+		maxScale = std::max(maxScale, scale);
+	}
+
+	return { newCenter, Radius * std::sqrt(maxScale) };
+}
+
+void Bounds::Compute(const Vertex* vertices, size_t count, BoundingBox& box, BoundingSphere& sphere)
+{
+	if (count == 0)
+	{
+		box = {};
+		sphere = {};
+		return;
+	}
+
+	box.Min = vertices[0].Position;
+	box.Max = vertices[0].Position;
+	for (size_t i = 1; i < count; i++)
+	{
+		const Vector3& position = vertices[i].Position;
+
+		box.Min = Vector3(std::min(box.Min.x, position.x), std::min(box.Min.y, position.y), std::min(box.Min.z, position.z));
+		box.Max = Vector3(std::max(box.Max.x, position.x), std::max(box.Max.y, position.y), std::max(box.Max.z, position.z));
+	}
+
+	// Farthest vertex from the center of the box, tighter than the half diagonal
+	sphere.Center = box.GetCenter();
+	float squaredRadius = 0.f;
+	for (size_t i = 0; i < count; i++)
+	{
+		squaredRadius = std::max(squaredRadius, (vertices[i].Position - sphere.Center).SquaredNorm());
+	}
+	sphere.Radius = std::sqrt(squaredRadius);
+}
@@ -0,0 +1,351 @@
+#include "world/bvh.h"
+
+#include <algorithm>
+
+#include "engine_debug/logger.h"
+
+DynamicBvh::DynamicBvh()
+{
+	mNodes.reserve(16);
+	mStack.reserve(64);
+}
+
+int DynamicBvh::CreateProxy(const BoundingBox& box, void* userData)
+{
+	const int proxy = AllocateNode();
+
+	const Vector3 margin(FatMargin, FatMargin, FatMargin);
+	mNodes[proxy].Box = { box.Min - margin, box.Max + margin };
+	mNodes[proxy].UserData = userData;
+	mNodes[proxy].Height = 0;
+
+	InsertLeaf(proxy);
+	mProxyCount++;
+
+	return proxy;
+}
+
+void DynamicBvh::DestroyProxy(int proxy)
+{
+	if (proxy < 0 || proxy >= (int)mNodes.size() || !mNodes[proxy].IsLeaf() || mNodes[proxy].Height != 0)
+	{
+		Logger::Error("DynamicBvh::DestroyProxy() invalid proxy {}", proxy);
+		return;
+	}
+
+	RemoveLeaf(proxy);
+	FreeNode(proxy);
+	mProxyCount--;
+}
+
+bool DynamicBvh::MoveProxy(int proxy, const BoundingBox& box)
+{
+	if (mNodes[proxy].Box.Contains(box))
+	{
+		return false;
+	}
+
+	RemoveLeaf(proxy);
+
+	const Vector3 margin(FatMargin, FatMargin, FatMargin);
+	mNodes[proxy].Box = { box.Min - margin, box.Max + margin };
+
+	InsertLeaf(proxy);
+
+	return true;
+}
+
+void DynamicBvh::Clear()
+{
+	mNodes.clear();
+	mRoot = NullNode;
+	mFreeList = NullNode;
+	mProxyCount = 0;
+}
+
+void* DynamicBvh::GetUserData(int proxy) const
+{
+	return mNodes[proxy].UserData;
+}
+
+const BoundingBox& DynamicBvh::GetFatBox(int proxy) const
+{
+	return mNodes[proxy].Box;
+}
+
+size_t DynamicBvh::GetProxyCount() const
+{
+	return mProxyCount;
+}
+
+int DynamicBvh::GetHeight() const
+{
+	return mRoot == NullNode ? -1 : mNodes[mRoot].Height;
+}
+
+int DynamicBvh::AllocateNode()
+{
+	if (mFreeList == NullNode)
+	{
+		mNodes.emplace_back();
+		return (int)mNodes.size() - 1;
+	}
+
+	const int node = mFreeList;
+	mFreeList = mNodes[node].Parent;
+	mNodes[node] = Node();
+
+	return node;
+}
+
+void DynamicBvh::FreeNode(int node)
+{
+	mNodes[node] = Node();
+	mNodes[node].Parent = mFreeList;
+	mFreeList = node;
+}
+
+void DynamicBvh::InsertLeaf(int leaf)
+{
+	if (mRoot == NullNode)
+	{
+		mRoot = leaf;
+		mNodes[leaf].Parent = NullNode;
+		return;
+	}
+
+	// Go down the tree to the sibling with the lowest cost : the area of the new parent plus the area added to the ancestors
+	const BoundingBox leafBox = mNodes[leaf].Box;
+	int index = mRoot;
+
+	while (!mNodes[index].IsLeaf())
+	{
+		const Node& node = mNodes[index];
+
+		const float area = node.Box.GetSurfaceArea();
+		const float combinedArea = BoundingBox::Merge(node.Box, leafBox).GetSurfaceArea();
+
+		// Cost of making a new parent for this node and the leaf
+		const float cost = 2.f * combinedArea;
+		// Minimum cost pushed down to the children
+		const float inheritanceCost = 2.f * (combinedArea - area);
+
+		float childCosts[2];
+		const int children[2] = { node.Child1, node.Child2 };
+		for (int i = 0; i < 2; i++)
+		{
+			const Node& child = mNodes[children[i]];
+			const float mergedArea = BoundingBox::Merge(leafBox, child.Box).GetSurfaceArea();
+
+			childCosts[i] = (child.IsLeaf() ? mergedArea : mergedArea - child.Box.GetSurfaceArea()) + inheritanceCost;
+		}
+
+		if (cost < childCosts[0] && cost < childCosts[1])
+		{
+			break;
+		}
+
+		index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+	}
+
+	const int sibling = index;
+
+	// The pool may grow, no reference to a node is kept across the allocation
+	const int oldParent = mNodes[sibling].Parent;
+	const int newParent = AllocateNode();
+	mNodes[newParent].Parent = oldParent;
+	mNodes[newParent].Box = BoundingBox::Merge(leafBox, mNodes[sibling].Box);
+	mNodes[newParent].Height = mNodes[sibling].Height + 1;
+	mNodes[newParent].Child1 = sibling;
+	mNodes[newParent].Child2 = leaf;
+	mNodes[sibling].Parent = newParent;
+	mNodes[leaf].Parent = newParent;
+
+	if (oldParent != NullNode)
+	{
+		if (mNodes[oldParent].Child1 == sibling)
+		{
+			mNodes[oldParent].Child1 = newParent;
+		}
+		else
+		{
+			mNodes[oldParent].Child2 = newParent;
+		}
+	}
+	else
+	{
+		mRoot = newParent;
+	}
+
+	Refit(mNodes[leaf].Parent);
+}
+
+void DynamicBvh::RemoveLeaf(int leaf)
+{
+	if (leaf == mRoot)
+	{
+		mRoot = NullNode;
+		return;
+	}
+
+	const int parent = mNodes[leaf].Parent;
+	const int grandParent = mNodes[parent].Parent;
+	const int sibling = mNodes[parent].Child1 == leaf ? mNodes[parent].Child2 : mNodes[parent].Child1;
+
+	// The sibling takes the place of the parent
+	if (grandParent != NullNode)
+	{
+		if (mNodes[grandParent].Child1 == parent)
+		{
+			mNodes[grandParent].Child1 = sibling;
+		}
+		else
+		{
+			mNodes[grandParent].Child2 = sibling;
+		}
+
+		mNodes[sibling].Parent = grandParent;
+		FreeNode(parent);
+
+		Refit(grandParent);
+	}
+	else
+	{
+		mRoot = sibling;
+		mNodes[sibling].Parent = NullNode;
+		FreeNode(parent);
+	}
+
+	mNodes[leaf].Parent = NullNode;
+}
+
+void DynamicBvh::Refit(int node)
+{
+	while (node != NullNode)
+	{
+		node = Balance(node);
+
+		Node& current = mNodes[node];
+		const Node& child1 = mNodes[current.Child1];
+		const Node& child2 = mNodes[current.Child2];
+
+		current.Height = 1 + std::max(child1.Height, child2.Height);
+		current.Box = BoundingBox::Merge(child1.Box, child2.Box);
+
+		node = current.Parent;
+	}
+}
+
+int DynamicBvh::Balance(int iA)
+{
+	Node& a = mNodes[iA];
+	if (a.IsLeaf() || a.Height < 2)
+	{
+		return iA;
+	}
+
+	const int iB = a.Child1;
+	const int iC = a.Child2;
+	Node& b = mNodes[iB];
+	Node& c = mNodes[iC];
+
+	const int balance = c.Height - b.Height;
+
+	// Rotate C up
+	if (balance > 1)
+	{
+		const int iF = c.Child1;
+		const int iG = c.Child2;
+		Node& f = mNodes[iF];
+		Node& g = mNodes[iG];
+
+		c.Child1 = iA;
+		c.Parent = a.Parent;
+		a.Parent = iC;
+
+		if (c.Parent != NullNode)
+		{
+			(mNodes[c.Parent].Child1 == iA ? mNodes[c.Parent].Child1 : mNodes[c.Parent].Child2) = iC;
+		}
+		else
+		{
+			mRoot = iC;
+		}
+
+		// The highest grandchild stays under C
+		if (f.Height > g.Height)
+		{
+			c.Child2 = iF;
+			a.Child2 = iG;
+			g.Parent = iA;
+			a.Box = BoundingBox::Merge(b.Box, g.Box);
+			c.Box = BoundingBox::Merge(a.Box, f.Box);
+
+			a.Height = 1 + std::max(b.Height, g.Height);
+			c.Height = 1 + std::max(a.Height, f.Height);
+		}
+		else
+		{
+			c.Child2 = iG;
+			a.Child2 = iF;
+			f.Parent = iA;
+			a.Box = BoundingBox::Merge(b.Box, f.Box);
+			c.Box = BoundingBox::Merge(a.Box, g.Box);
+
+			a.Height = 1 + std::max(b.Height, f.Height);
+			c.Height = 1 + std::max(a.Height, g.Height);
+		}
+
+		return iC;
+	}
+
+	// Rotate B up
+	if (balance < -1)
+	{
+		const int iD = b.Child1;
+		const int iE = b.Child2;
+		Node& d = mNodes[iD];
+		Node& e = mNodes[iE];
+
+		b.Child1 = iA;
+		b.Parent = a.Parent;
+		a.Parent = iB;
+
+		if (b.Parent != NullNode)
+		{
+			(mNodes[b.Parent].Child1 == iA ? mNodes[b.Parent].Child1 : mNodes[b.Parent].Child2) = iB;
+		}
+		else
+		{
+			mRoot = iB;
+		}
+
+		// The highest grandchild stays under B
+		if (d.Height > e.Height)
+		{
+			b.Child2 = iD;
+			a.Child1 = iE;
+			e.Parent = iA;
+			a.Box = BoundingBox::Merge(c.Box, e.Box);
+			b.Box = BoundingBox::Merge(a.Box, d.Box);
+
+			a.Height = 1 + std::max(c.Height, e.Height);
+			b.Height = 1 + std::max(a.Height, d.Height);
+		}
+		else
+		{
+			b.Child2 = iE;
+			a.Child1 = iD;
+			d.Parent = iA;
+			a.Box = BoundingBox::Merge(c.Box, d.Box);
+			b.Box = BoundingBox::Merge(a.Box, e.Box);
+
+			a.Height = 1 + std::max(c.Height, d.Height);
+			b.Height = 1 + std::max(a.Height, e.Height);
+		}
+
+		return iB;
+	}
+
+	return iA;
+}
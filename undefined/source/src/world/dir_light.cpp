@@ -1,8 +1,5 @@
 #include "world/dir_light.h"
 
-#include "resources/resource_manager.h"
-#include "resources/shader.h"
-
 DirLight::DirLight()
 {
 
@@ -17,13 +14,23 @@ DirLight::~DirLight()
 {
 }
 
-void DirLight::Draw()
+LightType DirLight::GetLightType() const
+{
+	return LightType::Directional;
+}
+
+void DirLight::FillGpuLight(GpuLight& gpuLight)
 {
-	pShader->Use();
 	Direction = GameTransform->Position;
-	pShader->SetVec3("dirLights[0].direction", Direction);
-	pShader->SetVec3("dirLights[0].ambient", Ambient);
-	pShader->SetVec3("dirLights[0].diffuse", Diffuse);
-	pShader->SetVec3("dirLights[0].specular", Specular);
-	pShader->UnUse();
+
+	gpuLight.Position = Vector4(0.f);
+	gpuLight.Direction = Vector4(Direction.x, Direction.y, Direction.z, 0.f);
+	gpuLight.Ambient = Vector4(Ambient.x, Ambient.y, Ambient.z, 0.f);
+	gpuLight.Diffuse = Vector4(Diffuse.x, Diffuse.y, Diffuse.z, 0.f);
+	gpuLight.Specular = Vector4(Specular.x, Specular.y, Specular.z, 0.f);
+}
+
+int DirLight::GetNbrOfDirLight() const
+{
+	return (int)LightManager::GetLightCount(LightType::Directional);
 }
@@ -0,0 +1,216 @@
+#include "world/light_clusters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <toolbox/Matrix4x4.h>
+#include <toolbox/Vector4.h>
+
+#include "service_locator.h"
+
+#include "wrapper/gl_extensions.h"
+
+#include "camera/camera.h"
+
+#include "world/light_manager.h"
+
+// Light references allocated the first time, the buffer grows when the clusters hold more lights
+constexpr size_t BASE_LIGHT_INDEX_CAPACITY = 4096;
+
+// Number of unsigned int used by the header of the LightClusters buffer
+constexpr size_t CLUSTER_HEADER_SIZE = 8;
+
+void LightClusters::Setup()
+{
+	mRenderer = ServiceLocator::Get<Renderer>();
+
+	mClusterBounds.resize(ClusterCount);
+	mClusterStaging.resize(CLUSTER_HEADER_SIZE + 2 * ClusterCount);
+
+	mRenderer->GenerateBuffer(1, &mClusterSSBO);
+	mRenderer->BindBuffer(GL_SHADER_STORAGE_BUFFER, mClusterSSBO);
+	mRenderer->SetBufferStorage(GL_SHADER_STORAGE_BUFFER, mClusterStaging.size() * sizeof(unsigned int), nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+	mLightIndexCapacity = BASE_LIGHT_INDEX_CAPACITY * sizeof(unsigned int);
+
+	mRenderer->GenerateBuffer(1, &mLightIndexSSBO);
+	mRenderer->BindBuffer(GL_SHADER_STORAGE_BUFFER, mLightIndexSSBO);
+	mRenderer->SetBufferData(GL_SHADER_STORAGE_BUFFER, (int)mLightIndexCapacity, nullptr, GL_DYNAMIC_DRAW);
+	mRenderer->BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	mRenderer->BindBufferBase(GL_SHADER_STORAGE_BUFFER, ClusterBufferBinding, mClusterSSBO);
+	mRenderer->BindBufferBase(GL_SHADER_STORAGE_BUFFER, LightIndexBufferBinding, mLightIndexSSBO);
+}
+
+void LightClusters::ComputeClusterBounds(const Camera& camera)
+{
+	const Matrix4x4& projection = camera.GetProjection();
+	const Matrix4x4 inverseProjection = Matrix4x4::Inverse(projection);
+
+	// Ray from the eye through every corner of the screen tiles, scaled to a view depth of 1
+	Vector3 corners[ClusterCountX + 1][ClusterCountY + 1];
+	for (unsigned int x = 0; x <= ClusterCountX; x++)
+	{
+		for (unsigned int y = 0; y <= ClusterCountY; y++)
+		{
+			const float ndcX = -1.f + 2.f * (float)x / ClusterCountX;
+			const float ndcY = -1.f + 2.f * (float)y / ClusterCountY;
+
+			const Vector4 point = inverseProjection * Vector4(ndcX, ndcY, -1.f, 1.f);
+			const Vector3 viewPoint(point.x / point.w, point.y / point.w, point.z / point.w);
+			const float depth = projection[3].z * viewPoint.z + projection[3].w;
+
+			corners[x][y] = viewPoint * (1.f / depth);
+		}
+	}
+
+	const float depthRatio = camera.Far / camera.Near;
+
+	for (unsigned int z = 0; z < ClusterCountZ; z++)
+	{
+		const float sliceNear = camera.Near * std::pow(depthRatio, (float)z / ClusterCountZ);
+		const float sliceFar = camera.Near * std::pow(depthRatio, (float)(z + 1) / ClusterCountZ);
+
+		for (unsigned int y = 0; y < ClusterCountY; y++)
+		{
+			for (unsigned int x = 0; x < ClusterCountX; x++)
+			{
+				const Vector3* rays[4] = { &corners[x][y], &corners[x + 1][y], &corners[x][y + 1], &corners[x + 1][y + 1] };
+
+				ClusterBounds& bounds = mClusterBounds[x + ClusterCountX * (y + ClusterCountY * z)];
+				bounds.Min = *rays[0] * sliceNear;
+				bounds.Max = bounds.Min;
+
+				for (const Vector3* ray : rays)
+				{
+					for (const float depth : { sliceNear, sliceFar })
+					{
+						const Vector3 point = *ray * depth;
+
+						bounds.Min = Vector3(std::min(bounds.Min.x, point.x), std::min(bounds.Min.y, point.y), std::min(bounds.Min.z, point.z));
+						bounds.Max = Vector3(std::max(bounds.Max.x, point.x), std::max(bounds.Max.y, point.y), std::max(bounds.Max.z, point.z));
+					}
+				}
+			}
+		}
+	}
+
+	mSliceScale = ClusterCountZ / std::log(depthRatio);
+	mSliceBias = mSliceScale * std::log(camera.Near);
+}
+
+unsigned int LightClusters::GetSlice(float depth)
+{
+	if (depth <= 0.f)
+	{
+		return 0;
+	}
+
+	const float slice = std::log(depth) * mSliceScale - mSliceBias;
+
+	return (unsigned int)std::clamp(slice, 0.f, (float)(ClusterCountZ - 1));
+}
+
+void LightClusters::Build(const Camera& camera)
+{
+	if (!mRenderer || camera.Width <= 0.f || camera.Height <= 0.f)
+	{
+		return;
+	}
+
+	ComputeClusterBounds(camera);
+
+	const Matrix4x4& view = camera.GetView();
+	const Vector4& depthRow = camera.GetProjection()[3];
+	const std::vector<Vector4>& lightBounds = LightManager::GetLocalLightBounds();
+	const unsigned int firstLocalLight = LightManager::GetLightCount(LightType::Directional);
+
+	// Find every cluster touched by the bounding sphere of each light
+	mClusterLights.clear();
+	for (unsigned int i = 0; i < (unsigned int)lightBounds.size(); i++)
+	{
+		const Vector4& sphere = lightBounds[i];
+		const Vector4 center = view * Vector4(sphere.x, sphere.y, sphere.z, 1.f);
+		const float radius = std::min(sphere.w, camera.Far);
+		const float depth = depthRow.z * center.z + depthRow.w;
+
+		if (depth + radius < camera.Near || depth - radius > camera.Far)
+		{
+			continue;
+		}
+
+		const unsigned int firstSlice = GetSlice(depth - radius);
+		const unsigned int lastSlice = GetSlice(depth + radius);
+
+		for (unsigned int z = firstSlice; z <= lastSlice; z++)
+		{
+			for (unsigned int clusterIndex = ClusterCountX * ClusterCountY * z; clusterIndex < ClusterCountX * ClusterCountY * (z + 1); clusterIndex++)
+			{
+				const ClusterBounds& bounds = mClusterBounds[clusterIndex];
+
+				// Squared distance between the center of the sphere and the box
+				float distance = 0.f;
+				for (int axis = 0; axis < 3; axis++)
+				{
+					const float closest = std::clamp(center[axis], bounds.Min[axis], bounds.Max[axis]);
+					distance += (center[axis] - closest) * (center[axis] - closest);
+				}
+
+				if (distance <= radius * radius)
+				{
+					mClusterLights.emplace_back(clusterIndex, firstLocalLight + i);
+				}
+			}
+		}
+	}
+
+	// Counting sort of the pairs by cluster : the header, then an (offset, count) per cluster
+	ClusterHeader header = { { ClusterCountX, ClusterCountY, ClusterCountZ, 0 }, { camera.Width, camera.Height, mSliceScale, mSliceBias } };
+	std::memcpy(mClusterStaging.data(), &header, sizeof(ClusterHeader));
+
+	unsigned int* clusters = mClusterStaging.data() + CLUSTER_HEADER_SIZE;
+	std::fill(clusters, clusters + 2 * ClusterCount, 0);
+
+	for (const std::pair<unsigned int, unsigned int>& pair : mClusterLights)
+	{
+		clusters[2 * pair.first + 1]++;
+	}
+
+	unsigned int offset = 0;
+	for (unsigned int i = 0; i < ClusterCount; i++)
+	{
+		clusters[2 * i] = offset;
+		offset += clusters[2 * i + 1];
+		clusters[2 * i + 1] = 0;
+	}
+
+	mLightIndices.resize(mClusterLights.size());
+	for (const std::pair<unsigned int, unsigned int>& pair : mClusterLights)
+	{
+		mLightIndices[clusters[2 * pair.first] + clusters[2 * pair.first + 1]++] = pair.second;
+	}
+
+	mRenderer->BindBuffer(GL_SHADER_STORAGE_BUFFER, mClusterSSBO);
+	mRenderer->SetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, mClusterStaging.size() * sizeof(unsigned int), mClusterStaging.data());
+
+	const size_t indicesSize = mLightIndices.size() * sizeof(unsigned int);
+
+	mRenderer->BindBuffer(GL_SHADER_STORAGE_BUFFER, mLightIndexSSBO);
+	if (indicesSize > mLightIndexCapacity)
+	{
+		mLightIndexCapacity = std::max(indicesSize, mLightIndexCapacity * 2);
+		mRenderer->SetBufferData(GL_SHADER_STORAGE_BUFFER, (int)mLightIndexCapacity, nullptr, GL_DYNAMIC_DRAW);
+	}
+
+	if (indicesSize > 0)
+	{
+		mRenderer->SetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, indicesSize, mLightIndices.data());
+	}
+
+	mRenderer->BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+size_t LightClusters::GetLightIndexCount()
+{
+	return mLightIndices.size();
+}
@@ -0,0 +1,154 @@
+#include "world/light_manager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "service_locator.h"
+
+#include "wrapper/gl_extensions.h"
+
+#include "world/light.h"
+#include "world/object.h"
+
+// Lights allocated the first time, the buffer grows when more lights are enabled
+constexpr size_t BASE_LIGHT_CAPACITY = 64;
+
+void LightManager::Setup()
+{
+	mRenderer = ServiceLocator::Get<Renderer>();
+
+	mCapacity = sizeof(LightCounts) + BASE_LIGHT_CAPACITY * sizeof(GpuLight);
+
+	mRenderer->GenerateBuffer(1, &mSSBO);
+	mRenderer->BindBuffer(GL_SHADER_STORAGE_BUFFER, mSSBO);
+	mRenderer->SetBufferData(GL_SHADER_STORAGE_BUFFER, (int)mCapacity, nullptr, GL_DYNAMIC_DRAW);
+	mRenderer->BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	mRenderer->BindBufferBase(GL_SHADER_STORAGE_BUFFER, LightBufferBinding, mSSBO);
+}
+
+void LightManager::Register(Light* light)
+{
+	mLights.push_back(light);
+}
+
+void LightManager::Unregister(Light* light)
+{
+	std::erase(mLights, light);
+}
+
+void LightManager::Update()
+{
+	if (!mRenderer)
+	{
+		return;
+	}
+
+	// Count the enabled lights of each type to know where each type starts
+	mLightCounts = {};
+	for (Light* light : mLights)
+	{
+		if (light->IsEnable() && light->GameObject && light->GameObject->IsEnable())
+		{
+			mLightCounts.Count[(unsigned int)light->GetLightType()]++;
+		}
+	}
+
+	unsigned int offsets[(unsigned int)LightType::Count] = {};
+	for (unsigned int i = 1; i < (unsigned int)LightType::Count; i++)
+	{
+		offsets[i] = offsets[i - 1] + mLightCounts.Count[i - 1];
+	}
+
+	const unsigned int lightCount = offsets[(unsigned int)LightType::Count - 1] + mLightCounts.Count[(unsigned int)LightType::Count - 1];
+	const size_t size = sizeof(LightCounts) + lightCount * sizeof(GpuLight);
+
+	mStaging.resize(size);
+	std::memcpy(mStaging.data(), &mLightCounts, sizeof(LightCounts));
+
+	GpuLight* gpuLights = reinterpret_cast<GpuLight*>(mStaging.data() + sizeof(LightCounts));
+	for (Light* light : mLights)
+	{
+		if (light->IsEnable() && light->GameObject && light->GameObject->IsEnable())
+		{
+			light->FillGpuLight(gpuLights[offsets[(unsigned int)light->GetLightType()]++]);
+		}
+	}
+
+	// Bounding spheres of the point and spot lights, used to bin them in the light clusters
+	const unsigned int dirLightCount = mLightCounts.Count[(unsigned int)LightType::Directional];
+	mLocalLightBounds.resize(lightCount - dirLightCount);
+	for (unsigned int i = dirLightCount; i < lightCount; i++)
+	{
+		const GpuLight& gpuLight = gpuLights[i];
+		mLocalLightBounds[i - dirLightCount] = Vector4(gpuLight.Position.x, gpuLight.Position.y, gpuLight.Position.z, ComputeRange(gpuLight));
+	}
+
+	// Nothing changed, the buffer already holds these lights
+	if (mStaging == mUploaded)
+	{
+		return;
+	}
+
+	mRenderer->BindBuffer(GL_SHADER_STORAGE_BUFFER, mSSBO);
+
+	if (size > mCapacity)
+	{
+		mCapacity = std::max(size, mCapacity * 2);
+		mRenderer->SetBufferData(GL_SHADER_STORAGE_BUFFER, (int)mCapacity, nullptr, GL_DYNAMIC_DRAW);
+	}
+
+	mRenderer->SetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, mStaging.data());
+	mRenderer->BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	mUploaded = mStaging;
+	mVersion++;
+}
+
+unsigned int LightManager::GetLightCount(LightType type)
+{
+	return mLightCounts.Count[(unsigned int)type];
+}
+
+const std::vector<Vector4>& LightManager::GetLocalLightBounds()
+{
+	return mLocalLightBounds;
+}
+
+uint64_t LightManager::GetVersion()
+{
+	return mVersion;
+}
+
+float LightManager::ComputeRange(const GpuLight& gpuLight)
+{
+	const float constant = gpuLight.Ambient.w;
+	const float linear = gpuLight.Diffuse.w;
+	const float quadratic = gpuLight.Specular.w;
+
+	const float maxIntensity = std::max({ gpuLight.Ambient.x, gpuLight.Ambient.y, gpuLight.Ambient.z,
+										  gpuLight.Diffuse.x, gpuLight.Diffuse.y, gpuLight.Diffuse.z,
+										  gpuLight.Specular.x, gpuLight.Specular.y, gpuLight.Specular.z });
+
+	// Solve maxIntensity / (constant + linear * d + quadratic * d^2) = LightCutOffIntensity
+	const float attenuationLimit = maxIntensity / LightCutOffIntensity;
+
+	if (attenuationLimit <= constant)
+	{
+		return 0.f;
+	}
+
+	if (quadratic > 0.f)
+	{
+		return (-linear + std::sqrt(linear * linear - 4.f * quadratic * (constant - attenuationLimit))) / (2.f * quadratic);
+	}
+
+	if (linear > 0.f)
+	{
+		return (attenuationLimit - constant) / linear;
+	}
+
+	// Not attenuated, the light reaches every cluster
+	return std::numeric_limits<float>::max();
+}
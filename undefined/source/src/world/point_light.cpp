@@ -7,35 +7,29 @@ PointLight::PointLight()
 PointLight::PointLight(const Vector3& ambient, const Vector3& diffuse, const Vector3& specular, const float constant_attenuation, const float linear_attenuation, const float quadratic_attenuation)
 	: Light(ambient, diffuse, specular), ConstantAttenuation(constant_attenuation), LinearAttenuation(linear_attenuation), QuadraticAttenuation(quadratic_attenuation)
 {
-	mPointLightsArray.push_back(this);
 }
 
 PointLight::~PointLight()
 {
 }
 
-void PointLight::Draw()
+LightType PointLight::GetLightType() const
 {
-	mID = mGlobalID;
-	pShader->Use();
-	pShader->SetVec3("pointLights[" + std::to_string(mID) + "].position", GameTransform->Position);
-	pShader->SetVec3("pointLights[" + std::to_string(mID) + "].ambient", Ambient);
-	pShader->SetVec3("pointLights[" + std::to_string(mID) + "].diffuse", Diffuse);
-	pShader->SetVec3("pointLights[" + std::to_string(mID) + "].specular", Specular);
-	pShader->SetFloat("pointLights[" + std::to_string(mID) + "].constant", ConstantAttenuation);
-	pShader->SetFloat("pointLights[" + std::to_string(mID) + "].linear", LinearAttenuation);
-	pShader->SetFloat("pointLights[" + std::to_string(mID) + "].quadratic", QuadraticAttenuation);
-	pShader->SetBool("pointLights[" + std::to_string(mID) + "].isUsed", true);
-	pShader->UnUse();
-	mGlobalID++;
+	return LightType::Point;
 }
 
-void PointLight::PostDraw()
+void PointLight::FillGpuLight(GpuLight& gpuLight)
 {
-	mGlobalID = 0;
+	const Vector3 position = GameTransform->Position;
+
+	gpuLight.Position = Vector4(position.x, position.y, position.z, 0.f);
+	gpuLight.Direction = Vector4(0.f);
+	gpuLight.Ambient = Vector4(Ambient.x, Ambient.y, Ambient.z, ConstantAttenuation);
+	gpuLight.Diffuse = Vector4(Diffuse.x, Diffuse.y, Diffuse.z, LinearAttenuation);
+	gpuLight.Specular = Vector4(Specular.x, Specular.y, Specular.z, QuadraticAttenuation);
 }
 
 int PointLight::GetNbrOfPointLight() const
 {
-	return (int)mPointLightsArray.size();
+	return (int)LightManager::GetLightCount(LightType::Point);
 }
@@ -1,7 +1,11 @@
 #include "world/scene.h"
 
+#include "resources/model_renderer.h"
+
 #include "world/skybox.h"
 
+#include "wrapper/render_queue.h"
+
 Scene::Scene()
 {
 }
@@ -148,8 +152,26 @@ void Scene::LateUpdate()
 
 void Scene::Draw()
 {
-	Renderer* rend = ServiceLocator::Get<Renderer>();
-	std::shared_ptr<Shader> shader = ResourceManager::Get<Shader>("base_shader");
+	SubmitDraws();
+	RenderQueue::Flush();
+
+	Skybox::Draw();
+}
+
+void Scene::SubmitDraws()
+{
+	// Only the objects whose proxy is in the frustum given to the RenderQueue submit their packets,
+	// the packets are still culled one by one against their own box when the queue is flushed
+	const bool culling = RenderQueue::FrustumCulling;
+	if (culling)
+	{
+		mVisibleQuery++;
+		mBvh.QueryFrustum(RenderQueue::GetFrustum(), [this](void* userData)
+		{
+			static_cast<Object*>(userData)->mVisibleQuery = mVisibleQuery;
+			return true;
+		});
+	}
 
 	for (size_t i = 0; i < Objects.size(); i++)
 	{
@@ -158,20 +180,24 @@ void Scene::Draw()
 			continue;
 		}
 
+		// An object not in the BVH yet is drawn
+		if (culling && Objects[i]->mBvhProxy != DynamicBvh::NullNode && Objects[i]->mVisibleQuery != mVisibleQuery)
+		{
+			continue;
+		}
+
+		// Every packet submitted by the components is stamped with the index of the object
+		RenderQueue::SetCurrentEntity((int)i);
+
 		for (Component* comp : Objects[i]->Components)
 		{
 			if (!comp->IsEnable())
 			{
 				continue;
 			}
-			rend->UseShader(shader->ID);
-			rend->SetUniform(shader->ID, "EntityID", (int)i);
-			rend->UnUseShader();
 			comp->Draw();
 		}
 	}
-
-	Skybox::Draw();
 }
 
 UNDEFINED_ENGINE void Scene::PostDraw()
@@ -201,6 +227,8 @@ Object* Scene::AddObject(const std::string& mName)
 	Objects.push_back(obj);
 	obj->SetParent(nullptr);
 
+	InsertInBvh(obj);
+
 	return obj;
 }
 
@@ -210,6 +238,8 @@ Object* Scene::AddObject(Object* parent, const std::string& mName)
 	Objects.push_back(obj);
 	obj->SetParent(parent);
 
+	InsertInBvh(obj);
+
 	return obj;
 }
 
@@ -221,6 +251,8 @@ Object* Scene::AddObject(Vector3 position, Vector3 rotation, const std::string&
 	obj->GameTransform->Position = position;
 	obj->GameTransform->Rotation = rotation;
 
+	InsertInBvh(obj);
+
 	return obj;
 }
 
@@ -240,6 +272,8 @@ Object* Scene::AddObject(Vector3 position, Vector3 rotation, Object* parent, boo
 		obj->GameTransform->LocalRotation = rotation;
 	}
 
+	InsertInBvh(obj);
+
 	return obj;
 }
 
@@ -259,6 +293,11 @@ UNDEFINED_ENGINE void Scene::RemoveObject(Object* object)
 		{
 			Object::mRoot->DetachChild(object);
 			Objects.erase(Objects.begin() + index);
+			if (object->mBvhProxy != DynamicBvh::NullNode)
+			{
+				mBvh.DestroyProxy(object->mBvhProxy);
+			}
+			mVersion++;
 			Logger::Info("Object \"{}\" removed", object->Name);
 			delete object;
 			Objects.shrink_to_fit();
@@ -269,3 +308,71 @@ UNDEFINED_ENGINE void Scene::RemoveObject(Object* object)
 	Logger::Warning("Object to remove not found in scene \"{}\"", Name);
 }
 
+void Scene::UpdateBvh()
+{
+	for (Object* object : Objects)
+	{
+		// Apply a pending change before reading the version
+		object->mTransform.WorldMatrix();
+
+		const ModelRenderer* modelRenderer = object->GetComponent<ModelRenderer>();
+		const void* model = modelRenderer ? modelRenderer->ModelObject.get() : nullptr;
+
+		if (object->mBvhProxy == DynamicBvh::NullNode)
+		{
+			InsertInBvh(object);
+			continue;
+		}
+
+		if (object->mBvhVersion == object->mTransform.GetVersion() && object->mBvhModel == model)
+		{
+			continue;
+		}
+
+		BoundingBox box;
+		object->mBvhModel = ComputeProxyBounds(object, box);
+		mBvh.MoveProxy(object->mBvhProxy, box);
+		mVersion++;
+		object->mBvhVersion = object->mTransform.GetVersion();
+	}
+}
+
+const DynamicBvh& Scene::GetBvh() const
+{
+	return mBvh;
+}
+
+uint64_t Scene::GetVersion() const
+{
+	return mVersion;
+}
+
+BoundingBox Scene::ComputeBounds(Object* object)
+{
+	BoundingBox box;
+	ComputeProxyBounds(object, box);
+	return box;
+}
+
+void Scene::InsertInBvh(Object* object)
+{
+	BoundingBox box;
+	object->mBvhModel = ComputeProxyBounds(object, box);
+	object->mBvhProxy = mBvh.CreateProxy(box, object);
+	object->mBvhVersion = object->mTransform.GetVersion();
+	mVersion++;
+}
+
+const void* Scene::ComputeProxyBounds(Object* object, BoundingBox& box)
+{
+	ModelRenderer* modelRenderer = object->GetComponent<ModelRenderer>();
+	if (modelRenderer && modelRenderer->GetWorldBounds(box))
+	{
+		return modelRenderer->ModelObject.get();
+	}
+
+	// The model is not loaded yet : no model is recorded so the proxy is refit until its box is known
+	const Vector3 position = object->mTransform.GetPosition();
+	box = { position, position };
+	return nullptr;
+}
@@ -82,6 +82,7 @@ void SceneManager::GlobalUpdate()
 		{
 			obj->mTransform.UpdateTransform();
 		}
+		ActualScene->UpdateBvh();
 		return;
 	}
 
@@ -96,6 +97,7 @@ void SceneManager::GlobalUpdate()
 		{
 			obj->mTransform.UpdateTransform();
 		}
+		ActualScene->UpdateBvh();
 		return;
 	}
 
@@ -115,6 +117,7 @@ void SceneManager::GlobalUpdate()
 	{
 		obj->mTransform.UpdateTransform();
 	}
+	ActualScene->UpdateBvh();
 }
 
 void SceneManager::Draw()
@@ -7,8 +7,6 @@
 
 #include "service_locator.h"
 
-#include "interface/interface.h"
-
 void Skybox::Setup()
 {
 	mSkyboxShader = ResourceManager::Get<Shader>("skybox_shader");
@@ -24,22 +22,14 @@ void Skybox::Setup()
 	mRenderer->BindBuffers(0, 0, 0);
 }
 
-void Skybox::Update(Camera* cam)
+void Skybox::Draw()
 {
-	mRenderer->UseShader(mSkyboxShader->ID);
-
-	for (int i = 0; i < Interface::EditorViewports.size(); i++)
+	// Nothing to draw with the fallback program, the sky appears once its program is built
+	if (!mSkyboxShader->IsReady())
 	{
-		mView = Matrix4x4(Matrix3x3(cam->GetView())); // remove translation from the view matrix
-		mRenderer->SetUniform(mSkyboxShader->ID, "view", mView);
-		mRenderer->SetUniform(mSkyboxShader->ID, "projection", cam->GetProjection());
+		return;
 	}
 
-	mRenderer->UnUseShader();
-}
-
-void Skybox::Draw()
-{
 	mRenderer->UseShader(mSkyboxShader->ID);
 
 	mRenderer->SetDepth(GL_LEQUAL);  // change depth function so depth test passes when values are equal to depth buffer's content
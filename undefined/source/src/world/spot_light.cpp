@@ -7,41 +7,29 @@ SpotLight::SpotLight()
 SpotLight::SpotLight(const Vector3& direction, const Vector3& ambient, const Vector3& diffuse, const Vector3& specular, const float cutOff, const float outerCutOff, const float constant, const float linear, const float quadratic)
 	: Light(ambient, diffuse, specular), Direction(direction), CutOff(cutOff), OuterCutOff(outerCutOff), ConstantAttenuation(constant), LinearAttenuation(linear), QuadraticAttenuation(quadratic)
 {
-	mSpotLightsArray.push_back(this);
 }
 
 SpotLight::~SpotLight()
 {
 }
 
-void SpotLight::Draw()
+LightType SpotLight::GetLightType() const
 {
-	mID = mGlobalID;
-	pShader->Use();
-	pShader->SetVec3("spotLights[" + std::to_string(mID) + "].position", GameTransform->Position);
-	pShader->SetVec3("spotLights[" + std::to_string(mID) + "].direction", Direction);
-	pShader->SetVec3("spotLights[" + std::to_string(mID) + "].ambient", Ambient);
-	pShader->SetVec3("spotLights[" + std::to_string(mID) + "].diffuse", Diffuse);
-	pShader->SetVec3("spotLights[" + std::to_string(mID) + "].specular", Specular);
-	pShader->SetFloat("spotLights[" + std::to_string(mID) + "].constant", ConstantAttenuation);
-	pShader->SetFloat("spotLights[" + std::to_string(mID) + "].linear", LinearAttenuation);
-	pShader->SetFloat("spotLights[" + std::to_string(mID) + "].quadratic", QuadraticAttenuation);
-	pShader->SetFloat("spotLights[" + std::to_string(mID) + "].cutOff", CutOff);
-	pShader->SetFloat("spotLights[" + std::to_string(mID) + "].outerCutOff", OuterCutOff);
-	pShader->SetBool("spotLights[" + std::to_string(mID) + "].isUsed", true);
-	pShader->UnUse();
-	mGlobalID++;
+	return LightType::Spot;
 }
 
-void SpotLight::PostDraw()
+void SpotLight::FillGpuLight(GpuLight& gpuLight)
 {
-	pShader->Use();
-	pShader->SetBool("spotLights[" + std::to_string(mID) + "].isUsed", false);
-	mGlobalID = 0;
-	pShader->UnUse();
+	const Vector3 position = GameTransform->Position;
+
+	gpuLight.Position = Vector4(position.x, position.y, position.z, OuterCutOff);
+	gpuLight.Direction = Vector4(Direction.x, Direction.y, Direction.z, CutOff);
+	gpuLight.Ambient = Vector4(Ambient.x, Ambient.y, Ambient.z, ConstantAttenuation);
+	gpuLight.Diffuse = Vector4(Diffuse.x, Diffuse.y, Diffuse.z, LinearAttenuation);
+	gpuLight.Specular = Vector4(Specular.x, Specular.y, Specular.z, QuadraticAttenuation);
 }
 
 int SpotLight::GetNbrOfSpotLight() const
 {
-	return (int)mSpotLightsArray.size();
+	return (int)LightManager::GetLightCount(LightType::Spot);
 }
@@ -1,6 +1,7 @@
 #include "world/transform.h"
 
 #include <cmath>
+#include <cstring>
 #include <toolbox/Matrix3x3.h>
 #include <toolbox/Quaternion.h>
 #include <toolbox/Calc.h>
@@ -8,6 +9,8 @@
 
 void Transform::UpdateTransform()
 {
+	const Matrix4x4 previousWorldTRS = mWorldTRS;
+
 	if (mParentTransform)
 	{
 		mWorldTRS = mLocalTRS * mParentTransform->WorldMatrix();
@@ -26,6 +29,12 @@ void Transform::UpdateTransform()
 	mLocalRotation = mLocalTRS.ToQuaternion();
 	Matrix3x3 localTrans = Matrix4x4::Transpose(mLocalTRS);
 	mLocalScale = Vector3(localTrans[0].Norm(), localTrans[1].Norm(), localTrans[2].Norm());
+
+	// Called every frame, only a real change makes the caches stale
+	if (std::memcmp(&previousWorldTRS, &mWorldTRS, sizeof(Matrix4x4)) != 0)
+	{
+		mVersion++;
+	}
 }
 
 const Matrix4x4& Transform::LocalMatrix()
@@ -42,6 +51,8 @@ const Matrix4x4& Transform::LocalMatrix()
 		{
 			mLocalTRS = mWorldTRS;
 		}
+
+		mVersion++;
 	}
 
 	return mLocalTRS;
@@ -69,6 +80,8 @@ void Transform::SetLocalMatrix(const Matrix4x4& matrix)
 	mRotation = mWorldTRS.ToQuaternion();
 	trans = Matrix4x4::Transpose(mWorldTRS);
 	mScale = Vector3(trans[0].Norm(), trans[1].Norm(), trans[2].Norm());
+
+	mVersion++;
 }
 
 const Matrix4x4& Transform::WorldMatrix()
@@ -85,6 +98,8 @@ const Matrix4x4& Transform::WorldMatrix()
 		{
 			mLocalTRS = mWorldTRS;
 		}
+
+		mVersion++;
 	}
 
 	return mWorldTRS;
@@ -112,6 +127,8 @@ void Transform::SetWorldMatrix(const Matrix4x4& matrix)
 	mLocalRotation = mLocalTRS.ToQuaternion();
 	trans = Matrix4x4::Transpose(mLocalTRS);
 	mLocalScale = Vector3(trans[0].Norm(), trans[1].Norm(), trans[2].Norm());
+
+	mVersion++;
 }
 
 Vector3 Transform::GetPosition()
@@ -134,6 +151,8 @@ void Transform::SetPosition(Vector3 newPosition)
 
 	mLocalPosition = { mLocalTRS[0][3], mLocalTRS[1][3], mLocalTRS[2][3] };
 	mPosition = { mWorldTRS[0][3], mWorldTRS[1][3], mWorldTRS[2][3] };
+
+	mVersion++;
 }
 
 Vector3 Transform::GetRotation()
@@ -171,6 +190,8 @@ void Transform::SetRotationRad(Vector3 newRotationRad)
 	mLocalRotation = mLocalTRS.ToQuaternion();
 
 	mRotation = mWorldTRS.ToQuaternion();
+
+	mVersion++;
 }
 
 Quaternion Transform::GetRotationQuat()
@@ -194,6 +215,8 @@ void Transform::SetRotationQuat(const Quaternion& newRotationQuat)
 	 mLocalRotation = mLocalTRS.ToQuaternion();
 
 	 mRotation = mWorldTRS.ToQuaternion();
+
+	 mVersion++;
 }
 
 Vector3 Transform::GetScale()
@@ -219,6 +242,8 @@ void Transform::SetScale(Vector3 newScale)
 
 	trans = Matrix4x4::Transpose(mWorldTRS);
 	mScale = Vector3(trans[0].Norm(), trans[1].Norm(), trans[2].Norm());
+
+	mVersion++;
 }
 
 Vector3 Transform::GetLocalPosition()
@@ -242,6 +267,8 @@ void Transform::SetLocalPosition(Vector3 newLocalPosition)
 	}
 
 	mPosition = { mWorldTRS[0][3], mWorldTRS[1][3], mWorldTRS[2][3] };
+
+	mVersion++;
 }
 
 Vector3 Transform::GetLocalRotation()
@@ -282,6 +309,8 @@ void Transform::SetLocalRotationRad(Vector3 newLocalRotationRad)
 	}
 	
 	mRotation = mWorldTRS.ToQuaternion();
+
+	mVersion++;
 }
 
 Quaternion Transform::GetLocalRotationQuat()
@@ -305,6 +334,8 @@ void Transform::SetLocalRotationQuat(Quaternion newLocalRotationQuat)
 	mLocalRotation = mLocalTRS.ToQuaternion();
 
 	mRotation = mWorldTRS.ToQuaternion();
+
+	mVersion++;
 }
 
 Vector3 Transform::GetLocalScale()
@@ -328,4 +359,11 @@ void Transform::SetLocalScale(Vector3 newLocalScale)
 
 	Matrix3x3 trans = Matrix4x4::Transpose(mWorldTRS);
 	mScale = Vector3(trans[0].Norm(), trans[1].Norm(), trans[2].Norm());
+
+	mVersion++;
+}
+
+unsigned int Transform::GetVersion() const
+{
+	return mVersion;
 }
\ No newline at end of file
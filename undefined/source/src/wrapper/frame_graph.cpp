@@ -0,0 +1,330 @@
+#include "wrapper/frame_graph.h"
+
+#include <algorithm>
+
+#include "service_locator.h"
+
+#include "engine_debug/logger.h"
+
+#include "wrapper/render_target_pool.h"
+
+FrameGraph::Builder::Builder(FrameGraph& graph, uint32_t pass)
+	: mGraph(graph), mPass(pass)
+{
+}
+
+FrameGraphResource FrameGraph::Builder::Read(FrameGraphResource resource)
+{
+	if (!resource.IsValid())
+	{
+		return resource;
+	}
+
+	mGraph.mPasses[mPass].Reads.push_back(resource);
+	mGraph.mResources[resource.Index].Readers[resource.Version].push_back(mPass);
+
+	return resource;
+}
+
+FrameGraphResource FrameGraph::Builder::Write(FrameGraphResource resource)
+{
+	if (!resource.IsValid())
+	{
+		return resource;
+	}
+
+	Resource& graphResource = mGraph.mResources[resource.Index];
+	if (resource.Version + 1 != graphResource.Writers.size())
+	{
+		Logger::Warning("FrameGraph : pass {} writes an old version of {}", mGraph.mPasses[mPass].Name, graphResource.Name);
+	}
+
+	mGraph.mPasses[mPass].Writes.push_back(resource);
+	graphResource.Writers.push_back((int)mPass);
+	graphResource.Readers.emplace_back();
+
+	return { resource.Index, (uint32_t)graphResource.Writers.size() - 1 };
+}
+
+void FrameGraph::Builder::SetSideEffect()
+{
+	mGraph.mPasses[mPass].HasSideEffect = true;
+}
+
+void FrameGraph::Reset()
+{
+	// Only when the last frame has not been executed
+	for (Resource& resource : mResources)
+	{
+		if (resource.IsTransient && resource.TextureID)
+		{
+			RenderTargetPool::Release(resource.TextureID);
+		}
+	}
+
+	mResources.clear();
+	mPasses.clear();
+	mOutputs.clear();
+	mOrder.clear();
+}
+
+FrameGraphResource FrameGraph::CreateTexture(const char* name, const FrameGraphTextureDesc& desc)
+{
+	Resource& resource = mResources.emplace_back();
+	resource.Name = name;
+	resource.Desc = desc;
+	resource.IsTransient = true;
+	resource.Writers.push_back(-1);
+	resource.Readers.emplace_back();
+
+	return { (uint32_t)mResources.size() - 1, 0 };
+}
+
+FrameGraphResource FrameGraph::Import(const char* name, unsigned int textureID)
+{
+	Resource& resource = mResources.emplace_back();
+	resource.Name = name;
+	resource.TextureID = textureID;
+	resource.Writers.push_back(-1);
+	resource.Readers.emplace_back();
+
+	return { (uint32_t)mResources.size() - 1, 0 };
+}
+
+void FrameGraph::MarkOutput(FrameGraphResource resource)
+{
+	if (resource.IsValid())
+	{
+		mOutputs.push_back(resource);
+	}
+}
+
+void FrameGraph::AddPass(const char* name, const std::function<void(Builder&)>& setup, ExecuteFunction execute)
+{
+	Pass& pass = mPasses.emplace_back();
+	pass.Name = name;
+	pass.Execute = std::move(execute);
+
+	Builder builder(*this, (uint32_t)mPasses.size() - 1);
+	setup(builder);
+}
+
+void FrameGraph::Compile()
+{
+	mOrder.clear();
+	for (Pass& pass : mPasses)
+	{
+		pass.IsKept = false;
+	}
+
+	for (uint32_t i = 0; i < mPasses.size(); i++)
+	{
+		if (mPasses[i].HasSideEffect)
+		{
+			Keep(i);
+		}
+	}
+
+	for (const FrameGraphResource& output : mOutputs)
+	{
+		const int writer = mResources[output.Index].Writers[output.Version];
+		if (writer >= 0)
+		{
+			Keep((uint32_t)writer);
+		}
+	}
+
+	if (!SortPasses())
+	{
+		Logger::Error("FrameGraph : the passes depend on each other, they run in the order they were added");
+
+		mOrder.clear();
+		for (uint32_t i = 0; i < mPasses.size(); i++)
+		{
+			if (mPasses[i].IsKept)
+			{
+				mOrder.push_back(i);
+			}
+		}
+	}
+
+	// Lifetime of each resource in the execution order
+	for (Resource& resource : mResources)
+	{
+		resource.FirstUse = SIZE_MAX;
+		resource.LastUse = 0;
+	}
+
+	for (size_t position = 0; position < mOrder.size(); position++)
+	{
+		const Pass& pass = mPasses[mOrder[position]];
+		for (const std::vector<FrameGraphResource>* resources : { &pass.Reads, &pass.Writes })
+		{
+			for (const FrameGraphResource& handle : *resources)
+			{
+				Resource& resource = mResources[handle.Index];
+				resource.FirstUse = std::min(resource.FirstUse, position);
+				resource.LastUse = std::max(resource.LastUse, position);
+			}
+		}
+	}
+}
+
+void FrameGraph::Execute()
+{
+	Renderer* renderer = ServiceLocator::Get<Renderer>();
+
+	// Textures given to the transient resources of this frame, a texture given twice is shared by two resources
+	std::vector<unsigned int> usedTextures;
+
+	for (size_t position = 0; position < mOrder.size(); position++)
+	{
+		for (Resource& resource : mResources)
+		{
+			if (resource.IsTransient && resource.FirstUse == position)
+			{
+				const FrameGraphTextureDesc& desc = resource.Desc;
+				resource.TextureID = RenderTargetPool::Acquire(desc.Width, desc.Height, desc.InternalFormat, desc.Levels);
+
+				renderer->Counters.TransientTargets++;
+				if (std::find(usedTextures.begin(), usedTextures.end(), resource.TextureID) != usedTextures.end())
+				{
+					renderer->Counters.TransientTargetsAliased++;
+				}
+				else
+				{
+					usedTextures.push_back(resource.TextureID);
+				}
+			}
+		}
+
+		mPasses[mOrder[position]].Execute(*this);
+
+		// Given back right after its last pass, the next transient texture of the same size and format takes it
+		for (Resource& resource : mResources)
+		{
+			if (resource.IsTransient && resource.TextureID && resource.LastUse == position)
+			{
+				RenderTargetPool::Release(resource.TextureID);
+				resource.TextureID = 0;
+			}
+		}
+	}
+
+	renderer->Counters.PassesExecuted += (unsigned int)mOrder.size();
+	renderer->Counters.PassesCulled += (unsigned int)(mPasses.size() - mOrder.size());
+}
+
+unsigned int FrameGraph::GetTexture(FrameGraphResource resource) const
+{
+	return resource.IsValid() ? mResources[resource.Index].TextureID : 0;
+}
+
+size_t FrameGraph::GetPassCount() const
+{
+	return mPasses.size();
+}
+
+const char* FrameGraph::GetPassName(size_t pass) const
+{
+	return mPasses[pass].Name;
+}
+
+bool FrameGraph::IsPassExecuted(size_t pass) const
+{
+	return mPasses[pass].IsKept;
+}
+
+void FrameGraph::Keep(uint32_t pass)
+{
+	if (mPasses[pass].IsKept)
+	{
+		return;
+	}
+	mPasses[pass].IsKept = true;
+
+	// The content read and the content a write is drawn over are both needed
+	for (const std::vector<FrameGraphResource>* resources : { &mPasses[pass].Reads, &mPasses[pass].Writes })
+	{
+		for (const FrameGraphResource& handle : *resources)
+		{
+			const int writer = mResources[handle.Index].Writers[handle.Version];
+			if (writer >= 0 && (uint32_t)writer != pass)
+			{
+				Keep((uint32_t)writer);
+			}
+		}
+	}
+}
+
+bool FrameGraph::SortPasses()
+{
+	std::vector<std::vector<uint32_t>> dependents(mPasses.size());
+	std::vector<uint32_t> dependencyCount(mPasses.size(), 0);
+
+	const auto addDependency = [&](int before, uint32_t after)
+	{
+		if (before >= 0 && (uint32_t)before != after && mPasses[before].IsKept)
+		{
+			dependents[before].push_back(after);
+			dependencyCount[after]++;
+		}
+	};
+
+	for (uint32_t i = 0; i < mPasses.size(); i++)
+	{
+		if (!mPasses[i].IsKept)
+		{
+			continue;
+		}
+
+		for (const FrameGraphResource& handle : mPasses[i].Reads)
+		{
+			addDependency(mResources[handle.Index].Writers[handle.Version], i);
+		}
+
+		// A write waits for the pass writing the version it replaces and for the passes reading it
+		for (const FrameGraphResource& handle : mPasses[i].Writes)
+		{
+			const Resource& resource = mResources[handle.Index];
+			addDependency(resource.Writers[handle.Version], i);
+			for (const uint32_t reader : resource.Readers[handle.Version])
+			{
+				addDependency((int)reader, i);
+			}
+		}
+	}
+
+	// The pass added first among the ready ones runs first
+	std::vector<uint32_t> ready;
+	size_t keptCount = 0;
+	for (uint32_t i = 0; i < mPasses.size(); i++)
+	{
+		if (mPasses[i].IsKept)
+		{
+			keptCount++;
+			if (dependencyCount[i] == 0)
+			{
+				ready.push_back(i);
+			}
+		}
+	}
+
+	while (!ready.empty())
+	{
+		std::vector<uint32_t>::iterator first = std::min_element(ready.begin(), ready.end());
+		const uint32_t pass = *first;
+		ready.erase(first);
+		mOrder.push_back(pass);
+
+		for (const uint32_t dependent : dependents[pass])
+		{
+			if (--dependencyCount[dependent] == 0)
+			{
+				ready.push_back(dependent);
+			}
+		}
+	}
+
+	return mOrder.size() == keptCount;
+}
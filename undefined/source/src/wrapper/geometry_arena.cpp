@@ -0,0 +1,249 @@
+#include "wrapper/geometry_arena.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#include "service_locator.h"
+
+#include "resources/mesh.h"
+
+#include "wrapper/gl_extensions.h"
+#include "wrapper/render_queue.h"
+
+// Elements allocated the first time, the buffers double when they are full
+constexpr unsigned int BASE_VERTEX_CAPACITY = 1 << 16;
+constexpr unsigned int BASE_INDEX_CAPACITY = 1 << 18;
+
+GeometryArena& GeometryArena::Get(VertexFormat format, unsigned int indexType)
+{
+	for (GeometryArena* arena : mArenas)
+	{
+		if (arena->mFormat == format && arena->mIndexType == indexType)
+		{
+			return *arena;
+		}
+	}
+
+	mArenas.push_back(new GeometryArena(format, indexType));
+	return *mArenas.back();
+}
+
+GeometryArena::GeometryArena(VertexFormat format, unsigned int indexType)
+	: mFormat(format), mIndexType(indexType)
+{
+	mRenderer = ServiceLocator::Get<Renderer>();
+
+	switch (mFormat)
+	{
+	case VertexFormat::Standard:
+		mVertexSize = sizeof(Vertex);
+		break;
+
+	case VertexFormat::Packed:
+		mVertexSize = sizeof(PackedVertex);
+		break;
+	}
+
+	mIndexSize = mIndexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+
+	mRenderer->GenerateVertexArray(1, &mVAO);
+
+	Grow(mVBO, mVertexCapacity, mVertexSize, BASE_VERTEX_CAPACITY, mVertexRanges);
+	Grow(mEBO, mIndexCapacity, mIndexSize, BASE_INDEX_CAPACITY, mIndexRanges);
+}
+
+GeometryAllocation GeometryArena::Allocate(const void* vertices, unsigned int vertexCount, const void* indices, unsigned int indexCount)
+{
+	GeometryAllocation allocation;
+	allocation.Arena = this;
+	allocation.VertexCount = vertexCount;
+	allocation.IndexCount = indexCount;
+
+	if (!mVertexRanges.Allocate(vertexCount, allocation.BaseVertex))
+	{
+		Grow(mVBO, mVertexCapacity, mVertexSize, mVertexCapacity + vertexCount, mVertexRanges);
+		mVertexRanges.Allocate(vertexCount, allocation.BaseVertex);
+	}
+
+	if (!mIndexRanges.Allocate(indexCount, allocation.FirstIndex))
+	{
+		Grow(mEBO, mIndexCapacity, mIndexSize, mIndexCapacity + indexCount, mIndexRanges);
+		mIndexRanges.Allocate(indexCount, allocation.FirstIndex);
+	}
+
+	// Upload through the copy target, binding the EBO would change the element buffer of the VAO currently bound
+	mRenderer->BindBuffer(GL_COPY_WRITE_BUFFER, mVBO);
+	mRenderer->SetBufferSubData(GL_COPY_WRITE_BUFFER, allocation.BaseVertex * mVertexSize, vertexCount * mVertexSize, vertices);
+	mRenderer->BindBuffer(GL_COPY_WRITE_BUFFER, mEBO);
+	mRenderer->SetBufferSubData(GL_COPY_WRITE_BUFFER, allocation.FirstIndex * mIndexSize, indexCount * mIndexSize, indices);
+	mRenderer->BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	return allocation;
+}
+
+void GeometryArena::Free(const GeometryAllocation& allocation)
+{
+	mVertexRanges.Free(allocation.BaseVertex, allocation.VertexCount);
+	mIndexRanges.Free(allocation.FirstIndex, allocation.IndexCount);
+}
+
+unsigned int GeometryArena::GetVAO() const
+{
+	return mVAO;
+}
+
+unsigned int GeometryArena::GetIndexType() const
+{
+	return mIndexType;
+}
+
+size_t GeometryArena::GetIndexSize() const
+{
+	return mIndexSize;
+}
+
+size_t GeometryArena::GetTotalMemory()
+{
+	size_t memory = 0;
+	for (GeometryArena* arena : mArenas)
+	{
+		memory += arena->mVertexCapacity * arena->mVertexSize + arena->mIndexCapacity * arena->mIndexSize;
+	}
+
+	return memory;
+}
+
+void GeometryArena::ResetAttributes()
+{
+	for (GeometryArena* arena : mArenas)
+	{
+		arena->SetAttributes();
+	}
+}
+
+void GeometryArena::Grow(unsigned int& buffer, unsigned int& capacity, size_t elementSize, unsigned int minCapacity, RangeAllocator& allocator)
+{
+	const unsigned int newCapacity = std::max(minCapacity, capacity * 2);
+
+	unsigned int newBuffer = 0;
+	mRenderer->GenerateBuffer(1, &newBuffer);
+	mRenderer->BindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+	mRenderer->SetBufferStorage(GL_COPY_WRITE_BUFFER, newCapacity * elementSize, nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+	if (buffer)
+	{
+		mRenderer->BindBuffer(GL_COPY_READ_BUFFER, buffer);
+		mRenderer->CopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, capacity * elementSize);
+		mRenderer->BindBuffer(GL_COPY_READ_BUFFER, 0);
+		mRenderer->DeleteBuffers(1, &buffer);
+	}
+
+	mRenderer->BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	allocator.Grow(capacity, newCapacity);
+	buffer = newBuffer;
+	capacity = newCapacity;
+
+	SetAttributes();
+}
+
+void GeometryArena::SetAttributes()
+{
+	if (!mVBO || !mEBO)
+	{
+		return;
+	}
+
+	mRenderer->BindVertexArray(mVAO);
+	mRenderer->BindBuffer(GL_ARRAY_BUFFER, mVBO);
+	mRenderer->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEBO);
+
+	switch (mFormat)
+	{
+	case VertexFormat::Standard:
+		// vertex positions
+		mRenderer->AttributePointers(0, 3, GL_FLOAT, sizeof(Vertex), (void*)0);
+
+		// vertex normals
+		mRenderer->AttributePointers(1, 3, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+
+		// vertex texture coords
+		mRenderer->AttributePointers(2, 2, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+		break;
+
+	case VertexFormat::Packed:
+		// vertex positions, from -1 to 1 in the bounding box (the model matrix of the instances brings them back in the space of the mesh)
+		mRenderer->AttributePointers(0, 3, GL_SHORT, sizeof(PackedVertex), (void*)offsetof(PackedVertex, Position), true);
+
+		// vertex normals, the fourth component is unused
+		mRenderer->AttributePointers(1, 4, GL_INT_2_10_10_10_REV, sizeof(PackedVertex), (void*)offsetof(PackedVertex, Normal), true);
+
+		// vertex texture coords
+		mRenderer->AttributePointers(2, 2, GL_HALF_FLOAT, sizeof(PackedVertex), (void*)offsetof(PackedVertex, TexCoords));
+		break;
+	}
+
+	// model matrix and entity id of each instance
+	RenderQueue::SetInstanceAttributes();
+
+	// Unbind the VAO first so it keeps its element buffer
+	mRenderer->BindVertexArray(0);
+	mRenderer->BindBuffer(GL_ARRAY_BUFFER, 0);
+	mRenderer->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+bool GeometryArena::RangeAllocator::Allocate(unsigned int count, unsigned int& offset)
+{
+	for (size_t i = 0; i < mFreeRanges.size(); i++)
+	{
+		std::pair<unsigned int, unsigned int>& range = mFreeRanges[i];
+
+		if (range.second < count)
+		{
+			continue;
+		}
+
+		offset = range.first;
+		range.first += count;
+		range.second -= count;
+
+		if (range.second == 0)
+		{
+			mFreeRanges.erase(mFreeRanges.begin() + i);
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+void GeometryArena::RangeAllocator::Free(unsigned int offset, unsigned int count)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	std::vector<std::pair<unsigned int, unsigned int>>::iterator next = std::lower_bound(mFreeRanges.begin(), mFreeRanges.end(), std::make_pair(offset, 0u));
+	next = mFreeRanges.insert(next, { offset, count });
+
+	// Merge with the next range
+	if (next + 1 != mFreeRanges.end() && next->first + next->second == (next + 1)->first)
+	{
+		next->second += (next + 1)->second;
+		mFreeRanges.erase(next + 1);
+	}
+
+	// Merge with the previous range
+	if (next != mFreeRanges.begin() && (next - 1)->first + (next - 1)->second == next->first)
+	{
+		(next - 1)->second += next->second;
+		mFreeRanges.erase(next);
+	}
+}
+
+void GeometryArena::RangeAllocator::Grow(unsigned int oldCapacity, unsigned int newCapacity)
+{
+	Free(oldCapacity, newCapacity - oldCapacity);
+}
@@ -0,0 +1,127 @@
+#include "wrapper/gl_extensions.h"
+
+#include <cstring>
+#include <glfw/glfw3.h>
+
+#include "engine_debug/logger.h"
+
+#ifndef GL_VERSION_3_2
+PFNGLFENCESYNCPROC glad_glFenceSync = nullptr;
+PFNGLCLIENTWAITSYNCPROC glad_glClientWaitSync = nullptr;
+PFNGLDELETESYNCPROC glad_glDeleteSync = nullptr;
+#endif
+
+#ifndef GL_VERSION_3_3
+PFNGLVERTEXATTRIBDIVISORPROC glad_glVertexAttribDivisor = nullptr;
+PFNGLGETQUERYOBJECTUI64VPROC glad_glGetQueryObjectui64v = nullptr;
+#endif
+
+#ifndef GL_VERSION_4_1
+PFNGLGETPROGRAMBINARYPROC glad_glGetProgramBinary = nullptr;
+PFNGLPROGRAMBINARYPROC glad_glProgramBinary = nullptr;
+PFNGLPROGRAMPARAMETERIPROC glad_glProgramParameteri = nullptr;
+#endif
+
+#ifndef GL_VERSION_4_2
+PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC glad_glDrawElementsInstancedBaseVertexBaseInstance = nullptr;
+PFNGLBINDIMAGETEXTUREPROC glad_glBindImageTexture = nullptr;
+PFNGLMEMORYBARRIERPROC glad_glMemoryBarrier = nullptr;
+PFNGLTEXSTORAGE2DPROC glad_glTexStorage2D = nullptr;
+#endif
+
+#ifndef GL_VERSION_4_3
+PFNGLMULTIDRAWELEMENTSINDIRECTPROC glad_glMultiDrawElementsIndirect = nullptr;
+PFNGLDISPATCHCOMPUTEPROC glad_glDispatchCompute = nullptr;
+PFNGLCOPYIMAGESUBDATAPROC glad_glCopyImageSubData = nullptr;
+#endif
+
+#ifndef GL_VERSION_4_4
+PFNGLBUFFERSTORAGEPROC glad_glBufferStorage = nullptr;
+#endif
+
+#ifndef GL_KHR_parallel_shader_compile
+PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glad_glMaxShaderCompilerThreadsKHR = nullptr;
+#endif
+
+template <typename FunctionT>
+static bool LoadFunction(FunctionT& function, const char* name)
+{
+	function = reinterpret_cast<FunctionT>(glfwGetProcAddress(name));
+
+	if (!function)
+	{
+		Logger::Error("OpenGL function {} could not be loaded", name);
+		return false;
+	}
+
+	return true;
+}
+
+bool GLExtensions::Load()
+{
+	bool isLoaded = true;
+
+#ifndef GL_VERSION_3_2
+	isLoaded &= LoadFunction(glad_glFenceSync, "glFenceSync");
+	isLoaded &= LoadFunction(glad_glClientWaitSync, "glClientWaitSync");
+	isLoaded &= LoadFunction(glad_glDeleteSync, "glDeleteSync");
+#endif
+
+#ifndef GL_VERSION_3_3
+	isLoaded &= LoadFunction(glad_glVertexAttribDivisor, "glVertexAttribDivisor");
+	isLoaded &= LoadFunction(glad_glGetQueryObjectui64v, "glGetQueryObjectui64v");
+#endif
+
+#ifndef GL_VERSION_4_1
+	isLoaded &= LoadFunction(glad_glGetProgramBinary, "glGetProgramBinary");
+	isLoaded &= LoadFunction(glad_glProgramBinary, "glProgramBinary");
+	isLoaded &= LoadFunction(glad_glProgramParameteri, "glProgramParameteri");
+#endif
+
+#ifndef GL_VERSION_4_2
+	isLoaded &= LoadFunction(glad_glDrawElementsInstancedBaseVertexBaseInstance, "glDrawElementsInstancedBaseVertexBaseInstance");
+	isLoaded &= LoadFunction(glad_glBindImageTexture, "glBindImageTexture");
+	isLoaded &= LoadFunction(glad_glMemoryBarrier, "glMemoryBarrier");
+	isLoaded &= LoadFunction(glad_glTexStorage2D, "glTexStorage2D");
+#endif
+
+#ifndef GL_VERSION_4_3
+	isLoaded &= LoadFunction(glad_glMultiDrawElementsIndirect, "glMultiDrawElementsIndirect");
+	isLoaded &= LoadFunction(glad_glDispatchCompute, "glDispatchCompute");
+	isLoaded &= LoadFunction(glad_glCopyImageSubData, "glCopyImageSubData");
+#endif
+
+#ifndef GL_VERSION_4_4
+	isLoaded &= LoadFunction(glad_glBufferStorage, "glBufferStorage");
+#endif
+
+	// Optional, the shaders are then finished one by one
+	ParallelShaderCompile = HasExtension("GL_KHR_parallel_shader_compile") || HasExtension("GL_ARB_parallel_shader_compile");
+	if (ParallelShaderCompile)
+	{
+		glad_glMaxShaderCompilerThreadsKHR = reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+		if (!glad_glMaxShaderCompilerThreadsKHR)
+		{
+			glad_glMaxShaderCompilerThreadsKHR = reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(glfwGetProcAddress("glMaxShaderCompilerThreadsARB"));
+		}
+	}
+
+	return isLoaded;
+}
+
+bool GLExtensions::HasExtension(const char* name)
+{
+	int count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+	for (int i = 0; i < count; i++)
+	{
+		const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+		if (extension && std::strcmp(extension, name) == 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
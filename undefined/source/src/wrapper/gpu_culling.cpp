@@ -0,0 +1,244 @@
+#include "wrapper/gpu_culling.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "service_locator.h"
+
+#include "camera/camera.h"
+
+#include "engine_debug/logger.h"
+
+#include "resources/resource_manager.h"
+#include "resources/shader.h"
+
+#include "wrapper/gl_extensions.h"
+#include "wrapper/render_queue.h"
+#include "wrapper/render_target_pool.h"
+
+static_assert(sizeof(InstanceData) == 17 * sizeof(float), "InstanceData must match INSTANCE_SIZE in the culling shader");
+static_assert(sizeof(GpuCullObject) == 32, "GpuCullObject must match the CullObject struct of the culling shader");
+
+// Number of counter buffers, the counters of a frame are read back when their buffer is reused
+constexpr size_t STATS_FRAME_COUNT = 3;
+
+// Local sizes of the compute shaders
+constexpr unsigned int CULL_GROUP_SIZE = 64;
+constexpr unsigned int PYRAMID_GROUP_SIZE = 8;
+
+void GpuCulling::Setup()
+{
+	mRenderer = ServiceLocator::Get<Renderer>();
+
+	mCullShader = ResourceManager::Get<Shader>("cull_shader");
+	mPyramidShader = ResourceManager::Get<Shader>("depth_pyramid_shader");
+
+	if (!mCullShader || !mPyramidShader || !mCullShader->ID || !mPyramidShader->ID)
+	{
+		Logger::Warning("GpuCulling::Setup() compute shaders not found, the culling stays on the CPU");
+		return;
+	}
+
+	const GpuCullingStats zero;
+	mStatsBuffers.resize(STATS_FRAME_COUNT);
+	mStatsFences.resize(STATS_FRAME_COUNT, nullptr);
+	for (unsigned int& buffer : mStatsBuffers)
+	{
+		mRenderer->GenerateBuffer(1, &buffer);
+		mRenderer->BindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+		mRenderer->SetBufferStorage(GL_SHADER_STORAGE_BUFFER, sizeof(GpuCullingStats), &zero, GL_DYNAMIC_STORAGE_BIT);
+	}
+	mRenderer->BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+bool GpuCulling::IsReady()
+{
+	// The culling stays on the CPU while the programs are built
+	return mCullShader && mPyramidShader && mCullShader->IsReady() && mPyramidShader->IsReady();
+}
+
+void GpuCulling::BeginFrame()
+{
+	if (mStatsBuffers.empty())
+	{
+		return;
+	}
+
+	// Every dispatch of the last frame is recorded, the fence tells when its counters are written
+	if (mStatsFences[mStatsIndex])
+	{
+		mRenderer->DeleteSync(mStatsFences[mStatsIndex]);
+	}
+	mStatsFences[mStatsIndex] = mRenderer->FenceSync();
+
+	mStatsIndex = (mStatsIndex + 1) % mStatsBuffers.size();
+
+	// Written STATS_FRAME_COUNT - 1 frames ago, only read once the GPU is done with it so the readback never stalls,
+	// the last counters read are kept otherwise
+	const GpuCullingStats zero;
+	mRenderer->BindBuffer(GL_SHADER_STORAGE_BUFFER, mStatsBuffers[mStatsIndex]);
+	GLsync& fence = mStatsFences[mStatsIndex];
+	if (fence && mRenderer->IsFenceSignaled(fence))
+	{
+		mRenderer->GetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GpuCullingStats), &mStats);
+		mRenderer->DeleteSync(fence);
+		fence = nullptr;
+	}
+	mRenderer->SetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GpuCullingStats), &zero);
+	mRenderer->BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void GpuCulling::SetViewport(unsigned int framebufferID, int width, int height)
+{
+	mCurrentFramebuffer = framebufferID;
+
+	if (!Enabled || !IsReady())
+	{
+		return;
+	}
+
+	ResizePyramid(mPyramids[framebufferID], width, height);
+}
+
+void GpuCulling::Cull(const InstanceData* instances, const GpuCullObject* objects, size_t count, size_t commandOffset, size_t commandSize)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	// Written straight in the frame data, the dispatch reads them from there
+	const size_t alignment = mRenderer->GetStorageOffsetAlignment();
+	const FrameDataAllocation sourceInstances = mRenderer->AllocateFrameData(count * sizeof(InstanceData), alignment);
+	std::memcpy(sourceInstances.Data, instances, count * sizeof(InstanceData));
+	const FrameDataAllocation cullObjects = mRenderer->AllocateFrameData(count * sizeof(GpuCullObject), alignment);
+	std::memcpy(cullObjects.Data, objects, count * sizeof(GpuCullObject));
+
+	const unsigned int frameData = mRenderer->GetFrameDataBuffer();
+	mRenderer->BindBufferRange(GL_SHADER_STORAGE_BUFFER, SourceBufferBinding, frameData, sourceInstances.Offset, count * sizeof(InstanceData));
+	mRenderer->BindBufferRange(GL_SHADER_STORAGE_BUFFER, ObjectBufferBinding, frameData, cullObjects.Offset, count * sizeof(GpuCullObject));
+	mRenderer->BindBufferBase(GL_SHADER_STORAGE_BUFFER, InstanceBufferBinding, frameData);
+	mRenderer->BindBufferRange(GL_SHADER_STORAGE_BUFFER, CommandBufferBinding, frameData, commandOffset, commandSize);
+	mRenderer->BindBufferBase(GL_SHADER_STORAGE_BUFFER, StatsBufferBinding, mStatsBuffers[mStatsIndex]);
+
+	auto pyramid = mPyramids.find(mCurrentFramebuffer);
+	const bool occlusion = OcclusionCulling && pyramid != mPyramids.end() && pyramid->second.IsBuilt;
+
+	mCullShader->Use();
+	mCullShader->SetInt("objectCount", (int)count);
+	mCullShader->SetBool("occlusionCulling", occlusion);
+
+	if (occlusion)
+	{
+		mRenderer->ActiveTexture(GL_TEXTURE0);
+		mRenderer->BindTexture(pyramid->second.PyramidTexture);
+		mCullShader->SetInt("depthPyramid", 0);
+		mCullShader->SetInt("pyramidLevelCount", pyramid->second.LevelCount);
+		mCullShader->SetMat4("previousViewProjection", pyramid->second.ViewProjection);
+	}
+
+	mRenderer->DispatchCompute(((unsigned int)count + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE);
+
+	// The commands and the instances are read by the following draws
+	mRenderer->SetMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+}
+
+bool GpuCulling::NeedsDepthPyramid()
+{
+	return Enabled && OcclusionCulling && IsReady();
+}
+
+void GpuCulling::BuildDepthPyramid(const Camera& camera, unsigned int depthTexture)
+{
+	if (!NeedsDepthPyramid() || !depthTexture)
+	{
+		return;
+	}
+
+	auto it = mPyramids.find(mCurrentFramebuffer);
+	if (it == mPyramids.end() || it->second.Width == 0 || it->second.Height == 0)
+	{
+		return;
+	}
+
+	DepthPyramid& pyramid = it->second;
+
+	mRenderer->BindFramebuffer(GL_FRAMEBUFFER, pyramid.DepthFramebuffer);
+	mRenderer->BindTexture(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, depthTexture);
+
+	mRenderer->BlitFramebuffer(mCurrentFramebuffer, pyramid.DepthFramebuffer, pyramid.Width, pyramid.Height, GL_DEPTH_BUFFER_BIT);
+	mRenderer->BindFramebuffer(GL_FRAMEBUFFER, mCurrentFramebuffer);
+
+	mPyramidShader->Use();
+	mPyramidShader->SetInt("source", 0);
+	mRenderer->ActiveTexture(GL_TEXTURE0);
+
+	// The texture comes from the pool with the filters of its last user
+	mRenderer->BindTexture(depthTexture);
+	mRenderer->SetTextureParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	mRenderer->SetTextureParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	// The first level reduces the depth copy, every other level reduces the level above it
+	for (int level = 0; level < pyramid.LevelCount; level++)
+	{
+		mRenderer->BindTexture(level == 0 ? depthTexture : pyramid.PyramidTexture);
+		mPyramidShader->SetInt("sourceLevel", level == 0 ? 0 : level - 1);
+		mRenderer->BindImageTexture(0, pyramid.PyramidTexture, level, GL_WRITE_ONLY, GL_R32F);
+
+		const unsigned int width = (unsigned int)std::max(1, pyramid.PyramidWidth >> level);
+		const unsigned int height = (unsigned int)std::max(1, pyramid.PyramidHeight >> level);
+		mRenderer->DispatchCompute((width + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE, (height + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE);
+
+		mRenderer->SetMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+	}
+
+	mRenderer->BindTexture(0);
+	mRenderer->UnUseShader();
+
+	pyramid.ViewProjection = camera.GetVP();
+	pyramid.IsBuilt = true;
+}
+
+const GpuCullingStats& GpuCulling::GetStats()
+{
+	return mStats;
+}
+
+void GpuCulling::ResizePyramid(DepthPyramid& pyramid, int width, int height)
+{
+	if (pyramid.Width == width && pyramid.Height == height)
+	{
+		return;
+	}
+
+	if (!pyramid.DepthFramebuffer)
+	{
+		mRenderer->GenerateFramebuffer(1, &pyramid.DepthFramebuffer);
+	}
+
+	// The texture of the previous size goes back to the pool, another viewport of that size can take it
+	RenderTargetPool::Release(pyramid.PyramidTexture);
+	pyramid.PyramidTexture = 0;
+
+	pyramid.Width = width;
+	pyramid.Height = height;
+	pyramid.IsBuilt = false;
+
+	if (width <= 0 || height <= 0)
+	{
+		return;
+	}
+
+	// A power of two base makes every texel of a level cover exactly 2x2 texels of the level above
+	pyramid.PyramidWidth = (int)std::bit_floor((unsigned int)width);
+	pyramid.PyramidHeight = (int)std::bit_floor((unsigned int)height);
+	pyramid.LevelCount = std::bit_width((unsigned int)std::max(pyramid.PyramidWidth, pyramid.PyramidHeight));
+
+	pyramid.PyramidTexture = RenderTargetPool::Acquire(pyramid.PyramidWidth, pyramid.PyramidHeight, GL_R32F, pyramid.LevelCount);
+	mRenderer->BindTexture(pyramid.PyramidTexture);
+	mRenderer->SetTextureParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	mRenderer->SetTextureParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	mRenderer->BindTexture(0);
+}
@@ -0,0 +1,78 @@
+#include "wrapper/gpu_timer.h"
+
+#include "service_locator.h"
+
+#include "wrapper/gl_extensions.h"
+
+// Weight of a new measure in the time displayed
+constexpr float SMOOTHING = 0.1f;
+
+GpuTimer::~GpuTimer()
+{
+	if (mRenderer)
+	{
+		mRenderer->DeleteQueries(QueryCount, mQueries);
+	}
+}
+
+void GpuTimer::Begin()
+{
+	if (!mRenderer)
+	{
+		mRenderer = ServiceLocator::Get<Renderer>();
+		mRenderer->GenerateQueries(QueryCount, mQueries);
+	}
+
+	ReadResults();
+
+	// The GPU is more than QueryCount measures behind, this one is dropped
+	if (mIsPending[mNextQuery])
+	{
+		return;
+	}
+
+	mRenderer->BeginQuery(GL_TIME_ELAPSED, mQueries[mNextQuery]);
+	mIsMeasuring = true;
+}
+
+void GpuTimer::End()
+{
+	if (!mIsMeasuring)
+	{
+		return;
+	}
+
+	mRenderer->EndQuery(GL_TIME_ELAPSED);
+	mIsMeasuring = false;
+
+	mIsPending[mNextQuery] = true;
+	mNextQuery = (mNextQuery + 1) % QueryCount;
+}
+
+float GpuTimer::GetMilliseconds() const
+{
+	return mMilliseconds;
+}
+
+void GpuTimer::ReadResults()
+{
+	// The queries end in the order of the ring, the first one not available stops the others
+	for (int i = 0; i < QueryCount; i++)
+	{
+		const int query = (mNextQuery + i) % QueryCount;
+		if (!mIsPending[query])
+		{
+			continue;
+		}
+
+		if (!mRenderer->IsQueryResultAvailable(mQueries[query]))
+		{
+			return;
+		}
+
+		const float milliseconds = mRenderer->GetQueryResult(mQueries[query]) / 1000000.f;
+		mMilliseconds = mHasResult ? mMilliseconds + (milliseconds - mMilliseconds) * SMOOTHING : milliseconds;
+		mHasResult = true;
+		mIsPending[query] = false;
+	}
+}
@@ -0,0 +1,281 @@
+#include "wrapper/picking.h"
+
+#include <algorithm>
+#include <climits>
+#include <toolbox/Matrix4x4.h>
+#include <toolbox/Vector3.h>
+#include <toolbox/Vector4.h>
+
+#include "service_locator.h"
+
+#include "camera/camera.h"
+
+#include "engine_debug/logger.h"
+
+#include "resources/model_renderer.h"
+#include "resources/resource_manager.h"
+#include "resources/shader.h"
+
+#include "world/scene_manager.h"
+
+#include "wrapper/gpu_culling.h"
+#include "wrapper/render_queue.h"
+
+static_assert(Picking::RegionSize % 2 == 1, "The region must have a center pixel");
+
+// Bytes of the region read back
+constexpr size_t REGION_BYTES = Picking::RegionSize * Picking::RegionSize * sizeof(int);
+
+void Picking::Setup()
+{
+	mRenderer = ServiceLocator::Get<Renderer>();
+
+	mPickingShader = ResourceManager::Get<Shader>("picking_shader");
+	if (!mPickingShader || !mPickingShader->ID)
+	{
+		Logger::Warning("Picking::Setup() picking shader not found, the clicks are resolved with a ray");
+		return;
+	}
+
+	mRenderer->GenerateFramebuffer(1, &mFramebuffer);
+	mRenderer->BindFramebuffer(GL_FRAMEBUFFER, mFramebuffer);
+
+	mRenderer->GenerateTexture(1, &mIDTexture);
+	mRenderer->BindTexture(mIDTexture);
+	mRenderer->SetTextureStorage(1, GL_R32I, RegionSize, RegionSize);
+	mRenderer->BindTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, mIDTexture);
+	mRenderer->BindTexture(0);
+
+	mRenderer->GenerateRenderbuffer(1, &mDepthRenderbuffer);
+	mRenderer->BindRenderbuffer(mDepthRenderbuffer);
+	mRenderer->SetRenderBufferStorageData(GL_DEPTH_COMPONENT24, (float)RegionSize, (float)RegionSize);
+	mRenderer->BindRenderbufferToFramebuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, mDepthRenderbuffer);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		Logger::Error("Picking::Setup() framebuffer is not complete, the clicks are resolved with a ray");
+		mRenderer->BindFramebuffer(GL_FRAMEBUFFER, 0);
+		return;
+	}
+	mRenderer->BindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	mRenderer->GenerateBuffer(1, &mPixelBuffer);
+	mRenderer->BindBuffer(GL_PIXEL_PACK_BUFFER, mPixelBuffer);
+	mRenderer->SetBufferData(GL_PIXEL_PACK_BUFFER, (int)REGION_BYTES, nullptr, GL_STREAM_READ);
+	mRenderer->BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	mIsSetup = true;
+}
+
+void Picking::Shutdown()
+{
+	if (mFence)
+	{
+		mRenderer->DeleteSync(mFence);
+		mFence = nullptr;
+	}
+
+	if (mIsSetup)
+	{
+		mRenderer->DeleteBuffers(1, &mPixelBuffer);
+		mRenderer->DeleteRenderbuffers(1, &mDepthRenderbuffer);
+		mRenderer->DeleteTextures(1, &mIDTexture);
+		mRenderer->DeleteFramebuffers(1, &mFramebuffer);
+		mIsSetup = false;
+	}
+
+	mPickingShader.reset();
+	mRequestCamera = nullptr;
+}
+
+void Picking::Update()
+{
+	// Render is called for every viewport each frame, a request still here belongs to a viewport closed since
+	mRequestCamera = nullptr;
+
+	if (!mFence || !mRenderer->IsFenceSignaled(mFence))
+	{
+		return;
+	}
+
+	mRenderer->DeleteSync(mFence);
+	mFence = nullptr;
+
+	// The copy is done, the map doesn't wait
+	mRenderer->BindBuffer(GL_PIXEL_PACK_BUFFER, mPixelBuffer);
+	const int* pixels = static_cast<const int*>(mRenderer->MapBufferRange(GL_PIXEL_PACK_BUFFER, 0, REGION_BYTES, GL_MAP_READ_BIT));
+	if (pixels)
+	{
+		int objectIndex = FindClosestID(pixels);
+		mRenderer->UnmapBuffer(GL_PIXEL_PACK_BUFFER);
+
+		// An object may have been removed while the region was drawn
+		if (!SceneManager::ActualScene || objectIndex >= (int)SceneManager::ActualScene->Objects.size())
+		{
+			objectIndex = -1;
+		}
+		mRenderer->ObjectIndex = objectIndex;
+	}
+	mRenderer->BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void Picking::Request(const Camera& camera, int x, int y)
+{
+	if (Mode == PickingMode::Ray)
+	{
+		ServiceLocator::Get<Renderer>()->ObjectIndex = RayPick(camera, x, y);
+		return;
+	}
+
+	mRequestCamera = &camera;
+	mRequestX = x;
+	mRequestY = y;
+}
+
+void Picking::Render(const Camera& camera)
+{
+	if (!mRequestCamera || mRequestCamera != &camera)
+	{
+		return;
+	}
+	mRequestCamera = nullptr;
+
+	// The ray gives the result while the picking shader is built
+	if (!mIsSetup || !mPickingShader->IsReady() || !SceneManager::ActualScene || camera.Width <= 0.f || camera.Height <= 0.f)
+	{
+		mRenderer->ObjectIndex = RayPick(camera, mRequestX, mRequestY);
+		return;
+	}
+
+	// The newest click wins, the copy still in flight is dropped
+	if (mFence)
+	{
+		mRenderer->DeleteSync(mFence);
+		mFence = nullptr;
+	}
+
+	// Scale the clip space so the region around the pixel covers the whole framebuffer of the region
+	const float scaleX = camera.Width / RegionSize;
+	const float scaleY = camera.Height / RegionSize;
+	const float centerX = 2.f * (mRequestX + 0.5f) / camera.Width - 1.f;
+	const float centerY = 2.f * (mRequestY + 0.5f) / camera.Height - 1.f;
+	const Matrix4x4 regionMatrix(
+		scaleX, 0.f, 0.f, -scaleX * centerX,
+		0.f, scaleY, 0.f, -scaleY * centerY,
+		0.f, 0.f, 1.f, 0.f,
+		0.f, 0.f, 0.f, 1.f
+	);
+	const Matrix4x4 viewProjection = regionMatrix * camera.GetVP();
+
+	// The viewport clicked is drawn right after with its own size
+	int previousViewport[4];
+	mRenderer->GetViewport(previousViewport);
+
+	mRenderer->BindFramebuffer(GL_FRAMEBUFFER, mFramebuffer);
+	mRenderer->SetViewport(0, 0, RegionSize, RegionSize);
+	mRenderer->ClearBufferInt(0, -1);
+	mRenderer->ClearBufferDepth();
+	mRenderer->SetCameraBuffer(viewProjection, camera.GetView(), regionMatrix * camera.GetProjection(), camera.Eye);
+
+	// The depth pyramid of the region is never built, the GPU culling only tests the frustum of the region
+	GpuCulling::SetViewport(mFramebuffer, RegionSize, RegionSize);
+
+	RenderQueue::Begin(camera, viewProjection, false);
+	RenderQueue::SetProgramOverride(mPickingShader.get());
+	SceneManager::ActualScene->SubmitDraws();
+	RenderQueue::Flush();
+
+	// Queued in the pixel buffer, read by Update once the fence is signaled
+	mRenderer->BindBuffer(GL_PIXEL_PACK_BUFFER, mPixelBuffer);
+	mRenderer->ReadPixels(0, 0, RegionSize, RegionSize, GL_RED_INTEGER, GL_INT, nullptr);
+	mRenderer->BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	mFence = mRenderer->FenceSync();
+
+	mRenderer->BindFramebuffer(GL_FRAMEBUFFER, 0);
+	mRenderer->SetViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+}
+
+int Picking::RayPick(const Camera& camera, int x, int y)
+{
+	Scene* scene = SceneManager::ActualScene;
+	if (!scene || camera.Width <= 0.f || camera.Height <= 0.f)
+	{
+		return -1;
+	}
+
+	// Unproject the center of the pixel on the near and the far planes
+	const float ndcX = 2.f * (x + 0.5f) / camera.Width - 1.f;
+	const float ndcY = 2.f * (y + 0.5f) / camera.Height - 1.f;
+	const Matrix4x4 inverseVP = Matrix4x4::Inverse(camera.GetVP());
+	const Vector4 nearPoint = inverseVP * Vector4(ndcX, ndcY, -1.f, 1.f);
+	const Vector4 farPoint = inverseVP * Vector4(ndcX, ndcY, 1.f, 1.f);
+
+	const Vector3 origin(nearPoint.x / nearPoint.w, nearPoint.y / nearPoint.w, nearPoint.z / nearPoint.w);
+	const Vector3 end(farPoint.x / farPoint.w, farPoint.y / farPoint.w, farPoint.z / farPoint.w);
+	const float length = (end - origin).Norm();
+	if (length <= 0.f)
+	{
+		return -1;
+	}
+	const Vector3 direction = (end - origin) / length;
+
+	Object* closestObject = nullptr;
+	float closestDistance = length;
+
+	// The BVH only gives the objects whose box is hit, their triangles decide
+	scene->GetBvh().RayCast(origin, direction, length, [&](void* userData, float) -> float
+	{
+		Object* object = static_cast<Object*>(userData);
+		ModelRenderer* renderer = object->GetComponent<ModelRenderer>();
+		if (!object->IsEnable() || !renderer || !renderer->IsEnable())
+		{
+			return closestDistance;
+		}
+
+		float distance = 0.f;
+		if (renderer->RayCast(origin, direction, closestDistance, distance))
+		{
+			closestDistance = distance;
+			closestObject = object;
+		}
+
+		return closestDistance;
+	});
+
+	std::vector<Object*>::iterator it = std::find(scene->Objects.begin(), scene->Objects.end(), closestObject);
+	return closestObject && it != scene->Objects.end() ? (int)(it - scene->Objects.begin()) : -1;
+}
+
+bool Picking::IsPending()
+{
+	return mRequestCamera != nullptr || mFence != nullptr;
+}
+
+bool Picking::HasRequest(const Camera& camera)
+{
+	return mRequestCamera == &camera;
+}
+
+int Picking::FindClosestID(const int* pixels)
+{
+	constexpr int center = RegionSize / 2;
+
+	int closestID = -1;
+	int closestDistance = INT_MAX;
+	for (int y = 0; y < RegionSize; y++)
+	{
+		for (int x = 0; x < RegionSize; x++)
+		{
+			const int id = pixels[y * RegionSize + x];
+			const int distance = (x - center) * (x - center) + (y - center) * (y - center);
+
+			if (id >= 0 && distance < closestDistance)
+			{
+				closestID = id;
+				closestDistance = distance;
+			}
+		}
+	}
+
+	return closestID;
+}
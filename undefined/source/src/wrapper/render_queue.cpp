@@ -0,0 +1,423 @@
+#include "wrapper/render_queue.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+
+#include "service_locator.h"
+
+#include "camera/camera.h"
+
+#include "resources/mesh.h"
+#include "resources/shader.h"
+
+#include "world/light_manager.h"
+
+#include "wrapper/geometry_arena.h"
+#include "wrapper/gl_extensions.h"
+
+constexpr uint64_t DEPTH_BAND_COUNT = 8;
+constexpr uint64_t FINE_DEPTH_MAX = (1 << 14) - 1;
+// The layer, the depth band, the program and the texture are above this bit in the key
+constexpr int STATE_KEY_SHIFT = 30;
+
+
+void RenderQueue::Begin(const Camera& camera, bool pickingOutput)
+{
+	Begin(camera, camera.GetVP(), pickingOutput);
+}
+
+void RenderQueue::Begin(const Camera& camera, const Matrix4x4& viewProjection, bool pickingOutput)
+{
+	mPackets.clear();
+	mSortedPackets.clear();
+	mLayers.clear();
+	for (std::vector<float>* coordinates : { &mCenterX, &mCenterY, &mCenterZ, &mExtentX, &mExtentY, &mExtentZ })
+	{
+		coordinates->clear();
+	}
+	mCurrentEntity = -1;
+	mProgramOverride = nullptr;
+
+	// The light loops of the types without a light are left out of the variants
+	mKeywords = 0;
+	mKeywords |= LightManager::GetLightCount(LightType::Directional) ? (uint32_t)ShaderKeyword::DirectionalLights : 0;
+	mKeywords |= LightManager::GetLightCount(LightType::Point) ? (uint32_t)ShaderKeyword::PointLights : 0;
+	mKeywords |= LightManager::GetLightCount(LightType::Spot) ? (uint32_t)ShaderKeyword::SpotLights : 0;
+	mKeywords |= pickingOutput ? (uint32_t)ShaderKeyword::PickingOutput : 0;
+
+	mViewProjection = viewProjection;
+	mFrustum = Frustum(mViewProjection);
+	mNear = camera.Near;
+	mFar = camera.Far;
+	mEye = camera.Eye;
+	mCamera = &camera;
+	mProjectionScale = camera.Height * 0.5f / std::tan(camera.Fov * 0.5f);
+}
+
+void RenderQueue::SetProgramOverride(Shader* program)
+{
+	mProgramOverride = program;
+}
+
+void RenderQueue::SetCurrentEntity(int entityID)
+{
+	mCurrentEntity = entityID;
+}
+
+void RenderQueue::Submit(Shader* program, unsigned int textureID, const Mesh* mesh, const Matrix4x4& transform, const BoundingBox& worldBounds, RenderLayer layer)
+{
+	DrawPacket& packet = mPackets.emplace_back();
+	if (mProgramOverride)
+	{
+		// Without the texture the packets of a mesh are grouped in a single draw
+		packet.Program = mProgramOverride;
+		packet.TextureID = 0;
+	}
+	else
+	{
+		packet.Program = ShaderVariants ? program->GetVariant(mKeywords | (textureID ? (uint32_t)ShaderKeyword::HasTexture : 0)) : program;
+		packet.TextureID = textureID;
+	}
+	packet.DrawMesh = mesh;
+	packet.Transform = transform;
+	packet.EntityID = mCurrentEntity;
+
+	mLayers.push_back(layer);
+
+	const Vector3 center = worldBounds.GetCenter();
+	const Vector3 extents = worldBounds.GetExtents();
+	mCenterX.push_back(center.x);
+	mCenterY.push_back(center.y);
+	mCenterZ.push_back(center.z);
+	mExtentX.push_back(extents.x);
+	mExtentY.push_back(extents.y);
+	mExtentZ.push_back(extents.z);
+}
+
+uint64_t RenderQueue::MakeKey(const DrawPacket& packet, RenderLayer layer)
+{
+	// The translation of the model matrix is in the last column, the last row of the VP gives its view depth
+	const Vector4& depthRow = mViewProjection[3];
+	const float depth = depthRow.x * packet.Transform[0].w + depthRow.y * packet.Transform[1].w + depthRow.z * packet.Transform[2].w + depthRow.w;
+
+	// Logarithmic distribution like the light clusters, more precision close to the camera
+	float normalizedDepth = 0.f;
+	if (depth > mNear)
+	{
+		normalizedDepth = std::min(std::log(depth / mNear) / std::log(mFar / mNear), 1.f);
+	}
+
+	// Transparent packets are drawn back to front
+	if (layer == RenderLayer::Transparent)
+	{
+		normalizedDepth = 1.f - normalizedDepth;
+	}
+
+	// A multi draw covers a whole program and texture, the bands would split it : its commands are ordered by depth instead
+	const uint64_t depthBand = MultiDrawIndirect ? 0 : std::min((uint64_t)(normalizedDepth * DEPTH_BAND_COUNT), DEPTH_BAND_COUNT - 1);
+	const uint64_t fineDepth = (uint64_t)(normalizedDepth * FINE_DEPTH_MAX);
+
+	return ((uint64_t)layer & 0x3) << 62
+		| depthBand << 59
+		| ((uint64_t)packet.Program->ID & 0x1FFF) << 46
+		| ((uint64_t)packet.TextureID & 0xFFFF) << STATE_KEY_SHIFT
+		| ((uint64_t)packet.DrawMesh->GetID() & 0xFFFF) << 14
+		| fineDepth;
+}
+
+void RenderQueue::SetInstanceAttributes()
+{
+	Renderer* renderer = ServiceLocator::Get<Renderer>();
+
+	// The instances of each flush are at a different offset, the draws reach them with their base instance
+	mInstanceAttributeBuffer = renderer->GetFrameDataBuffer();
+	renderer->BindBuffer(GL_ARRAY_BUFFER, mInstanceAttributeBuffer);
+
+	// model matrix, one row per attribute
+	for (unsigned int row = 0; row < 4; row++)
+	{
+		renderer->AttributePointers(3 + row, 4, GL_FLOAT, sizeof(InstanceData), (void*)(offsetof(InstanceData, Model) + row * sizeof(Vector4)));
+		renderer->AttributeDivisor(3 + row, 1);
+	}
+
+	// entity id
+	renderer->AttributeIPointers(7, 1, GL_INT, sizeof(InstanceData), (void*)offsetof(InstanceData, EntityID));
+	renderer->AttributeDivisor(7, 1);
+}
+
+void RenderQueue::Flush()
+{
+	Renderer* renderer = ServiceLocator::Get<Renderer>();
+
+	// The multi draw path can leave the visibility to the GPU, every packet is then sent
+	mGpuCulling = MultiDrawIndirect && GpuCulling::Enabled && GpuCulling::IsReady();
+
+	mVisible.resize(mPackets.size());
+	if (FrustumCulling && !mGpuCulling)
+	{
+		mFrustum.CullBoxes(mCenterX.data(), mCenterY.data(), mCenterZ.data(), mExtentX.data(), mExtentY.data(), mExtentZ.data(), mPackets.size(), mVisible.data());
+	}
+	else
+	{
+		std::fill(mVisible.begin(), mVisible.end(), (uint8_t)1);
+	}
+
+	// Only the visible packets are sorted and drawn
+	for (uint32_t i = 0; i < (uint32_t)mPackets.size(); i++)
+	{
+		if (mVisible[i])
+		{
+			mSortedPackets.emplace_back(MakeKey(mPackets[i], mLayers[i]), i);
+		}
+	}
+
+	if (!mGpuCulling)
+	{
+		renderer->Counters.PacketsVisible += (unsigned int)mSortedPackets.size();
+		renderer->Counters.PacketsCulled += (unsigned int)(mPackets.size() - mSortedPackets.size());
+	}
+
+	std::sort(mSortedPackets.begin(), mSortedPackets.end());
+
+	// Instance data in the sorted order, a group of instances is a contiguous range
+	mInstances.resize(mSortedPackets.size());
+	for (size_t i = 0; i < mSortedPackets.size(); i++)
+	{
+		const DrawPacket& packet = mPackets[mSortedPackets[i].second];
+
+		// Packed positions are in the bounds of the mesh, the dequantization comes before the model matrix
+		mInstances[i].Model = packet.DrawMesh->GetVertexFormat() == VertexFormat::Packed ? packet.Transform * packet.DrawMesh->GetDequantization() : packet.Transform;
+		mInstances[i].EntityID = packet.EntityID;
+	}
+
+	// Something else (e.g : ImGui) may have changed the bindings since the last flush
+	renderer->InvalidateStateCache();
+	renderer->ActiveTexture(GL_TEXTURE0);
+
+	// Every following packet drawing the same mesh with the same state is an instance of the same draw
+	mDrawGroups.clear();
+	for (size_t first = 0; first < mSortedPackets.size();)
+	{
+		const DrawPacket& packet = mPackets[mSortedPackets[first].second];
+
+		size_t last = first + 1;
+		while (last < mSortedPackets.size())
+		{
+			const DrawPacket& next = mPackets[mSortedPackets[last].second];
+
+			if (next.Program != packet.Program || next.TextureID != packet.TextureID || next.DrawMesh != packet.DrawMesh)
+			{
+				break;
+			}
+
+			last++;
+		}
+
+		mDrawGroups.push_back({ &packet, (unsigned int)first, (unsigned int)(last - first) });
+		first = last;
+	}
+
+	UploadInstances();
+
+	if (MultiDrawIndirect)
+	{
+		DrawGroupsIndirect();
+	}
+	else
+	{
+		DrawGroups();
+	}
+
+	renderer->UnUseShader();
+	renderer->BindVertexArray(0);
+	renderer->BindTexture(0);
+
+	mLastPacketCount = mSortedPackets.size();
+	mSortedPackets.clear();
+	mPackets.clear();
+	mLayers.clear();
+	for (std::vector<float>* coordinates : { &mCenterX, &mCenterY, &mCenterZ, &mExtentX, &mExtentY, &mExtentZ })
+	{
+		coordinates->clear();
+	}
+}
+
+void RenderQueue::UploadInstances()
+{
+	Renderer* renderer = ServiceLocator::Get<Renderer>();
+
+	// Everything the flush writes in the frame data, so the buffer isn't replaced between the instances and the commands
+	const size_t instanceSize = mInstances.size() * sizeof(InstanceData);
+	const size_t alignment = renderer->GetStorageOffsetAlignment();
+	size_t frameDataSize = instanceSize + sizeof(InstanceData) + mDrawGroups.size() * sizeof(DrawElementsIndirectCommand) + alignment;
+	if (mGpuCulling)
+	{
+		frameDataSize += instanceSize + mInstances.size() * sizeof(GpuCullObject) + 2 * alignment;
+	}
+	renderer->ReserveFrameData(frameDataSize);
+
+	// The per-instance attributes of the VAOs still read the buffer replaced
+	if (mInstanceAttributeBuffer != renderer->GetFrameDataBuffer())
+	{
+		GeometryArena::ResetAttributes();
+	}
+
+	// Aligned on an instance so the draws reach it with their base instance
+	const FrameDataAllocation instances = renderer->AllocateFrameData(instanceSize, sizeof(InstanceData));
+	mBaseInstance = (unsigned int)(instances.Offset / sizeof(InstanceData));
+
+	// The culling shader writes the visible instances itself
+	if (!mGpuCulling)
+	{
+		std::memcpy(instances.Data, mInstances.data(), instanceSize);
+	}
+}
+
+void RenderQueue::DrawGroups()
+{
+	Renderer* renderer = ServiceLocator::Get<Renderer>();
+
+	for (const DrawGroup& group : mDrawGroups)
+	{
+		const GeometryAllocation& allocation = group.Packet->DrawMesh->GetAllocation();
+
+		group.Packet->Program->Use();
+		renderer->BindVertexArray(allocation.Arena->GetVAO());
+		renderer->BindTexture(group.Packet->TextureID);
+		renderer->Counters.Triangles += allocation.IndexCount / 3 * group.InstanceCount;
+		renderer->DrawInstanced(GL_TRIANGLES, (int)allocation.IndexCount, allocation.Arena->GetIndexType(), (void*)(allocation.FirstIndex * allocation.Arena->GetIndexSize()),
+			(int)group.InstanceCount, (int)allocation.BaseVertex, mBaseInstance + group.FirstInstance);
+	}
+}
+
+void RenderQueue::DrawGroupsIndirect()
+{
+	Renderer* renderer = ServiceLocator::Get<Renderer>();
+
+	// The groups of a program and a texture are ordered by arena, then by the depth of their nearest packet (the first one of the group).
+	// Each multi draw keeps its commands front to back, back to front for the transparent layer whose depth is reversed in the key
+	for (size_t first = 0; first < mDrawGroups.size();)
+	{
+		const uint64_t state = mSortedPackets[mDrawGroups[first].FirstInstance].first >> STATE_KEY_SHIFT;
+
+		size_t last = first + 1;
+		while (last < mDrawGroups.size() && mSortedPackets[mDrawGroups[last].FirstInstance].first >> STATE_KEY_SHIFT == state)
+		{
+			last++;
+		}
+
+		std::sort(mDrawGroups.begin() + first, mDrawGroups.begin() + last, [](const DrawGroup& a, const DrawGroup& b)
+		{
+			const GeometryArena* arenaA = a.Packet->DrawMesh->GetAllocation().Arena;
+			const GeometryArena* arenaB = b.Packet->DrawMesh->GetAllocation().Arena;
+			if (arenaA != arenaB)
+			{
+				return std::less<const GeometryArena*>()(arenaA, arenaB);
+			}
+
+			const uint64_t depthA = mSortedPackets[a.FirstInstance].first & FINE_DEPTH_MAX;
+			const uint64_t depthB = mSortedPackets[b.FirstInstance].first & FINE_DEPTH_MAX;
+			return depthA != depthB ? depthA < depthB : a.FirstInstance < b.FirstInstance;
+		});
+
+		first = last;
+	}
+
+	// One command per group, the groups sharing a program, a texture and an arena become a single multi draw
+	mCommands.clear();
+	mCullObjects.clear();
+	mIndirectRuns.clear();
+	for (const DrawGroup& group : mDrawGroups)
+	{
+		const GeometryAllocation& allocation = group.Packet->DrawMesh->GetAllocation();
+
+		if (mIndirectRuns.empty() || mIndirectRuns.back().Packet->Program != group.Packet->Program || mIndirectRuns.back().Packet->TextureID != group.Packet->TextureID
+			|| mIndirectRuns.back().Packet->DrawMesh->GetAllocation().Arena != allocation.Arena)
+		{
+			mIndirectRuns.push_back({ group.Packet, mCommands.size(), 0, 0 });
+		}
+
+		DrawElementsIndirectCommand& command = mCommands.emplace_back();
+		command.Count = allocation.IndexCount;
+		command.InstanceCount = mGpuCulling ? 0 : group.InstanceCount;
+		command.FirstIndex = allocation.FirstIndex;
+		command.BaseVertex = (int)allocation.BaseVertex;
+		command.BaseInstance = mBaseInstance + group.FirstInstance;
+
+		if (mGpuCulling)
+		{
+			for (unsigned int i = group.FirstInstance; i < group.FirstInstance + group.InstanceCount; i++)
+			{
+				const uint32_t packetIndex = mSortedPackets[i].second;
+
+				GpuCullObject& object = mCullObjects.emplace_back();
+				object.Center = Vector3(mCenterX[packetIndex], mCenterY[packetIndex], mCenterZ[packetIndex]);
+				object.Command = (unsigned int)(mCommands.size() - 1);
+				object.Extents = Vector3(mExtentX[packetIndex], mExtentY[packetIndex], mExtentZ[packetIndex]);
+			}
+		}
+
+		// Before the GPU culling, the instances it removes are still counted
+		renderer->Counters.Triangles += allocation.IndexCount / 3 * group.InstanceCount;
+
+		mIndirectRuns.back().CommandCount++;
+		mIndirectRuns.back().InstanceCount += group.InstanceCount;
+	}
+
+	if (mCommands.empty())
+	{
+		return;
+	}
+
+	// Aligned for the GPU culling, which binds the commands as a storage buffer
+	const size_t commandSize = mCommands.size() * sizeof(DrawElementsIndirectCommand);
+	const FrameDataAllocation commands = renderer->AllocateFrameData(commandSize, renderer->GetStorageOffsetAlignment());
+	std::memcpy(commands.Data, mCommands.data(), commandSize);
+
+	if (mGpuCulling)
+	{
+		GpuCulling::Cull(mInstances.data(), mCullObjects.data(), mCullObjects.size(), commands.Offset, commandSize);
+	}
+
+	renderer->BindBuffer(GL_DRAW_INDIRECT_BUFFER, renderer->GetFrameDataBuffer());
+
+	for (const IndirectRun& run : mIndirectRuns)
+	{
+		const GeometryArena* arena = run.Packet->DrawMesh->GetAllocation().Arena;
+
+		run.Packet->Program->Use();
+		renderer->BindVertexArray(arena->GetVAO());
+		renderer->BindTexture(run.Packet->TextureID);
+		renderer->MultiDrawIndirect(GL_TRIANGLES, arena->GetIndexType(), commands.Offset + run.FirstCommand * sizeof(DrawElementsIndirectCommand), (int)run.CommandCount, run.InstanceCount);
+	}
+
+	renderer->BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+float RenderQueue::GetPixelsPerUnit(float distance)
+{
+	return mProjectionScale / std::max(distance, mNear);
+}
+
+const Vector3& RenderQueue::GetEye()
+{
+	return mEye;
+}
+
+const Camera* RenderQueue::GetCamera()
+{
+	return mCamera;
+}
+
+const Frustum& RenderQueue::GetFrustum()
+{
+	return mFrustum;
+}
+
+size_t RenderQueue::GetPacketCount()
+{
+	return mLastPacketCount;
+}
@@ -0,0 +1,167 @@
+#include "wrapper/render_target_pool.h"
+
+#include <algorithm>
+
+#include "service_locator.h"
+
+#include "engine_debug/logger.h"
+
+/// <summary>
+/// Bytes of a texel of the formats used by the passes, the drivers pad the 3 components formats to 4
+/// </summary>
+static size_t GetTexelSize(unsigned int internalFormat)
+{
+	switch (internalFormat)
+	{
+	case GL_R8:
+		return 1;
+	case GL_RG8:
+	case GL_R16F:
+		return 2;
+	case GL_RGBA16F:
+	case GL_RG32F:
+		return 8;
+	case GL_RGBA32F:
+		return 16;
+	default:
+		return 4;
+	}
+}
+
+unsigned int RenderTargetPool::Acquire(int width, int height, unsigned int internalFormat, int levels)
+{
+	for (RenderTarget& target : mTargets)
+	{
+		if (!target.IsUsed && target.Width == width && target.Height == height && target.InternalFormat == internalFormat && target.Levels == levels)
+		{
+			target.IsUsed = true;
+			return target.ID;
+		}
+	}
+
+	mRenderer = ServiceLocator::Get<Renderer>();
+
+	RenderTarget& target = mTargets.emplace_back();
+	target.Width = width;
+	target.Height = height;
+	target.InternalFormat = internalFormat;
+	target.Levels = levels;
+	target.IsUsed = true;
+
+	for (int level = 0; level < levels; level++)
+	{
+		target.Size += (size_t)std::max(1, width >> level) * std::max(1, height >> level) * GetTexelSize(internalFormat);
+	}
+
+	mRenderer->GenerateTexture(1, &target.ID);
+	mRenderer->BindTexture(target.ID);
+	mRenderer->SetTextureStorage(levels, internalFormat, std::max(width, 1), std::max(height, 1));
+	mRenderer->BindTexture(0);
+
+	mAllocationCount++;
+
+	return target.ID;
+}
+
+void RenderTargetPool::Release(unsigned int textureID)
+{
+	if (!textureID)
+	{
+		return;
+	}
+
+	for (RenderTarget& target : mTargets)
+	{
+		if (target.ID == textureID)
+		{
+			target.IsUsed = false;
+			target.ReleaseFrame = mFrame;
+			return;
+		}
+	}
+
+	Logger::Warning("RenderTargetPool::Release() texture {} is not from the pool", textureID);
+}
+
+void RenderTargetPool::Update()
+{
+	mFrame++;
+
+	size_t freeSize = 0;
+	for (size_t i = 0; i < mTargets.size();)
+	{
+		const RenderTarget& target = mTargets[i];
+		if (!target.IsUsed && mFrame - target.ReleaseFrame > MaxUnusedFrames)
+		{
+			Delete(i);
+			continue;
+		}
+
+		freeSize += target.IsUsed ? 0 : target.Size;
+		i++;
+	}
+
+	// The oldest free textures are dropped first
+	while (freeSize > MaxFreeSize)
+	{
+		size_t oldest = mTargets.size();
+		for (size_t i = 0; i < mTargets.size(); i++)
+		{
+			if (!mTargets[i].IsUsed && (oldest == mTargets.size() || mTargets[i].ReleaseFrame < mTargets[oldest].ReleaseFrame))
+			{
+				oldest = i;
+			}
+		}
+
+		freeSize -= mTargets[oldest].Size;
+		Delete(oldest);
+	}
+}
+
+void RenderTargetPool::Clear()
+{
+	while (!mTargets.empty())
+	{
+		Delete(mTargets.size() - 1);
+	}
+}
+
+size_t RenderTargetPool::GetTextureCount()
+{
+	return mTargets.size();
+}
+
+size_t RenderTargetPool::GetAllocatedSize()
+{
+	size_t size = 0;
+	for (const RenderTarget& target : mTargets)
+	{
+		size += target.Size;
+	}
+
+	return size;
+}
+
+size_t RenderTargetPool::GetFreeSize()
+{
+	size_t size = 0;
+	for (const RenderTarget& target : mTargets)
+	{
+		size += target.IsUsed ? 0 : target.Size;
+	}
+
+	return size;
+}
+
+size_t RenderTargetPool::GetAllocationCount()
+{
+	return mAllocationCount;
+}
+
+void RenderTargetPool::Delete(size_t index)
+{
+	mRenderer->DeleteTextures(1, &mTargets[index].ID);
+
+	mTargets[index] = mTargets.back();
+	mTargets.pop_back();
+}
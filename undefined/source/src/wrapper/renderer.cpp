@@ -1,7 +1,11 @@
 #include "wrapper/renderer.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
+#include "wrapper/gl_extensions.h"
+
 #include"resources/resource_manager.h"
 #include"resources/texture.h"
 #include"resources/model.h"
@@ -11,14 +15,33 @@
 
 #include "world/gizmo.h"
 
-void Renderer::Init()
+// Size of the section of each frame in the frame data ring buffer at the start, doubled when a frame needs more
+constexpr size_t BASE_FRAME_DATA_SECTION_SIZE = 4 * 1024 * 1024;
+
+bool Renderer::Init()
 {
     gladLoadGL();
+    if (!GLExtensions::Load())
+    {
+        Logger::Error("Renderer::Init() OpenGL functions are missing, the renderer is not initialized");
+        return false;
+    }
+
     SetClearColor(0, 0, 0);
     EnableTest(GL_DEPTH_TEST);
 
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    mUniformOffsetAlignment = (size_t)std::max(alignment, 1);
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    mStorageOffsetAlignment = (size_t)std::max(alignment, 1);
+
+    // Camera data, instances and indirect commands of every frame
+    CreateFrameData(BASE_FRAME_DATA_SECTION_SIZE);
+
     RendererDebug::DebugInit();
-    
+
+    return true;
 }
 
 void Renderer::SetClearColor(float redBaseColor, float greenBaseColor, float blueBaseColor)
@@ -31,6 +54,31 @@ void Renderer::ClearBuffer()
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
+void Renderer::ClearBufferInt(int drawBuffer, int value)
+{
+    glClearBufferiv(GL_COLOR, drawBuffer, &value);
+}
+
+void Renderer::ClearBufferDepth(float depth)
+{
+    glClearBufferfv(GL_DEPTH, 0, &depth);
+}
+
+void Renderer::ClearBufferColor()
+{
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void Renderer::SetViewport(int x, int y, int width, int height)
+{
+    glViewport(x, y, width, height);
+}
+
+void Renderer::GetViewport(int viewport[4])
+{
+    glGetIntegerv(GL_VIEWPORT, viewport);
+}
+
 void Renderer::GenerateBuffer(int index, unsigned int* buffer)
 {
     glGenBuffers(index, buffer);
@@ -64,11 +112,26 @@ void Renderer::GenerateRenderbuffer(int renderbufferNumber, unsigned int* ID)
 void Renderer::ActiveTexture(unsigned int ID)
 {
     glActiveTexture(ID);
+    mActiveTextureUnit = ID - GL_TEXTURE0;
 }
 
 void Renderer::BindTexture(unsigned int ID, unsigned int type)
 {
+    if (type != GL_TEXTURE_2D || mActiveTextureUnit >= CachedTextureUnits)
+    {
+        glBindTexture(type, ID);
+        return;
+    }
+
+    if (mBoundTextures[mActiveTextureUnit] == (int)ID)
+    {
+        Counters.TextureBindsSkipped++;
+        return;
+    }
+
     glBindTexture(type, ID);
+    mBoundTextures[mActiveTextureUnit] = (int)ID;
+    Counters.TextureBinds++;
 }
 
 void Renderer::BindTexture(int framebufferTarget, int attachement, unsigned int ID, int type)
@@ -76,11 +139,10 @@ void Renderer::BindTexture(int framebufferTarget, int attachement, unsigned int
     glFramebufferTexture2D(framebufferTarget, attachement, type, ID, 0);
 }
 
-void Renderer::ReadPixels(unsigned int framebufferID, uint32_t attachmentIndex, int x, int y)
+void Renderer::ReadPixels(int x, int y, int width, int height, unsigned int format, unsigned int type, void* data)
 {
-    glBindFramebuffer(GL_FRAMEBUFFER, framebufferID);
-    glReadBuffer(GL_COLOR_ATTACHMENT0 + attachmentIndex);
-    glReadPixels(x, y, 1, 1, GL_RED_INTEGER, GL_INT, &ObjectIndex);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glReadPixels(x, y, width, height, format, type, data);
 }
 
 void Renderer::BindFramebuffer(unsigned int target, unsigned int framebufferID)
@@ -93,13 +155,41 @@ void Renderer::BindRenderbuffer(unsigned int renderbufferID)
     glBindRenderbuffer(GL_RENDERBUFFER, renderbufferID);
 }
 
-void Renderer::BindBuffers(unsigned int VAO, unsigned int VBO, unsigned int EBO)
+void Renderer::BindVertexArray(unsigned int VAO)
 {
+    if (mBoundVertexArray == (int)VAO)
+    {
+        Counters.VertexArrayBindsSkipped++;
+        return;
+    }
+
     glBindVertexArray(VAO);
+    mBoundVertexArray = (int)VAO;
+    Counters.VertexArrayBinds++;
+}
+
+void Renderer::BindBuffers(unsigned int VAO, unsigned int VBO, unsigned int EBO)
+{
+    BindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
 }
 
+void Renderer::BindBuffer(unsigned int target, unsigned int buffer)
+{
+    glBindBuffer(target, buffer);
+}
+
+void Renderer::BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer)
+{
+    glBindBufferBase(target, index, buffer);
+}
+
+void Renderer::BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, size_t offset, size_t size)
+{
+    glBindBufferRange(target, index, buffer, (GLintptr)offset, (GLsizeiptr)size);
+}
+
 void Renderer::BindRenderbufferToFramebuffer(int framebufferTarget, int attachements, unsigned int renderbufferID)
 {
     glFramebufferRenderbuffer(framebufferTarget, attachements, GL_RENDERBUFFER, renderbufferID);
@@ -111,11 +201,102 @@ void Renderer::AttributePointers(unsigned int index, int size, unsigned int type
     glVertexAttribPointer(index, size, type, isNormalized, stride, pointer);
 }
 
+void Renderer::AttributeIPointers(unsigned int index, int size, unsigned int type, int stride, const void* pointer)
+{
+    glEnableVertexAttribArray(index);
+    glVertexAttribIPointer(index, size, type, stride, pointer);
+}
+
+void Renderer::AttributeDivisor(unsigned int index, unsigned int divisor)
+{
+    glVertexAttribDivisor(index, divisor);
+}
+
 void Renderer::SetBufferData(unsigned int target, int size, const void* data, unsigned int usage)
 {
     glBufferData(target, size, data, usage);
 }
 
+void Renderer::SetBufferSubData(unsigned int target, size_t offset, size_t size, const void* data)
+{
+    glBufferSubData(target, (GLintptr)offset, (GLsizeiptr)size, data);
+}
+
+void Renderer::SetBufferStorage(unsigned int target, size_t size, const void* data, unsigned int flags)
+{
+    glBufferStorage(target, (GLsizeiptr)size, data, flags);
+}
+
+void Renderer::CopyBufferSubData(unsigned int readTarget, unsigned int writeTarget, size_t readOffset, size_t writeOffset, size_t size)
+{
+    glCopyBufferSubData(readTarget, writeTarget, (GLintptr)readOffset, (GLintptr)writeOffset, (GLsizeiptr)size);
+}
+
+void Renderer::GetBufferSubData(unsigned int target, size_t offset, size_t size, void* data)
+{
+    glGetBufferSubData(target, (GLintptr)offset, (GLsizeiptr)size, data);
+}
+
+void* Renderer::MapBufferRange(unsigned int target, size_t offset, size_t size, unsigned int access)
+{
+    return glMapBufferRange(target, (GLintptr)offset, (GLsizeiptr)size, access);
+}
+
+bool Renderer::UnmapBuffer(unsigned int target)
+{
+    return glUnmapBuffer(target) == GL_TRUE;
+}
+
+GLsync Renderer::FenceSync()
+{
+    return glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool Renderer::IsFenceSignaled(GLsync fence)
+{
+    const GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+}
+
+void Renderer::DeleteSync(GLsync fence)
+{
+    glDeleteSync(fence);
+}
+
+void Renderer::GenerateQueries(int number, unsigned int* queries)
+{
+    glGenQueries(number, queries);
+}
+
+void Renderer::DeleteQueries(int number, unsigned int* queries)
+{
+    glDeleteQueries(number, queries);
+}
+
+void Renderer::BeginQuery(unsigned int target, unsigned int query)
+{
+    glBeginQuery(target, query);
+}
+
+void Renderer::EndQuery(unsigned int target)
+{
+    glEndQuery(target);
+}
+
+bool Renderer::IsQueryResultAvailable(unsigned int query)
+{
+    GLuint isAvailable = GL_FALSE;
+    glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+    return isAvailable == GL_TRUE;
+}
+
+uint64_t Renderer::GetQueryResult(unsigned int query)
+{
+    GLuint64 result = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &result);
+    return result;
+}
+
 void Renderer::SetRenderBufferStorageData(int format, float width, float height)
 {
     glRenderbufferStorage(GL_RENDERBUFFER, format, (GLsizei)width, (GLsizei)height);
@@ -126,14 +307,85 @@ void Renderer::SetTextureParameteri(unsigned int target, unsigned int texParam,
     glTexParameteri(target, texParam, texValue);
 }
 
+void Renderer::SetTextureImage(int level, int internalFormat, int width, int height, unsigned int format, unsigned int type, const void* data)
+{
+    glTexImage2D(GL_TEXTURE_2D, level, internalFormat, width, height, 0, format, type, data);
+}
+
+void Renderer::SetTextureStorage(int levels, unsigned int internalFormat, int width, int height)
+{
+    glTexStorage2D(GL_TEXTURE_2D, levels, internalFormat, width, height);
+}
+
+void Renderer::SetCompressedTextureImage(int level, int width, int height, unsigned int format, int size, const void* data)
+{
+    glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, format, size, data);
+}
+
+void Renderer::SetTextureSubImage(int level, int width, int height, unsigned int format, const void* data)
+{
+    glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, format, GL_UNSIGNED_BYTE, data);
+}
+
+void Renderer::CopyTextureLevel(unsigned int source, int sourceLevel, unsigned int destination, int destinationLevel, int width, int height)
+{
+    glCopyImageSubData(source, GL_TEXTURE_2D, sourceLevel, 0, 0, 0, destination, GL_TEXTURE_2D, destinationLevel, 0, 0, 0, width, height, 1);
+}
+
+void Renderer::SetPixelStore(unsigned int parameter, int value)
+{
+    glPixelStorei(parameter, value);
+}
+
+void Renderer::BindImageTexture(unsigned int unit, unsigned int texture, int level, unsigned int access, unsigned int format)
+{
+    glBindImageTexture(unit, texture, level, GL_FALSE, 0, access, format);
+}
+
+void Renderer::BlitFramebuffer(unsigned int readFramebuffer, unsigned int drawFramebuffer, int width, int height, unsigned int mask)
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFramebuffer);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, mask, GL_NEAREST);
+}
+
 void Renderer::Draw(unsigned int mode, int size, unsigned int type, const void* indices)
 {
     glDrawElements(mode, size, type, indices);
+    Counters.DrawCalls++;
+    Counters.Instances++;
+}
+
+void Renderer::DrawInstanced(unsigned int mode, int size, unsigned int type, const void* indices, int instanceCount, int baseVertex, unsigned int baseInstance)
+{
+    glDrawElementsInstancedBaseVertexBaseInstance(mode, size, type, indices, instanceCount, baseVertex, baseInstance);
+    Counters.DrawCalls++;
+    Counters.Instances += instanceCount;
+}
+
+void Renderer::MultiDrawIndirect(unsigned int mode, unsigned int type, size_t offset, int drawCount, unsigned int instanceCount)
+{
+    glMultiDrawElementsIndirect(mode, type, (const void*)offset, drawCount, 0);
+    Counters.DrawCalls++;
+    Counters.IndirectCommands += drawCount;
+    Counters.Instances += instanceCount;
+}
+
+void Renderer::DispatchCompute(unsigned int groupCountX, unsigned int groupCountY, unsigned int groupCountZ)
+{
+    glDispatchCompute(groupCountX, groupCountY, groupCountZ);
+}
+
+void Renderer::SetMemoryBarrier(unsigned int barriers)
+{
+    glMemoryBarrier(barriers);
 }
 
 void Renderer::Draw(unsigned int mode, int start, int count)
 {
     glDrawArrays(mode, start, count);
+    Counters.DrawCalls++;
+    Counters.Instances++;
 }
 
 void Renderer::DrawBuffers(int numberOfAttachement, unsigned int* attachements)
@@ -143,57 +395,204 @@ void Renderer::DrawBuffers(int numberOfAttachement, unsigned int* attachements)
 
 unsigned int Renderer::SetShader(int shaderType, const char* vShaderCode)
 {
-    if (shaderType != GL_FRAGMENT_SHADER && shaderType != GL_VERTEX_SHADER)
+    const unsigned int shader = CreateShader(shaderType, vShaderCode);
+
+    // print compile errors if any
+    CheckShader(shader, shaderType);
+
+    return shader;
+}
+
+unsigned int Renderer::CreateShader(int shaderType, const char* code)
+{
+    if (shaderType != GL_FRAGMENT_SHADER && shaderType != GL_VERTEX_SHADER && shaderType != GL_COMPUTE_SHADER)
     {
         return 0;
     }
 
+    unsigned int shader = glCreateShader(shaderType);
+    glShaderSource(shader, 1, &code, NULL);
+    glCompileShader(shader);
+
+    return shader;
+}
+
+bool Renderer::CheckShader(unsigned int shader, int shaderType) const
+{
     int success;
     char infoLog[512];
 
-    // Shader
-    unsigned int shader = glCreateShader(shaderType);
-    glShaderSource(shader, 1, &vShaderCode, NULL);
-    glCompileShader(shader);
-    // print compile errors if any
     glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
     if (!success)
     {
         glGetShaderInfoLog(shader, 512, NULL, infoLog);
-        Logger::Error("{} COMPILATION_FAILED {}", ((shaderType == GL_FRAGMENT_SHADER) ? "FRAGMENT" : "VERTEX"), infoLog);
-    };
+        Logger::Error("{} COMPILATION_FAILED {}", ((shaderType == GL_FRAGMENT_SHADER) ? "FRAGMENT" : (shaderType == GL_COMPUTE_SHADER) ? "COMPUTE" : "VERTEX"), infoLog);
+        return false;
+    }
 
-    return shader;
+    return true;
+}
+
+int Renderer::GetActiveUniformCount(unsigned int ID) const
+{
+    int count = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+
+    return count;
+}
+
+std::string Renderer::GetActiveUniformName(unsigned int ID, int index, int& arraySize) const
+{
+    char name[256];
+    int length = 0;
+    unsigned int type = 0;
+
+    glGetActiveUniform(ID, (GLuint)index, sizeof(name), &length, &arraySize, &type, name);
+
+    return std::string(name, length);
+}
+
+int Renderer::GetUniformLocation(unsigned int ID, const std::string& mName) const
+{
+    return glGetUniformLocation(ID, mName.c_str());
 }
 
 void Renderer::UseShader(int ID)
 {
+    if (mBoundProgram == ID)
+    {
+        Counters.ProgramBindsSkipped++;
+        return;
+    }
+
     glUseProgram(ID);
+    mBoundProgram = ID;
+    Counters.ProgramBinds++;
 }
 
 void Renderer::UnUseShader()
 {
-    glUseProgram(0);
+    UseShader(0);
 }
 
-void Renderer::LinkShader(unsigned int& ID, unsigned int vertex, unsigned int fragment)
+bool Renderer::LinkShader(unsigned int& ID, unsigned int vertex, unsigned int fragment)
 {
-    int success;
-    char infoLog[512];
+    ID = CreateProgram(vertex, fragment);
 
-    // shader Program
-    ID = glCreateProgram();
+    // print linking errors if any
+    return CheckProgram(ID);
+}
+
+bool Renderer::LinkShader(unsigned int& ID, unsigned int compute)
+{
+    ID = CreateProgram(compute);
+
+    return CheckProgram(ID);
+}
+
+unsigned int Renderer::CreateProgram(unsigned int vertex, unsigned int fragment)
+{
+    const unsigned int ID = glCreateProgram();
+    // The binary of the program is saved in the ProgramCache
+    glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glAttachShader(ID, vertex);
     glAttachShader(ID, fragment);
     glLinkProgram(ID);
-    // print linking errors if any
+
+    return ID;
+}
+
+unsigned int Renderer::CreateProgram(unsigned int compute)
+{
+    const unsigned int ID = glCreateProgram();
+    glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(ID, compute);
+    glLinkProgram(ID);
+
+    return ID;
+}
+
+bool Renderer::CheckProgram(unsigned int ID) const
+{
+    int success;
+    char infoLog[512];
+
     glGetProgramiv(ID, GL_LINK_STATUS, &success);
     if (!success)
     {
         glGetProgramInfoLog(ID, 512, NULL, infoLog);
         Logger::Error("SHADER_LINKING_FAILED {}", infoLog);
-        return;
+        return false;
     }
+
+    return true;
+}
+
+bool Renderer::IsProgramCompleted(unsigned int ID) const
+{
+    // Without the extension the status query waits for the driver, the program is considered completed
+    if (!GLExtensions::ParallelShaderCompile)
+    {
+        return true;
+    }
+
+    int isCompleted = GL_FALSE;
+    glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &isCompleted);
+
+    return isCompleted == GL_TRUE;
+}
+
+bool Renderer::SetProgramBinary(unsigned int& ID, unsigned int format, const void* data, int size)
+{
+    ID = glCreateProgram();
+    glProgramBinary(ID, format, data, size);
+
+    // A binary of another driver or version is rejected, it's not an error
+    int success;
+    glGetProgramiv(ID, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glDeleteProgram(ID);
+        ID = 0;
+        return false;
+    }
+
+    return true;
+}
+
+bool Renderer::GetProgramBinary(unsigned int ID, unsigned int& format, std::vector<uint8_t>& data) const
+{
+    int length = 0;
+    glGetProgramiv(ID, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+    {
+        return false;
+    }
+
+    data.resize(length);
+    GLenum binaryFormat = 0;
+    glGetProgramBinary(ID, length, &length, &binaryFormat, data.data());
+    data.resize(length);
+    format = binaryFormat;
+
+    return length > 0;
+}
+
+int Renderer::GetProgramBinaryFormatCount() const
+{
+    int count = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &count);
+
+    return count;
+}
+
+std::string Renderer::GetDriverDescription() const
+{
+    const char* vendor = reinterpret_cast<const char*>(glGetString(GL_VENDOR));
+    const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+
+    return std::string(vendor ? vendor : "") + " / " + (renderer ? renderer : "") + " / " + (version ? version : "");
 }
 
 void Renderer::SetUniform(unsigned int ID, const std::string& mName, bool value) const
@@ -221,11 +620,191 @@ void Renderer::SetUniform(unsigned int ID, const std::string& mName, const Matri
     glUniformMatrix4fv(glGetUniformLocation(ID, mName.c_str()), 1, true, &m[0].x);
 }
 
+void Renderer::SetUniform(int location, bool value) const
+{
+    glUniform1i(location, (int)value);
+}
+
+void Renderer::SetUniform(int location, int value) const
+{
+    glUniform1i(location, value);
+}
+
+void Renderer::SetUniform(int location, float value) const
+{
+    glUniform1f(location, value);
+}
+
+void Renderer::SetUniform(int location, const Vector3& v) const
+{
+    glUniform3fv(location, 1, &v.x);
+}
+
+void Renderer::SetUniform(int location, const Matrix4x4& m) const
+{
+    glUniformMatrix4fv(location, 1, true, &m[0].x);
+}
+
+void Renderer::SetCameraBuffer(const Matrix4x4& vp, const Matrix4x4& view, const Matrix4x4& projection, const Vector3& viewPos)
+{
+    const CameraBufferData data = { vp, view, projection, Vector4(viewPos.x, viewPos.y, viewPos.z, 1.f) };
+
+    // Each pass gets its own copy, the draws of the previous pass still read theirs
+    const FrameDataAllocation allocation = AllocateFrameData(sizeof(CameraBufferData), mUniformOffsetAlignment);
+    std::memcpy(allocation.Data, &data, sizeof(CameraBufferData));
+    glBindBufferRange(GL_UNIFORM_BUFFER, CameraBufferBinding, mFrameDataBuffer, (GLintptr)allocation.Offset, sizeof(CameraBufferData));
+}
+
+void Renderer::BeginFrameData()
+{
+    mFrameDataSection = (mFrameDataSection + 1) % FrameDataSections;
+    mFrameDataHead = 0;
+
+    GLsync& fence = mFrameDataFences[mFrameDataSection];
+    if (fence)
+    {
+        // Only waits when the CPU is FrameDataSections frames ahead of the GPU
+        if (!IsFenceSignaled(fence))
+        {
+            Counters.FrameDataWaits++;
+            while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+            {
+            }
+        }
+
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    for (size_t i = 0; i < mRetiredFrameData.size();)
+    {
+        std::pair<unsigned int, GLsync>& retired = mRetiredFrameData[i];
+        if (!retired.second || !IsFenceSignaled(retired.second))
+        {
+            i++;
+            continue;
+        }
+
+        glDeleteSync(retired.second);
+        // Deleting the buffer unmaps it
+        glDeleteBuffers(1, &retired.first);
+        retired = mRetiredFrameData.back();
+        mRetiredFrameData.pop_back();
+    }
+}
+
+void Renderer::EndFrameData()
+{
+    mFrameDataFences[mFrameDataSection] = FenceSync();
+
+    for (std::pair<unsigned int, GLsync>& retired : mRetiredFrameData)
+    {
+        if (!retired.second)
+        {
+            retired.second = FenceSync();
+        }
+    }
+}
+
+void Renderer::ReserveFrameData(size_t size)
+{
+    if (mFrameDataHead + size <= mFrameDataSectionSize)
+    {
+        return;
+    }
+
+    // Nothing drawn by the GPU is in the new buffer, every section is free
+    mRetiredFrameData.emplace_back(mFrameDataBuffer, nullptr);
+    for (GLsync& fence : mFrameDataFences)
+    {
+        if (fence)
+        {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    size_t sectionSize = mFrameDataSectionSize * 2;
+    while (sectionSize < size)
+    {
+        sectionSize *= 2;
+    }
+
+    Logger::Info("Frame data ring buffer grown to {} MB per frame", sectionSize / (1024 * 1024));
+    CreateFrameData(sectionSize);
+}
+
+FrameDataAllocation Renderer::AllocateFrameData(size_t size, size_t alignment)
+{
+    const size_t sectionStart = mFrameDataSection * mFrameDataSectionSize;
+    size_t offset = (sectionStart + mFrameDataHead + alignment - 1) / alignment * alignment;
+
+    if (offset + size > sectionStart + mFrameDataSectionSize)
+    {
+        ReserveFrameData(size + alignment);
+        return AllocateFrameData(size, alignment);
+    }
+
+    mFrameDataHead = offset + size - sectionStart;
+    Counters.FrameDataBytes += size;
+
+    return { mFrameData + offset, offset };
+}
+
+unsigned int Renderer::GetFrameDataBuffer() const
+{
+    return mFrameDataBuffer;
+}
+
+size_t Renderer::GetFrameDataSectionSize() const
+{
+    return mFrameDataSectionSize;
+}
+
+size_t Renderer::GetUniformOffsetAlignment() const
+{
+    return mUniformOffsetAlignment;
+}
+
+size_t Renderer::GetStorageOffsetAlignment() const
+{
+    return mStorageOffsetAlignment;
+}
+
+void Renderer::CreateFrameData(size_t sectionSize)
+{
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    mFrameDataSectionSize = sectionSize;
+    mFrameDataHead = 0;
+
+    GenerateBuffer(1, &mFrameDataBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, mFrameDataBuffer);
+    SetBufferStorage(GL_COPY_WRITE_BUFFER, mFrameDataSectionSize * FrameDataSections, nullptr, flags);
+    mFrameData = static_cast<uint8_t*>(MapBufferRange(GL_COPY_WRITE_BUFFER, 0, mFrameDataSectionSize * FrameDataSections, flags));
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    if (!mFrameData)
+    {
+        Logger::Error("Renderer : the frame data ring buffer could not be mapped");
+    }
+}
+
 void Renderer::DeleteShader(unsigned int shader)
 {
     glDeleteShader(shader);
 }
 
+void Renderer::DeleteProgram(unsigned int ID)
+{
+    if (mBoundProgram == (int)ID)
+    {
+        UnUseShader();
+    }
+
+    glDeleteProgram(ID);
+}
+
 void Renderer::DeleteFramebuffers(int number, unsigned int* framebuffersID)
 {
     glDeleteFramebuffers(number, framebuffersID);
@@ -239,6 +818,37 @@ void Renderer::DeleteRenderbuffers(int number, unsigned int* renderbuffersID)
 void Renderer::DeleteTextures(int number, unsigned int* ID)
 {
     glDeleteTextures(number, ID);
+
+    // A deleted texture is unbound from every unit
+    for (int i = 0; i < number; i++)
+    {
+        for (int& boundTexture : mBoundTextures)
+        {
+            if (boundTexture == (int)ID[i])
+            {
+                boundTexture = 0;
+            }
+        }
+    }
+}
+
+void Renderer::DeleteBuffers(int number, unsigned int* buffers)
+{
+    glDeleteBuffers(number, buffers);
+}
+
+void Renderer::DeleteVertexArrays(int number, unsigned int* vertexArrays)
+{
+    glDeleteVertexArrays(number, vertexArrays);
+
+    // A deleted VAO is unbound
+    for (int i = 0; i < number; i++)
+    {
+        if (mBoundVertexArray == (int)vertexArrays[i])
+        {
+            mBoundVertexArray = 0;
+        }
+    }
 }
 
 void Renderer::SetDepth(unsigned int depth)
@@ -246,6 +856,34 @@ void Renderer::SetDepth(unsigned int depth)
     glDepthFunc(depth);
 }
 
+void Renderer::SetDepthMask(bool isWritten)
+{
+    glDepthMask(isWritten ? GL_TRUE : GL_FALSE);
+}
+
+void Renderer::SetColorMask(bool isWritten)
+{
+    const GLboolean mask = isWritten ? GL_TRUE : GL_FALSE;
+    glColorMask(mask, mask, mask, mask);
+}
+
+void Renderer::InvalidateStateCache()
+{
+    mBoundProgram = -1;
+    mBoundVertexArray = -1;
+
+    for (int& boundTexture : mBoundTextures)
+    {
+        boundTexture = -1;
+    }
+}
+
+void Renderer::ResetCounters()
+{
+    LastFrameCounters = Counters;
+    Counters = RenderCounters();
+}
+
 void Renderer::SetQuad(unsigned int VBO, unsigned int EBO, unsigned int VAO)
 {
     float Vertices[] = {
@@ -266,7 +904,7 @@ void Renderer::SetQuad(unsigned int VBO, unsigned int EBO, unsigned int VAO)
     glGenBuffers(1, &VBO);
     glGenBuffers(1, &EBO);
 
-    glBindVertexArray(VAO);
+    BindVertexArray(VAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(Vertices), &Vertices, GL_STATIC_DRAW);
@@ -284,7 +922,7 @@ void Renderer::SetQuad(unsigned int VBO, unsigned int EBO, unsigned int VAO)
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
     glEnableVertexAttribArray(2);
 
-    glBindVertexArray(0);
+    BindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }